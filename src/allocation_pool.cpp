@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/allocation_pool.hpp>
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+// The buffers of the pool are shared with the arguments that use them, so the state lives until
+// the last buffer is returned even when the pool is destroyed before
+struct allocation_pool_impl
+{
+    struct free_list
+    {
+        std::vector<char*> buffers;
+        // When a buffer of this size was last requested
+        std::size_t last_use = 0;
+    };
+    std::mutex mutex;
+    std::unordered_map<std::size_t, free_list> free;
+    allocation_stats stats;
+    std::size_t limit = std::numeric_limits<std::size_t>::max();
+    std::size_t ticks = 0;
+
+    ~allocation_pool_impl() { release(); }
+
+    // Round up to one of four sizes between consecutive powers of two, so buffers can be reused
+    // for sizes that differ a little while wasting at most a quarter of the size
+    static std::size_t size_class(std::size_t bytes)
+    {
+        const std::size_t min_size = 64;
+        if(bytes <= min_size)
+            return min_size;
+        std::size_t p = min_size;
+        while(p * 2 < bytes)
+            p *= 2;
+        const std::size_t step = p / 4;
+        return (bytes + step - 1) / step * step;
+    }
+
+    // Free the buffers of the least recently used sizes, other than the size to keep, until at
+    // most the given bytes are cached
+    void trim(std::size_t bytes, std::size_t keep = 0)
+    {
+        while(stats.cached_bytes > bytes)
+        {
+            auto it = free.end();
+            for(auto fit = free.begin(); fit != free.end(); ++fit)
+            {
+                if(fit->first == keep or fit->second.buffers.empty())
+                    continue;
+                if(it == free.end() or fit->second.last_use < it->second.last_use)
+                    it = fit;
+            }
+            if(it == free.end())
+                return;
+            auto& buffers = it->second.buffers;
+            while(not buffers.empty() and stats.cached_bytes > bytes)
+            {
+                delete[] buffers.back(); // NOLINT
+                buffers.pop_back();
+                stats.cached_bytes -= it->first;
+            }
+        }
+    }
+
+    void release()
+    {
+        trim(0);
+        free.clear();
+    }
+
+    // Keep a released buffer for reuse when it fits under the limit, which is never more than
+    // the most bytes that were in use at once
+    void put(char* ptr, std::size_t n)
+    {
+        stats.bytes_in_use -= n;
+        auto most = std::min(limit, stats.peak_bytes);
+        if(n <= most)
+            trim(most - n, n);
+        if(stats.cached_bytes + n > most)
+        {
+            delete[] ptr; // NOLINT
+            stats.trimmed++;
+            return;
+        }
+        stats.cached_bytes += n;
+        free[n].buffers.push_back(ptr);
+    }
+};
+
+static thread_local allocation_pool* current_pool = nullptr; // NOLINT
+
+allocation_pool::allocation_pool() : impl(std::make_shared<allocation_pool_impl>()) {}
+
+std::shared_ptr<char> allocation_pool::allocate(std::size_t bytes)
+{
+    auto n       = allocation_pool_impl::size_class(bytes);
+    char* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(impl->mutex);
+        auto& stats = impl->stats;
+        stats.allocations++;
+        stats.bytes_in_use += n;
+        stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes_in_use);
+        auto& fl         = impl->free[n];
+        fl.last_use      = ++impl->ticks;
+        if(not fl.buffers.empty())
+        {
+            buffer = fl.buffers.back();
+            fl.buffers.pop_back();
+            stats.reused++;
+            stats.cached_bytes -= n;
+        }
+    }
+    if(buffer == nullptr)
+        buffer = new char[n]; // NOLINT
+    std::memset(buffer, 0, bytes);
+    return {buffer, [n, pool = impl](char* ptr) {
+                std::lock_guard<std::mutex> lock(pool->mutex);
+                pool->put(ptr, n);
+            }};
+}
+
+allocation_stats allocation_pool::stats() const
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    return impl->stats;
+}
+
+void allocation_pool::release()
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->release();
+}
+
+void allocation_pool::trim(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->trim(bytes);
+}
+
+void allocation_pool::set_limit(std::size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(impl->mutex);
+    impl->limit = bytes;
+    impl->trim(bytes);
+}
+
+allocation_pool* allocation_pool::current() { return current_pool; }
+
+allocation_pool::scope::scope(allocation_pool* pool) : previous(current_pool)
+{
+    current_pool = pool;
+}
+
+allocation_pool::scope::~scope() { current_pool = previous; }
+
+std::ostream& operator<<(std::ostream& os, const allocation_stats& s)
+{
+    os << "Host allocations: " << s.allocations << ", reused: " << s.reused
+       << ", peak: " << s.peak_bytes / (1024.0 * 1024.0)
+       << "MiB, cached: " << s.cached_bytes / (1024.0 * 1024.0) << "MiB, trimmed: " << s.trimmed;
+    return os;
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -21,6 +21,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+#include <migraphx/batch_executor.hpp>
 #include <migraphx/execution_environment.hpp>
 #include <migraphx/migraphx.h>
 #include <migraphx/rank.hpp>
@@ -149,6 +150,13 @@ void set_exhaustive_tune_flag(compile_options& options, bool value)
 
 void set_file_format(file_options& options, const char* format) { options.format = format; }
 
+void set_max_batch(batch_executor_options& options, size_t value) { options.max_batch = value; }
+
+void set_max_latency(batch_executor_options& options, size_t value)
+{
+    options.max_latency = std::chrono::microseconds{value};
+}
+
 void set_default_dim_value(onnx_options& options, size_t value)
 {
     options.default_dim_value = value;
@@ -609,6 +617,39 @@ struct migraphx_program
     migraphx::program object;
 };
 
+extern "C" struct migraphx_batch_executor_options;
+struct migraphx_batch_executor_options
+{
+    template <class... Ts>
+    migraphx_batch_executor_options(Ts&&... xs)
+        : object(std::forward<Ts>(xs)...) // NOLINT(readability-redundant-member-init)
+    {
+    }
+    migraphx::batch_executor_options object;
+};
+
+extern "C" struct migraphx_batch_executor_stats;
+struct migraphx_batch_executor_stats
+{
+    template <class... Ts>
+    migraphx_batch_executor_stats(Ts&&... xs)
+        : object(std::forward<Ts>(xs)...) // NOLINT(readability-redundant-member-init)
+    {
+    }
+    migraphx::batch_executor_stats object;
+};
+
+extern "C" struct migraphx_batch_executor;
+struct migraphx_batch_executor
+{
+    template <class... Ts>
+    migraphx_batch_executor(Ts&&... xs)
+        : object(std::forward<Ts>(xs)...) // NOLINT(readability-redundant-member-init)
+    {
+    }
+    migraphx::batch_executor object;
+};
+
 extern "C" struct migraphx_operation;
 struct migraphx_operation
 {
@@ -1757,6 +1798,212 @@ migraphx_program_experimental_get_context(migraphx_context_t* out, const_migraph
     return api_error_result;
 }
 
+extern "C" migraphx_status
+migraphx_batch_executor_options_destroy(migraphx_batch_executor_options_t batch_executor_options)
+{
+    auto api_error_result = migraphx::try_([&] { destroy((batch_executor_options)); });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_options_assign_to(migraphx_batch_executor_options_t output,
+                                          const_migraphx_batch_executor_options_t input)
+{
+    auto api_error_result = migraphx::try_([&] { *output = *input; });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_options_create(migraphx_batch_executor_options_t* batch_executor_options)
+{
+    auto api_error_result = migraphx::try_([&] {
+        *batch_executor_options = object_cast<migraphx_batch_executor_options_t>(
+            allocate<migraphx::batch_executor_options>());
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_options_set_max_batch(
+    migraphx_batch_executor_options_t batch_executor_options, size_t value)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_options == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_options: Null pointer");
+        migraphx::set_max_batch((batch_executor_options->object), (value));
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_options_set_max_latency(
+    migraphx_batch_executor_options_t batch_executor_options, size_t value)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_options == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_options: Null pointer");
+        migraphx::set_max_latency((batch_executor_options->object), (value));
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_stats_destroy(migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] { destroy((batch_executor_stats)); });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_stats_assign_to(migraphx_batch_executor_stats_t output,
+                                        const_migraphx_batch_executor_stats_t input)
+{
+    auto api_error_result = migraphx::try_([&] { *output = *input; });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_stats_requests(size_t* out,
+                                       const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).requests;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_stats_batches(size_t* out,
+                                      const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).batches;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_stats_rows(size_t* out,
+                                   const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).rows;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_stats_padded_rows(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).padded_rows;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_stats_queue_depth(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).queue_depth;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_stats_max_queue_depth(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).max_queue_depth;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_stats_queue_time_us(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor_stats == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param,
+                           "Bad parameter batch_executor_stats: Null pointer");
+        *out = (batch_executor_stats->object).queue_time_us;
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_destroy(migraphx_batch_executor_t batch_executor)
+{
+    auto api_error_result = migraphx::try_([&] { destroy((batch_executor)); });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_assign_to(migraphx_batch_executor_t output,
+                                                             const_migraphx_batch_executor_t input)
+{
+    auto api_error_result = migraphx::try_([&] { *output = *input; });
+    return api_error_result;
+}
+
+extern "C" migraphx_status migraphx_batch_executor_create(migraphx_batch_executor_t* batch_executor,
+                                                          const_migraphx_program_t p,
+                                                          migraphx_batch_executor_options_t options)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(p == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter p: Null pointer");
+        if(options == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter options: Null pointer");
+        *batch_executor = object_cast<migraphx_batch_executor_t>(
+            allocate<migraphx::batch_executor>((p->object), (options->object)));
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_run(migraphx_arguments_t* out,
+                            const_migraphx_batch_executor_t batch_executor,
+                            migraphx_program_parameters_t params)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter batch_executor: Null pointer");
+        if(params == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter params: Null pointer");
+        *out = allocate<migraphx_arguments_t>((batch_executor->object).run((params->object)));
+    });
+    return api_error_result;
+}
+
+extern "C" migraphx_status
+migraphx_batch_executor_get_stats(migraphx_batch_executor_stats_t* out,
+                                  const_migraphx_batch_executor_t batch_executor)
+{
+    auto api_error_result = migraphx::try_([&] {
+        if(batch_executor == nullptr)
+            MIGRAPHX_THROW(migraphx_status_bad_param, "Bad parameter batch_executor: Null pointer");
+        *out = allocate<migraphx_batch_executor_stats_t>((batch_executor->object).stats());
+    });
+    return api_error_result;
+}
+
 extern "C" migraphx_status migraphx_operation_destroy(migraphx_operation_t operation)
 {
     auto api_error_result = migraphx::try_([&] { destroy((operation)); });
@@ -116,6 +116,15 @@ typedef const struct migraphx_module* const_migraphx_module_t;
 typedef struct migraphx_program* migraphx_program_t;
 typedef const struct migraphx_program* const_migraphx_program_t;
 
+typedef struct migraphx_batch_executor_options* migraphx_batch_executor_options_t;
+typedef const struct migraphx_batch_executor_options* const_migraphx_batch_executor_options_t;
+
+typedef struct migraphx_batch_executor_stats* migraphx_batch_executor_stats_t;
+typedef const struct migraphx_batch_executor_stats* const_migraphx_batch_executor_stats_t;
+
+typedef struct migraphx_batch_executor* migraphx_batch_executor_t;
+typedef const struct migraphx_batch_executor* const_migraphx_batch_executor_t;
+
 typedef struct migraphx_operation* migraphx_operation_t;
 typedef const struct migraphx_operation* const_migraphx_operation_t;
 
@@ -469,6 +478,67 @@ MIGRAPHX_C_EXPORT migraphx_status migraphx_program_equal(bool* out,
 MIGRAPHX_C_EXPORT migraphx_status migraphx_program_experimental_get_context(
     migraphx_context_t* out, const_migraphx_program_t program);
 
+MIGRAPHX_C_EXPORT migraphx_status
+migraphx_batch_executor_options_destroy(migraphx_batch_executor_options_t batch_executor_options);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_options_assign_to(
+    migraphx_batch_executor_options_t output, const_migraphx_batch_executor_options_t input);
+
+MIGRAPHX_C_EXPORT migraphx_status
+migraphx_batch_executor_options_create(migraphx_batch_executor_options_t* batch_executor_options);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_options_set_max_batch(
+    migraphx_batch_executor_options_t batch_executor_options, size_t value);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_options_set_max_latency(
+    migraphx_batch_executor_options_t batch_executor_options, size_t value);
+
+MIGRAPHX_C_EXPORT migraphx_status
+migraphx_batch_executor_stats_destroy(migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_assign_to(
+    migraphx_batch_executor_stats_t output, const_migraphx_batch_executor_stats_t input);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_requests(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_batches(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_rows(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_padded_rows(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_queue_depth(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_max_queue_depth(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_stats_queue_time_us(
+    size_t* out, const_migraphx_batch_executor_stats_t batch_executor_stats);
+
+MIGRAPHX_C_EXPORT migraphx_status
+migraphx_batch_executor_destroy(migraphx_batch_executor_t batch_executor);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_assign_to(
+    migraphx_batch_executor_t output, const_migraphx_batch_executor_t input);
+
+MIGRAPHX_C_EXPORT migraphx_status
+migraphx_batch_executor_create(migraphx_batch_executor_t* batch_executor,
+                               const_migraphx_program_t p,
+                               migraphx_batch_executor_options_t options);
+
+MIGRAPHX_C_EXPORT migraphx_status
+migraphx_batch_executor_run(migraphx_arguments_t* out,
+                            const_migraphx_batch_executor_t batch_executor,
+                            migraphx_program_parameters_t params);
+
+MIGRAPHX_C_EXPORT migraphx_status migraphx_batch_executor_get_stats(
+    migraphx_batch_executor_stats_t* out, const_migraphx_batch_executor_t batch_executor);
+
 MIGRAPHX_C_EXPORT migraphx_status migraphx_operation_destroy(migraphx_operation_t operation);
 
 MIGRAPHX_C_EXPORT migraphx_status migraphx_operation_assign_to(migraphx_operation_t output,
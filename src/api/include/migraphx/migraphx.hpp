@@ -1238,6 +1238,84 @@ struct program : MIGRAPHX_HANDLE_BASE(program)
     friend bool operator!=(const program& px, const program& py) { return not(px == py); }
 };
 
+/// Options for batching requests in a batch_executor
+struct batch_executor_options : MIGRAPHX_HANDLE_BASE(batch_executor_options)
+{
+    batch_executor_options() { this->make_handle(&migraphx_batch_executor_options_create); }
+
+    MIGRAPHX_HANDLE_CONSTRUCTOR(batch_executor_options)
+
+    /// Largest number of rows to run in a single batch, zero uses the
+    /// largest batch size the program supports
+    void set_max_batch(size_t value)
+    {
+        call(&migraphx_batch_executor_options_set_max_batch, this->get_handle_ptr(), value);
+    }
+
+    /// Longest time in microseconds a request waits for other requests to
+    /// fill its batch
+    void set_max_latency(size_t value)
+    {
+        call(&migraphx_batch_executor_options_set_max_latency, this->get_handle_ptr(), value);
+    }
+};
+
+/// Counters collected by a batch_executor
+struct batch_executor_stats : MIGRAPHX_HANDLE_BASE(batch_executor_stats)
+{
+    MIGRAPHX_HANDLE_CONSTRUCTOR(batch_executor_stats)
+
+    size_t requests() const { return get(&migraphx_batch_executor_stats_requests); }
+    size_t batches() const { return get(&migraphx_batch_executor_stats_batches); }
+    size_t rows() const { return get(&migraphx_batch_executor_stats_rows); }
+    size_t padded_rows() const { return get(&migraphx_batch_executor_stats_padded_rows); }
+    size_t queue_depth() const { return get(&migraphx_batch_executor_stats_queue_depth); }
+    size_t max_queue_depth() const { return get(&migraphx_batch_executor_stats_max_queue_depth); }
+    size_t queue_time_us() const { return get(&migraphx_batch_executor_stats_queue_time_us); }
+
+    private:
+    template <class F>
+    size_t get(F f) const
+    {
+        size_t pout;
+        call(f, &pout, this->get_handle_ptr());
+        return pout;
+    }
+};
+
+/// Runs a compiled program on requests from many threads, combining the
+/// requests along the batch dimension
+struct batch_executor : MIGRAPHX_HANDLE_BASE(batch_executor)
+{
+    MIGRAPHX_HANDLE_CONSTRUCTOR(batch_executor)
+
+    batch_executor(const program& p, const batch_executor_options& options)
+    {
+        this->make_handle(
+            &migraphx_batch_executor_create, p.get_handle_ptr(), options.get_handle_ptr());
+    }
+
+    batch_executor(const program& p) : batch_executor(p, batch_executor_options{}) {}
+
+    /// Run a single request, blocking until the batch it was placed in has
+    /// finished. This can be called concurrently from many threads. The
+    /// parameter buffers are read by the worker thread, so they must not be
+    /// freed by another thread while the call is running.
+    arguments run(const program_parameters& pparams) const
+    {
+        migraphx_arguments_t pout;
+        call(&migraphx_batch_executor_run, &pout, this->get_handle_ptr(), pparams.get_handle_ptr());
+        return arguments(pout, own{});
+    }
+
+    batch_executor_stats stats() const
+    {
+        migraphx_batch_executor_stats_t pout;
+        call(&migraphx_batch_executor_get_stats, &pout, this->get_handle_ptr());
+        return batch_executor_stats(pout, own{});
+    }
+};
+
 // options for migraphx file format options
 struct file_options : MIGRAPHX_HANDLE_BASE(file_options)
 {
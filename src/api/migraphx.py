@@ -297,6 +297,66 @@ def program(h):
              returns='migraphx::context')
 
 
+@auto_handle()
+def batch_executor_options(h):
+    h.constructor('create')
+    h.method('set_max_batch',
+             api.params(value='size_t'),
+             invoke='migraphx::set_max_batch($@)')
+    h.method('set_max_latency',
+             api.params(value='size_t'),
+             invoke='migraphx::set_max_latency($@)')
+
+
+@auto_handle()
+def batch_executor_stats(h):
+    h.method('requests',
+             invoke='${batch_executor_stats}.requests',
+             returns='size_t',
+             const=True)
+    h.method('batches',
+             invoke='${batch_executor_stats}.batches',
+             returns='size_t',
+             const=True)
+    h.method('rows',
+             invoke='${batch_executor_stats}.rows',
+             returns='size_t',
+             const=True)
+    h.method('padded_rows',
+             invoke='${batch_executor_stats}.padded_rows',
+             returns='size_t',
+             const=True)
+    h.method('queue_depth',
+             invoke='${batch_executor_stats}.queue_depth',
+             returns='size_t',
+             const=True)
+    h.method('max_queue_depth',
+             invoke='${batch_executor_stats}.max_queue_depth',
+             returns='size_t',
+             const=True)
+    h.method('queue_time_us',
+             invoke='${batch_executor_stats}.queue_time_us',
+             returns='size_t',
+             const=True)
+
+
+@auto_handle()
+def batch_executor(h):
+    h.constructor(
+        'create',
+        api.params(p='const migraphx::program&',
+                   options='migraphx::batch_executor_options'))
+    h.method('run',
+             api.params(
+                 params='std::unordered_map<std::string, migraphx::argument>'),
+             returns='std::vector<migraphx::argument>',
+             const=True)
+    h.method('get_stats',
+             fname='stats',
+             returns='migraphx::batch_executor_stats',
+             const=True)
+
+
 @auto_handle()
 def operation(h):
     h.constructor('create',
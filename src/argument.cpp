@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <migraphx/argument.hpp>
+#include <migraphx/allocation_pool.hpp>
 #include <migraphx/functional.hpp>
 #include <unordered_map>
 
@@ -30,7 +31,8 @@ inline namespace MIGRAPHX_INLINE_NS {
 
 argument::argument(const shape& s) : m_shape(s)
 {
-    auto buffer = make_shared_array<char>(s.bytes());
+    auto* pool  = allocation_pool::current();
+    auto buffer = pool == nullptr ? make_shared_array<char>(s.bytes()) : pool->allocate(s.bytes());
     assign_buffer({[=]() mutable { return buffer.get(); }});
 }
 
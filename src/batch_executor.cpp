@@ -0,0 +1,419 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/batch_executor.hpp>
+#include <migraphx/errors.hpp>
+#include <migraphx/ranges.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+namespace {
+
+struct batch_request
+{
+    parameter_map params;
+    std::size_t rows = 0;
+    // Rows already taken into a batch
+    std::size_t next_row = 0;
+    // Rows whose outputs have been written
+    std::size_t done_rows = 0;
+    bool failed           = false;
+    std::vector<argument> outputs;
+    std::promise<std::vector<argument>> result;
+    std::chrono::steady_clock::time_point submitted;
+};
+
+// A range of rows of a request placed at an offset in the batch
+struct batch_segment
+{
+    std::shared_ptr<batch_request> request;
+    std::size_t request_row = 0;
+    std::size_t batch_row   = 0;
+    std::size_t rows        = 0;
+};
+
+struct batch
+{
+    std::vector<batch_segment> segments;
+    std::size_t size = 0;
+};
+
+shape with_batch(const shape& s, std::size_t n)
+{
+    auto lens    = s.lens();
+    lens.front() = n;
+    return {s.type(), lens};
+}
+
+std::size_t row_bytes(const shape& s) { return s.bytes() / s.lens().front(); }
+
+std::vector<std::size_t> trailing_lens(const shape& s)
+{
+    return {s.lens().begin() + 1, s.lens().end()};
+}
+
+} // namespace
+
+struct batch_executor_impl
+{
+    batch_executor_impl(program p, batch_executor_options opts)
+        : prog(std::move(p)), options(opts), param_shapes(prog.get_parameter_shapes())
+    {
+        if(not prog.is_compiled())
+            MIGRAPHX_THROW("BATCH_EXECUTOR: program must be compiled");
+        find_batch_sizes();
+        max_batch = sizes.back();
+        if(options.max_batch > 0)
+            max_batch = std::min(max_batch, options.max_batch);
+        worker = std::thread([this] { work(); });
+    }
+
+    batch_executor_impl(const batch_executor_impl&)            = delete;
+    batch_executor_impl& operator=(const batch_executor_impl&) = delete;
+
+    ~batch_executor_impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopped = true;
+        }
+        cv.notify_all();
+        worker.join();
+    }
+
+    // The batch sizes come from the first dimension of the input parameters
+    void find_batch_sizes()
+    {
+        bool first = true;
+        for(auto&& [name, s] : param_shapes)
+        {
+            if(contains(name, "#output_"))
+                continue;
+            if(s.ndim() == 0)
+                MIGRAPHX_THROW("BATCH_EXECUTOR: parameter " + name + " has no batch dimension");
+            std::vector<std::size_t> param_sizes;
+            bool param_any_size = false;
+            if(s.dynamic() and not s.dyn_dims().front().is_fixed())
+            {
+                const auto& dd = s.dyn_dims().front();
+                param_sizes.assign(dd.optimals.begin(), dd.optimals.end());
+                param_sizes.push_back(dd.max);
+                param_any_size = dd.optimals.empty();
+                min_batch      = dd.min;
+            }
+            else
+            {
+                param_sizes = {s.dynamic() ? s.dyn_dims().front().max : s.lens().front()};
+            }
+            std::sort(param_sizes.begin(), param_sizes.end());
+            param_sizes.erase(std::unique(param_sizes.begin(), param_sizes.end()),
+                              param_sizes.end());
+            if(first)
+            {
+                sizes    = param_sizes;
+                any_size = param_any_size;
+                first    = false;
+            }
+            else if(sizes != param_sizes)
+            {
+                MIGRAPHX_THROW("BATCH_EXECUTOR: parameters have different batch dimensions");
+            }
+        }
+        if(first)
+            MIGRAPHX_THROW("BATCH_EXECUTOR: program has no parameters");
+    }
+
+    // Smallest batch size the rows fit into
+    std::size_t choose_batch(std::size_t rows) const
+    {
+        if(any_size)
+            return std::max(rows, min_batch);
+        auto it = std::lower_bound(sizes.begin(), sizes.end(), rows);
+        if(it == sizes.end())
+            return sizes.back();
+        return *it;
+    }
+
+    // Check the request against the parameter shapes and return its number of rows
+    std::size_t validate(const parameter_map& params) const
+    {
+        if(params.empty())
+            MIGRAPHX_THROW("BATCH_EXECUTOR: empty request");
+        std::size_t rows = 0;
+        for(auto&& [name, arg] : params)
+        {
+            auto it = param_shapes.find(name);
+            if(it == param_shapes.end())
+                MIGRAPHX_THROW("BATCH_EXECUTOR: unknown parameter " + name);
+            const auto& s     = arg.get_shape();
+            const auto& param = it->second;
+            if(s.dynamic() or not s.standard() or s.type() != param.type() or
+               s.ndim() != param.ndim())
+                MIGRAPHX_THROW("BATCH_EXECUTOR: invalid shape for parameter " + name);
+            if(param.dynamic())
+            {
+                const auto& dds = param.dyn_dims();
+                if(not std::equal(dds.begin() + 1,
+                                  dds.end(),
+                                  s.lens().begin() + 1,
+                                  [](const auto& dd, auto len) {
+                                      return len >= dd.min and len <= dd.max;
+                                  }))
+                    MIGRAPHX_THROW("BATCH_EXECUTOR: invalid shape for parameter " + name);
+            }
+            else if(trailing_lens(s) != trailing_lens(param))
+            {
+                MIGRAPHX_THROW("BATCH_EXECUTOR: invalid shape for parameter " + name);
+            }
+            if(rows == 0)
+                rows = s.lens().front();
+            if(rows == 0 or rows != s.lens().front())
+                MIGRAPHX_THROW("BATCH_EXECUTOR: parameters have different batch sizes");
+        }
+        for(auto&& [name, param] : param_shapes)
+        {
+            if(not contains(name, "#output_") and not contains(params, name))
+                MIGRAPHX_THROW("BATCH_EXECUTOR: missing parameter " + name);
+        }
+        return rows;
+    }
+
+    // Requests can only share a batch when all dimensions but the batch match
+    static bool compatible(const batch_request& x, const batch_request& y)
+    {
+        if(x.params.size() != y.params.size())
+            return false;
+        return std::all_of(x.params.begin(), x.params.end(), [&](auto&& pp) {
+            auto it = y.params.find(pp.first);
+            return it != y.params.end() and
+                   trailing_lens(it->second.get_shape()) == trailing_lens(pp.second.get_shape());
+        });
+    }
+
+    std::future<std::vector<argument>> submit(parameter_map params)
+    {
+        auto r    = std::make_shared<batch_request>();
+        r->rows   = validate(params);
+        r->params = std::move(params);
+        auto f    = r->result.get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            r->submitted = std::chrono::steady_clock::now();
+            queue.push_back(r);
+            queued_rows += r->rows;
+            st.requests++;
+            st.max_queue_depth = std::max<std::uint64_t>(st.max_queue_depth, queue.size());
+        }
+        cv.notify_one();
+        return f;
+    }
+
+    // Take rows from the front of the queue, must be called with the lock held
+    batch take_batch()
+    {
+        batch b;
+        auto now = std::chrono::steady_clock::now();
+        while(not queue.empty() and b.size < max_batch)
+        {
+            auto r = queue.front();
+            if(not b.segments.empty() and not compatible(*b.segments.front().request, *r))
+                break;
+            auto n = std::min(r->rows - r->next_row, max_batch - b.size);
+            if(r->next_row == 0)
+                st.queue_time_us +=
+                    std::chrono::duration_cast<std::chrono::microseconds>(now - r->submitted)
+                        .count();
+            b.segments.push_back({r, r->next_row, b.size, n});
+            r->next_row += n;
+            b.size += n;
+            queued_rows -= n;
+            if(r->next_row == r->rows)
+                queue.pop_front();
+        }
+        auto rows = b.size;
+        b.size    = choose_batch(rows);
+        st.batches++;
+        st.rows += rows;
+        st.padded_rows += b.size - rows;
+        return b;
+    }
+
+    static parameter_map gather(const batch& b)
+    {
+        parameter_map params;
+        for(auto&& [name, arg] : b.segments.front().request->params)
+        {
+            argument result{with_batch(arg.get_shape(), b.size)};
+            auto n          = row_bytes(arg.get_shape());
+            char* data      = result.data();
+            std::size_t end = 0;
+            for(auto&& seg : b.segments)
+            {
+                const char* src = seg.request->params.at(name).data() + seg.request_row * n;
+                std::copy_n(src, seg.rows * n, data + seg.batch_row * n);
+                end = seg.batch_row + seg.rows;
+            }
+            // Fill the padding with zeros
+            std::fill(data + end * n, data + b.size * n, 0);
+            params[name] = result;
+        }
+        return params;
+    }
+
+    static void scatter(const batch& b, const std::vector<argument>& results)
+    {
+        for(const auto& result : results)
+        {
+            const auto& s = result.get_shape();
+            if(s.dynamic() or not s.standard() or s.ndim() == 0 or s.lens().front() != b.size)
+                MIGRAPHX_THROW("BATCH_EXECUTOR: output is not batched");
+        }
+        for(auto&& seg : b.segments)
+        {
+            auto& r = *seg.request;
+            if(r.failed)
+                continue;
+            if(r.outputs.empty())
+            {
+                std::transform(results.begin(),
+                               results.end(),
+                               std::back_inserter(r.outputs),
+                               [&](const auto& result) {
+                                   return argument{with_batch(result.get_shape(), r.rows)};
+                               });
+            }
+            for(std::size_t i = 0; i < results.size(); i++)
+            {
+                auto n = row_bytes(results[i].get_shape());
+                std::copy_n(results[i].data() + seg.batch_row * n,
+                            seg.rows * n,
+                            r.outputs[i].data() + seg.request_row * n);
+            }
+            r.done_rows += seg.rows;
+            if(r.done_rows == r.rows)
+                r.result.set_value(std::move(r.outputs));
+        }
+    }
+
+    void run_batch(const batch& b)
+    {
+        try
+        {
+            scatter(b, prog.eval(gather(b)));
+        }
+        catch(...)
+        {
+            auto e = std::current_exception();
+            for(auto&& seg : b.segments)
+            {
+                if(seg.request->failed)
+                    continue;
+                seg.request->failed = true;
+                seg.request->result.set_exception(e);
+            }
+        }
+    }
+
+    void work()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for(;;)
+        {
+            cv.wait(lock, [&] { return stopped or not queue.empty(); });
+            if(queue.empty())
+                return;
+            // Wait for the batch to fill up, but not longer than the oldest request can wait
+            auto deadline = queue.front()->submitted + options.max_latency;
+            cv.wait_until(lock, deadline, [&] { return stopped or queued_rows >= max_batch; });
+            auto b = take_batch();
+            lock.unlock();
+            run_batch(b);
+            lock.lock();
+        }
+    }
+
+    batch_executor_stats stats() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto result        = st;
+        result.queue_depth = queue.size();
+        return result;
+    }
+
+    program prog;
+    batch_executor_options options;
+    std::unordered_map<std::string, shape> param_shapes;
+    std::vector<std::size_t> sizes;
+    bool any_size         = false;
+    std::size_t min_batch = 1;
+    std::size_t max_batch = 1;
+
+    mutable std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<std::shared_ptr<batch_request>> queue;
+    std::size_t queued_rows = 0;
+    bool stopped            = false;
+    batch_executor_stats st;
+    std::thread worker;
+};
+
+batch_executor::batch_executor(program p, batch_executor_options options)
+    : impl(std::make_shared<batch_executor_impl>(std::move(p), options))
+{
+}
+
+std::future<std::vector<argument>> batch_executor::submit(parameter_map params) const
+{
+    if(impl == nullptr)
+        MIGRAPHX_THROW("BATCH_EXECUTOR: executor has no program");
+    return impl->submit(std::move(params));
+}
+
+std::vector<argument> batch_executor::run(parameter_map params) const
+{
+    return submit(std::move(params)).get();
+}
+
+std::vector<std::size_t> batch_executor::batch_sizes() const
+{
+    if(impl == nullptr)
+        return {};
+    return impl->sizes;
+}
+
+batch_executor_stats batch_executor::stats() const
+{
+    if(impl == nullptr)
+        return {};
+    return impl->stats();
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
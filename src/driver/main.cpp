@@ -48,13 +48,17 @@
 #include <migraphx/eliminate_pad.hpp>
 #include <migraphx/generate.hpp>
 #include <migraphx/pass_manager.hpp>
+#include <migraphx/perf_profile.hpp>
 #include <migraphx/propagate_constant.hpp>
 #include <migraphx/quantization.hpp>
 #include <migraphx/register_op.hpp>
 #include <migraphx/simplify_algebra.hpp>
 #include <migraphx/simplify_reshapes.hpp>
 #include <migraphx/register_target.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/time.hpp>
 
+#include <cstring>
 #include <fstream>
 
 namespace migraphx {
@@ -79,6 +83,7 @@ struct loader
     bool optimize               = false;
     bool skip_unknown_operators = false;
     bool brief                  = false;
+    bool time_parse             = false;
     std::string output_type;
     std::string output;
     std::string default_dyn_dim;
@@ -112,6 +117,10 @@ struct loader
            ap.help("Skip unknown operators when parsing and continue to parse."),
            ap.set_value(true));
         ap(is_nhwc, {"--nchw"}, ap.help("Treat tensorflow format as nchw"), ap.set_value(false));
+        ap(time_parse,
+           {"--time-parse"},
+           ap.help("Print the time spent in each phase of parsing an onnx file"),
+           ap.set_value(true));
         ap(trim, {"--trim", "-t"}, ap.help("Trim instructions from the end"));
         ap(param_dims,
            {"--input-dim"},
@@ -164,6 +173,11 @@ struct loader
            {"--binary"},
            ap.help("Print out program in binary format."),
            ap.set_value("binary"));
+        ap(output_type,
+           {"--mapped"},
+           ap.help("Print out program in binary format with literals that are memory mapped "
+                   "when loading."),
+           ap.set_value("mapped"));
         ap(output, {"--output", "-o"}, ap.help("Output to file."));
     }
 
@@ -289,6 +303,7 @@ struct loader
         }
         options.skip_unknown_operators = skip_unknown_operators;
         options.print_program_on_error = true;
+        options.print_parse_time       = time_parse;
         options.map_input_dims         = map_input_dims;
         options.map_dyn_input_dims     = map_dyn_input_dims;
         options.dim_params             = map_dim_params;
@@ -421,6 +436,12 @@ struct loader
             *os << to_json_string(p.to_value()) << std::endl;
         else if(type == "binary")
             write(*os, save_buffer(p));
+        else if(type == "mapped")
+        {
+            file_options options;
+            options.mapped_literals = true;
+            write(*os, save_buffer(p, options));
+        }
     }
 };
 
@@ -487,6 +508,8 @@ struct compiler
     bool to_fp16 = false;
     bool to_fp8  = false;
     bool to_int8 = false;
+    calibration_options calibration;
+    std::size_t weight_bits = 0;
 
     std::vector<std::string> fill0;
     std::vector<std::string> fill1;
@@ -510,6 +533,24 @@ struct compiler
         ap(to_fp16, {"--fp16"}, ap.help("Quantize for fp16"), ap.set_value(true));
         ap(to_int8, {"--int8"}, ap.help("Quantize for int8"), ap.set_value(true));
         ap(to_fp8, {"--fp8"}, ap.help("Quantize for fp8e4m3fnuz type"), ap.set_value(true));
+        ap(calibration.method,
+           {"--calibration"},
+           ap.help("Calibration method for int8 and fp8: max, percentile or mse"));
+        ap(calibration.percentile,
+           {"--calibration-percentile"},
+           ap.help("Percentile of the values kept by the percentile calibration"));
+        ap(weight_bits,
+           {"--int4-weights"},
+           ap.help("Store the weights of dot as int4 and dequantize them in the dot"),
+           ap.set_value(4));
+        ap(weight_bits,
+           {"--int8-weights"},
+           ap.help("Store the weights of dot as int8 and dequantize them in the dot"),
+           ap.set_value(8));
+        ap(calibration.per_channel,
+           {"--per-channel"},
+           ap.help("Quantize the weights of dot and convolution for each output channel"),
+           ap.set_value(true));
     }
 
     auto params(const program& p)
@@ -556,13 +597,21 @@ struct compiler
         {
             quantize_fp16(p);
         }
+        if(weight_bits == 4)
+        {
+            quantize_weights_int4(p);
+        }
+        if(weight_bits == 8)
+        {
+            quantize_weights_int8(p);
+        }
         if(to_int8)
         {
-            quantize_int8(p, t, {host_params(p)});
+            quantize_int8(p, t, {host_params(p)}, {"dot", "convolution"}, calibration);
         }
         if(to_fp8)
         {
-            quantize_fp8(p, t, {host_params(p)});
+            quantize_fp8(p, t, {host_params(p)}, calibration);
         }
         p.compile(t, co);
         l.save(p);
@@ -690,8 +739,12 @@ struct run_cmd : command<run_cmd>
 struct perf : command<perf>
 {
     compiler c;
-    unsigned n = 100;
-    bool detailed = false;
+    unsigned n       = 100;
+    bool detailed    = false;
+    bool overhead    = false;
+    bool percentiles = false;
+    std::string trace_file;
+    std::string flame_graph_file;
     void parse(argument_parser& ap)
     {
         c.parse(ap);
@@ -700,6 +753,25 @@ struct perf : command<perf>
            {"--detailed", "-d"},
            ap.help("Show a more detailed summary report"),
            ap.set_value(true));
+        ap(overhead,
+           {"--overhead"},
+           ap.help("Only report the overhead of the interpreter without running the kernels"),
+           ap.set_value(true));
+        ap(percentiles,
+           {"--percentiles"},
+           ap.help("Report the p50/p90/p99 latency of every instruction"),
+           ap.set_value(true));
+        ap(trace_file,
+           {"--trace"},
+           ap.help("Write a chrome trace event file of every instruction run"));
+        ap(flame_graph_file,
+           {"--flame-graph"},
+           ap.help("Write the instruction times as folded stacks for a flame graph"));
+    }
+
+    bool profiling() const
+    {
+        return percentiles or not trace_file.empty() or not flame_graph_file.empty();
     }
 
     void run()
@@ -708,8 +780,35 @@ struct perf : command<perf>
         auto p = c.compile();
         std::cout << "Allocating params ... " << std::endl;
         auto m = c.params(p);
-        std::cout << "Running performance report ... " << std::endl;
-        p.perf_report(std::cout, n, m, c.l.batch, detailed);
+        if(overhead)
+        {
+            std::cout << "Running overhead report ... " << std::endl;
+            overhead_report(std::cout, p, m, n);
+            return;
+        }
+        if(not profiling())
+        {
+            std::cout << "Running performance report ... " << std::endl;
+            p.perf_report(std::cout, n, m, c.l.batch, detailed);
+            std::cout << p.get_allocation_stats() << std::endl;
+            return;
+        }
+        std::cout << "Running profile ... " << std::endl;
+        auto prof = p.profile(n, m);
+        if(percentiles)
+            prof.print_summary(std::cout);
+        if(not trace_file.empty())
+        {
+            std::ofstream fs(trace_file);
+            prof.write_chrome_trace(fs);
+            std::cout << "Wrote trace to " << trace_file << std::endl;
+        }
+        if(not flame_graph_file.empty())
+        {
+            std::ofstream fs(flame_graph_file);
+            prof.write_folded_stacks(fs);
+            std::cout << "Wrote folded stacks to " << flame_graph_file << std::endl;
+        }
     }
 };
 
@@ -798,6 +897,66 @@ struct tf : command<tf>
     }
 };
 
+struct bandwidth : command<bandwidth>
+{
+    template <class T>
+    static std::vector<T> to_vector(const std::vector<std::string>& xs)
+    {
+        std::vector<T> result(xs.size());
+        std::transform(xs.begin(), xs.end(), result.begin(), [](const std::string& x) {
+            return value_parser<T>::apply(x);
+        });
+        return result;
+    }
+
+    std::vector<std::string> lens;
+    std::vector<std::string> permutation;
+    std::size_t n = 100;
+    void parse(argument_parser& ap)
+    {
+        ap(lens,
+           {"--lens"},
+           ap.help("Dimensions of the tensor (default: 64 256 256)"),
+           ap.append(),
+           ap.nargs(2));
+        ap(permutation,
+           {"--permutation"},
+           ap.help("Permutation of the dimensions that is copied (default: 0 2 1)"),
+           ap.append(),
+           ap.nargs(2));
+        ap(n, {"--iterations", "-n"}, ap.help("Number of iterations to run"));
+    }
+
+    void run() const
+    {
+        using milliseconds = std::chrono::duration<double, std::milli>;
+        std::vector<std::size_t> dims = {64, 256, 256};
+        std::vector<int64_t> perm     = {0, 2, 1};
+        if(not lens.empty())
+            dims = to_vector<std::size_t>(lens);
+        if(not permutation.empty())
+            perm = to_vector<int64_t>(permutation);
+        shape s{shape::float_type, dims};
+        auto input  = generate_argument(s);
+        auto ts     = make_op("transpose", {{"permutation", perm}}).compute_shape({s});
+        auto output = argument{shape{s.type(), ts.lens()}};
+        auto op     = make_op("contiguous");
+        // Both the reads and the writes are counted
+        auto report = [&](const std::string& name, auto f) {
+            f();
+            double ms = time<milliseconds>([&] {
+                for(std::size_t i = 0; i < n; i++)
+                    f();
+            });
+            std::cout << name << ": " << 2.0 * s.bytes() * n / (ms * 1.0e6) << " GB/s"
+                      << std::endl;
+        };
+        report("memcpy", [&] { std::memcpy(output.data(), input.data(), s.bytes()); });
+        report("contiguous", [&] { op.compute(s, {input}); });
+        report("transpose", [&] { op.compute(output.get_shape(), {input.reshape(ts)}); });
+    }
+};
+
 struct main_command
 {
     static std::string get_command_help(const std::string& title = colorize(color::fg_yellow,
@@ -27,6 +27,8 @@
 #include <migraphx/instruction.hpp>
 #include <migraphx/instruction_ref.hpp>
 #include <migraphx/register_target.hpp>
+#include <migraphx/time.hpp>
+#include <numeric>
 #ifdef HAVE_GPU
 #include <migraphx/gpu/hip.hpp>
 #endif
@@ -131,6 +133,35 @@ bool is_offload_copy_set(const program& p)
     return param_ins.empty();
 }
 
+void overhead_report(std::ostream& os, const program& p, const parameter_map& m, std::size_t n)
+{
+    using milliseconds = std::chrono::duration<double, std::milli>;
+    if(n == 0)
+        return;
+    // Warm up
+    p.dry_run(m);
+    std::vector<double> times;
+    times.reserve(n);
+    for(std::size_t i = 0; i < n; i++)
+        times.push_back(time<milliseconds>([&] { p.dry_run(m); }));
+    std::sort(times.begin(), times.end());
+    auto mods        = p.get_modules();
+    std::size_t nins = std::accumulate(
+        mods.begin(), mods.end(), std::size_t{0}, [](auto x, const auto* mod) {
+            return x + mod->size();
+        });
+    double average = std::accumulate(times.begin(), times.end(), 0.0) / times.size();
+    double median  = times[times.size() / 2];
+    double per_ins = nins == 0 ? 0.0 : average * 1000.0 / nins;
+    os << "Instructions: " << nins << std::endl;
+    os << "Iterations: " << n << std::endl;
+    os << "Overhead min: " << times.front() << "ms" << std::endl;
+    os << "Overhead median: " << median << "ms" << std::endl;
+    os << "Overhead max: " << times.back() << "ms" << std::endl;
+    os << "Overhead average: " << average << "ms" << std::endl;
+    os << "Overhead per instruction: " << per_ins << "us" << std::endl;
+}
+
 } // namespace  MIGRAPHX_INLINE_NS
 } // namespace driver
 } // namespace migraphx
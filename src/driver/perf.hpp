@@ -49,6 +49,17 @@ target get_target(bool gpu);
  */
 bool is_offload_copy_set(const program& p);
 
+/**
+ * @brief Reports the time spent by the interpreter to walk the program without running any of
+ the kernels, which is the fixed cost paid by each call to eval.
+
+ * @param os Stream to print the report to
+ * @param p Compiled MIGraphX program
+ * @param m Parameters used to run the program
+ * @param n Number of iterations to time
+ */
+void overhead_report(std::ostream& os, const program& p, const parameter_map& m, std::size_t n);
+
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace driver
 } // namespace migraphx
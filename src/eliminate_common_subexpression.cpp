@@ -27,16 +27,30 @@
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/functional.hpp>
+#include <migraphx/hash.hpp>
 
+#include <unordered_map>
 #include <unordered_set>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+// Instructions are equal when they use the same inputs, so combine the
+// structural hash with the identity of the inputs
+static std::size_t cse_hash(instruction_ref ins)
+{
+    std::size_t h = ins->hash();
+    for(auto input : ins->inputs())
+        hash_combine(h, input);
+    return h;
+}
+
 template <class Range>
-void cse_range(module& m, Range&& r)
+void cse_range(module& m,
+               Range&& r,
+               const std::unordered_map<instruction_ref, std::size_t>& positions)
 {
-    std::unordered_multimap<std::string, instruction_ref> instructions;
+    std::unordered_multimap<std::size_t, instruction_ref> instructions;
     std::unordered_set<instruction_ref> processed_ins;
     for(auto ins : r)
     {
@@ -44,8 +58,9 @@ void cse_range(module& m, Range&& r)
         if(ins->outputs().empty())
             continue;
 
-        // Find instruction with the same name
-        auto found_instructions = range(instructions.equal_range(ins->name()));
+        // Find instruction with the same hash
+        auto h                  = cse_hash(ins);
+        auto found_instructions = range(instructions.equal_range(h));
         for(const auto& pp : found_instructions)
         {
             auto eq = pp.second;
@@ -61,16 +76,23 @@ void cse_range(module& m, Range&& r)
                          std::back_inserter(outputs),
                          [&](auto x) { return m.has_instruction(x); });
 
-            std::sort(outputs.begin(), outputs.end(), [&](auto x, auto y) {
-                return std::distance(eq, x) < std::distance(eq, y);
-            });
-            cse_range(m, outputs);
+            std::sort(outputs.begin(),
+                      outputs.end(),
+                      by(std::less<>{}, [&](auto x) { return positions.at(x); }));
+            cse_range(m, outputs, positions);
         }
-        instructions.emplace(ins->name(), ins);
+        instructions.emplace(h, ins);
     }
 }
 
-void eliminate_common_subexpression::apply(module& m) const { cse_range(m, iterator_for(m)); }
+void eliminate_common_subexpression::apply(module& m) const
+{
+    // The pass only rewires inputs, so the positions stay valid throughout
+    std::unordered_map<instruction_ref, std::size_t> positions;
+    for(auto ins : iterator_for(m))
+        positions.emplace(ins, positions.size());
+    cse_range(m, iterator_for(m), positions);
+}
 
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
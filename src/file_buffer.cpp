@@ -26,6 +26,12 @@
 #include <migraphx/fileutils.hpp>
 #include <fstream>
 #include <iostream>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -65,6 +71,31 @@ std::string read_string(const fs::path& filename)
     return generic_read_file<std::string>(filename);
 }
 
+std::shared_ptr<char> map_buffer(const fs::path& filename)
+{
+#ifdef _WIN32
+    auto buffer = std::make_shared<std::vector<char>>(read_buffer(filename));
+    return {buffer, buffer->data()};
+#else
+    int fd = open(filename.c_str(), O_RDONLY); // NOLINT
+    if(fd < 0)
+        MIGRAPHX_THROW("Failure opening file: " + filename);
+    struct stat st = {};
+    if(fstat(fd, &st) != 0 or st.st_size < 1)
+    {
+        close(fd);
+        MIGRAPHX_THROW("Invalid size for: " + filename);
+    }
+    auto size = static_cast<std::size_t>(st.st_size);
+    void* p   = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping stays valid after the file is closed
+    close(fd);
+    if(p == MAP_FAILED) // NOLINT
+        MIGRAPHX_THROW("Failure mapping file: " + filename);
+    return {static_cast<char*>(p), [size](char* x) { munmap(x, size); }};
+#endif
+}
+
 void write_buffer(const fs::path& filename, const char* buffer, std::size_t size)
 {
     std::ofstream os(filename, std::ios::out | std::ios::binary);
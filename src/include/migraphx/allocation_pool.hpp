@@ -0,0 +1,96 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_ALLOCATION_POOL_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_ALLOCATION_POOL_HPP
+
+#include <migraphx/config.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <memory>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct allocation_stats
+{
+    // Number of buffers requested from the pool
+    std::size_t allocations = 0;
+    // Number of requests served with a buffer that was released before
+    std::size_t reused = 0;
+    // Bytes of the buffers that are used, and the most that were used at once
+    std::size_t bytes_in_use = 0;
+    std::size_t peak_bytes   = 0;
+    // Bytes of the released buffers kept for reuse
+    std::size_t cached_bytes = 0;
+    // Number of released buffers that were freed to stay under the limit of the pool
+    std::size_t trimmed = 0;
+};
+
+MIGRAPHX_EXPORT std::ostream& operator<<(std::ostream& os, const allocation_stats& s);
+
+struct allocation_pool_impl;
+
+/// A pool of host buffers grouped in size classes. While a pool is in use on a thread, the
+/// arguments that thread allocates take their buffers from the pool, and a buffer goes back to
+/// the pool once the last argument that refers to it is released. The buffers are zeroed like
+/// the ones allocated without a pool. The pool keeps at most as many bytes as were in use at
+/// once, and less when a limit is set. The buffers of the sizes that were used least recently are
+/// freed first, so the buffers of shapes that are no longer used don't stay in the pool.
+struct MIGRAPHX_EXPORT allocation_pool
+{
+    allocation_pool();
+
+    std::shared_ptr<char> allocate(std::size_t bytes);
+
+    allocation_stats stats() const;
+    /// Frees the cached buffers
+    void release();
+    /// Frees the cached buffers until at most `bytes` are cached
+    void trim(std::size_t bytes);
+    /// Sets the most bytes of released buffers kept for reuse
+    void set_limit(std::size_t bytes);
+
+    /// The pool used by the arguments allocated on this thread, or nullptr
+    static allocation_pool* current();
+
+    /// Uses the pool on this thread while the scope is alive
+    struct MIGRAPHX_EXPORT scope
+    {
+        explicit scope(allocation_pool* pool);
+        scope(const scope&)            = delete;
+        scope& operator=(const scope&) = delete;
+        ~scope();
+
+        private:
+        allocation_pool* previous;
+    };
+
+    private:
+    std::shared_ptr<allocation_pool_impl> impl;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif // MIGRAPHX_GUARD_MIGRAPHX_ALLOCATION_POOL_HPP
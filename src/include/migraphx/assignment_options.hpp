@@ -25,6 +25,8 @@
 #define MIGRAPHX_GUARD_RTGLIB_ASSIGNMENT_OPTIONS_HPP
 
 #include <migraphx/support_metric.hpp>
+#include <string>
+#include <unordered_map>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -32,6 +34,9 @@ inline namespace MIGRAPHX_INLINE_NS {
 struct assignment_options
 {
     support_metric metric = support_metric::latency;
+    /// The cost to copy a byte to or from each target, in the units of the metric of its
+    /// supported segments. The targets that are missing share the memory of the host.
+    std::unordered_map<std::string, float> copy_costs = {};
 };
 
 } // namespace MIGRAPHX_INLINE_NS
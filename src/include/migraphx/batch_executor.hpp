@@ -0,0 +1,99 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_BATCH_EXECUTOR_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_BATCH_EXECUTOR_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/program.hpp>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <memory>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct batch_executor_options
+{
+    /// Most rows evaluated together. Zero uses the largest batch size the program supports.
+    std::size_t max_batch = 0;
+    /// Longest time the oldest request waits for more requests before a partial batch is run
+    std::chrono::microseconds max_latency{1000};
+};
+
+struct batch_executor_stats
+{
+    // Number of requests submitted
+    std::uint64_t requests = 0;
+    // Number of times the program was evaluated
+    std::uint64_t batches = 0;
+    // Number of rows from requests that were evaluated
+    std::uint64_t rows = 0;
+    // Number of rows added to fill up a batch
+    std::uint64_t padded_rows = 0;
+    // Number of requests waiting to be evaluated
+    std::uint64_t queue_depth = 0;
+    // Largest number of requests that were waiting at the same time
+    std::uint64_t max_queue_depth = 0;
+    // Total time the requests waited in the queue before being evaluated
+    std::uint64_t queue_time_us = 0;
+};
+
+struct batch_executor_impl;
+
+/// Evaluates a compiled program for many independent requests by concatenating them along the
+/// first (batch) dimension. Requests are padded up to the batch size of the program, or to the
+/// closest optimal batch size for a program with a dynamic batch, and requests larger than the
+/// batch are split over several evaluations. The outputs must also be batched along the first
+/// dimension and each request gets back its own rows. The arguments passed in and returned are
+/// host buffers, so programs for a device target should be compiled with offload copy.
+///
+/// Copies of the executor share the same queue and worker thread.
+struct MIGRAPHX_EXPORT batch_executor
+{
+    batch_executor() = default;
+    explicit batch_executor(program p, batch_executor_options options = {});
+
+    /// Queues a request. Each parameter has the shape of the program parameter except for the
+    /// batch dimension, which can be any size greater than zero but must be the same for all of
+    /// the parameters. Every input parameter of the program must be passed. The arguments are
+    /// not copied, so their buffers must stay valid until the future is ready.
+    std::future<std::vector<argument>> submit(parameter_map params) const;
+
+    /// Submits a request and waits for its outputs
+    std::vector<argument> run(parameter_map params) const;
+
+    /// The batch sizes the requests are padded up to
+    std::vector<std::size_t> batch_sizes() const;
+
+    batch_executor_stats stats() const;
+
+    private:
+    std::shared_ptr<batch_executor_impl> impl;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif // MIGRAPHX_GUARD_MIGRAPHX_BATCH_EXECUTOR_HPP
@@ -25,76 +25,551 @@
 #define MIGRAPHX_GUARD_RTGLIB_CONVOLUTION_HPP
 
 #include <migraphx/config.hpp>
-#include <migraphx/dfor.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/errors.hpp>
+#include <migraphx/gemm.hpp>
 #include <migraphx/par_for.hpp>
-#include <migraphx/shape_for_each.hpp>
 #include <migraphx/tensor_view.hpp>
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include <type_traits>
 #include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-template <class Output, class T, class Padding, class Stride, class Dilation>
-void convolution(
-    Output output, T input, T weights, Padding padding, Stride stride, Dilation dilation, int group)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CONV_WINOGRAD)
+
+enum class convolution_algorithm
 {
-    auto output_shape = output.get_shape();
-    auto in_lens      = input.get_shape().lens();
+    automatic,
+    direct,
+    im2col,
+    winograd_f2x3,
+    winograd_f4x3
+};
 
-    auto wei_lens = weights.get_shape().lens();
-    auto wei_n    = wei_lens[0];
-    auto wei_c    = wei_lens[1];
-    std::vector<std::size_t> win_size(wei_lens.begin() + 1, wei_lens.end());
+namespace detail {
 
-    par_for(output_shape.elements(), [&](auto i) {
-        auto idx_o = output_shape.multi(i);
-        auto w     = idx_o[1];
-        auto n_dim = idx_o.size();
+struct conv_geometry
+{
+    std::size_t batch = 0;
+    // Number of input and output channels in each group
+    std::size_t wei_c = 0;
+    std::size_t wei_n = 0;
+    std::size_t group = 1;
+    std::vector<std::size_t> in_lens;
+    std::vector<std::size_t> out_lens;
+    std::vector<std::size_t> win_lens;
+    std::vector<std::ptrdiff_t> padding;
+    std::vector<std::ptrdiff_t> stride;
+    std::vector<std::ptrdiff_t> dilation;
+    std::size_t out_elements = 1;
+    std::size_t win_elements = 1;
 
-        std::vector<std::ptrdiff_t> win_start;
-        for(std::size_t dim = 2; dim < n_dim; ++dim)
+    std::size_t ndim() const { return in_lens.size(); }
+    std::size_t out_channels() const { return wei_n * group; }
+
+    // Dilated offsets of each element of the window for every spatial dimension
+    std::vector<std::ptrdiff_t> window_offsets() const
+    {
+        std::vector<std::ptrdiff_t> result;
+        result.reserve(win_elements * ndim());
+        std::vector<std::size_t> idx(ndim(), 0);
+        for(std::size_t w = 0; w < win_elements; w++)
         {
-            auto d_2 = dim - 2;
-            win_start.push_back(std::ptrdiff_t(idx_o[dim] * stride[d_2]) -
-                                std::ptrdiff_t(padding[d_2]));
+            for(std::size_t d = 0; d < ndim(); d++)
+                result.push_back(std::ptrdiff_t(idx[d]) * dilation[d]);
+            next_index(idx, win_lens);
         }
-        const auto group_id = w / (wei_n / group);
-
-        shape win_shape{output_shape.type(), win_size};
-
-        double acc = 0.0;
-        shape_for_each(win_shape, [&](const auto& idx_win) {
-            auto k           = idx_win[0];
-            const auto in_ch = group_id * wei_c + k;
-            std::vector<std::ptrdiff_t> idx(idx_o.begin(), idx_o.end());
-            idx[1] = in_ch;
-            std::vector<std::ptrdiff_t> idx_dil(idx_win.size() - 1);
-            std::transform(idx_win.cbegin() + 1,
-                           idx_win.cend(),
-                           dilation.cbegin(),
-                           idx_dil.begin(),
-                           [](std::ptrdiff_t ii, std::ptrdiff_t d) { return d * ii; });
-            std::transform(idx_dil.begin(),
-                           idx_dil.end(),
-                           win_start.begin(),
-                           idx.begin() + 2,
-                           [](std::ptrdiff_t ii, std::ptrdiff_t jj) { return ii + jj; });
-            std::vector<std::ptrdiff_t> idx_wei(idx_o.size());
-            idx_wei[0] = w;
-            std::copy(idx_win.begin(), idx_win.end(), idx_wei.begin() + 1);
-            if(std::all_of(idx.begin() + 2, idx.end(), [&](auto ii) { return ii >= 0; }) and
-               std::equal(idx.begin(),
-                          idx.end(),
-                          in_lens.begin(),
-                          in_lens.end(),
-                          std::less<std::ptrdiff_t>{}))
+        return result;
+    }
+
+    // Increment a multi-index over the lens, returns false after the last index
+    static bool next_index(std::vector<std::size_t>& idx, const std::vector<std::size_t>& lens)
+    {
+        for(std::size_t d = idx.size(); d > 0; d--)
+        {
+            if(++idx[d - 1] < lens[d - 1])
+                return true;
+            idx[d - 1] = 0;
+        }
+        return false;
+    }
+
+    static void
+    unflatten(std::size_t i, const std::vector<std::size_t>& lens, std::vector<std::size_t>& idx)
+    {
+        for(std::size_t d = lens.size(); d > 0; d--)
+        {
+            idx[d - 1] = i % lens[d - 1];
+            i /= lens[d - 1];
+        }
+    }
+};
+
+template <class Padding, class Stride, class Dilation>
+conv_geometry make_conv_geometry(const shape& output,
+                                 const shape& input,
+                                 const shape& weights,
+                                 const Padding& padding,
+                                 const Stride& stride,
+                                 const Dilation& dilation,
+                                 int group)
+{
+    conv_geometry g;
+    const auto& wei_lens = weights.lens();
+    g.batch              = output.lens()[0];
+    g.group              = group;
+    g.wei_n              = wei_lens[0] / group;
+    g.wei_c              = wei_lens[1];
+    g.in_lens.assign(input.lens().begin() + 2, input.lens().end());
+    g.out_lens.assign(output.lens().begin() + 2, output.lens().end());
+    g.win_lens.assign(wei_lens.begin() + 2, wei_lens.end());
+    for(std::size_t d = 0; d < g.ndim(); d++)
+    {
+        g.padding.push_back(padding[d]);
+        g.stride.push_back(stride[d]);
+        g.dilation.push_back(dilation[d]);
+    }
+    g.out_elements = std::accumulate(
+        g.out_lens.begin(), g.out_lens.end(), std::size_t{1}, std::multiplies<>{});
+    g.win_elements = std::accumulate(
+        g.win_lens.begin(), g.win_lens.end(), std::size_t{1}, std::multiplies<>{});
+    return g;
+}
+
+// Returns the stride to traverse all of the spatial dimensions as a single dimension, or zero if
+// they are not packed together
+inline std::size_t spatial_stride(const shape& s)
+{
+    const auto& lens    = s.lens();
+    const auto& strides = s.strides();
+    for(std::size_t d = 2; d + 1 < lens.size(); d++)
+    {
+        if(strides[d] != strides[d + 1] * lens[d + 1])
+            return 0;
+    }
+    return strides.back();
+}
+
+template <class T>
+using conv_value_t = std::remove_cv_t<typename T::value_type>;
+
+// Computes each output directly from the window of the input. This is used for depthwise
+// convolutions where there is no reduction over the channels to turn into a gemm.
+template <class Output, class T>
+void conv_direct(Output output, T input, T weights, const conv_geometry& g)
+{
+    using out_type        = conv_value_t<Output>;
+    using acc_type        = gemm_accumulator_t<conv_value_t<T>>;
+    const auto& os        = output.get_shape();
+    const auto& is        = input.get_shape();
+    const auto& ws        = weights.get_shape();
+    const std::size_t nd  = g.ndim();
+    const auto win_off    = g.window_offsets();
+    std::vector<std::size_t> wei_off;
+    std::vector<std::size_t> widx(nd, 0);
+    do
+    {
+        wei_off.push_back(
+            std::inner_product(widx.begin(), widx.end(), ws.strides().begin() + 2, std::size_t{0}));
+    } while(conv_geometry::next_index(widx, g.win_lens));
+
+    par_for(g.batch * g.out_channels(), [&](std::size_t i) {
+        const std::size_t n  = i / g.out_channels();
+        const std::size_t k  = i % g.out_channels();
+        const std::size_t gi = k / g.wei_n;
+        const auto* in = input.data() + n * is.strides()[0] + gi * g.wei_c * is.strides()[1];
+        const auto* wei = weights.data() + k * ws.strides()[0];
+        auto* out       = output.data() + n * os.strides()[0] + k * os.strides()[1];
+        std::vector<std::size_t> pos(nd, 0);
+        std::vector<std::ptrdiff_t> start(nd);
+        do
+        {
+            std::size_t out_off = 0;
+            for(std::size_t d = 0; d < nd; d++)
+            {
+                start[d] = std::ptrdiff_t(pos[d]) * g.stride[d] - g.padding[d];
+                out_off += pos[d] * os.strides()[d + 2];
+            }
+            acc_type acc = 0;
+            for(std::size_t w = 0; w < g.win_elements; w++)
+            {
+                std::ptrdiff_t in_off = 0;
+                bool inside           = true;
+                for(std::size_t d = 0; d < nd and inside; d++)
+                {
+                    auto x = start[d] + win_off[w * nd + d];
+                    inside = x >= 0 and x < std::ptrdiff_t(g.in_lens[d]);
+                    in_off += x * std::ptrdiff_t(is.strides()[d + 2]);
+                }
+                if(not inside)
+                    continue;
+                for(std::size_t c = 0; c < g.wei_c; c++)
+                {
+                    acc += static_cast<acc_type>(in[c * is.strides()[1] + in_off]) *
+                           static_cast<acc_type>(wei[c * ws.strides()[1] + wei_off[w]]);
+                }
+            }
+            out[out_off] = static_cast<out_type>(acc);
+        } while(conv_geometry::next_index(pos, g.out_lens));
+    });
+}
+
+// Unfolds the input windows into columns and computes the convolution with a gemm for each
+// group. The output positions are processed in chunks to bound the size of the column buffer.
+template <class Output, class T>
+void conv_im2col(Output output, T input, T weights, const conv_geometry& g)
+{
+    using in_type         = conv_value_t<T>;
+    using out_type        = conv_value_t<Output>;
+    const auto& os        = output.get_shape();
+    const auto& is        = input.get_shape();
+    const auto& ws        = weights.get_shape();
+    const std::size_t nd  = g.ndim();
+    const std::size_t kdim = g.wei_c * g.win_elements;
+    // Nothing is reduced so the output is zero
+    if(kdim == 0)
+    {
+        std::fill(output.begin(), output.end(), out_type{0});
+        return;
+    }
+    const std::size_t chunk =
+        std::max<std::size_t>(1, std::min(g.out_elements, (1u << 20) / kdim));
+    const auto win_off = g.window_offsets();
+    const auto zero    = static_cast<in_type>(0);
+
+    // The weights are used as a matrix of output channels by window elements
+    std::vector<in_type> wpack;
+    in_type* wdata = weights.data();
+    if(not ws.standard())
+    {
+        wpack.assign(weights.begin(), weights.end());
+        wdata = wpack.data();
+    }
+
+    const std::size_t out_stride = spatial_stride(os);
+    std::vector<in_type> cols(chunk * kdim);
+    std::vector<out_type> tmp(out_stride == 0 ? g.wei_n * chunk : 0);
+    for(std::size_t n = 0; n < g.batch; n++)
+    {
+        for(std::size_t gi = 0; gi < g.group; gi++)
+        {
+            const auto* in = input.data() + n * is.strides()[0] + gi * g.wei_c * is.strides()[1];
+            for(std::size_t p0 = 0; p0 < g.out_elements; p0 += chunk)
             {
-                acc += input(idx.begin(), idx.end()) * weights(idx_wei.begin(), idx_wei.end());
+                const std::size_t pc = std::min(chunk, g.out_elements - p0);
+                par_for(pc, std::max<std::size_t>(1, 4096 / kdim), [&](std::size_t j) {
+                    std::vector<std::size_t> pos(nd);
+                    conv_geometry::unflatten(p0 + j, g.out_lens, pos);
+                    in_type* col = cols.data() + j * kdim;
+                    for(std::size_t w = 0; w < g.win_elements; w++)
+                    {
+                        std::ptrdiff_t in_off = 0;
+                        bool inside           = true;
+                        for(std::size_t d = 0; d < nd and inside; d++)
+                        {
+                            auto x = std::ptrdiff_t(pos[d]) * g.stride[d] - g.padding[d] +
+                                     win_off[w * nd + d];
+                            inside = x >= 0 and x < std::ptrdiff_t(g.in_lens[d]);
+                            in_off += x * std::ptrdiff_t(is.strides()[d + 2]);
+                        }
+                        for(std::size_t c = 0; c < g.wei_c; c++)
+                        {
+                            col[c * g.win_elements + w] =
+                                inside ? in[c * is.strides()[1] + in_off] : zero;
+                        }
+                    }
+                });
+                auto amat = make_view(shape{is.type(), {g.wei_n, kdim}},
+                                      wdata + gi * g.wei_n * kdim);
+                auto bmat = make_view(shape{is.type(), {kdim, pc}, {1, kdim}}, cols.data());
+                if(out_stride != 0)
+                {
+                    auto* out = output.data() + n * os.strides()[0] +
+                                gi * g.wei_n * os.strides()[1] + p0 * out_stride;
+                    gemm(make_view(shape{os.type(), {g.wei_n, pc}, {os.strides()[1], out_stride}},
+                                   out),
+                         amat,
+                         bmat,
+                         1.0f,
+                         0.0f);
+                    continue;
+                }
+                gemm(make_view(shape{os.type(), {g.wei_n, pc}}, tmp.data()),
+                     amat,
+                     bmat,
+                     1.0f,
+                     0.0f);
+                std::vector<std::size_t> idx(nd + 2, n);
+                for(std::size_t k = 0; k < g.wei_n; k++)
+                {
+                    idx[1] = gi * g.wei_n + k;
+                    std::vector<std::size_t> pos(nd);
+                    for(std::size_t j = 0; j < pc; j++)
+                    {
+                        conv_geometry::unflatten(p0 + j, g.out_lens, pos);
+                        std::copy(pos.begin(), pos.end(), idx.begin() + 2);
+                        output(idx.begin(), idx.end()) = tmp[k * pc + j];
+                    }
+                }
             }
-        });
+        }
+    }
+}
+
+// Transformation matrices for the Winograd minimal filtering algorithm F(M, 3), in row-major
+// order. The filter is transformed with G, the input tiles with B^T and the products with A^T.
+template <std::size_t M>
+struct winograd_transform;
 
-        output[i] = acc;
+template <>
+struct winograd_transform<2>
+{
+    static constexpr std::size_t alpha        = 4;
+    static constexpr std::array<double, 16> bt = {
+        1, 0, -1, 0, 0, 1, 1, 0, 0, -1, 1, 0, 0, 1, 0, -1};
+    static constexpr std::array<double, 12> g = {
+        1, 0, 0, 0.5, 0.5, 0.5, 0.5, -0.5, 0.5, 0, 0, 1};
+    static constexpr std::array<double, 8> at = {1, 1, 1, 0, 0, 1, -1, -1};
+};
+
+template <>
+struct winograd_transform<4>
+{
+    static constexpr std::size_t alpha        = 6;
+    static constexpr std::array<double, 36> bt = {
+        4, 0, -5, 0, 1, 0, 0, -4, -4, 1, 1, 0, 0, 4, -4, -1, 1, 0,
+        0, -2, -1, 2, 1, 0, 0, 2, -1, -2, 1, 0, 0, 4, 0, -5, 0, 1};
+    static constexpr std::array<double, 18> g = {1.0 / 4,
+                                                 0,
+                                                 0,
+                                                 -1.0 / 6,
+                                                 -1.0 / 6,
+                                                 -1.0 / 6,
+                                                 -1.0 / 6,
+                                                 1.0 / 6,
+                                                 -1.0 / 6,
+                                                 1.0 / 24,
+                                                 1.0 / 12,
+                                                 1.0 / 6,
+                                                 1.0 / 24,
+                                                 -1.0 / 12,
+                                                 1.0 / 6,
+                                                 0,
+                                                 0,
+                                                 1};
+    static constexpr std::array<double, 24> at = {1, 1, 1, 1, 1,  0, 0, 1, -1, 2, -2, 0,
+                                                  0, 1, 1, 4, 4,  0, 0, 1, -1, 8, -8, 1};
+};
+
+// Computes X * Y * X^T where X is a cols x rows matrix and Y is a rows x rows matrix
+template <std::size_t Rows, std::size_t Cols, class Acc, class Matrix>
+std::array<Acc, Cols * Cols> winograd_sandwich(const Matrix& x,
+                                               const std::array<Acc, Rows * Rows>& y)
+{
+    std::array<Acc, Cols * Rows> tmp{};
+    for(std::size_t i = 0; i < Cols; i++)
+    {
+        for(std::size_t j = 0; j < Rows; j++)
+        {
+            Acc s = 0;
+            for(std::size_t k = 0; k < Rows; k++)
+                s += static_cast<Acc>(x[i * Rows + k]) * y[k * Rows + j];
+            tmp[i * Rows + j] = s;
+        }
+    }
+    std::array<Acc, Cols * Cols> result{};
+    for(std::size_t i = 0; i < Cols; i++)
+    {
+        for(std::size_t j = 0; j < Cols; j++)
+        {
+            Acc s = 0;
+            for(std::size_t k = 0; k < Rows; k++)
+                s += tmp[i * Rows + k] * static_cast<Acc>(x[j * Rows + k]);
+            result[i * Cols + j] = s;
+        }
+    }
+    return result;
+}
+
+inline bool winograd_supported(const conv_geometry& g)
+{
+    return g.ndim() == 2 and g.win_lens[0] == 3 and g.win_lens[1] == 3 and
+           std::all_of(g.stride.begin(), g.stride.end(), [](auto s) { return s == 1; }) and
+           std::all_of(g.dilation.begin(), g.dilation.end(), [](auto d) { return d == 1; });
+}
+
+// Winograd F(M, 3) convolution for 3x3 filters. The element-wise products of the transformed
+// tiles are reduced over the channels with a batched gemm.
+template <std::size_t M, class Output, class T>
+void conv_winograd(Output output, T input, T weights, const conv_geometry& g)
+{
+    using wt                    = winograd_transform<M>;
+    using out_type              = conv_value_t<Output>;
+    using acc_type              = gemm_accumulator_t<conv_value_t<T>>;
+    constexpr std::size_t alpha = wt::alpha;
+    constexpr std::size_t a2    = alpha * alpha;
+    const auto& os              = output.get_shape();
+    const auto& is              = input.get_shape();
+    const auto& ws              = weights.get_shape();
+    const std::size_t tiles_h   = (g.out_lens[0] + M - 1) / M;
+    const std::size_t tiles_w   = (g.out_lens[1] + M - 1) / M;
+    const std::size_t ntiles    = tiles_h * tiles_w;
+    const std::size_t chunk     = std::max<std::size_t>(
+        1, std::min(ntiles, (1u << 18) / (a2 * std::max(g.wei_c, g.wei_n))));
+    const shape::type_t acc_shape_type = shape::get_type<acc_type>{};
+
+    // Transformed filters stored as [group][alpha * alpha][wei_n][wei_c]
+    std::vector<acc_type> u(g.group * a2 * g.wei_n * g.wei_c);
+    par_for(g.out_channels() * g.wei_c, [&](std::size_t i) {
+        const std::size_t k  = i / g.wei_c;
+        const std::size_t c  = i % g.wei_c;
+        const std::size_t gi = k / g.wei_n;
+        const auto* wei      = weights.data() + k * ws.strides()[0] + c * ws.strides()[1];
+        std::array<acc_type, 9> f{};
+        for(std::size_t r = 0; r < 3; r++)
+        {
+            for(std::size_t s = 0; s < 3; s++)
+                f[r * 3 + s] =
+                    static_cast<acc_type>(wei[r * ws.strides()[2] + s * ws.strides()[3]]);
+        }
+        auto tf = winograd_sandwich<3, alpha>(wt::g, f);
+        for(std::size_t xi = 0; xi < a2; xi++)
+            u[((gi * a2 + xi) * g.wei_n + (k % g.wei_n)) * g.wei_c + c] = tf[xi];
     });
+
+    std::vector<acc_type> v(a2 * g.wei_c * chunk);
+    std::vector<acc_type> prod(a2 * g.wei_n * chunk);
+    for(std::size_t n = 0; n < g.batch; n++)
+    {
+        for(std::size_t gi = 0; gi < g.group; gi++)
+        {
+            const auto* in = input.data() + n * is.strides()[0] + gi * g.wei_c * is.strides()[1];
+            for(std::size_t t0 = 0; t0 < ntiles; t0 += chunk)
+            {
+                const std::size_t tc = std::min(chunk, ntiles - t0);
+                par_for(g.wei_c * tc, [&](std::size_t i) {
+                    const std::size_t c     = i / tc;
+                    const std::size_t j     = i % tc;
+                    const std::ptrdiff_t y0 = std::ptrdiff_t((t0 + j) / tiles_w * M) - g.padding[0];
+                    const std::ptrdiff_t x0 = std::ptrdiff_t((t0 + j) % tiles_w * M) - g.padding[1];
+                    std::array<acc_type, a2> d{};
+                    for(std::size_t r = 0; r < alpha; r++)
+                    {
+                        auto y = y0 + std::ptrdiff_t(r);
+                        if(y < 0 or y >= std::ptrdiff_t(g.in_lens[0]))
+                            continue;
+                        for(std::size_t s = 0; s < alpha; s++)
+                        {
+                            auto x = x0 + std::ptrdiff_t(s);
+                            if(x < 0 or x >= std::ptrdiff_t(g.in_lens[1]))
+                                continue;
+                            d[r * alpha + s] = static_cast<acc_type>(in[c * is.strides()[1] +
+                                                                        y * is.strides()[2] +
+                                                                        x * is.strides()[3]]);
+                        }
+                    }
+                    auto td = winograd_sandwich<alpha, alpha>(wt::bt, d);
+                    for(std::size_t xi = 0; xi < a2; xi++)
+                        v[(xi * g.wei_c + c) * tc + j] = td[xi];
+                });
+                gemm(make_view(shape{acc_shape_type, {a2, g.wei_n, tc}}, prod.data()),
+                     make_view(shape{acc_shape_type, {a2, g.wei_n, g.wei_c}},
+                               u.data() + gi * a2 * g.wei_n * g.wei_c),
+                     make_view(shape{acc_shape_type, {a2, g.wei_c, tc}}, v.data()),
+                     1.0f,
+                     0.0f);
+                par_for(g.wei_n * tc, [&](std::size_t i) {
+                    const std::size_t k  = i / tc;
+                    const std::size_t j  = i % tc;
+                    const std::size_t y0 = ((t0 + j) / tiles_w) * M;
+                    const std::size_t x0 = ((t0 + j) % tiles_w) * M;
+                    std::array<acc_type, a2> m{};
+                    for(std::size_t xi = 0; xi < a2; xi++)
+                        m[xi] = prod[(xi * g.wei_n + k) * tc + j];
+                    auto y    = winograd_sandwich<alpha, M>(wt::at, m);
+                    auto* out = output.data() + n * os.strides()[0] +
+                                (gi * g.wei_n + k) * os.strides()[1];
+                    for(std::size_t r = 0; r < M and y0 + r < g.out_lens[0]; r++)
+                    {
+                        for(std::size_t s = 0; s < M and x0 + s < g.out_lens[1]; s++)
+                        {
+                            out[(y0 + r) * os.strides()[2] + (x0 + s) * os.strides()[3]] =
+                                static_cast<out_type>(y[r * M + s]);
+                        }
+                    }
+                });
+            }
+        }
+    }
+}
+
+template <class T>
+convolution_algorithm select_convolution_algorithm(const conv_geometry& g)
+{
+    using acc_type = gemm_accumulator_t<conv_value_t<T>>;
+    // Depthwise convolutions have nothing to reduce over the channels
+    if(g.wei_c == 1)
+        return convolution_algorithm::direct;
+    // The transforms only pay off when there are enough channels to reduce over. Winograd is
+    // less accurate than the other algorithms, so it is only used when it is enabled.
+    if(enabled(MIGRAPHX_CONV_WINOGRAD{}) and std::is_floating_point<acc_type>{} and
+       winograd_supported(g) and g.wei_c >= 8 and g.wei_n >= 8)
+    {
+        if(g.out_lens[0] >= 8 and g.out_lens[1] >= 8)
+            return convolution_algorithm::winograd_f4x3;
+        return convolution_algorithm::winograd_f2x3;
+    }
+    return convolution_algorithm::im2col;
+}
+
+} // namespace detail
+
+/// Computes the convolution on the host. By default the algorithm is selected from the shapes:
+/// depthwise convolutions are computed directly and everything else is lowered to im2col
+/// followed by a gemm. When MIGRAPHX_CONV_WINOGRAD is set, 3x3 convolutions with unit stride
+/// use Winograd instead.
+template <class Output, class T, class Padding, class Stride, class Dilation>
+void convolution(Output output,
+                 T input,
+                 T weights,
+                 Padding padding,
+                 Stride stride,
+                 Dilation dilation,
+                 int group,
+                 convolution_algorithm algo = convolution_algorithm::automatic)
+{
+    auto g = detail::make_conv_geometry(output.get_shape(),
+                                        input.get_shape(),
+                                        weights.get_shape(),
+                                        padding,
+                                        stride,
+                                        dilation,
+                                        group);
+    if(output.get_shape().elements() == 0)
+        return;
+    if(algo == convolution_algorithm::automatic)
+        algo = detail::select_convolution_algorithm<T>(g);
+    switch(algo)
+    {
+    case convolution_algorithm::direct: detail::conv_direct(output, input, weights, g); return;
+    case convolution_algorithm::automatic:
+    case convolution_algorithm::im2col: detail::conv_im2col(output, input, weights, g); return;
+    case convolution_algorithm::winograd_f2x3:
+    case convolution_algorithm::winograd_f4x3:
+        if(not detail::winograd_supported(g) or
+           std::is_integral<detail::gemm_accumulator_t<detail::conv_value_t<T>>>{})
+            MIGRAPHX_THROW("Winograd convolution requires a floating point 3x3 filter with unit "
+                           "stride and dilation");
+        if(algo == convolution_algorithm::winograd_f2x3)
+            detail::conv_winograd<2>(output, input, weights, g);
+        else
+            detail::conv_winograd<4>(output, input, weights, g);
+        return;
+    }
 }
 
 } // namespace MIGRAPHX_INLINE_NS
@@ -26,6 +26,7 @@
 
 #include <migraphx/config.hpp>
 #include <migraphx/filesystem.hpp>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,6 +37,11 @@ MIGRAPHX_EXPORT std::vector<char>
 read_buffer(const fs::path& filename, size_t offset = 0, size_t nbytes = 0);
 MIGRAPHX_EXPORT std::string read_string(const fs::path& filename);
 
+/// Maps the whole file into memory without reading it. The pages are copy-on-write so writes are
+/// never stored in the file, and the mapping is released when the last copy of the pointer is
+/// destroyed. Where memory mapping is not available the file is read into memory instead.
+MIGRAPHX_EXPORT std::shared_ptr<char> map_buffer(const fs::path& filename);
+
 MIGRAPHX_EXPORT void write_buffer(const fs::path& filename, const char* buffer, std::size_t size);
 MIGRAPHX_EXPORT void write_buffer(const fs::path& filename, const std::vector<char>& buffer);
 
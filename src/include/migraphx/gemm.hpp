@@ -25,38 +25,263 @@
 #define MIGRAPHX_GUARD_RTGLIB_GEMM_HPP
 
 #include <migraphx/config.hpp>
-#include <migraphx/dfor.hpp>
-#include <migraphx/par_for.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/thread_pool.hpp>
 #include <migraphx/tensor_view.hpp>
+#include <algorithm>
+#include <type_traits>
+#include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_GEMM_ACCUMULATE_DOUBLE)
+
+namespace detail {
+
+// Type used to accumulate the products exactly enough for verification: floating point inputs
+// are accumulated in double and integer inputs are accumulated exactly
+template <class T, class = void>
+struct gemm_accumulator
+{
+    using type = double;
+};
+
+template <class T>
+struct gemm_accumulator<T, std::enable_if_t<std::is_integral<T>{}>>
+{
+    using type = std::conditional_t<(sizeof(T) == 1), std::int32_t, std::int64_t>;
+};
+
+template <class T>
+using gemm_accumulator_t = typename gemm_accumulator<std::remove_cv_t<T>>::type;
+
+// Sizes of the register tile computed by the micro kernel and of the blocks that are packed so
+// they stay in cache. The micro kernel uses a full cache line of the accumulator type for each
+// row so the inner loop can be vectorized by the compiler.
+template <class Acc>
+struct gemm_blocking
+{
+    static constexpr std::size_t mr = 4;
+    static constexpr std::size_t nr = 64 / sizeof(Acc);
+    static constexpr std::size_t mc = 128;
+    static constexpr std::size_t kc = 256;
+    static constexpr std::size_t nc = 256;
+};
+
+struct gemm_matrix
+{
+    std::size_t row_stride = 0;
+    std::size_t col_stride = 0;
+};
+
+inline gemm_matrix make_gemm_matrix(const shape& s)
+{
+    auto n = s.ndim();
+    return {s.strides()[n - 2], s.strides()[n - 1]};
+}
+
+// Pack a mc x kc block of A into panels of mr rows, where each column of a panel is contiguous.
+// The rows past the end are padded with zeros.
+template <class Acc, class U>
+void gemm_pack_a(
+    Acc* dst, const U* a, gemm_matrix am, std::size_t mc, std::size_t kc, std::size_t mr)
+{
+    for(std::size_t i = 0; i < mc; i += mr)
+    {
+        auto rows = std::min(mr, mc - i);
+        for(std::size_t p = 0; p < kc; p++)
+        {
+            for(std::size_t ii = 0; ii < rows; ii++)
+                dst[ii] = static_cast<Acc>(a[(i + ii) * am.row_stride + p * am.col_stride]);
+            std::fill(dst + rows, dst + mr, Acc{0});
+            dst += mr;
+        }
+    }
+}
+
+// Pack a kc x nc block of B into panels of nr columns, where each row of a panel is contiguous.
+// The columns past the end are padded with zeros.
+template <class Acc, class U>
+void gemm_pack_b(
+    Acc* dst, const U* b, gemm_matrix bm, std::size_t kc, std::size_t nc, std::size_t nr)
+{
+    for(std::size_t j = 0; j < nc; j += nr)
+    {
+        auto cols = std::min(nr, nc - j);
+        for(std::size_t p = 0; p < kc; p++)
+        {
+            for(std::size_t jj = 0; jj < cols; jj++)
+                dst[jj] = static_cast<Acc>(b[p * bm.row_stride + (j + jj) * bm.col_stride]);
+            std::fill(dst + cols, dst + nr, Acc{0});
+            dst += nr;
+        }
+    }
+}
+
+// Computes a mr x nr tile of C from packed panels of A and B. The loop bounds are constant so the
+// accumulators are kept in registers.
+template <std::size_t MR, std::size_t NR, class Acc>
+void gemm_micro_kernel(std::size_t kc, const Acc* a, const Acc* b, Acc* c, std::size_t ldc)
+{
+    Acc acc[MR][NR] = {};
+    for(std::size_t p = 0; p < kc; p++)
+    {
+        for(std::size_t i = 0; i < MR; i++)
+        {
+            const Acc x = a[p * MR + i];
+            for(std::size_t j = 0; j < NR; j++)
+                acc[i][j] += x * b[p * NR + j];
+        }
+    }
+    for(std::size_t i = 0; i < MR; i++)
+    {
+        for(std::size_t j = 0; j < NR; j++)
+            c[i * ldc + j] += acc[i][j];
+    }
+}
+
+inline std::size_t round_up(std::size_t x, std::size_t n) { return ((x + n - 1) / n) * n; }
+
+template <class Acc, class T, class U, class F>
+void blocked_gemm(thread_pool& pool,
+                  tensor_view<T> cmat,
+                  tensor_view<U> amat,
+                  tensor_view<U> bmat,
+                  F alpha,
+                  F beta)
+{
+    using blocking           = gemm_blocking<Acc>;
+    constexpr std::size_t mr = blocking::mr;
+    constexpr std::size_t nr = blocking::nr;
+
+    const auto& cs     = cmat.get_shape();
+    std::size_t n_dims = cs.ndim();
+    std::size_t m      = cs.lens()[n_dims - 2];
+    std::size_t n      = cs.lens()[n_dims - 1];
+    std::size_t k      = amat.get_shape().lens()[n_dims - 1];
+    assert(amat.get_shape().lens()[n_dims - 1] == bmat.get_shape().lens()[n_dims - 2]);
+    assert(cs.lens()[n_dims - 2] == amat.get_shape().lens()[n_dims - 2]);
+    assert(cs.lens()[n_dims - 1] == bmat.get_shape().lens()[n_dims - 1]);
+    if(cs.elements() == 0)
+        return;
+
+    auto am = make_gemm_matrix(amat.get_shape());
+    auto bm = make_gemm_matrix(bmat.get_shape());
+    auto cm = make_gemm_matrix(cs);
+
+    // Offsets of each matrix in the batch
+    std::size_t nbatch = cs.elements() / (m * n);
+    std::vector<std::size_t> batch_lens(cs.lens().begin(), cs.lens().end() - 2);
+    auto batch_offset = [&](std::size_t b, const shape& s) {
+        std::size_t result = 0;
+        for(std::size_t d = batch_lens.size(); d > 0; d--)
+        {
+            result += (b % batch_lens[d - 1]) * s.strides()[d - 1];
+            b /= batch_lens[d - 1];
+        }
+        return result;
+    };
+
+    const std::size_t mc     = std::min(blocking::mc, round_up(m, mr));
+    const std::size_t kc     = std::min(blocking::kc, std::max<std::size_t>(k, 1));
+    const std::size_t nc     = std::min(blocking::nc, round_up(n, nr));
+    const std::size_t mblock = (m + mc - 1) / mc;
+    const std::size_t ntasks = nbatch * mblock;
+    // Avoid spawning threads for small problems
+    const std::size_t task_work = mc * nc * std::max<std::size_t>(k, 1);
+    const std::size_t min_grain = std::max<std::size_t>(1, (1u << 18) / task_work);
+    const std::size_t nthreads  = std::min(pool.size(), ntasks / min_grain);
+
+    pool.run(ntasks, nthreads, [&](std::size_t task, std::size_t) {
+        std::vector<Acc> apack(mc * kc);
+        std::vector<Acc> bpack(kc * nc);
+        std::vector<Acc> ctile(mc * nc);
+
+        const std::size_t b  = task / mblock;
+        const std::size_t ic = (task % mblock) * mc;
+        const std::size_t mm = std::min(mc, m - ic);
+        const U* a           = amat.data() + batch_offset(b, amat.get_shape());
+        const U* bb          = bmat.data() + batch_offset(b, bmat.get_shape());
+        T* c                 = cmat.data() + batch_offset(b, cs);
+
+        for(std::size_t jc = 0; jc < n; jc += nc)
+        {
+            const std::size_t nn = std::min(nc, n - jc);
+            std::fill(ctile.begin(), ctile.end(), Acc{0});
+            for(std::size_t pc = 0; pc < k; pc += kc)
+            {
+                const std::size_t kk = std::min(kc, k - pc);
+                gemm_pack_a(apack.data(),
+                            a + ic * am.row_stride + pc * am.col_stride,
+                            am,
+                            mm,
+                            kk,
+                            mr);
+                gemm_pack_b(bpack.data(),
+                            bb + pc * bm.row_stride + jc * bm.col_stride,
+                            bm,
+                            kk,
+                            nn,
+                            nr);
+                for(std::size_t jr = 0; jr < nn; jr += nr)
+                {
+                    for(std::size_t ir = 0; ir < mm; ir += mr)
+                    {
+                        gemm_micro_kernel<mr, nr>(kk,
+                                                  apack.data() + ir * kk,
+                                                  bpack.data() + jr * kk,
+                                                  ctile.data() + ir * nc + jr,
+                                                  nc);
+                    }
+                }
+            }
+            // Scale and write back the valid part of the tile
+            for(std::size_t i = 0; i < mm; i++)
+            {
+                T* crow = c + (ic + i) * cm.row_stride + jc * cm.col_stride;
+                for(std::size_t j = 0; j < nn; j++)
+                {
+                    auto& x = crow[j * cm.col_stride];
+                    auto r  = static_cast<double>(alpha) * static_cast<double>(ctile[i * nc + j]);
+                    // Like BLAS, C is not read when beta is zero
+                    if(beta != 0)
+                        r += static_cast<double>(x) * static_cast<double>(beta);
+                    x = static_cast<T>(r);
+                }
+            }
+        }
+    });
+}
+
+} // namespace detail
+
+/// Computes C = alpha * A * B + beta * C for each matrix in the batch of the tensors using the
+/// threads of the pool. The inputs are packed into cache sized blocks and floating point inputs
+/// with less precision than double are accumulated in float. Setting
+/// MIGRAPHX_GEMM_ACCUMULATE_DOUBLE accumulates them in double instead, which is slower but is
+/// useful to verify results. The order of the accumulation does not depend on the number of
+/// threads, so the results are deterministic.
+template <class T, class U, class F>
+void gemm(thread_pool& pool,
+          tensor_view<T> cmat,
+          tensor_view<U> amat,
+          tensor_view<U> bmat,
+          F alpha,
+          F beta)
+{
+    using acc_type = detail::gemm_accumulator_t<U>;
+    if(std::is_integral<acc_type>{} or std::is_same<U, double>{} or
+       enabled(MIGRAPHX_GEMM_ACCUMULATE_DOUBLE{}))
+        detail::blocked_gemm<acc_type>(pool, cmat, amat, bmat, alpha, beta);
+    else
+        detail::blocked_gemm<float>(pool, cmat, amat, bmat, alpha, beta);
+}
+
 template <class T, class U, class F>
 void gemm(tensor_view<T> cmat, tensor_view<U> amat, tensor_view<U> bmat, F alpha, F beta)
 {
-    std::size_t n_dims = cmat.get_shape().lens().size();
-    std::size_t dim_0  = n_dims - 2;
-    std::size_t dim_1  = n_dims - 1;
-    auto k             = amat.get_shape().lens()[dim_1];
-
-    assert(amat.get_shape().lens()[dim_1] == bmat.get_shape().lens()[dim_0]);
-    assert(cmat.get_shape().lens()[dim_0] == amat.get_shape().lens()[dim_0]);
-    assert(cmat.get_shape().lens()[dim_1] == bmat.get_shape().lens()[dim_1]);
-    auto cs = cmat.get_shape();
-
-    par_for(cs.elements(), [&](auto i) {
-        auto c_idx = cs.multi(i);
-        auto a_idx = c_idx;
-        auto b_idx = c_idx;
-        double s   = 0.0;
-        dfor(k)([&](auto kk) {
-            a_idx[dim_1] = b_idx[dim_0] = kk;
-            s += static_cast<double>(amat(a_idx.begin(), a_idx.end())) *
-                 static_cast<double>(bmat(b_idx.begin(), b_idx.end()));
-        });
-        cmat(c_idx.begin(), c_idx.end()) = alpha * s + cmat(c_idx.begin(), c_idx.end()) * beta;
-    });
+    gemm(get_thread_pool(), cmat, amat, bmat, alpha, beta);
 }
 
 } // namespace MIGRAPHX_INLINE_NS
@@ -88,6 +88,11 @@ struct MIGRAPHX_EXPORT instruction
 
     friend bool operator!=(const instruction& x, const instruction& y);
 
+    /// Hash of the operator, shape, literal and number of module inputs. The
+    /// inputs are not included so that callers can combine them by identity
+    /// or by position. The value is cached until the instruction is modified.
+    std::size_t hash() const;
+
     friend bool operator==(instruction_ref ref, const instruction& i);
 
     friend bool operator!=(const instruction& i, instruction_ref ref);
@@ -180,6 +185,8 @@ struct MIGRAPHX_EXPORT instruction
     literal lit;
     bool normalized       = false;
     std::size_t target_id = 0;
+    // Zero when the hash needs to be computed
+    mutable std::size_t cached_hash = 0;
 };
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -39,7 +39,8 @@ inline namespace MIGRAPHX_INLINE_NS {
 
 /**
  * @brief Represents a raw literal
- * @details This stores the literal has a raw buffer that is owned by this class
+ * @details This stores the literal has a raw buffer that is owned by this class, or shared with
+ * another owner such as a memory mapped file
  */
 struct literal : raw_data<literal>
 {
@@ -87,6 +88,9 @@ struct literal : raw_data<literal>
         std::copy(x, x + s.bytes(), buffer.get());
     }
 
+    /// Shares the buffer without copying it, the buffer must hold at least s.bytes()
+    literal(const shape& s, std::shared_ptr<char> x) : buffer(std::move(x)), m_shape(s) {}
+
     /// Whether data is available
     bool empty() const { return this->buffer == nullptr; }
 
@@ -34,6 +34,12 @@ inline namespace MIGRAPHX_INLINE_NS {
 struct file_options
 {
     std::string format = "msgpack";
+    /// Store the literals in page aligned blocks next to the program, so that loading the file
+    /// maps the literals into memory instead of copying them
+    bool mapped_literals = false;
+    /// Stored with the program when saving it. When loading, the file must have been saved with
+    /// the same key, unless it's empty.
+    std::string key = "";
 };
 
 MIGRAPHX_EXPORT program load(const std::string& filename,
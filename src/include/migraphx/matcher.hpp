@@ -30,11 +30,14 @@
 #include <migraphx/instruction.hpp>
 #include <migraphx/module.hpp>
 #include <migraphx/optional.hpp>
+#include <migraphx/rank.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/type_name.hpp>
 #include <migraphx/source_location.hpp>
 #include <migraphx/config.hpp>
 #include <array>
+#include <functional>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 
@@ -193,6 +196,46 @@ struct id_matcher
     }
 };
 
+using root_names_ptr = std::shared_ptr<const std::unordered_set<std::string>>;
+
+template <class M>
+auto get_root_names(rank<1>, const M& m) -> decltype(root_names_ptr{m.root_names()})
+{
+    return m.root_names();
+}
+
+template <class M>
+root_names_ptr get_root_names(rank<0>, const M&)
+{
+    return nullptr;
+}
+
+/// Get the names of the operators that the instruction matched by m can have, or nullptr when it
+/// can be any operator
+template <class M>
+root_names_ptr get_root_names(const M& m)
+{
+    return get_root_names(rank<1>{}, m);
+}
+
+/// Keeps the names of the operators that the matched instruction can have
+template <class M>
+struct rooted_matcher
+{
+    root_names_ptr names;
+    M m;
+
+    root_names_ptr root_names() const { return names; }
+
+    auto match(matcher_context& ctx, instruction_ref ins) const { return m.match(ctx, ins); }
+};
+
+template <class M>
+rooted_matcher<M> make_rooted_matcher(root_names_ptr names, M m)
+{
+    return {std::move(names), std::move(m)};
+}
+
 // Forward declare class and constructors
 template <class M>
 struct basic_matcher;
@@ -229,8 +272,8 @@ struct basic_matcher
     {
         // Copy m because we cant capture `this` by value
         auto mm = m;
-        return make_basic_fun_matcher([=](matcher_context& ctx,
-                                          instruction_ref ins) -> optional<instruction_ref> {
+        auto f  = make_basic_fun_matcher([=](matcher_context& ctx,
+                                            instruction_ref ins) -> optional<instruction_ref> {
             auto result = mm.match(ctx, ins);
             if(result)
             {
@@ -241,9 +284,15 @@ struct basic_matcher
             }
             return nullopt;
         });
+        return basic_matcher<rooted_matcher<decltype(f)>>{{get_root_names(m), f}};
     }
 
-    auto bind(std::string name) const { return bind_match(m, std::move(name)); }
+    auto bind(std::string name) const
+    {
+        return make_rooted_matcher(get_root_names(m), bind_match(m, std::move(name)));
+    }
+
+    root_names_ptr root_names() const { return get_root_names(m); }
 
     auto match(matcher_context& ctx, instruction_ref ins) const { return m.match(ctx, ins); }
 };
@@ -376,48 +425,64 @@ MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_MATCHES)
 MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_MATCHES_FOR)
 MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_VALIDATE_MATCHES)
 
+/// Tries a matcher on an instruction and applies it when it matches, tracing and validating the
+/// module as requested by the environment
+struct match_applier
+{
+    source_location location;
+    int trace                = value_of(MIGRAPHX_TRACE_MATCHES{});
+    bool validate            = enabled(MIGRAPHX_VALIDATE_MATCHES{});
+    std::string trace_filter = string_value_of(MIGRAPHX_TRACE_MATCHES_FOR{});
+
+    explicit match_applier(source_location loc) : location(loc) {}
+
+    template <class Mod, class M, class Matcher>
+    bool operator()(Mod& mod, instruction_ref ins, const M& m, const Matcher& mm) const
+    {
+        const auto& matcher_name = get_type_name(m);
+        const bool trace_for     = not trace_filter.empty() and
+                               (contains(std::string{location.file_name()}, trace_filter) or
+                                contains(std::string{location.function_name()}, trace_filter) or
+                                contains(matcher_name, trace_filter));
+        if(trace > 1 and trace_for)
+            std::cout << "Match: " << matcher_name << std::endl;
+        auto r = match_instruction(get_module(mod), ins, mm);
+        if(r.result == get_module(mod).end())
+            return false;
+        if(trace > 0 or trace_for)
+        {
+            std::cout << "Matched by " << matcher_name << std::endl;
+            get_module(mod).debug_print(ins);
+        }
+        // If its already invalid dont validate it again
+        bool invalidated = validate and get_module(mod).validate() != get_module(mod).end();
+        m.apply(mod, r);
+        if(validate and not invalidated)
+        {
+            auto invalid = get_module(mod).validate();
+            if(invalid != get_module(mod).end())
+            {
+                std::cout << "Invalid program from match: " << matcher_name << std::endl;
+                std::cout << "Invalid instructions: " << std::endl;
+                get_module(mod).debug_print(invalid->inputs());
+                get_module(mod).debug_print(invalid);
+            }
+        }
+        return true;
+    }
+};
+
 /// Find matches for an instruction in the module for per section of matchers
 template <class Mod, class... Ms>
 void find_matches_for(source_location location, Mod& mod, instruction_ref ins, Ms&&... ms)
 {
-    const int trace         = value_of(MIGRAPHX_TRACE_MATCHES{});
-    const bool validate     = enabled(MIGRAPHX_VALIDATE_MATCHES{});
-    const auto trace_filter = string_value_of(MIGRAPHX_TRACE_MATCHES_FOR{});
-    bool match              = false;
+    match_applier apply_match{location};
+    bool match = false;
     each_args(
         [&](auto&& m) {
-            const auto& matcher_name = get_type_name(m);
-            const bool trace_for     = not trace_filter.empty() and
-                                   (contains(std::string{location.file_name()}, trace_filter) or
-                                    contains(std::string{location.function_name()}, trace_filter) or
-                                    contains(matcher_name, trace_filter));
             if(match)
                 return;
-            if(trace > 1 and trace_for)
-                std::cout << "Match: " << matcher_name << std::endl;
-            auto r = match_instruction(get_module(mod), ins, m.matcher());
-            if(r.result == get_module(mod).end())
-                return;
-            if(trace > 0 or trace_for)
-            {
-                std::cout << "Matched by " << matcher_name << std::endl;
-                get_module(mod).debug_print(ins);
-            }
-            // If its already invalid dont validate it again
-            bool invalidated = validate and get_module(mod).validate() != get_module(mod).end();
-            m.apply(mod, r);
-            if(validate and not invalidated)
-            {
-                auto invalid = get_module(mod).validate();
-                if(invalid != get_module(mod).end())
-                {
-                    std::cout << "Invalid program from match: " << matcher_name << std::endl;
-                    std::cout << "Invalid instructions: " << std::endl;
-                    get_module(mod).debug_print(invalid->inputs());
-                    get_module(mod).debug_print(invalid);
-                }
-            }
-            match = true;
+            match = apply_match(mod, ins, m, m.matcher());
         },
         ms...);
 }
@@ -438,6 +503,60 @@ struct find_matches
 template <class Mod, class... Ms>
 find_matches(Mod& mod, Ms&&... ms) -> find_matches<Mod, Ms...>;
 
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TIME_PASSES)
+
+/// Runs rewrite rules over a module until none of them match anymore
+struct MIGRAPHX_EXPORT rewrite_driver
+{
+    struct rule
+    {
+        std::string name;
+        /// The names of the operators the rule can start at, or nullptr for any operator
+        root_names_ptr roots;
+        /// Tries the rule on an instruction, and returns whether it matched
+        std::function<bool(instruction_ref)> apply;
+    };
+    std::vector<rule> rules;
+
+    /// The first round visits every instruction. The next rounds only visit the instructions
+    /// that the previous round changed, together with their inputs and outputs and the outputs of
+    /// these, and once none of these change anymore, a round over every instruction checks that
+    /// no rule matches elsewhere. Each instruction is only tried with the rules that can start
+    /// at its operator, in the order of the rules. The finish function runs after every round.
+    void run(module& m,
+             const std::function<void()>& finish,
+             source_location location = source_location::current()) const;
+};
+
+/// Find matches in a module until a fixpoint is reached, where finish runs after every round,
+/// such as to remove the dead code. See rewrite_driver.
+template <class Mod, class F, class... Ms>
+struct find_matches_fixpoint
+{
+    find_matches_fixpoint(Mod& mod,
+                          F finish,
+                          Ms&&... ms,
+                          source_location location = source_location::current())
+    {
+        match_applier apply_match{location};
+        rewrite_driver driver;
+        each_args(
+            [&](auto&& m) {
+                auto mm = m.matcher();
+                driver.rules.push_back({get_type_name(m),
+                                        get_root_names(mm),
+                                        [&mod, &m, &apply_match, mm](instruction_ref ins) {
+                                            return apply_match(mod, ins, m, mm);
+                                        }});
+            },
+            ms...);
+        driver.run(get_module(mod), finish, location);
+    }
+};
+
+template <class Mod, class F, class... Ms>
+find_matches_fixpoint(Mod& mod, F finish, Ms&&... ms) -> find_matches_fixpoint<Mod, F, Ms...>;
+
 template <class M, class F>
 struct find_generic_match
 {
@@ -700,25 +819,36 @@ inline auto var(std::string s)
         });
 }
 
-inline auto name(std::string s)
+/// Matches the name of the operator, which is also used to look up the matchers by the name of
+/// the instruction they start at
+struct name_matcher
 {
-    return make_basic_pred_matcher(
-        [=, m_s = std::move(s)](instruction_ref ins) { return ins->name() == m_s; });
+    root_names_ptr names;
+
+    root_names_ptr root_names() const { return names; }
+
+    optional<instruction_ref> match(const matcher_context&, instruction_ref ins) const
+    {
+        if(names->count(ins->name()) > 0)
+            return ins;
+        return nullopt;
+    }
+};
+
+inline auto name(std::unordered_set<std::string> names)
+{
+    return basic_matcher<name_matcher>{
+        {std::make_shared<const std::unordered_set<std::string>>(std::move(names))}};
 }
 
+inline auto name(std::string s) { return name(std::unordered_set<std::string>{std::move(s)}); }
+
 inline auto name_contains(const std::string& name)
 {
     return make_basic_pred_matcher(
         [=](instruction_ref ins) { return contains(ins->get_operator().name(), name); });
 }
 
-inline auto name(std::unordered_set<std::string> names)
-{
-    return make_basic_pred_matcher([=, m_names = std::move(names)](instruction_ref ins) {
-        return m_names.count(ins->name()) > 0;
-    });
-}
-
 template <class... Ts>
 inline auto name(std::string s, Ts... xs) // NOLINT
 {
@@ -35,11 +35,22 @@ struct module;
 /**
  * Remove multiple memory allocations using graph coloring to find memory allocations that can be
  * reused.
+ *
+ * The planner selects how offsets are assigned:
+ *  - "coloring": first fit over the conflict table of the live allocations (the default)
+ *  - "greedy_by_size": place the largest allocations first into the best fitting gap among the
+ *    allocations whose live intervals overlap
+ *  - "best_fit": place the allocations in program order into the best fitting gap
+ * The interval based planners only keep the live interval of each allocation instead of the full
+ * conflict table. The MIGRAPHX_MEMORY_PLANNER environment variable overrides the planner.
  */
 struct MIGRAPHX_EXPORT memory_coloring
 {
     std::string allocation_op{};
-    bool verify = false;
+    bool verify         = false;
+    std::string planner = "coloring";
+    /// Move each allocation next to its first use before planning to shorten the live intervals
+    bool reorder = false;
     std::string name() const { return "memory_coloring"; }
     void apply(module& m) const;
 };
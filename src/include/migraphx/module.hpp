@@ -80,6 +80,13 @@ struct MIGRAPHX_EXPORT module
     bool bypass() const;
     void set_bypass(bool b = true);
 
+    /// Counter that changes whenever an instruction is added, removed, moved or replaced
+    std::size_t version() const;
+
+    /// While set, the instructions that are inserted, moved or replaced, and the instructions
+    /// whose inputs or outputs change, are added to the set. Removed instructions are taken out.
+    void track_changes(std::unordered_set<instruction_ref>* changed);
+
     template <class... Ts, MIGRAPHX_REQUIRES(std::is_same<Ts, instruction_ref>{}...)>
     instruction_ref add_instruction(operation op, Ts... args)
     {
@@ -261,6 +268,19 @@ struct MIGRAPHX_EXPORT module
 
     void print_graph(std::ostream& os, bool brief = false) const;
 
+    /// Structural hash of the instructions, where inputs are identified by
+    /// their position in the module
+    std::size_t hash() const;
+    /// Hash that numbers the instructions in ids, so inputs from modules
+    /// hashed earlier are identified by their position as well
+    std::size_t hash(std::unordered_map<instruction_ref, std::size_t>& ids) const;
+
+    /// Compare the instructions the same way as the printed modules. The
+    /// map_ins records the matching instructions, so inputs from modules
+    /// compared earlier are matched as well.
+    bool equal(const module& m,
+               std::unordered_map<instruction_ref, instruction_ref>& map_ins) const;
+
     void print_py(std::ostream& os) const;
     std::unordered_map<instruction_ref, std::string>
     print_py(std::ostream& os,
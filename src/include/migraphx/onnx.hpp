@@ -58,6 +58,8 @@ struct onnx_options
     int64_t limit_max_iterations = std::numeric_limits<uint16_t>::max();
     /// Use dynamic output for operators when available
     bool use_dyn_output = false;
+    /// Print the time spent reading the model, decoding initializers and parsing the graph
+    bool print_parse_time = false;
 };
 
 /// Create a program from an onnx file
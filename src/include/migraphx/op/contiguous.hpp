@@ -26,7 +26,7 @@
 
 #include <migraphx/check_shapes.hpp>
 #include <migraphx/argument.hpp>
-#include <migraphx/shape_for_each.hpp>
+#include <migraphx/strided_for_each.hpp>
 #include <migraphx/config.hpp>
 #include <migraphx/dyn_output.hpp>
 
@@ -65,9 +65,8 @@ struct contiguous
         assert(dyn_out.computed_shape.standard());
         argument result{dyn_out.computed_shape};
         visit_all(result, args[0])([&](auto output, auto input) {
-            shape_for_each(output.get_shape(), [&](const auto& idx) {
-                output(idx.begin(), idx.end()) = input(idx.begin(), idx.end());
-            });
+            par_strided_for_each(1u << 16, output.get_shape(), input.get_shape())(
+                [&](auto out_idx, auto in_idx) { output.data()[out_idx] = input.data()[in_idx]; });
         });
         return result;
     }
@@ -0,0 +1,203 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_OPERATORS_DEQUANT_DOT_HPP
+#define MIGRAPHX_GUARD_OPERATORS_DEQUANT_DOT_HPP
+
+#include <migraphx/check_shapes.hpp>
+#include <migraphx/argument.hpp>
+#include <migraphx/config.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/value.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace op {
+
+/**
+ * Computes the dot of A [..., M, K] with the weights [K, N] which are stored quantized and are
+ * dequantized while the dot is computed. The rows of the weights are split into groups of
+ * group_size rows, and each group has a scale and a zero point for every column, so the inputs
+ * are A, the quantized weights, the scales [K / group_size, N] and the zero points
+ * [K / group_size, N]. The weights are int8 for 8 bits, and for 4 bits they are unsigned values
+ * packed in pairs of rows along the first axis as done by pack_int4.
+ */
+struct dequant_dot
+{
+    std::size_t group_size = 128;
+    std::size_t bits       = 8;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.group_size, "group_size"), f(self.bits, "bits"));
+    }
+
+    std::string name() const { return "dequant_dot"; }
+
+    shape::type_t weight_type() const
+    {
+        return (bits == 4) ? shape::uint8_type : shape::int8_type;
+    }
+
+    shape compute_shape(std::vector<shape> inputs) const
+    {
+        check_shapes{inputs, *this}.has(4).standard();
+        const auto& a      = inputs.at(0);
+        const auto& w      = inputs.at(1);
+        const auto& scales = inputs.at(2);
+        const auto& zp     = inputs.at(3);
+        if(bits != 4 and bits != 8)
+            MIGRAPHX_THROW("DEQUANT_DOT: only 4 and 8 bits are supported");
+        if(a.ndim() < 2 or w.ndim() != 2)
+            MIGRAPHX_THROW("DEQUANT_DOT: A needs 2 or more dims and the weights need 2 dims");
+        if(w.type() != weight_type() or zp.type() != weight_type())
+            MIGRAPHX_THROW("DEQUANT_DOT: weights and zero points must be " +
+                           shape::cpp_type(weight_type()));
+        if(scales.type() != a.type())
+            MIGRAPHX_THROW("DEQUANT_DOT: scales must have the type of A");
+        auto k = a.lens().back();
+        auto n = w.lens().back();
+        if(w.lens().front() * 8 / bits != k)
+            MIGRAPHX_THROW("DEQUANT_DOT: inner dimensions do not match: {" +
+                           to_string_range(a.lens()) + "} x {" + to_string_range(w.lens()) + "}");
+        if(group_size == 0 or k % group_size != 0)
+            MIGRAPHX_THROW("DEQUANT_DOT: group size must divide " + std::to_string(k));
+        std::vector<std::size_t> qparam_lens = {k / group_size, n};
+        if(scales.lens() != qparam_lens or zp.lens() != qparam_lens)
+            MIGRAPHX_THROW("DEQUANT_DOT: scales and zero points must be {" +
+                           to_string_range(qparam_lens) + "}");
+        auto out_lens   = a.lens();
+        out_lens.back() = n;
+        return {a.type(), out_lens};
+    }
+
+    argument compute(const shape& output_shape, std::vector<argument> args) const
+    {
+        argument result{output_shape};
+        const std::size_t k    = args[0].get_shape().lens().back();
+        const std::size_t n    = output_shape.lens().back();
+        const std::size_t rows = output_shape.elements() / n;
+        // Number of columns of the weights handled by a task
+        const std::size_t block = 64;
+        visit_all(result, args[0], args[2])([&](auto output, auto a, auto scales) {
+            if(bits == 4)
+                this->gemm(output.data(),
+                           a.data(),
+                           args[1].get<uint8_t>().data(),
+                           scales.data(),
+                           args[3].get<uint8_t>().data(),
+                           rows,
+                           k,
+                           n,
+                           block);
+            else
+                this->gemm(output.data(),
+                           a.data(),
+                           args[1].get<int8_t>().data(),
+                           scales.data(),
+                           args[3].get<int8_t>().data(),
+                           rows,
+                           k,
+                           n,
+                           block);
+        });
+        return result;
+    }
+
+    private:
+    float weight(const uint8_t* w, std::size_t i, std::size_t j, std::size_t n) const
+    {
+        auto x = w[(i / 2) * n + j];
+        // Packed little endian, so the even row is in the low 4 bits
+        return static_cast<float>((i % 2 == 0) ? (x & 0x0Fu) : (x >> 4u));
+    }
+
+    float weight(const int8_t* w, std::size_t i, std::size_t j, std::size_t n) const
+    {
+        return static_cast<float>(w[i * n + j]);
+    }
+
+    // Each task computes a block of columns for all of the rows. A group of the weights of the
+    // block is dequantized to a tile that stays in the cache while it is multiplied with every
+    // row, so the weights are only read once from memory in their compressed form.
+    template <class T, class W>
+    void gemm(T* y,
+              const T* a,
+              const W* w,
+              const T* scales,
+              const W* zp,
+              std::size_t rows,
+              std::size_t k,
+              std::size_t n,
+              std::size_t block) const
+    {
+        const std::size_t nblocks = (n + block - 1) / block;
+        par_for(nblocks, 1, [&](std::size_t b) {
+            const std::size_t col = b * block;
+            const std::size_t nb  = std::min(block, n - col);
+            std::vector<float> acc(rows * nb, 0.0f);
+            std::vector<float> tile(group_size * nb);
+            for(std::size_t g = 0; g < k / group_size; g++)
+            {
+                for(std::size_t i = 0; i < group_size; i++)
+                {
+                    auto row = g * group_size + i;
+                    for(std::size_t j = 0; j < nb; j++)
+                    {
+                        auto q = g * n + col + j;
+                        tile[i * nb + j] =
+                            (this->weight(w, row, col + j, n) - static_cast<float>(zp[q])) *
+                            static_cast<float>(scales[q]);
+                    }
+                }
+                for(std::size_t r = 0; r < rows; r++)
+                {
+                    const T* x = a + r * k + g * group_size;
+                    float* z   = acc.data() + r * nb;
+                    for(std::size_t i = 0; i < group_size; i++)
+                    {
+                        auto xi        = static_cast<float>(x[i]);
+                        const float* t = tile.data() + i * nb;
+                        for(std::size_t j = 0; j < nb; j++)
+                            z[j] += xi * t[j];
+                    }
+                }
+            }
+            for(std::size_t r = 0; r < rows; r++)
+            {
+                for(std::size_t j = 0; j < nb; j++)
+                    y[r * n + col + j] = static_cast<T>(acc[r * nb + j]);
+            }
+        });
+    }
+};
+
+} // namespace op
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -30,7 +30,7 @@
 #include <migraphx/stringutils.hpp>
 #include <migraphx/streamutils.hpp>
 #include <migraphx/literal.hpp>
-#include <migraphx/shape_for_each.hpp>
+#include <migraphx/strided_for_each.hpp>
 #include <migraphx/config.hpp>
 #include <migraphx/value.hpp>
 #include <migraphx/op/normalize_attribute.hpp>
@@ -122,18 +122,30 @@ struct gather
                 }
                 else
                 {
-                    auto out_lens  = data.get_shape().lens();
-                    out_lens[axis] = indices.get_shape().elements();
-                    migraphx::shape out_comp_shape{data.get_shape().type(), out_lens};
-                    shape_for_each(out_comp_shape, [&](const auto& out_idx_v, size_t out_idx) {
-                        auto data_idx   = out_idx_v;
-                        auto in_index   = indices[data_idx[axis]];
-                        in_index        = (in_index < 0) ? in_index + axis_dim_size : in_index;
-                        // don't go out of bounds: https://github.com/ROCm/AMDMIGraphX/issues/2838
-                        assert(in_index >= 0 and in_index < axis_dim_size);
-                        data_idx[axis]  = in_index;
-                        output[out_idx] = data(data_idx.begin(), data_idx.end());
-                    });
+                    const auto& data_shape = data.get_shape();
+                    auto out_lens          = data_shape.lens();
+                    out_lens[axis]         = indices.get_shape().elements();
+                    migraphx::shape out_comp_shape{data_shape.type(), out_lens};
+                    // The data is traversed without the axis, and the position along the axis
+                    // selects the index that is added back
+                    auto data_strides  = data_shape.strides();
+                    auto axis_stride   = data_strides[axis];
+                    auto axis_len      = static_cast<std::int64_t>(axis_dim_size);
+                    data_strides[axis] = 0;
+                    std::vector<std::size_t> index_strides(out_lens.size(), 0);
+                    index_strides[axis] = 1;
+                    strided_for_each(out_comp_shape,
+                                     shape{data_shape.type(), out_lens, data_strides},
+                                     shape{data_shape.type(), out_lens, index_strides})(
+                        [&](auto out_idx, auto data_idx, auto i) {
+                            auto in_index = static_cast<std::int64_t>(indices[i]);
+                            if(in_index < 0)
+                                in_index += axis_len;
+                            // don't go out of bounds:
+                            // https://github.com/ROCm/AMDMIGraphX/issues/2838
+                            assert(in_index >= 0 and in_index < axis_len);
+                            output[out_idx] = data.data()[data_idx + in_index * axis_stride];
+                        });
                 }
             });
         });
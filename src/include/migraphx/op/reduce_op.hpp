@@ -29,11 +29,13 @@
 #include <migraphx/dyn_output.hpp>
 #include <migraphx/argument.hpp>
 #include <migraphx/tensor_view.hpp>
-#include <migraphx/shape_for_each.hpp>
+#include <migraphx/strided_for_each.hpp>
 #include <migraphx/par_for.hpp>
+#include <migraphx/thread_pool.hpp>
 #include <migraphx/config.hpp>
 #include <migraphx/value.hpp>
 #include <migraphx/op/normalize_attribute.hpp>
+#include <array>
 #include <vector>
 
 namespace migraphx {
@@ -192,25 +194,142 @@ struct reduce_op : op_name<Derived>
         }
     }
 
+    template <class Accumulator, class T>
+    Accumulator fold(Accumulator val, const T& x) const
+    {
+        auto& self    = static_cast<const Derived&>(*this);
+        Accumulator y = x;
+        return self.op()(Accumulator{self.input()(y)}, val);
+    }
+
+    // Fold the n elements x[0], x[stride], ... into val. Several accumulators are used so the
+    // iterations don't depend on each other.
+    template <class T, class Accumulator>
+    Accumulator reduce_run(const T* x, std::size_t stride, std::size_t n, Accumulator val) const
+    {
+        auto& self                      = static_cast<const Derived&>(*this);
+        Accumulator init                = self.init();
+        std::array<Accumulator, 4> accs = {val, init, init, init};
+        std::size_t j                   = 0;
+        for(; j + accs.size() <= n; j += accs.size())
+        {
+            for(std::size_t k = 0; k < accs.size(); k++)
+                accs[k] = this->fold(accs[k], x[(j + k) * stride]);
+        }
+        for(; j < n; j++)
+            accs[0] = this->fold(accs[0], x[j * stride]);
+        auto op = self.op();
+        return op(op(accs[0], accs[1]), op(accs[2], accs[3]));
+    }
+
     template <class T>
-    void reduce(const tensor_view<T>& input,
-                const shape& batch_shape,
-                const std::vector<int64_t>& tuned_axes,
-                const std::vector<std::size_t>& out_idx,
-                tensor_view<T>& output) const
+    void reduce(tensor_view<T> output, tensor_view<T> input, const shape& batch_shape) const
     {
         using accumulator = accumulator_type<T>;
-        auto& self        = static_cast<const Derived&>(*this);
-        auto data_idx     = out_idx;
-        accumulator val   = self.init();
-        shape_for_each(batch_shape, [&](const auto& b_idx) {
-            this->tune_dims(tuned_axes, b_idx, data_idx);
-            accumulator x = input(data_idx.begin(), data_idx.end());
-            val           = self.op()(accumulator{self.input()(x)}, val);
-        });
+        // Number of elements a task should at least reduce
+        const std::size_t min_grain = 1u << 14;
+        auto& self                  = static_cast<const Derived&>(*this);
+        const auto& out_shape       = output.get_shape();
+        const auto& in_strides      = input.get_shape().strides();
+        // The dimensions that are kept with their strides in the output and the input, and the
+        // dimensions that are reduced with their strides in the input
+        const detail::strided_dims<2> kept{out_shape.lens(), {&out_shape.strides(), &in_strides}};
+        const detail::strided_dims<1> reduced{batch_shape.lens(), {&in_strides}};
+        const std::size_t nout = kept.elements();
+        const std::size_t nred = reduced.elements();
+        const T* x             = input.data();
+        T* y                   = output.data();
+        const accumulator init = self.init();
+        auto finish            = self.output(batch_shape);
+
+        // Fold the elements [start, last) of the reduced dimensions at offset into val
+        auto reduce_range =
+            [&](std::size_t offset, std::size_t start, std::size_t last, accumulator val) {
+                auto run = [&](const auto& base, const auto& stride, auto first, auto end) {
+                    val = this->reduce_run(
+                        x + offset + base[0] + first * stride[0], stride[0], end - first, val);
+                };
+                detail::strided_for_each_run(reduced, start, last, run);
+                return val;
+            };
+
+        if(nout < get_thread_pool().size() and nred >= 2 * min_grain)
+        {
+            // Too few outputs to keep the threads busy, so each task reduces a part of the
+            // reduced elements for all of the outputs and the parts are combined afterwards
+            const std::size_t chunk   = std::max<std::size_t>(min_grain, (nred + 63) / 64);
+            const std::size_t nchunks = (nred + chunk - 1) / chunk;
+            std::vector<accumulator> partials(nchunks * nout, init);
+            par_for(nchunks, 1, [&](std::size_t c) {
+                const std::size_t start = c * chunk;
+                const std::size_t last  = std::min(nred, start + chunk);
+                std::size_t i           = c * nout;
+                auto run = [&](const auto& base, const auto& stride, auto first, auto end) {
+                    for(auto j = first; j < end; j++)
+                        partials[i++] = reduce_range(base[1] + j * stride[1], start, last, init);
+                };
+                detail::strided_for_each_run(kept, 0, nout, run);
+            });
+            auto op       = self.op();
+            std::size_t i = 0;
+            auto run      = [&](const auto& base, const auto& stride, auto first, auto end) {
+                for(auto j = first; j < end; j++, i++)
+                {
+                    accumulator val = partials[i];
+                    for(std::size_t c = 1; c < nchunks; c++)
+                        val = op(val, partials[c * nout + i]);
+                    y[base[0] + j * stride[0]] = finish(val);
+                }
+            };
+            detail::strided_for_each_run(kept, 0, nout, run);
+            return;
+        }
 
-        output(out_idx.begin(), out_idx.end()) =
-            static_cast<const Derived&>(*this).output(batch_shape)(val);
+        // When the reduced elements are closer together than the outputs, each output is reduced
+        // on its own, otherwise a chunk of outputs is reduced together so the innermost loop walks
+        // over the input elements of neighbouring outputs
+        const bool inner = kept.lens.empty() or reduced.lens.empty() or
+                           reduced.strides.back()[0] <= kept.strides.back()[1];
+        const std::size_t chunk = std::max<std::size_t>(
+            {min_grain / std::max<std::size_t>(nred, 1), (nout + 63) / 64, 1});
+        const std::size_t nchunks = (nout + chunk - 1) / chunk;
+        par_for(nchunks, 1, [&](std::size_t c) {
+            const std::size_t start = c * chunk;
+            const std::size_t last  = std::min(nout, start + chunk);
+            if(inner)
+            {
+                auto run = [&](const auto& base, const auto& stride, auto first, auto end) {
+                    for(auto j = first; j < end; j++)
+                        y[base[0] + j * stride[0]] =
+                            finish(reduce_range(base[1] + j * stride[1], 0, nred, init));
+                };
+                detail::strided_for_each_run(kept, start, last, run);
+                return;
+            }
+            // The input offset, stride and length of each run of outputs in the chunk
+            std::vector<std::array<std::size_t, 3>> runs;
+            auto add_run = [&](const auto& base, const auto& stride, auto first, auto end) {
+                runs.push_back({base[1] + first * stride[1], stride[1], end - first});
+            };
+            detail::strided_for_each_run(kept, start, last, add_run);
+            std::vector<accumulator> accs(last - start, init);
+            auto each_reduced = [&](std::size_t offset) {
+                auto* acc = accs.data();
+                for(const auto& r : runs)
+                {
+                    const T* xs = x + offset + r[0];
+                    for(std::size_t j = 0; j < r[2]; j++, acc++)
+                        *acc = this->fold(*acc, xs[j * r[1]]);
+                }
+            };
+            detail::strided_for_each_range(reduced, 0, nred, each_reduced);
+            auto* acc = accs.data();
+            auto run  = [&](const auto& base, const auto& stride, auto first, auto end) {
+                for(auto j = first; j < end; j++, acc++)
+                    y[base[0] + j * stride[0]] = finish(*acc);
+            };
+            detail::strided_for_each_run(kept, start, last, run);
+        });
     }
 
     argument reduce(const shape& computed_shape,
@@ -223,12 +342,8 @@ struct reduce_op : op_name<Derived>
         shape batch_shape{computed_shape.type(), batch_lens};
         argument result{computed_shape};
 
-        visit_all(result, data_arg)([&](auto output, auto input) {
-            par_for(computed_shape.elements(), [&](auto i) {
-                auto out_idx = computed_shape.multi(i);
-                this->reduce(input, batch_shape, reduce_axes, out_idx, output);
-            });
-        });
+        visit_all(result, data_arg)(
+            [&](auto output, auto input) { this->reduce(output, input, batch_shape); });
 
         return result;
     }
@@ -25,52 +25,16 @@
 #define MIGRAPHX_GUARD_MIGRAPHX_PAR_HPP
 
 #include <migraphx/config.hpp>
+#include <migraphx/simple_par_for.hpp>
 #if MIGRAPHX_HAS_EXECUTORS
 #include <execution>
-#else
-#include <migraphx/simple_par_for.hpp>
 #endif
 #include <algorithm>
-#include <mutex>
 #include <vector>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-namespace detail {
-
-struct exception_list
-{
-    std::vector<std::exception_ptr> exceptions;
-    std::mutex m;
-    void add_exception()
-    {
-        std::lock_guard<std::mutex> guard(m);
-        exceptions.push_back(std::current_exception());
-    }
-    template <class F>
-    auto collect(F f)
-    {
-        return [f, this](auto&&... xs) {
-            try
-            {
-                f(std::forward<decltype(xs)>(xs)...);
-            }
-            catch(...)
-            {
-                this->add_exception();
-            }
-        };
-    }
-    void throw_if_exception() const
-    {
-        if(not exceptions.empty())
-            std::rethrow_exception(exceptions.front());
-    }
-};
-
-} // namespace detail
-
 template <class InputIt, class OutputIt, class UnaryOperation>
 OutputIt par_transform(InputIt first1, InputIt last1, OutputIt d_first, UnaryOperation unary_op)
 {
@@ -96,14 +60,9 @@ OutputIt par_transform(
 template <class InputIt, class UnaryFunction>
 void par_for_each(InputIt first, InputIt last, UnaryFunction f)
 {
-#if MIGRAPHX_HAS_EXECUTORS
-    // Propagate the exception
-    detail::exception_list ex;
-    std::for_each(std::execution::par, first, last, ex.collect(std::move(f)));
-    ex.throw_if_exception();
-#else
+    // Use the thread pool even when executors are available so all of the parallel loops share
+    // the same threads
     simple_par_for(last - first, [&](auto i) { f(first[i]); });
-#endif
 }
 
 template <class... Ts>
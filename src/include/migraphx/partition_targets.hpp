@@ -0,0 +1,64 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_PARTITION_TARGETS_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_PARTITION_TARGETS_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/assignment_options.hpp>
+#include <migraphx/target_assignments.hpp>
+#include <migraphx/module_ref.hpp>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct program;
+struct target;
+
+/**
+ * @brief Assign the instructions of the module to the targets that minimize the predicted cost
+ *
+ * The cost of an instruction on a target is its share of the metric of the supported segment
+ * that contains it, and copying a value between two targets costs the bytes copied times the
+ * copy costs of both targets. The latency metric minimizes the sum of all the costs, while the
+ * throughput metric minimizes the load of the busiest target. Instructions that no target
+ * supports are left unassigned.
+ */
+MIGRAPHX_EXPORT target_assignments assign_targets(const_module_ref mod,
+                                                  const std::vector<target>& targets,
+                                                  const assignment_options& options);
+
+/**
+ * @brief Move the instructions of the main module into submodules called with run_on_target
+ *
+ * Consecutive instructions that are assigned to the same target are placed in the same
+ * submodule, and the target_id is the index of the target in targets.
+ */
+MIGRAPHX_EXPORT void partition_targets(program& p,
+                                       const std::vector<target>& targets,
+                                       const target_assignments& tass);
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+#endif // MIGRAPHX_GUARD_MIGRAPHX_PARTITION_TARGETS_HPP
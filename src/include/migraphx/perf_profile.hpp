@@ -0,0 +1,110 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHLIB_PERF_PROFILE_HPP
+#define MIGRAPHX_GUARD_MIGRAPHLIB_PERF_PROFILE_HPP
+
+#include <migraphx/config.hpp>
+#include <cstddef>
+#include <iosfwd>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+/// Distribution of a set of timings, in milliseconds
+struct MIGRAPHX_EXPORT timing_summary
+{
+    std::size_t count = 0;
+    double min        = 0;
+    double mean       = 0;
+    double stddev     = 0;
+    double p50        = 0;
+    double p90        = 0;
+    double p99        = 0;
+    double max        = 0;
+
+    static timing_summary compute(std::vector<double> samples);
+};
+
+/**
+ * Timings of each instruction recorded over several runs of a program by
+ * `program::profile`. Every execution of an instruction is kept as an event,
+ * so instructions in submodules that run several times per run (such as loop
+ * bodies) have several events per run. Times are in milliseconds from the
+ * start of the first run.
+ */
+struct MIGRAPHX_EXPORT perf_profile
+{
+    static constexpr std::size_t no_parent = std::numeric_limits<std::size_t>::max();
+
+    struct instruction_info
+    {
+        /// Name of the instruction as printed in the program, such as `@3`
+        std::string name;
+        std::string module;
+        /// Group attribute of the operator, or the operator name when it has none
+        std::string group;
+    };
+
+    struct event
+    {
+        /// Index into `instructions`
+        std::size_t instruction = 0;
+        /// Index of the event that ran the submodule this event belongs to
+        std::size_t parent = no_parent;
+        std::size_t run    = 0;
+        double start       = 0;
+        double duration    = 0;
+    };
+
+    struct run_event
+    {
+        double start    = 0;
+        double duration = 0;
+    };
+
+    std::vector<instruction_info> instructions;
+    std::vector<event> events;
+    std::vector<run_event> runs;
+
+    timing_summary run_summary() const;
+    /// Summary of the timings for each entry in `instructions`
+    std::vector<timing_summary> instruction_summaries() const;
+
+    /// Print the p50/p90/p99 latencies of every instruction
+    void print_summary(std::ostream& os) const;
+    /// Write the events in the chrome trace event format, which can be loaded in
+    /// chrome://tracing or perfetto
+    void write_chrome_trace(std::ostream& os) const;
+    /// Write the self time of every call stack in microseconds, in the folded
+    /// format used by flamegraph.pl and speedscope
+    void write_folded_stacks(std::ostream& os) const;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif // MIGRAPHX_GUARD_MIGRAPHLIB_PERF_PROFILE_HPP
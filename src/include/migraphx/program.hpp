@@ -38,7 +38,9 @@
 #include <migraphx/env.hpp>
 #include <migraphx/config.hpp>
 #include <migraphx/execution_environment.hpp>
+#include <migraphx/allocation_pool.hpp>
 #include <algorithm>
+#include <functional>
 #include <iostream>
 
 namespace migraphx {
@@ -50,6 +52,7 @@ MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_EVAL)
 struct program_impl;
 
 struct marker;
+struct perf_profile;
 
 /**
  * @brief Stores the instruction stream
@@ -77,6 +80,12 @@ struct MIGRAPHX_EXPORT program
 
     std::unordered_map<std::string, shape> get_parameter_shapes() const;
 
+    /// Evaluates the program. A compiled program can be evaluated from many threads at once:
+    /// each concurrent eval gets its own results, contexts and copies of the global buffers such
+    /// as the scratch memory, while the literals are shared. When a target uses device memory,
+    /// or the program is not compiled, the copies would share the same buffers so the concurrent
+    /// evals run one at a time instead. The output parameters of a program on the host are
+    /// allocated when they are not passed.
     std::vector<argument> eval(parameter_map params,
                                execution_environment exec_env = execution_environment{}) const;
 
@@ -84,6 +93,9 @@ struct MIGRAPHX_EXPORT program
 
     void finish() const;
 
+    /// Statistics of the host buffers that the evals of the compiled program allocated
+    allocation_stats get_allocation_stats() const;
+
     std::size_t size() const;
 
     std::vector<shape> get_output_shapes() const;
@@ -102,6 +114,13 @@ struct MIGRAPHX_EXPORT program
 
     bool is_compiled() const;
 
+    /// Whether the parameters and results of the program are in host memory for every target
+    /// it was compiled for
+    bool uses_host_memory() const;
+
+    /// Copies a result of the program to the host, or returns it when it's already there
+    argument copy_to_host(const argument& arg) const;
+
     void finalize();
 
     void perf_report(std::ostream& os,
@@ -112,8 +131,14 @@ struct MIGRAPHX_EXPORT program
 
     void mark(const parameter_map& params, marker&& m);
 
+    /// Time every instruction over n runs, keeping each measurement
+    perf_profile profile(std::size_t n, parameter_map params) const;
+
     value to_value() const;
     void from_value(const value& v);
+    /// Restore the program using make_literal to create the literals from their serialized
+    /// values
+    void from_value(const value& v, const std::function<literal(const value&)>& make_literal);
 
     void debug_print() const;
     void debug_print(instruction_ref ins) const;
@@ -135,6 +160,9 @@ struct MIGRAPHX_EXPORT program
 
     program& sort();
 
+    /// Structural hash of all the modules, which is stable for equal programs
+    std::size_t hash() const;
+
     MIGRAPHX_EXPORT friend std::ostream& operator<<(std::ostream& os, const program& p);
     MIGRAPHX_EXPORT friend bool operator==(const program& x, const program& y);
     friend bool operator!=(const program& x, const program& y) { return not(x == y); }
@@ -0,0 +1,104 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_PROGRAM_CACHE_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_PROGRAM_CACHE_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/compile_options.hpp>
+#include <migraphx/filesystem.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct program;
+struct target;
+
+struct program_cache_stats
+{
+    // Number of compiled programs loaded from the cache
+    std::uint64_t hits = 0;
+    // Number of lookups that did not find a usable program
+    std::uint64_t misses = 0;
+    // Number of compiled programs written to the cache
+    std::uint64_t stores = 0;
+    // Number of programs removed to keep the cache under its size limit
+    std::uint64_t evictions = 0;
+};
+
+/// A directory of compiled programs. Each program is saved with `save` under a key computed from
+/// the program before it is compiled, the target and its device, the compile options, the
+/// MIGRAPHX_ environment variables and the version of MIGraphX. The key is also stored in the
+/// file, and a file with another key is not loaded. Writers hold a lock file in the directory,
+/// and the files are written to a temporary name and renamed so readers never see a partial
+/// file. When the directory is larger than the size limit the least recently used programs are
+/// removed.
+struct MIGRAPHX_EXPORT program_cache
+{
+    explicit program_cache(fs::path cache_dir, std::size_t max_size = 0);
+    program_cache(const program_cache&)            = delete;
+    program_cache& operator=(const program_cache&) = delete;
+
+    /// Computes the key of the program, which is the name of the target and a SHA-256 digest.
+    /// Unlike `program::hash`, every byte of the literals is used.
+    static std::string
+    key(const program& p, const target& t, const compile_options& options = compile_options{});
+
+    /// Replaces the program with the compiled program stored under the key, and returns false
+    /// when there is no such program or it can't be loaded
+    bool load(const std::string& key, program& p) const;
+
+    /// Stores the compiled program under the key
+    void store(const std::string& key, const program& p) const;
+
+    fs::path path(const std::string& key) const;
+
+    const fs::path& directory() const { return dir; }
+    /// Largest total size in bytes of the cached programs, zero for no limit
+    std::size_t size_limit() const { return max_size; }
+
+    program_cache_stats stats() const;
+
+    private:
+    void evict(const fs::path& keep) const;
+
+    fs::path dir;
+    std::size_t max_size = 0;
+    mutable std::atomic<std::uint64_t> hits{0};
+    mutable std::atomic<std::uint64_t> misses{0};
+    mutable std::atomic<std::uint64_t> stores{0};
+    mutable std::atomic<std::uint64_t> evictions{0};
+};
+
+/// The cache used by `program::compile`, which is enabled by setting MIGRAPHX_PROGRAM_CACHE_DIR
+/// to a directory. MIGRAPHX_PROGRAM_CACHE_SIZE sets its size limit in megabytes, which is 4096
+/// by default. Returns nullptr when the cache is not enabled.
+MIGRAPHX_EXPORT program_cache* get_program_cache();
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif // MIGRAPHX_GUARD_MIGRAPHX_PROGRAM_CACHE_HPP
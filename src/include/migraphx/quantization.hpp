@@ -38,16 +38,46 @@ inline namespace MIGRAPHX_INLINE_NS {
 
 struct program;
 
+/**
+ * Options for the calibration of the 8-bit quantization
+ */
+struct calibration_options
+{
+    /// How the range of a tensor is chosen from the calibration data: "max" uses the largest
+    /// absolute value, "percentile" clips the values above the given percentile of the absolute
+    /// values, and "mse" picks the range with the smallest quantization error
+    std::string method = "max";
+    /// Percentile of the absolute values kept by the "percentile" method
+    float percentile = 99.99f;
+    /// Use a scale for each output channel of the constant weights of dot and convolution
+    bool per_channel = false;
+    /// Number of calibration batches evaluated at once, 0 evaluates as many as there are threads
+    /// on the host targets and one at a time otherwise
+    std::size_t jobs = 0;
+};
+
 MIGRAPHX_EXPORT void quantize_fp16(program& prog,
                                    const std::vector<std::string>& ins_names = {"all"});
 
+/// Stores the constant weights of dot as int8, with a scale and a zero point for each group of
+/// group_size rows of every column. The weights are dequantized while the dot is computed. Only
+/// the ref and cpu targets compute this natively, the other targets store the weights in full
+/// precision again when compiling.
+MIGRAPHX_EXPORT void quantize_weights_int8(program& prog, std::size_t group_size = 128);
+
+/// Like quantize_weights_int8, but the weights are stored as pairs of unsigned 4-bit values
+MIGRAPHX_EXPORT void quantize_weights_int4(program& prog, std::size_t group_size = 128);
+
 MIGRAPHX_EXPORT void quantize_int8(program& prog,
                                    const target& t,
                                    const std::vector<parameter_map>& calibration,
                                    const std::unordered_set<std::string>& ins_names = {
-                                       "dot", "convolution"});
-MIGRAPHX_EXPORT void
-quantize_fp8(program& prog, const target& t, const std::vector<parameter_map>& calibration);
+                                       "dot", "convolution"},
+                                   const calibration_options& options = {});
+MIGRAPHX_EXPORT void quantize_fp8(program& prog,
+                                  const target& t,
+                                  const std::vector<parameter_map>& calibration,
+                                  const calibration_options& options = {});
 
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
@@ -30,6 +30,7 @@
 #include <functional>
 #include <migraphx/argument.hpp>
 #include <migraphx/config.hpp>
+#include <memory>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -56,10 +57,38 @@ struct MIGRAPHX_EXPORT quantize_8bits_pass
 {
     shape::type_t precision = shape::int8_type;
     std::vector<std::pair<float, float>> quant_params;
+    // Quantize the constant weights of dot and convolution with a scale for each output channel
+    bool per_channel = false;
     std::string name() const { return "quantize_8bits"; }
     void apply(module& m) const;
 };
 
+struct calibrator_impl;
+
+/**
+ * Collects the statistics of the captured arguments over the calibration data and computes the
+ * quantization parameters from them. The arguments are read in place, and add can be called from
+ * several threads at once.
+ */
+struct MIGRAPHX_EXPORT calibrator
+{
+    calibrator(std::size_t n,
+               shape::type_t precision,
+               const std::string& method = "max",
+               float percentile          = 99.99f);
+    calibrator(const calibrator&)            = delete;
+    calibrator& operator=(const calibrator&) = delete;
+    ~calibrator();
+
+    void add(std::size_t ins_index, const argument& arg);
+
+    /// The scale and shift of each captured argument, in the form used by quantize_8bits_pass
+    std::vector<std::pair<float, float>> quant_params() const;
+
+    private:
+    std::unique_ptr<calibrator_impl> impl;
+};
+
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
 
@@ -0,0 +1,61 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_RTGLIB_QUANTIZE_WEIGHTS_HPP
+#define MIGRAPHX_GUARD_RTGLIB_QUANTIZE_WEIGHTS_HPP
+
+#include <string>
+#include <migraphx/config.hpp>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct module;
+
+/**
+ * quantize the constant weights of dot to int8 or int4 with a scale and a zero point for each
+ * group of rows of every column, which are dequantized by dequant_dot while it computes the dot
+ */
+struct MIGRAPHX_EXPORT quantize_weights_pass
+{
+    std::size_t bits       = 8;
+    std::size_t group_size = 128;
+    std::string name() const { return "quantize_weights"; }
+    void apply(module& m) const;
+};
+
+/**
+ * rewrite dequant_dot to a dot with the dequantized weights, for the targets that don't compute
+ * it directly. Constant folding turns these weights back into full precision literals, so a
+ * warning is printed when any dequant_dot is rewritten.
+ */
+struct MIGRAPHX_EXPORT rewrite_dequant_dot
+{
+    std::string name() const { return "rewrite_dequant_dot"; }
+    void apply(module& m) const;
+};
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif
@@ -24,6 +24,7 @@
 #ifndef MIGRAPHX_GUARD_RTGLIB_REWRITE_RNN_HPP
 #define MIGRAPHX_GUARD_RTGLIB_REWRITE_RNN_HPP
 
+#include <functional>
 #include <string>
 #include <vector>
 #include <migraphx/instruction_ref.hpp>
@@ -35,29 +36,53 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
 struct module;
+struct module_pass_manager;
 
 /**
- * Rewrite rnn to gemm and add.
+ * Rewrite rnn to gemm and add. The input of all of the timesteps is multiplied with the input
+ * weights in a single gemm, and the recurrence is either unrolled or run in a loop submodule.
  */
 struct MIGRAPHX_EXPORT rewrite_rnn
 {
+    /// Unroll the recurrence once per timestep, otherwise it runs in a loop so the size of the
+    /// graph doesn't depend on the sequence length
+    bool unroll = true;
+
     std::string name() const { return "rewrite_rnn"; }
-    void apply(module& m) const;
+    void apply(module_pass_manager& mpm) const;
 
     private:
+    // Computes the states of a timestep from the input projection of the timestep and the
+    // previous states, inserting the instructions into the module before the instruction
+    using rnn_step = std::function<std::vector<instruction_ref>(
+        module&, instruction_ref, instruction_ref, const std::vector<instruction_ref>&)>;
+
+    instruction_ref input_projection(module& m,
+                                     instruction_ref ins,
+                                     instruction_ref seq,
+                                     instruction_ref w,
+                                     instruction_ref bias,
+                                     long seq_len) const;
+    std::vector<instruction_ref> run_recurrence(bool is_forward,
+                                                module_pass_manager& mpm,
+                                                instruction_ref ins,
+                                                instruction_ref xw,
+                                                std::vector<instruction_ref> states,
+                                                const rnn_step& step) const;
+
     // for vanilla rnn operators
-    void apply_vanilla_rnn(module& m, instruction_ref ins) const;
+    void apply_vanilla_rnn(module_pass_manager& mpm, instruction_ref ins) const;
     std::vector<instruction_ref> vanilla_rnn_cell(bool is_forward,
-                                                  module& m,
+                                                  module_pass_manager& mpm,
                                                   instruction_ref ins,
                                                   std::vector<instruction_ref> inputs,
                                                   const operation& actv_func) const;
     std::vector<operation> vanilla_rnn_actv_funcs(instruction_ref ins) const;
 
     // for gru operators
-    void apply_gru(module& m, instruction_ref ins) const;
+    void apply_gru(module_pass_manager& mpm, instruction_ref ins) const;
     std::vector<instruction_ref> gru_cell(bool is_forward,
-                                          module& m,
+                                          module_pass_manager& mpm,
                                           instruction_ref ins,
                                           std::vector<instruction_ref> inputs,
                                           int linear_before_reset,
@@ -67,9 +92,9 @@ struct MIGRAPHX_EXPORT rewrite_rnn
     std::vector<operation> gru_actv_funcs(instruction_ref ins) const;
 
     // for lstm operators
-    void apply_lstm(module& m, instruction_ref ins) const;
+    void apply_lstm(module_pass_manager& mpm, instruction_ref ins) const;
     std::vector<instruction_ref> lstm_cell(bool is_forward,
-                                           module& m,
+                                           module_pass_manager& mpm,
                                            instruction_ref ins,
                                            std::vector<instruction_ref> inputs,
                                            const operation& actv_func1,
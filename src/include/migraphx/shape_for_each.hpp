@@ -32,29 +32,29 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
 /**
- * Iterates the given function over the indices from the shape in order.
+ * Iterates the given function over the indices from the shape in order. The indices are updated
+ * by carrying into the outer dimensions instead of being recomputed for every element.
  */
 template <class F>
 void shape_for_each(const migraphx::shape& s, F f)
 {
-    std::vector<std::size_t> indices(s.lens().size());
+    const auto& lens = s.lens();
+    std::vector<std::size_t> indices(lens.size());
     const auto& index_const_ref = indices;
-    shape ss{s.type(), s.lens()};
-    size_t max = ss.elements();
+    std::size_t max             = shape{s.type(), lens}.elements();
     for(std::size_t i = 0; i < max; i++)
     {
-        std::transform(ss.strides().begin(),
-                       ss.strides().end(),
-                       ss.lens().begin(),
-                       indices.begin(),
-                       [&](std::size_t stride, std::size_t len) {
-                           assert(len > 0 and stride > 0);
-                           return (i / stride) % len;
-                       });
         if constexpr(std::is_invocable<F, decltype(index_const_ref), decltype(i)>{})
             f(index_const_ref, i);
         else
             f(index_const_ref);
+        for(std::size_t d = indices.size(); d > 0; d--)
+        {
+            assert(lens[d - 1] > 0);
+            if(++indices[d - 1] < lens[d - 1])
+                break;
+            indices[d - 1] = 0;
+        }
     }
 }
 
@@ -24,6 +24,7 @@
 #ifndef MIGRAPHX_GUARD_RTGLIB_SIMPLE_PAR_FOR_HPP
 #define MIGRAPHX_GUARD_RTGLIB_SIMPLE_PAR_FOR_HPP
 
+#include <migraphx/thread_pool.hpp>
 #include <thread>
 #include <cmath>
 #include <algorithm>
@@ -72,29 +73,17 @@ void simple_par_for_impl(std::size_t n, std::size_t threadsize, F f)
     }
     else
     {
-        std::vector<joinable_thread> threads(threadsize);
-// Using const here causes gcc 5 to ICE
-#if(!defined(__GNUC__) || __GNUC__ != 5)
-        const
-#endif
-            std::size_t grainsize = std::ceil(static_cast<double>(n) / threads.size());
-
-        std::size_t work = 0;
-        std::size_t tid  = 0;
-        std::generate(threads.begin(), threads.end(), [=, &work, &tid] {
-            auto result = joinable_thread([=] {
-                std::size_t start = work;
-                std::size_t last  = std::min(n, work + grainsize);
-                for(std::size_t i = start; i < last; i++)
-                {
-                    thread_invoke(i, tid, f);
-                }
-            });
-            work += grainsize;
-            ++tid;
-            return result;
+        // Use more tasks than threads so threads that finish early can steal the remaining work
+        const std::size_t ntasks    = std::min(n, threadsize * 4);
+        const std::size_t grainsize = (n + ntasks - 1) / ntasks;
+        get_thread_pool().run(ntasks, threadsize, [&](std::size_t task, std::size_t tid) {
+            std::size_t start = task * grainsize;
+            std::size_t last  = std::min(n, start + grainsize);
+            for(std::size_t i = start; i < last; i++)
+            {
+                thread_invoke(i, tid, f);
+            }
         });
-        assert(work >= n);
     }
 }
 
@@ -38,7 +38,8 @@ struct module;
  */
 struct MIGRAPHX_EXPORT simplify_reshapes
 {
-    size_t depth = 4;
+    /// Number of times the matchers run over the module, or 0 to run them until nothing changes
+    size_t depth = 0;
     std::string name() const { return "simplify_reshapes"; }
     void apply(module& m) const;
 };
@@ -0,0 +1,209 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_STRIDED_FOR_EACH_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_STRIDED_FOR_EACH_HPP
+
+#include <migraphx/config.hpp>
+#include <migraphx/shape.hpp>
+#include <migraphx/par_for.hpp>
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+namespace detail {
+
+// The dimensions shared by a set of tensors with their strides in each of the tensors. Adjacent
+// dimensions that are contiguous in all of the tensors are merged, and dimensions of length one
+// are removed.
+template <std::size_t N>
+struct strided_dims
+{
+    std::vector<std::size_t> lens;
+    std::vector<std::array<std::size_t, N>> strides;
+
+    strided_dims(const std::vector<std::size_t>& input_lens,
+                 const std::array<const std::vector<std::size_t>*, N>& input_strides)
+    {
+        for(std::size_t d = 0; d < input_lens.size(); d++)
+        {
+            if(input_lens[d] == 1)
+                continue;
+            std::array<std::size_t, N> s;
+            for(std::size_t k = 0; k < N; k++)
+                s[k] = (*input_strides[k])[d];
+            if(not lens.empty() and std::equal(strides.back().begin(),
+                                               strides.back().end(),
+                                               s.begin(),
+                                               [&](auto outer, auto inner) {
+                                                   return outer == inner * input_lens[d];
+                                               }))
+            {
+                lens.back() *= input_lens[d];
+                strides.back() = s;
+                continue;
+            }
+            lens.push_back(input_lens[d]);
+            strides.push_back(s);
+        }
+    }
+
+    std::size_t elements() const
+    {
+        return std::accumulate(
+            lens.begin(), lens.end(), std::size_t{1}, std::multiplies<std::size_t>{});
+    }
+};
+
+template <std::size_t N, class F, std::size_t... Is>
+void strided_inner_loop(F& f,
+                        const std::array<std::size_t, N>& base,
+                        const std::array<std::size_t, N>& stride,
+                        std::size_t first,
+                        std::size_t last,
+                        std::index_sequence<Is...>)
+{
+    for(std::size_t j = first; j < last; j++)
+        f((base[Is] + j * stride[Is])...);
+}
+
+// Calls f(base, stride, first, last) for each run of the elements [start, last) along the
+// innermost dimension, where the offsets of the elements of the run are base + j * stride for j in
+// [first, last). Only the first index is computed with divisions, and the rest are found by
+// carrying into the outer dimensions.
+template <std::size_t N, class F>
+void strided_for_each_run(const strided_dims<N>& dims, std::size_t start, std::size_t last, F& f)
+{
+    if(start >= last)
+        return;
+    std::array<std::size_t, N> base{};
+    if(dims.lens.empty())
+    {
+        f(base, base, std::size_t{0}, std::size_t{1});
+        return;
+    }
+    const std::size_t nd    = dims.lens.size();
+    const std::size_t inner = dims.lens.back();
+    std::vector<std::size_t> idx(nd);
+    std::size_t r = start;
+    for(std::size_t d = nd; d > 0; d--)
+    {
+        idx[d - 1] = r % dims.lens[d - 1];
+        r /= dims.lens[d - 1];
+    }
+    for(std::size_t d = 0; d + 1 < nd; d++)
+    {
+        for(std::size_t k = 0; k < N; k++)
+            base[k] += idx[d] * dims.strides[d][k];
+    }
+    std::size_t j = idx.back();
+    for(std::size_t i = start; i < last;)
+    {
+        auto n = std::min(inner - j, last - i);
+        f(base, dims.strides.back(), j, j + n);
+        i += n;
+        j = 0;
+        for(std::size_t d = nd - 1; d > 0; d--)
+        {
+            auto& x = idx[d - 1];
+            x++;
+            for(std::size_t k = 0; k < N; k++)
+                base[k] += dims.strides[d - 1][k];
+            if(x < dims.lens[d - 1])
+                break;
+            for(std::size_t k = 0; k < N; k++)
+                base[k] -= x * dims.strides[d - 1][k];
+            x = 0;
+        }
+    }
+}
+
+// Calls f with the offsets of the elements [start, last) in the order of the dimensions
+template <std::size_t N, class F>
+void strided_for_each_range(const strided_dims<N>& dims,
+                            std::size_t start,
+                            std::size_t last,
+                            F& f)
+{
+    auto run = [&](const std::array<std::size_t, N>& base,
+                   const std::array<std::size_t, N>& stride,
+                   std::size_t first,
+                   std::size_t end) {
+        strided_inner_loop(f, base, stride, first, end, std::make_index_sequence<N>{});
+    };
+    strided_for_each_run(dims, start, last, run);
+}
+
+template <class... Shapes>
+auto make_strided_dims(const shape& s, const Shapes&... ss)
+{
+    assert(((ss.lens() == s.lens()) and ...));
+    return strided_dims<sizeof...(Shapes) + 1>{s.lens(), {&s.strides(), &ss.strides()...}};
+}
+
+} // namespace detail
+
+/**
+ * Returns a function that calls f with the offset of the element in each of the shapes, for every
+ * index of the shapes in order. The shapes must have the same lens. Dimensions that are
+ * contiguous in all of the shapes are merged and the innermost dimension is iterated in a tight
+ * loop, so unlike shape_for_each no index is computed with divisions.
+ */
+template <class... Shapes>
+auto strided_for_each(const shape& s, const Shapes&... ss)
+{
+    return [dims = detail::make_strided_dims(s, ss...)](auto f) {
+        detail::strided_for_each_range(dims, 0, dims.elements(), f);
+    };
+}
+
+/**
+ * Like strided_for_each, but the elements are split into chunks of at least min_grain elements
+ * which are run in parallel, so f is not called in order.
+ */
+template <class... Shapes>
+auto par_strided_for_each(std::size_t min_grain, const shape& s, const Shapes&... ss)
+{
+    return [min_grain, dims = detail::make_strided_dims(s, ss...)](auto f) {
+        const std::size_t n = dims.elements();
+        // Use more chunks than threads so uneven chunks can be balanced by the pool
+        const std::size_t chunk   = std::max<std::size_t>({min_grain, (n + 63) / 64, 1});
+        const std::size_t nchunks = (n + chunk - 1) / chunk;
+        par_for(nchunks, 1, [&](std::size_t c) {
+            auto g = f;
+            detail::strided_for_each_range(dims, c * chunk, std::min(n, (c + 1) * chunk), g);
+        });
+    };
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif // MIGRAPHX_GUARD_MIGRAPHX_STRIDED_FOR_EACH_HPP
@@ -34,6 +34,8 @@ inline namespace MIGRAPHX_INLINE_NS {
 struct supported_segment
 {
     std::unordered_set<instruction_ref> instructions;
+    /// The predicted cost of running the instructions on the target, as measured by the
+    /// support_metric that was asked for. Lower is better.
     float metric;
 };
 
@@ -49,8 +49,13 @@ struct target_assignments
     auto begin() const { return assignments.begin(); }
     auto end() const { return assignments.end(); }
 
+    /// The predicted cost of the assignments, as measured by the metric they were chosen for
+    float get_cost() const { return cost; }
+    void set_cost(float c) { cost = c; }
+
     private:
     std::unordered_map<instruction_ref, std::string> assignments;
+    float cost = 0;
 };
 
 } // namespace MIGRAPHX_INLINE_NS
@@ -0,0 +1,91 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#ifndef MIGRAPHX_GUARD_MIGRAPHX_THREAD_POOL_HPP
+#define MIGRAPHX_GUARD_MIGRAPHX_THREAD_POOL_HPP
+
+#include <migraphx/config.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+struct thread_pool_impl;
+
+struct thread_pool_stats
+{
+    // Number of parallel jobs dispatched to the worker threads
+    std::uint64_t jobs = 0;
+    // Number of tasks executed by all of the jobs
+    std::uint64_t tasks = 0;
+    // Number of tasks a thread took from the queue of another thread
+    std::uint64_t steals = 0;
+    // Time the worker threads spent waiting for a job
+    std::uint64_t idle_ns = 0;
+};
+
+/// A persistent pool of threads that execute parallel loops. Each thread has its own queue of
+/// tasks and steals from the other queues once its own queue is empty. The calling thread takes
+/// part in the job as thread 0.
+struct MIGRAPHX_EXPORT thread_pool
+{
+    explicit thread_pool(std::size_t nthreads, bool pin_threads = false);
+    thread_pool(const thread_pool&)            = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+    ~thread_pool();
+
+    /// Number of threads including the calling thread
+    std::size_t size() const;
+
+    /// Calls f(task, tid) for every task in [0, ntasks) using at most max_threads threads, and
+    /// waits for all of the tasks to finish. The first exception thrown by a task is rethrown.
+    /// Nested calls run serially on the calling thread, and calls made while another thread is
+    /// using the pool are shared with the worker threads that are not busy.
+    void run(std::size_t ntasks,
+             std::size_t max_threads,
+             const std::function<void(std::size_t, std::size_t)>& f);
+
+    /// Abandons the worker threads and starts new ones. This is used in the child process after
+    /// a fork, where the worker threads of the parent no longer exist. The old threads can't be
+    /// joined, so their state is intentionally leaked.
+    void restart();
+
+    thread_pool_stats stats() const;
+    void reset_stats();
+
+    private:
+    std::unique_ptr<thread_pool_impl> impl;
+};
+
+/// The thread pool shared by the host parallel algorithms. The number of threads can be set
+/// with MIGRAPHX_NUM_THREADS and the threads are pinned to cores when
+/// MIGRAPHX_THREAD_AFFINITY is set. The pool is restarted by its first use in the child process
+/// after a fork.
+MIGRAPHX_EXPORT thread_pool& get_thread_pool();
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
+
+#endif // MIGRAPHX_GUARD_MIGRAPHX_THREAD_POOL_HPP
@@ -33,6 +33,9 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+/// A name made from the prefix, the process, the thread, the time and random characters
+MIGRAPHX_EXPORT std::string unique_string(const std::string& prefix);
+
 struct MIGRAPHX_EXPORT tmp_dir
 {
     fs::path path;
@@ -24,8 +24,10 @@
 #include <migraphx/instruction.hpp>
 #include <migraphx/builtin.hpp>
 #include <migraphx/erase.hpp>
+#include <migraphx/hash.hpp>
 #include <migraphx/module.hpp>
 #include <migraphx/ranges.hpp>
+#include <string_view>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -61,7 +63,8 @@ void instruction::replace(const shape& r)
 {
     if(r != result)
     {
-        result = r;
+        result      = r;
+        cached_hash = 0;
         for(auto&& ins : output)
         {
             assert(ins->name() == "@return" or ins->name().front() != '@');
@@ -72,8 +75,9 @@ void instruction::replace(const shape& r)
 
 void instruction::replace(operation o)
 {
-    normalized = false;
-    op         = std::move(o);
+    normalized  = false;
+    op          = std::move(o);
+    cached_hash = 0;
     recompute_shape();
 }
 
@@ -87,6 +91,7 @@ void instruction::clear_arguments()
     }
     arguments.clear();
     module_args.clear();
+    cached_hash = 0;
 }
 
 bool operator==(const instruction& i, instruction_ref ref)
@@ -172,6 +177,62 @@ bool operator==(const instruction& x, const instruction& y)
 
 bool operator!=(const instruction& x, const instruction& y) { return not(x == y); }
 
+static void hash_shape(std::size_t& h, const shape& s)
+{
+    hash_combine(h, static_cast<int>(s.type()));
+    if(s.type() == shape::tuple_type)
+    {
+        for(const auto& sub : s.sub_shapes())
+            hash_shape(h, sub);
+    }
+    else if(s.dynamic())
+    {
+        for(const auto& dd : s.dyn_dims())
+        {
+            hash_combine(h, dd.min);
+            hash_combine(h, dd.max);
+        }
+    }
+    else
+    {
+        for(auto len : s.lens())
+            hash_combine(h, len);
+        for(auto stride : s.strides())
+            hash_combine(h, stride);
+    }
+}
+
+std::size_t instruction::hash() const
+{
+    if(cached_hash != 0)
+        return cached_hash;
+    std::size_t h = hash_value(op.name());
+    hash_combine(h, op.to_value());
+    hash_shape(h, result);
+    // Modules can be renamed, so only their number is part of the cached hash
+    hash_combine(h, module_args.size());
+    if(op.name() == "@literal" and not lit.empty())
+    {
+        // Only sample the ends of large literals, since the data may be mapped
+        // from a file. Equal hashes are still compared with the full data.
+        const std::size_t sample = 128;
+        auto bytes               = lit.get_shape().bytes();
+        hash_shape(h, lit.get_shape());
+        if(bytes <= 2 * sample)
+        {
+            hash_combine(h, std::string_view{lit.data(), bytes});
+        }
+        else
+        {
+            hash_combine(h, std::string_view{lit.data(), sample});
+            hash_combine(h, std::string_view{lit.data() + bytes - sample, sample});
+        }
+    }
+    // Keep zero free to mark a hash that has not been computed
+    cached_hash = h == 0 ? 1 : h;
+    return cached_hash;
+}
+
 bool operator==(instruction_ref ref, const instruction& i) { return i == ref; }
 
 bool operator!=(const instruction& i, instruction_ref ref) { return not(i == ref); }
@@ -227,8 +288,9 @@ void instruction::replace(instruction_ref ins,
 
 void instruction::replace(operation o, const shape& r, std::vector<instruction_ref> args)
 {
-    normalized = false;
-    op         = std::move(o);
+    normalized  = false;
+    op          = std::move(o);
+    cached_hash = 0;
     replace(r);
     replace(std::move(args));
 }
@@ -238,7 +300,8 @@ void instruction::replace(operation o,
                           std::vector<instruction_ref> args,
                           std::vector<module_ref> mdl_args)
 {
-    op = std::move(o);
+    op          = std::move(o);
+    cached_hash = 0;
     replace(r);
     replace(std::move(args), std::move(mdl_args));
 }
@@ -294,6 +357,7 @@ void instruction::replace_mod_argument(module_ref old, module_ref new_mod)
 {
     assert(std::any_of(module_args.begin(), module_args.end(), [&](auto i) { return i == old; }));
     std::replace(module_args.begin(), module_args.end(), old, new_mod);
+    cached_hash = 0;
 }
 
 bool instruction::is_undefined() const
@@ -26,13 +26,89 @@
 #include <migraphx/file_buffer.hpp>
 #include <migraphx/json.hpp>
 #include <migraphx/msgpack.hpp>
+#include <array>
+#include <cstring>
 #include <fstream>
+#include <sstream>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
+// Layout of a file with mapped literals: the header is followed by the literals, each aligned to
+// a page boundary, and the program serialized with msgpack is stored at the end. The literals in
+// the program refer to their data with an offset from the start of the file.
+constexpr std::size_t mapped_literal_alignment = 4096;
+constexpr std::array<char, 8> mapped_file_magic = {'M', 'I', 'G', 'X', 'M', 'A', 'P', '1'};
+
+struct mapped_file_header
+{
+    std::array<char, 8> magic    = mapped_file_magic;
+    std::uint64_t program_offset = 0;
+    std::uint64_t program_size   = 0;
+};
+
+static bool is_mapped_file(const char* buffer, std::size_t size)
+{
+    return size >= sizeof(mapped_file_header) and
+           std::equal(mapped_file_magic.begin(), mapped_file_magic.end(), buffer);
+}
+
+static bool is_mapped_file(const std::string& filename)
+{
+    std::array<char, sizeof(mapped_file_header)> buffer{};
+    std::ifstream is(filename, std::ios::binary);
+    is.read(buffer.data(), buffer.size());
+    return is_mapped_file(buffer.data(), is.gcount());
+}
+
+static void check_key(const value& v, const std::string& key)
+{
+    if(key.empty())
+        return;
+    if(not v.contains("key") or v.at("key").to<std::string>() != key)
+        MIGRAPHX_THROW("The file was not saved with the key: " + key);
+}
+
+// Create the literals from the buffer using get_data, which is passed the offset and shape of
+// the literal
+template <class F>
+static program
+load_mapped(const char* buffer, std::size_t size, const std::string& key, F get_data)
+{
+    mapped_file_header header;
+    std::memcpy(&header, buffer, sizeof(header));
+    if(header.program_offset > size or header.program_size > size - header.program_offset)
+        MIGRAPHX_THROW("Invalid program offset in file with mapped literals");
+    auto pv = from_msgpack(buffer + header.program_offset, header.program_size);
+    check_key(pv, key);
+    program p;
+    p.from_value(pv, [&](const value& v) {
+        if(not v.contains("offset"))
+            return migraphx::from_value<literal>(v);
+        auto s      = migraphx::from_value<shape>(v.at("shape"));
+        auto offset = v.at("offset").to<std::size_t>();
+        if(offset > header.program_offset or s.bytes() > header.program_offset - offset)
+            MIGRAPHX_THROW("Invalid literal offset in file with mapped literals");
+        return get_data(offset, s);
+    });
+    return p;
+}
+
 program load(const std::string& filename, const file_options& options)
 {
+    if(is_mapped_file(filename))
+    {
+        auto size   = fs::file_size(filename);
+        auto buffer = map_buffer(filename);
+        return load_mapped(buffer.get(),
+                           size,
+                           options.key,
+                           [&](std::size_t offset, const shape& s) {
+                               // Share the ownership of the mapping with the literal
+                               return literal{s,
+                                              std::shared_ptr<char>(buffer, buffer.get() + offset)};
+                           });
+    }
     return load_buffer(read_buffer(filename), options);
 }
 program load_buffer(const std::vector<char>& buffer, const file_options& options)
@@ -41,27 +117,32 @@ program load_buffer(const std::vector<char>& buffer, const file_options& options
 }
 program load_buffer(const char* buffer, std::size_t size, const file_options& options)
 {
-    program p;
+    if(is_mapped_file(buffer, size))
+    {
+        // The buffer is not owned by the program so the literals are copied
+        return load_mapped(buffer, size, options.key, [&](std::size_t offset, const shape& s) {
+            return literal{s, buffer + offset};
+        });
+    }
+    value v;
     if(options.format == "msgpack")
     {
-        p.from_value(from_msgpack(buffer, size));
+        v = from_msgpack(buffer, size);
     }
     else if(options.format == "json")
     {
-        p.from_value(from_json_string(buffer, size));
+        v = from_json_string(buffer, size);
     }
     else
     {
         MIGRAPHX_THROW("Unknown format: " + options.format);
     }
+    check_key(v, options.key);
+    program p;
+    p.from_value(v);
     return p;
 }
 
-void save(const program& p, const std::string& filename, const file_options& options)
-{
-    write_buffer(filename, save_buffer(p, options));
-}
-
 // MIOpen doesn't support serializing fusion plans with Find-2.0 APIs
 void print_miopen_warning(const program& p)
 {
@@ -80,9 +161,76 @@ void print_miopen_warning(const program& p)
     }
 }
 
+// Write the literals into the stream at page aligned offsets, and replace their data with the
+// offset in the serialized program
+static void write_mapped_literals(std::ostream& os, value& v, std::size_t& pos)
+{
+    const std::array<char, mapped_literal_alignment> padding{};
+    for(auto& mod : v.at("modules"))
+    {
+        for(auto& node : mod.at("nodes"))
+        {
+            if(not node.contains("literal") or not node.at("literal").contains("data"))
+                continue;
+            auto& lit         = node.at("literal");
+            const auto& data  = lit.at("data").get_binary();
+            std::size_t extra = (mapped_literal_alignment - pos % mapped_literal_alignment) %
+                                mapped_literal_alignment;
+            os.write(padding.data(), extra);
+            pos += extra;
+            os.write(reinterpret_cast<const char*>(data.data()), data.size());
+            value result;
+            result["shape"]  = lit.at("shape");
+            result["offset"] = pos;
+            pos += data.size();
+            lit = result;
+        }
+    }
+}
+
+static void save_mapped(const program& p, std::ostream& os, const std::string& key)
+{
+    value v = p.to_value();
+    if(not key.empty())
+        v["key"] = key;
+    print_miopen_warning(p);
+    mapped_file_header header;
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    std::size_t pos = sizeof(header);
+    write_mapped_literals(os, v, pos);
+    auto buffer           = to_msgpack(v);
+    header.program_offset = pos;
+    header.program_size   = buffer.size();
+    os.write(buffer.data(), buffer.size());
+    os.seekp(0);
+    os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+}
+
+void save(const program& p, const std::string& filename, const file_options& options)
+{
+    if(options.mapped_literals and options.format == "msgpack")
+    {
+        std::ofstream os(filename, std::ios::out | std::ios::binary);
+        save_mapped(p, os, options.key);
+        if(not os)
+            MIGRAPHX_THROW("Error writing file: " + filename);
+        return;
+    }
+    write_buffer(filename, save_buffer(p, options));
+}
+
 std::vector<char> save_buffer(const program& p, const file_options& options)
 {
+    if(options.mapped_literals and options.format == "msgpack")
+    {
+        std::ostringstream os;
+        save_mapped(p, os, options.key);
+        auto s = os.str();
+        return {s.begin(), s.end()};
+    }
     value v = p.to_value();
+    if(not options.key.empty())
+        v["key"] = options.key;
     print_miopen_warning(p);
     std::vector<char> buffer;
     if(options.format == "msgpack")
@@ -0,0 +1,135 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/matcher.hpp>
+#include <migraphx/time.hpp>
+#include <algorithm>
+#include <iostream>
+#include <numeric>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace match {
+
+// Stop rules that keep undoing each other
+static const std::size_t max_rounds = 128;
+
+namespace {
+struct track_changes
+{
+    module* m;
+    track_changes(module& mod, std::unordered_set<instruction_ref>& changed) : m(&mod)
+    {
+        m->track_changes(&changed);
+    }
+    track_changes(const track_changes&)            = delete;
+    track_changes& operator=(const track_changes&) = delete;
+    ~track_changes() { m->track_changes(nullptr); }
+};
+} // namespace
+
+void rewrite_driver::run(module& m,
+                         const std::function<void()>& finish,
+                         source_location location) const
+{
+    using milliseconds = std::chrono::duration<double, std::milli>;
+    const bool timed   = enabled(MIGRAPHX_TIME_PASSES{});
+    std::vector<std::size_t> hits(rules.size());
+    std::vector<double> times(rules.size());
+
+    std::unordered_map<std::string, std::vector<std::size_t>> index;
+    auto rules_for = [&](const std::string& name) -> const std::vector<std::size_t>& {
+        auto it = index.find(name);
+        if(it != index.end())
+            return it->second;
+        std::vector<std::size_t> r;
+        for(std::size_t i = 0; i < rules.size(); i++)
+        {
+            if(rules[i].roots == nullptr or contains(*rules[i].roots, name))
+                r.push_back(i);
+        }
+        return index.emplace(name, std::move(r)).first->second;
+    };
+    auto visit = [&](instruction_ref ins) {
+        for(auto i : rules_for(ins->name()))
+        {
+            bool matched = false;
+            if(timed)
+                times[i] += time<milliseconds>([&] { matched = rules[i].apply(ins); });
+            else
+                matched = rules[i].apply(ins);
+            if(matched)
+            {
+                hits[i]++;
+                return;
+            }
+        }
+    };
+
+    std::unordered_set<instruction_ref> changed;
+    std::unordered_set<instruction_ref> worklist;
+    track_changes tracking{m, changed};
+    bool full_round    = true;
+    std::size_t rounds = 0;
+    while(rounds < max_rounds)
+    {
+        rounds++;
+        worklist.clear();
+        if(not full_round)
+        {
+            worklist = changed;
+            for(auto ins : changed)
+                worklist.insert(ins->outputs().begin(), ins->outputs().end());
+        }
+        changed.clear();
+        for(auto ins : iterator_for(m))
+        {
+            if(full_round or contains(worklist, ins))
+                visit(ins);
+        }
+        finish();
+        if(not changed.empty())
+            full_round = false;
+        else if(full_round)
+            break;
+        else
+            full_round = true;
+    }
+
+    if(timed)
+    {
+        std::vector<std::size_t> order(rules.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](auto x, auto y) { return times[x] > times[y]; });
+        std::cout << location.function_name() << ": " << rounds << " rounds\n";
+        for(auto i : order)
+        {
+            std::cout << "    " << rules[i].name << ": " << hits[i] << " matches, " << times[i]
+                      << "ms\n";
+        }
+    }
+}
+
+} // namespace match
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
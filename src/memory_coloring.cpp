@@ -33,6 +33,9 @@
 #include <migraphx/stringutils.hpp>
 #include <unordered_set>
 #include <unordered_map>
+#include <cstdint>
+#include <limits>
+#include <numeric>
 #include <map>
 #include <set>
 
@@ -40,6 +43,8 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
 MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_DEBUG_MEMORY_COLORING);
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_MEMORY_PLANNER);
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_MEMORY_PLANNER);
 
 using instruction_set     = std::unordered_set<instruction_ref>;
 using instruction_set_map = std::unordered_map<instruction_ref, instruction_set>;
@@ -297,11 +302,19 @@ static std::size_t find_max_alignment(const module& m, const std::string& alloca
     return alignment;
 }
 
-void memory_coloring::apply(module& m) const
+using offset_map = std::unordered_map<instruction_ref, std::size_t>;
+
+static std::size_t allocation_units(instruction_ref ins, std::size_t alignment)
 {
-    const std::size_t alignment = find_max_alignment(m, allocation_op);
-    auto conflict_table         = build_conflict_table(m, allocation_op);
-    auto as                     = allocation_segment::build(m, conflict_table, alignment);
+    return 1 + (ins->get_shape().bytes() - 1) / alignment;
+}
+
+// Assign the offsets, in units of the alignment, with the conflict table
+static offset_map
+plan_coloring(const module& m, const std::string& allocation_op, std::size_t alignment)
+{
+    auto conflict_table = build_conflict_table(m, allocation_op);
+    auto as             = allocation_segment::build(m, conflict_table, alignment);
 
     // All allocations should have a segment
     assert(std::all_of(conflict_table.begin(), conflict_table.end(), [&](auto&& pp) {
@@ -336,16 +349,219 @@ void memory_coloring::apply(module& m) const
         }
     }
 
+    offset_map result;
+    for(auto&& [ins, seg] : as.ins2segment)
+        result[ins] = seg.first;
+    return result;
+}
+
+struct allocation_interval
+{
+    instruction_ref ins;
+    std::size_t start  = 0;
+    std::size_t end    = 0;
+    std::size_t size   = 0;
+    std::size_t offset = 0;
+
+    bool overlaps(const allocation_interval& x) const { return start <= x.end and x.start <= end; }
+};
+
+// Compute the live interval of each allocation in a single pass over the module. An allocation is
+// live from where it is allocated until the last use of it or of any instruction that aliases it.
+static std::vector<allocation_interval>
+build_live_intervals(const module& m, const std::string& allocation_op, std::size_t alignment)
+{
+    auto implicit_deps = m.calc_implicit_deps();
+    std::vector<allocation_interval> intervals;
+    std::unordered_map<instruction_ref, std::size_t> index;
+    std::size_t i = 0;
+    for(auto ins : iterator_for(m))
+    {
+        auto update_end = [&](const auto& inputs) {
+            for(auto input : inputs)
+            {
+                auto it = index.find(instruction::get_output_alias(input));
+                if(it == index.end())
+                    continue;
+                intervals[it->second].end = i;
+            }
+        };
+        update_end(ins->inputs());
+        update_end(implicit_deps[ins]);
+        if(ins->name() == allocation_op and ins->get_shape().bytes() > 0)
+        {
+            index[ins] = intervals.size();
+            intervals.push_back({ins, i, i, allocation_units(ins, alignment)});
+        }
+        i++;
+    }
+    return intervals;
+}
+
+// The peak total size of the allocations that are live at the same time. No assignment of offsets
+// can use less memory than this.
+static std::size_t live_lower_bound(const std::vector<allocation_interval>& intervals)
+{
+    std::vector<std::pair<std::size_t, std::int64_t>> events;
+    for(const auto& x : intervals)
+    {
+        events.emplace_back(x.start, x.size);
+        events.emplace_back(x.end + 1, -std::int64_t(x.size));
+    }
+    // Intervals ending before a position are removed before the ones starting there are added
+    std::sort(events.begin(), events.end());
+    std::int64_t live = 0;
+    std::int64_t peak = 0;
+    for(auto&& [pos, size] : events)
+    {
+        live += size;
+        peak = std::max(peak, live);
+    }
+    return peak;
+}
+
+// Place each allocation, in the given order, into the smallest gap between the already placed
+// allocations whose live intervals overlap with it, or after all of them if there is no such gap.
+// The placed allocations are ordered by the end of their live interval so the ones that ended
+// before the allocation starts are skipped. When the allocations are placed in the order they
+// start, those can never overlap again and they are removed.
+static void place_best_fit(std::vector<allocation_interval>& intervals,
+                           const std::vector<std::size_t>& order)
+{
+    const bool sweep = std::is_sorted(order.begin(), order.end(), by(std::less<>{}, [&](auto i) {
+                                          return intervals[i].start;
+                                      }));
+    std::multimap<std::size_t, std::size_t> placed;
+    std::vector<std::size_t> live;
+    for(auto i : order)
+    {
+        auto& x    = intervals[i];
+        auto first = placed.lower_bound(x.start);
+        if(sweep)
+            first = placed.erase(placed.begin(), first);
+        live.clear();
+        std::for_each(first, placed.end(), [&](const auto& p) {
+            if(intervals[p.second].start <= x.end)
+                live.push_back(p.second);
+        });
+        std::sort(live.begin(), live.end(), by(std::less<>{}, [&](auto j) {
+                      return intervals[j].offset;
+                  }));
+        std::size_t best_gap = std::numeric_limits<std::size_t>::max();
+        std::size_t offset   = 0;
+        std::size_t end      = 0;
+        for(auto j : live)
+        {
+            const auto& y = intervals[j];
+            if(y.offset >= end + x.size and y.offset - end < best_gap)
+            {
+                best_gap = y.offset - end;
+                offset   = end;
+            }
+            end = std::max(end, y.offset + y.size);
+        }
+        x.offset = (best_gap == std::numeric_limits<std::size_t>::max()) ? end : offset;
+        placed.emplace(x.end, i);
+    }
+}
+
+// Assign the offsets, in units of the alignment, with the live intervals
+static offset_map plan_intervals(const module& m,
+                                 const std::string& allocation_op,
+                                 std::size_t alignment,
+                                 const std::string& planner)
+{
+    auto intervals = build_live_intervals(m, allocation_op, alignment);
+    std::vector<std::size_t> order(intervals.size());
+    std::iota(order.begin(), order.end(), 0);
+    if(planner == "greedy_by_size")
+    {
+        std::stable_sort(order.begin(), order.end(), by(std::greater<>{}, [&](auto i) {
+                             return intervals[i].size;
+                         }));
+    }
+    place_best_fit(intervals, order);
+
+    // Overlapping intervals should not have overlapping offsets
+    assert(std::none_of(intervals.begin(), intervals.end(), [&](const auto& x) {
+        return std::any_of(intervals.begin(), intervals.end(), [&](const auto& y) {
+            return &x != &y and x.overlaps(y) and
+                   is_overlap({x.offset, x.offset + x.size}, {y.offset, y.offset + y.size});
+        });
+    }));
+
+    offset_map result;
+    for(const auto& x : intervals)
+        result[x.ins] = x.offset;
+    return result;
+}
+
+// Move each allocation right before its first use, so it is not live before it is needed
+static void sink_allocations(module& m, const std::string& allocation_op)
+{
+    std::unordered_map<instruction_ref, std::size_t> position;
+    std::vector<instruction_ref> allocations;
+    std::size_t i = 0;
+    for(auto ins : iterator_for(m))
+    {
+        position[ins] = i++;
+        if(ins->name() == allocation_op and ins->inputs().empty())
+            allocations.push_back(ins);
+    }
+    for(auto ins : allocations)
+    {
+        const auto& outputs = ins->outputs();
+        if(outputs.empty() or std::any_of(outputs.begin(), outputs.end(), [&](auto out) {
+               return not contains(position, out);
+           }))
+            continue;
+        auto first = *std::min_element(
+            outputs.begin(), outputs.end(), by(std::less<>{}, [&](auto out) {
+                return position.at(out);
+            }));
+        m.move_instruction(ins, first);
+    }
+}
+
+void memory_coloring::apply(module& m) const
+{
+    const auto strategy = string_value_of(MIGRAPHX_MEMORY_PLANNER::value(), planner);
+    if(reorder)
+        sink_allocations(m, allocation_op);
+
+    const std::size_t alignment = find_max_alignment(m, allocation_op);
+    offset_map offsets;
+    if(strategy == "coloring")
+        offsets = plan_coloring(m, allocation_op, alignment);
+    else if(contains({"greedy_by_size", "best_fit"}, strategy))
+        offsets = plan_intervals(m, allocation_op, alignment, strategy);
+    else
+        MIGRAPHX_THROW("Unknown memory planner: " + strategy);
+
     // Total memory
-    std::size_t n = as.max() * alignment;
+    std::size_t n = 0;
+    for(auto&& [ins, offset] : offsets)
+        n = std::max(n, offset + allocation_units(ins, alignment));
+    n *= alignment;
+
+    if(enabled(MIGRAPHX_TRACE_MEMORY_PLANNER{}))
+    {
+        auto intervals = build_live_intervals(m, allocation_op, alignment);
+        auto bound     = live_lower_bound(intervals) * alignment;
+        std::cout << "memory_coloring[" << strategy << "]: scratch = " << n
+                  << " bytes, lower bound = " << bound << " bytes";
+        if(bound > 0)
+            std::cout << " (" << (100.0 * n) / bound << "%)";
+        std::cout << std::endl;
+    }
 
     // Replace allocations
     auto mem = m.add_parameter("scratch", shape{shape::int8_type, {n}});
-    for(auto&& [ins, seg] : as.ins2segment)
+    for(auto&& [ins, unit] : offsets)
     {
         assert(ins->name() == allocation_op);
         auto s             = ins->get_shape();
-        std::size_t offset = seg.first * alignment;
+        std::size_t offset = unit * alignment;
         assert(offset < n);
         m.replace_instruction(
             ins, make_op("load", {{"shape", to_value(s)}, {"offset", offset}}), mem);
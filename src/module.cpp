@@ -28,6 +28,8 @@
 #include <migraphx/instruction.hpp>
 #include <migraphx/target.hpp>
 #include <migraphx/env.hpp>
+#include <migraphx/functional.hpp>
+#include <migraphx/hash.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/time.hpp>
 #include <migraphx/iterator_for.hpp>
@@ -58,6 +60,23 @@ struct module_impl
     std::string name;
     uint32_t nparams = 0;
     bool bypass      = false;
+    // Incremented on every change to the instructions
+    std::size_t version = 0;
+    // Collects the instructions affected by the changes while it is set
+    std::unordered_set<instruction_ref>* changed = nullptr;
+
+    void mark_changed(instruction_ref ins)
+    {
+        if(changed != nullptr)
+            changed->insert(ins);
+    }
+
+    template <class Range>
+    void mark_changed(const Range& r)
+    {
+        if(changed != nullptr)
+            changed->insert(r.begin(), r.end());
+    }
 
     bool contains(instruction_ref ins) const
     {
@@ -72,6 +91,9 @@ struct module_impl
         // cppcheck-suppress redundantInitialization
         auto r = instructions.emplace(pos, std::forward<Ts>(xs)...);
         instruction_set.insert(std::addressof(*r));
+        version++;
+        mark_changed(r);
+        mark_changed(r->inputs());
         return r;
     }
     instruction_ref insert(instruction_ref pos, const instruction& ins)
@@ -84,6 +106,7 @@ struct module_impl
         instructions.clear();
         instruction_set.clear();
         nparams = 0;
+        version++;
     }
 
     void push_front(const instruction& ins) { insert(instructions.begin(), ins); }
@@ -105,12 +128,21 @@ struct module_impl
     instruction_ref erase(instruction_ref pos)
     {
         instruction_set.erase(std::addressof(*pos));
+        if(changed != nullptr)
+            changed->erase(pos);
+        version++;
         return instructions.erase(pos);
     }
 
     instruction_ref erase(instruction_ref start, instruction_ref last)
     {
         std::for_each(start, last, [&](auto& ins) { instruction_set.erase(std::addressof(ins)); });
+        if(changed != nullptr)
+        {
+            for(auto ins = start; ins != last; ++ins)
+                changed->erase(ins);
+        }
+        version++;
         return instructions.erase(start, last);
     }
 };
@@ -142,12 +174,20 @@ void module::set_name(const std::string& name) { impl->name = name; }
 bool module::bypass() const { return impl->bypass; }
 void module::set_bypass(bool b) { impl->bypass = b; }
 
+std::size_t module::version() const { return impl->version; }
+
+void module::track_changes(std::unordered_set<instruction_ref>* changed)
+{
+    impl->changed = changed;
+}
+
 void module::assign(const module& m)
 {
     // copy the impl
     if(not impl)
         impl = std::make_unique<module_impl>();
-    *impl = *m.impl;
+    *impl         = *m.impl;
+    impl->changed = nullptr;
 
     // clear instructions
     if(not impl->instructions.empty())
@@ -323,7 +363,12 @@ instruction_ref module::replace_instruction(instruction_ref ins,
     assert(not starts_with(op.name(), "@"));
 
     shape r = compute_shape(op, args);
+    impl->mark_changed(ins->inputs());
     instruction::replace(ins, op, r, std::move(args));
+    impl->version++;
+    impl->mark_changed(ins);
+    impl->mark_changed(ins->inputs());
+    impl->mark_changed(ins->outputs());
     assert(ins->valid(begin()));
     return ins;
 }
@@ -336,7 +381,12 @@ instruction_ref module::replace_instruction(instruction_ref ins,
     assert(has_instruction(ins));
     assert(not starts_with(op.name(), "@"));
     auto out_shape = compute_shape(op, args, module_args);
+    impl->mark_changed(ins->inputs());
     instruction::replace(ins, op, out_shape, std::move(args), std::move(module_args));
+    impl->version++;
+    impl->mark_changed(ins);
+    impl->mark_changed(ins->inputs());
+    impl->mark_changed(ins->outputs());
     assert(ins->valid(begin()));
     return ins;
 }
@@ -359,8 +409,12 @@ instruction_ref module::replace_instruction(instruction_ref ins, instruction_ref
     {
         return rep;
     }
+    impl->version++;
     // Make a copy of outputs which can be changed when calling replace_argument
     auto outputs = ins->outputs();
+    impl->mark_changed(ins);
+    impl->mark_changed(rep);
+    impl->mark_changed(outputs);
     for(auto out : outputs)
     {
         // TODO: Check for possible cycles
@@ -385,6 +439,7 @@ instruction_ref module::remove_instruction(instruction_ref ins)
 {
     assert(has_instruction(ins));
     assert(ins->outputs().empty());
+    impl->mark_changed(ins->inputs());
     ins->clear_arguments();
     return impl->erase(ins);
 }
@@ -395,6 +450,8 @@ instruction_ref module::remove_instructions(instruction_ref first, instruction_r
         return first;
     // TODO: Check every element
     assert(has_instruction(first));
+    for(auto ins = first; ins != last; ++ins)
+        impl->mark_changed(ins->inputs());
     std::for_each(first, last, [&](instruction& ins) { ins.clear_arguments(); });
     assert(std::all_of(first, last, [&](const instruction& ins) { return ins.outputs().empty(); }));
     return impl->erase(first, last);
@@ -405,6 +462,8 @@ instruction_ref module::move_instruction(instruction_ref src, instruction_ref ds
     assert(has_instruction(src));
     assert(has_instruction(dst) or is_end(dst, this->end()));
     impl->instructions.splice(dst, impl->instructions, src);
+    impl->version++;
+    impl->mark_changed(src);
     return src;
 }
 
@@ -535,7 +594,10 @@ instruction_ref module::replace_return(std::vector<instruction_ref> args)
         return this->add_return(args);
 
     shape r = compute_shape(last->get_operator(), args);
+    impl->mark_changed(last->inputs());
     instruction::replace(last, last->get_operator(), r, std::move(args));
+    impl->version++;
+    impl->mark_changed(last->inputs());
     assert(last->valid(begin()));
 
     return last;
@@ -618,6 +680,7 @@ void module::rename_parameter(instruction_ref ins, const std::string& name)
     *ins         = instruction{op, ins->get_shape(), {}};
     for(auto output : outputs)
         ins->add_output(output);
+    impl->version++;
 }
 
 std::unordered_map<std::string, shape> module::get_parameter_shapes() const
@@ -1401,7 +1464,97 @@ ins_dep_map module::calc_implicit_deps() const
     return mod_implicit_deps;
 }
 
-bool operator==(const module& x, const module& y) { return to_string(x) == to_string(y); }
+std::size_t module::hash() const
+{
+    std::unordered_map<instruction_ref, std::size_t> ids;
+    return this->hash(ids);
+}
+
+std::size_t module::hash(std::unordered_map<instruction_ref, std::size_t>& ids) const
+{
+    std::size_t h = hash_value(this->name());
+    for(auto ins : iterator_for(*this))
+    {
+        hash_combine(h, ins->hash());
+        hash_combine(h, ins->get_target_id());
+        for(const auto* mod : ins->module_inputs())
+            hash_combine(h, mod->name());
+        for(auto input : ins->inputs())
+        {
+            // Inputs from modules that have not been hashed use zero
+            auto it = ids.find(input);
+            hash_combine(h, it == ids.end() ? 0 : it->second);
+        }
+        ids.emplace(ins, ids.size() + 1);
+    }
+    return h;
+}
+
+// The printed name of a module only appears as a prefix of its instructions
+static std::string print_prefix(const module& m)
+{
+    if(m.name() == "main")
+        return "";
+    return m.name();
+}
+
+template <class T>
+static bool equal_printed(const T& x, const T& y)
+{
+    return x == y or to_string(x) == to_string(y);
+}
+
+// Compares the same as the printed form of the modules, but avoids building
+// the strings. Instructions are matched by position, which map_ins records in
+// both directions so inputs from other modules can be compared as well.
+bool module::equal(const module& m,
+                   std::unordered_map<instruction_ref, instruction_ref>& map_ins) const
+{
+    if(this->size() != m.size())
+        return false;
+    if(this->size() > 0 and print_prefix(*this) != print_prefix(m))
+        return false;
+    auto y = m.begin();
+    for(auto x : iterator_for(*this))
+    {
+        if(x->get_target_id() != y->get_target_id())
+            return false;
+        if(not equal_printed(x->get_operator(), y->get_operator()))
+            return false;
+        if(x->name() != "@return" and not equal_printed(x->get_shape(), y->get_shape()))
+            return false;
+        if(x->name() == "@literal" and x->get_literal().get_shape().elements() <= 10 and
+           not equal_printed(x->get_literal(), y->get_literal()))
+            return false;
+        if(not std::equal(x->inputs().begin(),
+                          x->inputs().end(),
+                          y->inputs().begin(),
+                          y->inputs().end(),
+                          [&](auto xi, auto yi) {
+                              auto it = map_ins.find(xi);
+                              if(it == map_ins.end())
+                                  return not contains(map_ins, yi);
+                              return it->second == yi;
+                          }))
+            return false;
+        if(not std::equal(x->module_inputs().begin(),
+                          x->module_inputs().end(),
+                          y->module_inputs().begin(),
+                          y->module_inputs().end(),
+                          by(std::equal_to<>{}, [](const auto* mod) { return mod->name(); })))
+            return false;
+        map_ins[x] = y;
+        map_ins[y] = x;
+        y++;
+    }
+    return true;
+}
+
+bool operator==(const module& x, const module& y)
+{
+    std::unordered_map<instruction_ref, instruction_ref> map_ins;
+    return x.equal(y, map_ins);
+}
 
 std::ostream& operator<<(std::ostream& os, const module& m)
 {
@@ -32,6 +32,7 @@
 #include <onnx.pb.h>
 #include <unordered_map>
 #include <functional>
+#include <memory>
 #include <utility>
 #include <vector>
 
@@ -89,6 +90,17 @@ struct onnx_parser
             return add_literal(literal{std::forward<Ts>(xs)...});
         }
     };
+    struct mapped_file
+    {
+        std::shared_ptr<char> data = nullptr;
+        std::size_t size           = 0;
+    };
+    struct parse_times
+    {
+        double read_model   = 0;
+        double initializers = 0;
+        double graph        = 0;
+    };
     using node_map = std::unordered_map<std::string, onnx::NodeProto>;
     using op_func  = std::function<std::vector<instruction_ref>(
         onnx_parser&, const node_info&, std::vector<instruction_ref>)>;
@@ -104,6 +116,10 @@ struct onnx_parser
     int64_t max_loop_iterations  = 10;
     int64_t limit_max_iterations = std::numeric_limits<uint16_t>::max();
     int64_t opset_version        = 13;
+    // External data files referenced by the tensors of a graph, mapped once per file
+    std::unordered_map<std::string, mapped_file> external_data;
+    // Time in milliseconds spent in each phase of the last parse
+    parse_times times;
 
     std::unordered_map<std::string, op_func> ops;
 
@@ -119,6 +135,8 @@ struct onnx_parser
     std::vector<instruction_ref>
     parse_graph(module* mod, const onnx::GraphProto& graph, bool inlining = false);
     literal parse_value(const onnx::AttributeProto& attr) const;
+    void map_external_data(const onnx::GraphProto& graph);
+    mapped_file get_external_data(const std::string& location) const;
     literal parse_tensor(const onnx::TensorProto& t) const;
     shape parse_type(const onnx::TypeProto& t) const;
     shape parse_type(const onnx::TypeProto& t, const std::vector<std::size_t>& input_dims) const;
@@ -89,6 +89,13 @@ program parse_onnx_from(const onnx_options& options, Ts&&... xs)
         parser.parse_from(std::forward<Ts>(xs)...);
     }
 
+    if(options.print_parse_time)
+    {
+        std::cout << "Read model: " << parser.times.read_model << "ms" << std::endl;
+        std::cout << "Parse initializers: " << parser.times.initializers << "ms" << std::endl;
+        std::cout << "Parse graph: " << parser.times.graph << "ms" << std::endl;
+    }
+
     return std::move(parser.prog);
 }
 
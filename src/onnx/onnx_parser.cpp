@@ -35,7 +35,10 @@
 #include <migraphx/filesystem.hpp>
 #include <migraphx/op/unknown.hpp>
 #include <migraphx/float8.hpp>
+#include <migraphx/bit_cast.hpp>
 #include <migraphx/env.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/time.hpp>
 #include <onnx.pb.h>
 
 namespace migraphx {
@@ -44,6 +47,8 @@ namespace onnx {
 
 MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_ONNX_PARSER)
 
+using milliseconds = std::chrono::duration<double, std::milli>;
+
 static shape shape_from_dyn_dims(shape::type_t shape_type,
                                  const std::vector<shape::dynamic_dimension>& dyn_dims)
 {
@@ -249,14 +254,18 @@ void onnx_parser::parse_from(std::istream& is, std::string name)
         this->path = parent_path.string();
 
     onnx::ModelProto model;
+    timer t{};
     if(model.ParseFromIstream(&is))
     {
-        auto version  = get_opset_version(model);
-        opset_version = (version == -1) ? opset_version : version;
+        times.read_model = t.record<milliseconds>();
+        auto version     = get_opset_version(model);
+        opset_version    = (version == -1) ? opset_version : version;
 
         if(model.has_graph())
         {
+            timer graph_timer{};
             (void)this->parse_graph(mm, model.graph());
+            times.graph = graph_timer.record<milliseconds>() - times.initializers;
         }
     }
     else
@@ -269,14 +278,18 @@ void onnx_parser::parse_from(const void* data, std::size_t size)
 {
     auto* mm = prog.get_main_module();
     onnx::ModelProto model;
+    timer t{};
     if(model.ParseFromArray(data, size))
     {
-        auto version  = get_opset_version(model);
-        opset_version = (version == -1) ? opset_version : version;
+        times.read_model = t.record<milliseconds>();
+        auto version     = get_opset_version(model);
+        opset_version    = (version == -1) ? opset_version : version;
 
         if(model.has_graph())
         {
+            timer graph_timer{};
             (void)this->parse_graph(mm, model.graph());
+            times.graph = graph_timer.record<milliseconds>() - times.initializers;
         }
     }
     else
@@ -321,18 +334,27 @@ void print_added_instructions(module* mod,
 }
 
 std::unordered_map<std::string, instruction_ref>
-parse_intializer(const onnx_parser& parser, module* mod, const onnx::GraphProto& graph)
+parse_intializer(onnx_parser& parser, module* mod, const onnx::GraphProto& graph)
 {
+    timer t{};
+    parser.map_external_data(graph);
+    // Decode the initializers in parallel, but add them to the module in order
+    std::vector<literal> literals(graph.initializer_size());
+    par_for(literals.size(), 1, [&](auto i) {
+        literals[i] = parser.parse_tensor(graph.initializer(static_cast<int>(i)));
+    });
     std::unordered_map<std::string, instruction_ref> mod_insts;
-    for(auto&& f : graph.initializer())
+    for(std::size_t i = 0; i < literals.size(); i++)
     {
+        const auto& f = graph.initializer(static_cast<int>(i));
         if(enabled(MIGRAPHX_TRACE_ONNX_PARSER{}))
             std::cout << "initializer: " << f.name() << std::endl;
         // backup instructions in parent mod
-        mod_insts[f.name()] = mod->add_literal(parser.parse_tensor(f));
+        mod_insts[f.name()] = mod->add_literal(std::move(literals[i]));
         if(enabled(MIGRAPHX_TRACE_ONNX_PARSER{}))
             mod->debug_print(mod_insts[f.name()]);
     }
+    parser.times.initializers += t.record<milliseconds>();
     return mod_insts;
 }
 
@@ -493,30 +515,72 @@ literal onnx_parser::parse_value(const onnx::AttributeProto& attr) const
     MIGRAPHX_THROW("PARSE_VALUE: Invalid attribute type " + std::to_string(attr.type()));
 }
 
+void onnx_parser::map_external_data(const onnx::GraphProto& graph)
+{
+    auto map_tensor = [&](const onnx::TensorProto& t) {
+        if(t.external_data().empty())
+            return;
+        const std::string& location = t.external_data().at(0).value();
+        if(contains(external_data, location))
+            return;
+        external_data[location] = get_external_data(location);
+    };
+    for(auto&& t : graph.initializer())
+        map_tensor(t);
+    // Tensors in the attributes of the nodes, such as constant nodes, can also be external. The
+    // nodes of subgraphs are mapped when the initializers of the subgraph are parsed.
+    for(auto&& node : graph.node())
+    {
+        for(auto&& attr : node.attribute())
+        {
+            if(attr.has_t())
+                map_tensor(attr.t());
+            for(auto&& t : attr.tensors())
+                map_tensor(t);
+        }
+    }
+}
+
+onnx_parser::mapped_file onnx_parser::get_external_data(const std::string& location) const
+{
+    auto it = external_data.find(location);
+    if(it != external_data.end())
+        return it->second;
+    auto filename = path / location;
+    return {map_buffer(filename), fs::file_size(filename)};
+}
+
 literal onnx_parser::parse_tensor(const onnx::TensorProto& t) const
 {
     std::vector<std::size_t> dims(t.dims().begin(), t.dims().end());
     auto type = get_type(t.data_type());
     shape tensor_shape(type, dims);
-    auto external_data = t.external_data();
-    if(not external_data.empty())
+    const auto& data_fields = t.external_data();
+    if(not data_fields.empty())
     {
-        const std::string& data_file = external_data.at(0).value();
-        size_t num_data_fields       = external_data.size();
+        const std::string& data_file = data_fields.at(0).value();
+        size_t num_data_fields       = data_fields.size();
         size_t offset                = 0;
         size_t nbytes                = tensor_shape.bytes();
 
         if(num_data_fields > 1) // if offset field is present
         {
-            offset = std::stoul(t.external_data().at(1).value());
+            offset = std::stoul(data_fields.at(1).value());
         }
         if(num_data_fields > 2) // if nbytes field is present
         {
-            nbytes = std::stoul(t.external_data().at(2).value());
+            nbytes = std::stoul(data_fields.at(2).value());
         }
-        auto raw_buffer = read_buffer(path / data_file, offset, nbytes);
-        std::string s(raw_buffer.begin(), raw_buffer.end());
-        return create_literal(type, dims, s.data());
+        auto file = get_external_data(data_file);
+        if(offset > file.size or nbytes > file.size - offset or nbytes < tensor_shape.bytes())
+            MIGRAPHX_THROW("PARSE_TENSOR: Invalid external data for tensor: " + t.name());
+        // Borrow the data from the mapping when it is aligned for the type
+        if(tensor_shape.elements() > 0 and offset % tensor_shape.type_size() == 0)
+        {
+            shape s = dims.empty() ? shape{type} : tensor_shape;
+            return literal{s, std::shared_ptr<char>(file.data, file.data.get() + offset)};
+        }
+        return create_literal(type, dims, file.data.get() + offset);
     }
     if(t.has_raw_data())
     {
@@ -538,12 +602,13 @@ literal onnx_parser::parse_tensor(const onnx::TensorProto& t) const
     case onnx::TensorProto::UINT64:
         return create_literal(shape::uint64_type, dims, t.uint64_data());
     case onnx::TensorProto::FLOAT16: {
-        std::vector<uint16_t> data_uint16(t.int32_data().begin(), t.int32_data().end());
-        std::vector<half> data_half;
-        std::transform(data_uint16.begin(),
-                       data_uint16.end(),
-                       std::back_inserter(data_half),
-                       [](uint16_t raw_val) { return *reinterpret_cast<half*>(&raw_val); });
+        std::vector<half> data_half(t.int32_data().size());
+        std::transform(t.int32_data().begin(),
+                       t.int32_data().end(),
+                       data_half.begin(),
+                       [](int32_t raw_val) {
+                           return bit_cast<half>(static_cast<uint16_t>(raw_val));
+                       });
         return create_literal(shape::half_type, dims, data_half);
     }
     case onnx::TensorProto::DOUBLE:
@@ -0,0 +1,418 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/partition_targets.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/target.hpp>
+#include <algorithm>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+static bool is_builtin(instruction_ref ins) { return starts_with(ins->name(), "@"); }
+
+static std::size_t get_bytes(const shape& s) { return s.dynamic() ? 0 : s.bytes(); }
+
+struct target_cost_model
+{
+    const_module_ref mod               = nullptr;
+    const std::vector<target>* targets = nullptr;
+    assignment_options options;
+    // The cost of each instruction on the targets that support it
+    std::vector<std::unordered_map<instruction_ref, float>> costs = {};
+    // The cost to copy a byte to or from each target. The host is the last target, and holds
+    // the parameters, the results, and the instructions that no target supports.
+    std::vector<float> copy_costs = {};
+    // The targets that support each builtin instruction
+    std::unordered_map<instruction_ref, std::vector<std::size_t>> builtins = {};
+    // The instructions that can be assigned, in program order
+    std::vector<instruction_ref> candidates = {};
+    // The targets the candidates are assigned to
+    std::unordered_map<instruction_ref, std::size_t> assigned = {};
+    // The cost charged to each target
+    std::vector<float> loads = {};
+
+    std::size_t host() const { return targets->size(); }
+
+    void init()
+    {
+        costs.resize(host());
+        for(std::size_t i = 0; i < host(); i++)
+        {
+            const auto& t = targets->at(i);
+            for(const auto& segment : t.find_supported(mod, options.metric))
+            {
+                const auto& instructions = segment.instructions;
+
+                auto n = std::count_if(instructions.begin(), instructions.end(), [](auto ins) {
+                    return not is_builtin(ins);
+                });
+                for(auto ins : instructions)
+                {
+                    if(is_builtin(ins))
+                    {
+                        builtins[ins].push_back(i);
+                        continue;
+                    }
+                    // Each instruction gets an equal share of the cost of the segment
+                    auto c  = segment.metric / n;
+                    auto it = costs[i].find(ins);
+                    if(it == costs[i].end())
+                        costs[i][ins] = c;
+                    else
+                        it->second = std::min(it->second, c);
+                }
+            }
+            auto it = options.copy_costs.find(t.name());
+            copy_costs.push_back(it == options.copy_costs.end() ? 0.0f : it->second);
+        }
+        copy_costs.push_back(0.0f);
+        for(auto ins : iterator_for(*mod))
+        {
+            if(not supported(ins).empty())
+                candidates.push_back(ins);
+        }
+        compute_loads();
+    }
+
+    std::vector<std::size_t> supported(instruction_ref ins) const
+    {
+        std::vector<std::size_t> result;
+        for(std::size_t i = 0; i < host(); i++)
+        {
+            if(contains(costs[i], ins))
+                result.push_back(i);
+        }
+        return result;
+    }
+
+    std::size_t get_target(instruction_ref ins) const
+    {
+        auto it = assigned.find(ins);
+        if(it == assigned.end())
+            return host();
+        return it->second;
+    }
+
+    // Charge the cost of the instruction, and of copying its result to the targets that use it
+    void charge(instruction_ref ins, float sign)
+    {
+        // Literals are copied into the submodules that use them
+        if(ins->name() == "@literal")
+            return;
+        auto t = get_target(ins);
+        if(t != host())
+            loads[t] += sign * costs[t].at(ins);
+        std::vector<std::size_t> users;
+        for(auto output : ins->outputs())
+        {
+            auto u = get_target(output);
+            if(u != t and not contains(users, u))
+                users.push_back(u);
+        }
+        auto bytes = get_bytes(ins->get_shape());
+        for(auto u : users)
+        {
+            loads[t] += sign * copy_costs[t] * bytes;
+            loads[u] += sign * copy_costs[u] * bytes;
+        }
+    }
+
+    void compute_loads()
+    {
+        loads.assign(host() + 1, 0.0f);
+        for(auto ins : iterator_for(*mod))
+            charge(ins, 1);
+    }
+
+    float total() const
+    {
+        if(options.metric == support_metric::throughput)
+            return *std::max_element(loads.begin(), loads.end());
+        return std::accumulate(loads.begin(), loads.end(), 0.0f);
+    }
+
+    void assign(instruction_ref ins, std::size_t t)
+    {
+        // Only the costs of the instruction and of its inputs depend on its target
+        std::vector<instruction_ref> affected;
+        for(auto input : ins->inputs())
+        {
+            if(not contains(affected, input))
+                affected.push_back(input);
+        }
+        affected.push_back(ins);
+        for(auto x : affected)
+            charge(x, -1);
+        assigned[ins] = t;
+        for(auto x : affected)
+            charge(x, 1);
+    }
+
+    // Move the instructions to the target, and keep the move if it lowers the total cost
+    bool try_assign(const std::vector<instruction_ref>& instructions, std::size_t t)
+    {
+        auto before = total();
+        std::vector<std::size_t> previous;
+        for(auto ins : instructions)
+        {
+            previous.push_back(get_target(ins));
+            assign(ins, t);
+        }
+        if(total() < before - 1e-6f * std::max(1.0f, before))
+            return true;
+        for(std::size_t i = 0; i < instructions.size(); i++)
+            assign(instructions[i], previous[i]);
+        return false;
+    }
+
+    // Runs of consecutive candidates that are assigned to the same target
+    std::vector<std::vector<instruction_ref>> get_runs() const
+    {
+        std::vector<std::vector<instruction_ref>> result;
+        for(auto ins : candidates)
+        {
+            if(result.empty() or get_target(result.back().front()) != get_target(ins))
+                result.emplace_back();
+            result.back().push_back(ins);
+        }
+        return result;
+    }
+
+    bool improve()
+    {
+        bool improved = false;
+        for(auto ins : candidates)
+        {
+            for(auto t : supported(ins))
+            {
+                if(t != get_target(ins))
+                    improved |= try_assign({ins}, t);
+            }
+        }
+        // Moving a single instruction can cost an extra copy on each side, so try moving the
+        // runs as a whole
+        for(const auto& run : get_runs())
+        {
+            for(std::size_t t = 0; t < host(); t++)
+            {
+                if(t == get_target(run.front()))
+                    continue;
+                if(std::any_of(run.begin(), run.end(), [&](auto ins) {
+                       return not contains(costs[t], ins);
+                   }))
+                    continue;
+                improved |= try_assign(run, t);
+            }
+        }
+        return improved;
+    }
+
+    void optimize()
+    {
+        // Start from the greedy choice of each instruction in program order
+        for(auto ins : candidates)
+        {
+            auto best      = host();
+            auto best_cost = 0.0f;
+            for(auto t : supported(ins))
+            {
+                assign(ins, t);
+                if(best != host() and total() >= best_cost)
+                    continue;
+                best      = t;
+                best_cost = total();
+            }
+            assign(ins, best);
+        }
+        const std::size_t max_iterations = 16;
+        for(std::size_t i = 0; i < max_iterations; i++)
+        {
+            if(not improve())
+                break;
+        }
+        // Recompute the loads to drop the rounding errors of the incremental updates
+        compute_loads();
+    }
+
+    target_assignments get_assignments() const
+    {
+        target_assignments result;
+        for(auto ins : candidates)
+            result.insert(result.end(), {ins, targets->at(get_target(ins)).name()});
+        // A builtin goes to the target of its first user that supports it
+        for(const auto& [ins, ts] : builtins)
+        {
+            auto t  = ts.front();
+            auto it = std::find_if(ins->outputs().begin(), ins->outputs().end(), [&](auto output) {
+                return contains(ts, get_target(output));
+            });
+            if(it != ins->outputs().end())
+                t = get_target(*it);
+            result.insert(result.end(), {ins, targets->at(t).name()});
+        }
+        result.set_cost(total());
+        return result;
+    }
+};
+
+target_assignments assign_targets(const_module_ref mod,
+                                  const std::vector<target>& targets,
+                                  const assignment_options& options)
+{
+    target_cost_model model{mod, &targets, options};
+    model.init();
+    model.optimize();
+    return model.get_assignments();
+}
+
+static std::string get_target_module_name(const program& p, const std::string& target_name)
+{
+    auto mods = p.get_modules();
+    std::unordered_set<std::string> names;
+    std::transform(mods.begin(), mods.end(), std::inserter(names, names.end()), [](auto* m) {
+        return m->name();
+    });
+    std::size_t n = 0;
+    std::string name;
+    do
+    {
+        name = target_name + "_mod" + std::to_string(n++);
+    } while(contains(names, name));
+    return name;
+}
+
+// The parameters of run_on_target are passed in the sorted order of their names
+static std::string get_param_name(std::size_t i, std::size_t n)
+{
+    auto s = std::to_string(i);
+    return "x" + std::string(std::to_string(n).size() - s.size(), '0') + s;
+}
+
+void partition_targets(program& p,
+                       const std::vector<target>& targets,
+                       const target_assignments& tass)
+{
+    auto* mm           = p.get_main_module();
+    auto get_target_id = [&](const std::string& name) {
+        auto it = std::find_if(
+            targets.begin(), targets.end(), [&](const auto& t) { return t.name() == name; });
+        if(it == targets.end())
+            MIGRAPHX_THROW("PARTITION_TARGETS: Unknown target: " + name);
+        return std::distance(targets.begin(), it);
+    };
+    // Group the consecutive instructions that are assigned to the same target
+    std::vector<std::pair<std::size_t, std::vector<instruction_ref>>> partitions;
+    bool open = false;
+    for(auto ins : iterator_for(*mm))
+    {
+        if(is_builtin(ins))
+            continue;
+        auto it = tass.find(ins);
+        if(it == tass.end())
+        {
+            open = false;
+            continue;
+        }
+        std::size_t tid = get_target_id(it->second);
+        if(open and partitions.back().first == tid)
+        {
+            partitions.back().second.push_back(ins);
+        }
+        else
+        {
+            partitions.push_back({tid, {ins}});
+            open = true;
+        }
+    }
+    for(const auto& [tid, instructions] : partitions)
+    {
+        std::unordered_set<instruction_ref> members(instructions.begin(), instructions.end());
+        std::vector<instruction_ref> inputs;
+        std::vector<instruction_ref> literals;
+        std::vector<instruction_ref> outputs;
+        for(auto ins : instructions)
+        {
+            for(auto input : ins->inputs())
+            {
+                if(contains(members, input) or contains(inputs, input) or
+                   contains(literals, input))
+                    continue;
+                if(input->name() == "@literal")
+                    literals.push_back(input);
+                else
+                    inputs.push_back(input);
+            }
+            if(std::any_of(ins->outputs().begin(), ins->outputs().end(), [&](auto output) {
+                   return not contains(members, output);
+               }))
+                outputs.push_back(ins);
+        }
+
+        auto* sm = p.create_module(get_target_module_name(p, targets[tid].name()));
+        std::unordered_map<instruction_ref, instruction_ref> map_ins;
+        for(std::size_t i = 0; i < inputs.size(); i++)
+        {
+            map_ins[inputs[i]] =
+                sm->add_parameter(get_param_name(i, inputs.size()), inputs[i]->get_shape());
+        }
+        for(auto lit : literals)
+            map_ins[lit] = sm->add_literal(lit->get_literal());
+        sm->add_instructions(instructions, &map_ins);
+        std::vector<instruction_ref> returns;
+        std::transform(outputs.begin(), outputs.end(), std::back_inserter(returns), [&](auto ins) {
+            return map_ins.at(ins);
+        });
+        sm->add_return(returns);
+
+        auto last = instructions.back();
+        auto r    = mm->insert_instruction(
+            std::next(last), make_op("run_on_target", {{"target_id", tid}}), inputs, {sm});
+        auto pos = std::next(r);
+        for(std::size_t i = 0; i < outputs.size(); i++)
+        {
+            auto elem  = mm->insert_instruction(pos, make_op("get_tuple_elem", {{"index", i}}), r);
+            auto users = outputs[i]->outputs();
+            for(auto user : users)
+            {
+                if(not contains(members, user))
+                    instruction::replace_argument(user, outputs[i], elem);
+            }
+        }
+        std::for_each(instructions.rbegin(), instructions.rend(), [&](auto ins) {
+            mm->remove_instruction(ins);
+        });
+    }
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
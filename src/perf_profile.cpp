@@ -0,0 +1,195 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/perf_profile.hpp>
+#include <migraphx/json.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/value.hpp>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <numeric>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+static double percentile(const std::vector<double>& sorted, double p)
+{
+    // Nearest rank
+    auto rank = static_cast<std::size_t>(std::ceil(p * sorted.size() / 100.0));
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+timing_summary timing_summary::compute(std::vector<double> samples)
+{
+    timing_summary result;
+    if(samples.empty())
+        return result;
+    std::sort(samples.begin(), samples.end());
+    result.count = samples.size();
+    result.min   = samples.front();
+    result.max   = samples.back();
+    result.mean  = std::accumulate(samples.begin(), samples.end(), 0.0) / samples.size();
+    double sq    = std::accumulate(samples.begin(), samples.end(), 0.0, [&](double acc, double x) {
+        return acc + (x - result.mean) * (x - result.mean);
+    });
+    result.stddev = std::sqrt(sq / samples.size());
+    result.p50    = percentile(samples, 50);
+    result.p90    = percentile(samples, 90);
+    result.p99    = percentile(samples, 99);
+    return result;
+}
+
+timing_summary perf_profile::run_summary() const
+{
+    std::vector<double> samples;
+    std::transform(runs.begin(), runs.end(), std::back_inserter(samples), [](const auto& r) {
+        return r.duration;
+    });
+    return timing_summary::compute(samples);
+}
+
+std::vector<timing_summary> perf_profile::instruction_summaries() const
+{
+    std::vector<std::vector<double>> samples(instructions.size());
+    for(const auto& e : events)
+        samples[e.instruction].push_back(e.duration);
+    std::vector<timing_summary> result;
+    std::transform(samples.begin(), samples.end(), std::back_inserter(result), [](auto& s) {
+        return timing_summary::compute(std::move(s));
+    });
+    return result;
+}
+
+static void print_timing(std::ostream& os, const timing_summary& t)
+{
+    os << "p50=" << t.p50 << "ms, p90=" << t.p90 << "ms, p99=" << t.p99 << "ms, max=" << t.max
+       << "ms, stddev=" << t.stddev << "ms";
+}
+
+void perf_profile::print_summary(std::ostream& os) const
+{
+    auto summaries = instruction_summaries();
+    for(std::size_t i = 0; i < instructions.size(); i++)
+    {
+        const auto& info = instructions[i];
+        const auto& t    = summaries[i];
+        // Instructions that are never evaluated, such as @return
+        if(t.count == 0)
+            continue;
+        os << info.name << " = " << info.group << ": ";
+        print_timing(os, t);
+        // Ratio of the tail to the median, to make jittery instructions easy to spot
+        if(t.p50 > 0)
+            os << ", p99/p50=" << t.p99 / t.p50;
+        if(t.count != runs.size())
+            os << ", count=" << t.count;
+        os << std::endl;
+    }
+    os << std::endl;
+    os << "Runs: " << runs.size() << std::endl;
+    os << "Run time: ";
+    print_timing(os, run_summary());
+    os << std::endl;
+}
+
+void perf_profile::write_chrome_trace(std::ostream& os) const
+{
+    // Chrome trace events use microseconds
+    auto us = [](double ms) { return ms * 1000.0; };
+    os << "{\"traceEvents\":[" << std::endl;
+    const char* sep = "";
+    for(std::size_t i = 0; i < runs.size(); i++)
+    {
+        value v = {{"name", "run"},
+                   {"cat", "program"},
+                   {"ph", "X"},
+                   {"pid", 0},
+                   {"tid", 0},
+                   {"ts", us(runs[i].start)},
+                   {"dur", us(runs[i].duration)},
+                   {"args", {{"run", i}}}};
+        os << sep << to_json_string(v);
+        sep = ",\n";
+    }
+    for(const auto& e : events)
+    {
+        const auto& info = instructions[e.instruction];
+        value v          = {{"name", info.group},
+                            {"cat", info.module},
+                            {"ph", "X"},
+                            {"pid", 0},
+                            {"tid", 0},
+                            {"ts", us(e.start)},
+                            {"dur", us(e.duration)},
+                            {"args", {{"instruction", info.name}, {"run", e.run}}}};
+        os << sep << to_json_string(v);
+    }
+    os << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+static std::string frame_name(std::string name)
+{
+    std::replace_if(name.begin(), name.end(), [](char c) { return c == ';' or c == ' '; }, '_');
+    return name;
+}
+
+void perf_profile::write_folded_stacks(std::ostream& os) const
+{
+    std::vector<double> child_time(events.size());
+    std::vector<double> top_level_time(runs.size());
+    for(const auto& e : events)
+    {
+        if(e.parent == no_parent)
+            top_level_time.at(e.run) += e.duration;
+        else
+            child_time[e.parent] += e.duration;
+    }
+    // Sort by the stack so the output is stable
+    std::map<std::string, double> stacks;
+    for(std::size_t i = 0; i < events.size(); i++)
+    {
+        std::vector<std::string> frames;
+        for(auto j = i; j != no_parent; j = events[j].parent)
+        {
+            const auto& info = instructions[events[j].instruction];
+            frames.push_back(frame_name(info.group));
+            frames.push_back(frame_name(info.module));
+        }
+        std::reverse(frames.begin(), frames.end());
+        stacks[join_strings(frames, ";")] += events[i].duration - child_time[i];
+    }
+    // Time spent in the program between the instructions
+    for(std::size_t i = 0; i < runs.size(); i++)
+        stacks["main;[overhead]"] += runs[i].duration - top_level_time[i];
+    for(const auto& [stack, ms] : stacks)
+    {
+        auto count = std::llround(ms * 1000.0);
+        if(count > 0)
+            os << stack << " " << count << std::endl;
+    }
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -22,6 +22,7 @@
  * THE SOFTWARE.
  */
 #include <migraphx/version.h>
+#include <migraphx/allocation_pool.hpp>
 #include <migraphx/compile_options.hpp>
 #include <migraphx/program.hpp>
 #include <migraphx/stringutils.hpp>
@@ -29,6 +30,7 @@
 #include <migraphx/op/identity.hpp>
 #include <migraphx/target.hpp>
 #include <migraphx/env.hpp>
+#include <migraphx/hash.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/time.hpp>
 #include <migraphx/pass_manager.hpp>
@@ -39,6 +41,9 @@
 #include <migraphx/output_iterator.hpp>
 #include <migraphx/make_op.hpp>
 #include <migraphx/marker.hpp>
+#include <migraphx/partition_targets.hpp>
+#include <migraphx/perf_profile.hpp>
+#include <migraphx/program_cache.hpp>
 #include <migraphx/supported_segments.hpp>
 
 #include <iostream>
@@ -50,6 +55,9 @@
 #include <utility>
 #include <unordered_set>
 #include <map>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
 #include <cassert>
 
 namespace migraphx {
@@ -68,12 +76,390 @@ struct mark_instruction_target
     }
 };
 
+// A flattened form of the modules used by eval. Each instruction is assigned an
+// integer slot, so evaluating the plan does not need to hash instruction_refs, and
+// the operators are normalized ahead of time.
+struct execution_plan
+{
+    enum class step_kind
+    {
+        literal,
+        param,
+        outline,
+        ret,
+        op
+    };
+
+    struct step
+    {
+        step_kind kind = step_kind::op;
+        instruction_ref ins;
+        const operation* op = nullptr;
+        std::size_t output  = 0;
+        std::vector<std::size_t> inputs;
+        // Index of the plan for each of the module inputs of the instruction
+        std::vector<std::size_t> mods;
+        shape output_shape;
+        std::string param;
+        argument lit;
+        // The output lives as long as the program, such as the scratch memory
+        bool global = false;
+    };
+
+    struct module_plan
+    {
+        const module* mod   = nullptr;
+        std::size_t version = 0;
+        std::vector<step> steps;
+    };
+
+    std::vector<module_plan> modules;
+    // A deque keeps the pointers to the normalized operators stable
+    std::deque<operation> normalized_ops;
+    std::size_t nslots = 0;
+    // The modules have instructions that can only be evaluated by the generic_eval of a module.
+    // The plan is still kept so it's only created again once the modules change.
+    bool unsupported = false;
+
+    // The modules can still be changed through a module_ref after the plan is built
+    bool is_stale() const
+    {
+        return std::any_of(modules.begin(), modules.end(), [](const module_plan& mp) {
+            return mp.mod->version() != mp.version;
+        });
+    }
+
+    static std::shared_ptr<const execution_plan> create(const module* mm)
+    {
+        auto plan = std::make_shared<execution_plan>();
+        std::unordered_map<instruction_ref, std::size_t> slots;
+        std::unordered_map<const module*, std::size_t> plans;
+        plan->unsupported = not plan->add_module(mm, slots, plans);
+        return plan;
+    }
+
+    private:
+    bool add_module(const module* mod,
+                    std::unordered_map<instruction_ref, std::size_t>& slots,
+                    std::unordered_map<const module*, std::size_t>& plans)
+    {
+        auto idx   = modules.size();
+        plans[mod] = idx;
+        modules.push_back({mod, mod->version(), {}});
+        std::vector<step> steps;
+        steps.reserve(mod->size());
+        for(auto ins : iterator_for(*mod))
+        {
+            step s;
+            s.ins          = ins;
+            s.output       = nslots++;
+            s.output_shape = ins->get_shape();
+            slots[ins]     = s.output;
+            for(auto input : ins->inputs())
+            {
+                // Inputs that are not defined before use can only be handled by generic_eval
+                if(not contains(slots, input))
+                    return false;
+                s.inputs.push_back(slots.at(input));
+            }
+            for(auto* smod : ins->module_inputs())
+            {
+                if(not contains(plans, smod) and not add_module(smod, slots, plans))
+                    return false;
+                s.mods.push_back(plans.at(smod));
+            }
+            const auto& name = ins->name();
+            if(name == "@literal")
+            {
+                s.kind = step_kind::literal;
+                s.lit  = ins->get_literal().get_argument();
+            }
+            else if(name == "@param")
+            {
+                s.kind  = step_kind::param;
+                s.param = any_cast<builtin::param>(ins->get_operator()).parameter;
+            }
+            else if(name == "@outline")
+            {
+                s.kind = step_kind::outline;
+            }
+            else if(name == "@return")
+            {
+                s.kind = step_kind::ret;
+            }
+            else if(ins->need_normalization())
+            {
+                normalized_ops.push_back(ins->normalized_operator());
+                s.op = &normalized_ops.back();
+            }
+            else
+            {
+                s.op = &ins->get_operator();
+            }
+            if(s.op != nullptr)
+                s.global = s.op->get_lifetime() == lifetime::global;
+            steps.push_back(std::move(s));
+        }
+        modules[idx].steps = std::move(steps);
+        return true;
+    }
+};
+
+// The mutable storage used while evaluating an execution_plan
+struct eval_state
+{
+    std::shared_ptr<const execution_plan> plan;
+    std::vector<argument> results;
+    std::vector<std::vector<argument>> values;
+    // States created for concurrent evals own a copy of the contexts and the buffers of the
+    // global instructions, while the first state uses the ones of the program
+    bool concurrent = false;
+    std::vector<context> contexts;
+    std::unordered_map<std::size_t, argument> globals;
+
+    explicit eval_state(std::shared_ptr<const execution_plan> p)
+        : plan(std::move(p)), results(plan->nslots), values(plan->nslots)
+    {
+        for(const auto& mp : plan->modules)
+        {
+            for(const auto& s : mp.steps)
+                values[s.output].reserve(s.inputs.size());
+        }
+    }
+
+    eval_state(std::shared_ptr<const execution_plan> p, const std::vector<context>& ctx)
+        : eval_state(std::move(p))
+    {
+        concurrent = true;
+        contexts   = ctx;
+        for(const auto& mp : plan->modules)
+        {
+            for(const auto& s : mp.steps)
+            {
+                if(s.global)
+                    globals.emplace(s.output, argument{s.output_shape});
+            }
+        }
+    }
+};
+
+// Targets whose memory is on the host return the same buffer when copying to the target
+static bool uses_host_memory(const target& t)
+{
+    argument probe{shape{shape::int8_type, {1}}};
+    return t.copy_to(probe).data() == probe.data();
+}
+
+// The shapes of the outputs of the instructions, which are the sizes the ops allocate
+static std::vector<shape> allocation_shapes(const module* mm)
+{
+    std::vector<shape> result;
+    std::vector<const module*> mods = {mm};
+    auto sub_modules                = mm->get_sub_modules();
+    mods.insert(mods.end(), sub_modules.begin(), sub_modules.end());
+    for(const auto* mod : mods)
+    {
+        std::transform(mod->begin(), mod->end(), std::back_inserter(result), [](const auto& ins) {
+            return ins.get_shape();
+        });
+    }
+    return result;
+}
+
+using output_parameters = std::vector<std::pair<std::string, shape>>;
+
+// The parameters that the outputs of the main module are written to
+static output_parameters find_output_parameters(const module* mm)
+{
+    output_parameters result;
+    for(auto&& [name, s] : mm->get_parameter_shapes())
+    {
+        if(contains(name, "#output_"))
+            result.emplace_back(name, s);
+    }
+    return result;
+}
+
+struct eval_cache
+{
+    // The plan is created again by the next eval once the modules are changed. It's only
+    // accessed with the mutex held, since evals can run concurrently.
+    std::shared_ptr<const execution_plan> plan = nullptr;
+    // Whether the program is evaluated with a plan, which is only done once it's compiled or
+    // finalized
+    bool enabled = false;
+    // Whether concurrent evals can use their own copies of the contexts and global buffers. The
+    // copies of the contexts of targets that use device memory would share the same buffers, so
+    // their evals wait for the state of the program instead.
+    bool concurrent = true;
+    // The states that are not used by an eval. New states are only created when all of them are
+    // in use, so there are never more states than concurrent evals.
+    std::vector<std::unique_ptr<eval_state>> states;
+    // The host buffers allocated by the ops are returned here to be reused by the next evals
+    std::shared_ptr<allocation_pool> pool = nullptr;
+    // The shapes the pool was created for
+    std::vector<shape> pool_shapes;
+    // The output parameters of programs on the host, which are allocated when an eval doesn't
+    // pass them
+    std::shared_ptr<const output_parameters> outputs = nullptr;
+    std::mutex mutex;
+    std::condition_variable available;
+    // The evals without a plan use the contexts and buffers of the program, so they run one at a
+    // time
+    std::mutex fallback_mutex;
+
+    eval_cache() = default;
+    // The plan refers to instructions of the program, so it is never copied
+    eval_cache(const eval_cache&) {}
+    eval_cache& operator=(const eval_cache&)
+    {
+        reset();
+        return *this;
+    }
+
+    void reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        enabled    = false;
+        concurrent = true;
+        plan       = nullptr;
+        states.clear();
+        pool = nullptr;
+        pool_shapes.clear();
+        outputs = nullptr;
+        available.notify_all();
+    }
+
+    // Drop the plan when it can refer to modules that are removed
+    void invalidate()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        plan = nullptr;
+        states.clear();
+        available.notify_all();
+    }
+
+    void build(const module* mm, const std::vector<target>& targets)
+    {
+        bool host   = std::all_of(targets.begin(), targets.end(), &uses_host_memory);
+        auto shapes = allocation_shapes(mm);
+        auto params = host ? std::make_shared<const output_parameters>(find_output_parameters(mm))
+                           : nullptr;
+        std::lock_guard<std::mutex> lock(mutex);
+        enabled    = true;
+        concurrent = host;
+        outputs    = params;
+        rebuild(mm);
+        // The buffers of the pool are kept when the program allocates the same sizes
+        if(pool == nullptr or shapes != pool_shapes)
+        {
+            pool        = std::make_shared<allocation_pool>();
+            pool_shapes = std::move(shapes);
+        }
+    }
+
+    // Allocate the output parameters of a program on the host that the eval doesn't pass
+    void add_outputs(parameter_map& params)
+    {
+        std::shared_ptr<const output_parameters> out = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            out = outputs;
+        }
+        if(out == nullptr)
+            return;
+        for(const auto& [name, s] : *out)
+        {
+            if(not contains(params, name))
+                params.emplace(name, argument{s});
+        }
+    }
+
+    bool has_plan()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return enabled;
+    }
+
+    // The plan for the current version of the modules, or nullptr when the program is evaluated
+    // without one
+    std::shared_ptr<const execution_plan> get_plan(const module* mm)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(not enabled)
+            return nullptr;
+        if(plan == nullptr or plan->is_stale())
+            rebuild(mm);
+        if(plan->unsupported)
+            return nullptr;
+        return plan;
+    }
+
+    // Use a state that no other eval is using, or create one with copies of the contexts
+    template <class F>
+    auto with_state(const std::shared_ptr<const execution_plan>& p,
+                    const std::vector<context>& ctx,
+                    F f)
+    {
+        std::unique_ptr<eval_state> state   = nullptr;
+        std::shared_ptr<allocation_pool> use = nullptr;
+        bool copy_contexts                   = true;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if(not concurrent)
+                available.wait(lock, [&] { return not states.empty() or plan != p; });
+            if(not states.empty())
+            {
+                state = std::move(states.back());
+                states.pop_back();
+            }
+            use           = pool;
+            copy_contexts = concurrent;
+        }
+        if(state == nullptr and copy_contexts)
+            state = std::make_unique<eval_state>(p, ctx);
+        else if(state == nullptr)
+            state = std::make_unique<eval_state>(p);
+        auto release = [&] {
+            std::lock_guard<std::mutex> lock(mutex);
+            // The state is dropped when the plan was rebuilt during the eval
+            if(state->plan == plan)
+                states.push_back(std::move(state));
+            available.notify_one();
+        };
+        try
+        {
+            allocation_pool::scope use_pool{use.get()};
+            auto result = f(*state);
+            release();
+            return result;
+        }
+        catch(...)
+        {
+            release();
+            throw;
+        }
+    }
+
+    private:
+    // Requires the mutex to be held
+    void rebuild(const module* mm)
+    {
+        states.clear();
+        plan = execution_plan::create(mm);
+        if(not plan->unsupported)
+            states.push_back(std::make_unique<eval_state>(plan));
+        available.notify_all();
+    }
+};
+
 struct program_impl
 {
     // A map is used to keep references to modules of the program
     std::unordered_map<std::string, module> modules;
     std::vector<context> contexts;
     std::vector<target> targets;
+    eval_cache cache;
 };
 
 program::program() : impl(std::make_unique<program_impl>()) { this->create_module("main"); }
@@ -127,6 +513,9 @@ void program::assign(const program& p)
         for(auto ins : iterator_for(mp.second))
             instruction::replace_refs(ins, ins_map, mod_map);
     }
+
+    if(p.impl->cache.has_plan())
+        impl->cache.build(&impl->modules.at("main"), impl->targets);
 }
 
 shape program::get_parameter_shape(std::string name) const
@@ -161,6 +550,18 @@ std::vector<shape> program::get_output_shapes() const
     return mm->get_output_shapes();
 }
 
+argument program::copy_to_host(const argument& arg) const
+{
+    // The targets return the arguments that are not in their memory as they are
+    for(const auto& t : impl->targets)
+    {
+        auto result = t.copy_from(arg);
+        if(result.data() != arg.data())
+            return result;
+    }
+    return arg;
+}
+
 context& program::get_context() const
 {
     assert(impl->contexts.size() == 1);
@@ -176,44 +577,14 @@ instruction_ref program::validate() const
 target_assignments program::get_target_assignments(const std::vector<target>& targets,
                                                    assignment_options options)
 {
-    const auto m = options.metric;
-
-    target_assignments p;
-
-    const auto* mod = get_main_module();
-    std::vector<std::pair<target, supported_segments>> target_subgraphs;
-    target_subgraphs.reserve(targets.size());
-    std::transform(targets.begin(),
-                   targets.end(),
-                   std::back_inserter(target_subgraphs),
-                   [&](const auto& t) { return std::make_pair(t, t.find_supported(mod, m)); });
-
-    for(const auto ins : iterator_for(*mod))
-    {
-        if(contains(p, ins))
-        {
-            continue;
-        }
+    return assign_targets(get_main_module(), targets, options);
+}
 
-        for(const auto& [target, subgraph] : target_subgraphs)
-        {
-            // can't pass a structured binding into lambda in C++17 so create a variable for it
-            const auto& t = target;
-            for(const auto& segment : subgraph)
-            {
-                const auto& instructions = segment.instructions;
-                if(not contains(instructions, ins))
-                {
-                    continue;
-                }
-                std::transform(instructions.begin(),
-                               instructions.end(),
-                               std::inserter(p, p.end()),
-                               [&](auto instr) { return std::make_pair(instr, t.name()); });
-            }
-        }
-    }
-    return p;
+bool program::uses_host_memory() const
+{
+    return std::all_of(impl->targets.begin(), impl->targets.end(), [](const target& t) {
+        return migraphx::uses_host_memory(t);
+    });
 }
 
 bool program::is_compiled() const { return not this->impl->contexts.empty(); }
@@ -307,6 +678,14 @@ void program::compile(const target& t, compile_options options)
 {
     // todo: combine with multi-target compile method
     assert(not this->is_compiled());
+    auto* cache = get_program_cache();
+    std::string cache_key;
+    if(cache != nullptr)
+    {
+        cache_key = program_cache::key(*this, t, options);
+        if(cache->load(cache_key, *this))
+            return;
+    }
     this->impl->targets  = {t};
     this->impl->contexts = {t.get_context()};
 
@@ -336,12 +715,16 @@ void program::compile(const target& t, compile_options options)
         }
         mod->finalize(this->impl->contexts);
     }
+    this->impl->cache.build(this->get_main_module(), this->impl->targets);
+    if(cache != nullptr)
+        cache->store(cache_key, *this);
 }
 
 void program::finalize()
 {
     auto* mm = this->get_main_module();
     mm->finalize(this->impl->contexts);
+    this->impl->cache.build(mm, this->impl->targets);
 }
 
 template <class T>
@@ -514,20 +897,125 @@ std::vector<argument> generic_eval(const module* mod,
 }
 
 template <class F>
-std::vector<argument> generic_eval(const program& p,
+std::vector<argument> generic_eval(const execution_plan& plan,
+                                   std::size_t midx,
+                                   eval_state& state,
+                                   std::vector<context>& ctx,
+                                   const std::unordered_map<std::string, argument>& params,
+                                   F trace)
+{
+    using step_kind   = execution_plan::step_kind;
+    const auto& steps = plan.modules[midx].steps;
+    auto& results     = state.results;
+    for(const auto& s : steps)
+    {
+        auto ins = s.ins;
+        switch(s.kind)
+        {
+        case step_kind::literal: {
+            results[s.output] = trace(ins, [&] { return s.lit; });
+            break;
+        }
+        case step_kind::param: {
+            results[s.output] = trace(ins, [&] {
+                auto it = params.find(s.param);
+                if(it == params.end())
+                    MIGRAPHX_THROW("Parameter not found: " + s.param);
+                const auto& param = it->second;
+                if(not s.output_shape.any_of_dynamic() and param.get_shape() != s.output_shape)
+                {
+                    MIGRAPHX_THROW("Incorrect shape {" + to_string(param.get_shape()) +
+                                   "} for parameter: " + s.param +
+                                   " should be: " + to_string(s.output_shape));
+                }
+                return param;
+            });
+            break;
+        }
+        case step_kind::outline: {
+            results[s.output] = trace(ins, [&] { return argument{s.output_shape, nullptr}; });
+            break;
+        }
+        case step_kind::ret: {
+            std::vector<argument> prog_outputs(s.inputs.size());
+            std::transform(s.inputs.begin(),
+                           s.inputs.end(),
+                           prog_outputs.begin(),
+                           [&](std::size_t i) { return results[i]; });
+            return prog_outputs;
+        }
+        case step_kind::op: {
+            if(s.global and state.concurrent)
+            {
+                results[s.output] = trace(ins, [&] { return state.globals.at(s.output); });
+                break;
+            }
+            auto& values = state.values[s.output];
+            values.resize(s.inputs.size());
+            std::transform(s.inputs.begin(), s.inputs.end(), values.begin(), [&](std::size_t i) {
+                return results[i];
+            });
+            const auto& mod_args = ins->module_inputs();
+            auto module_eval     = [&](module_ref smod,
+                                   const std::unordered_map<std::string, argument>& inputs) {
+                auto it = std::find(mod_args.begin(), mod_args.end(), smod);
+                if(it == mod_args.end())
+                    MIGRAPHX_THROW("Module " + smod->name() + " is not an input of " +
+                                   ins->name());
+                auto smidx = s.mods[std::distance(mod_args.begin(), it)];
+                return generic_eval(plan, smidx, state, ctx, inputs, trace);
+            };
+
+            results[s.output] = trace(ins, [&] {
+                const auto& op = *s.op;
+                if(op.is_context_free())
+                    return op.compute(s.output_shape, values, mod_args, module_eval);
+                if(ins->get_target_id() >= ctx.size())
+                    MIGRAPHX_THROW("No context available for " + op.name());
+                return op.compute(
+                    ctx[ins->get_target_id()], s.output_shape, values, mod_args, module_eval);
+            });
+            // Release the inputs, but keep the capacity for the next eval
+            values.clear();
+            break;
+        }
+        }
+        assert(s.output_shape.any_of_dynamic() or
+               results[s.output].get_shape() == s.output_shape);
+    }
+    if(steps.empty())
+        return {};
+    return {results[steps.back().output]};
+}
+
+template <class F>
+std::vector<argument> generic_eval(program_impl& impl,
                                    std::vector<context>& ctx,
                                    std::unordered_map<std::string, argument> params,
                                    F trace)
 {
-    const module* mm = p.get_main_module();
-    return generic_eval(mm, ctx, params, {}, trace);
+    auto& cache = impl.cache;
+    auto plan   = cache.get_plan(&impl.modules.at("main"));
+    if(plan == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(cache.fallback_mutex);
+        return generic_eval(&impl.modules.at("main"), ctx, std::move(params), {}, trace);
+    }
+    return cache.with_state(plan, impl.contexts, [&](eval_state& state) {
+        // Concurrent evals use their own copies of the contexts of the program
+        auto& state_ctx =
+            (state.concurrent and &ctx == &impl.contexts) ? state.contexts : ctx;
+        auto result = generic_eval(*state.plan, 0, state, state_ctx, params, trace);
+        // Don't keep the intermediate buffers alive between evals
+        std::fill(state.results.begin(), state.results.end(), argument{});
+        return result;
+    });
 }
 
 std::vector<argument> program::eval_with_context(std::vector<context>& ctx,
                                                  parameter_map params) const
 {
-    const module* mm = this->get_main_module();
-    return generic_eval(mm, ctx, std::move(params), {}, [](auto&&, auto f) { return f(); });
+    return generic_eval(*this->impl, ctx, std::move(params), [](auto&&, auto f) { return f(); });
 }
 
 std::vector<argument> program::eval(parameter_map params, execution_environment exec_env) const
@@ -536,6 +1024,7 @@ std::vector<argument> program::eval(parameter_map params, execution_environment
 
     auto trace_level = value_of(MIGRAPHX_TRACE_EVAL{});
     std::vector<argument> ret;
+    this->impl->cache.add_outputs(params);
 
     if(exec_env.async)
     {
@@ -552,7 +1041,7 @@ std::vector<argument> program::eval(parameter_map params, execution_environment
             instruction::print(ss, x, ins_names);
             ins_out[x] = ss.str();
         });
-        ret = generic_eval(*this, contexts, std::move(params), [&](instruction_ref ins, auto f) {
+        auto trace = [&](instruction_ref ins, auto f) {
             const auto& ctx = contexts[ins->get_target_id()];
             ctx.finish();
             std::cout << "Run instruction: " << ins_out.at(ins) << std::endl;
@@ -595,11 +1084,13 @@ std::vector<argument> program::eval(parameter_map params, execution_environment
                 }
             }
             return result;
-        });
+        };
+        ret = generic_eval(*this->impl, contexts, std::move(params), trace);
     }
     else
     {
-        ret = generic_eval(*this, contexts, std::move(params), [&](auto&&, auto f) { return f(); });
+        ret = generic_eval(
+            *this->impl, contexts, std::move(params), [&](auto&&, auto f) { return f(); });
     }
 
     if(exec_env.async)
@@ -617,6 +1108,19 @@ void program::finish() const
         ctx.finish();
 }
 
+allocation_stats program::get_allocation_stats() const
+{
+    auto& cache = this->impl->cache;
+    std::shared_ptr<allocation_pool> pool = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        pool = cache.pool;
+    }
+    if(pool == nullptr)
+        return {};
+    return pool->stats();
+}
+
 std::string get_migraphx_version()
 {
     std::stringstream ss;
@@ -691,7 +1195,8 @@ value program::to_value() const
 static void mod_from_val(module_ref mod,
                          const value& v,
                          std::unordered_map<std::string, instruction_ref>& instructions,
-                         const std::unordered_map<std::string, module_ref>& map_mods)
+                         const std::unordered_map<std::string, module_ref>& map_mods,
+                         const std::function<literal(const value&)>& make_literal)
 {
     const auto& module_val = v.at(mod->name());
     for(const value& node : module_val.at("nodes"))
@@ -709,8 +1214,7 @@ static void mod_from_val(module_ref mod,
         }
         else if(name == "@literal")
         {
-            output =
-                mod->insert_literal(mod->end(), migraphx::from_value<literal>(node.at("literal")));
+            output = mod->insert_literal(mod->end(), make_literal(node.at("literal")));
         }
         else
         {
@@ -735,7 +1239,7 @@ static void mod_from_val(module_ref mod,
 
                 for(const auto& smod : module_inputs)
                 {
-                    mod_from_val(smod, v, instructions, map_mods);
+                    mod_from_val(smod, v, instructions, map_mods, make_literal);
                 }
             }
 
@@ -758,6 +1262,11 @@ static void mod_from_val(module_ref mod,
 }
 
 void program::from_value(const value& v)
+{
+    this->from_value(v, [](const value& lv) { return migraphx::from_value<literal>(lv); });
+}
+
+void program::from_value(const value& v, const std::function<literal(const value&)>& make_literal)
 {
     auto version = v.at("version").to<int>();
     if(version != program_file_version)
@@ -785,7 +1294,7 @@ void program::from_value(const value& v)
         this->impl->contexts.back().from_value(v.at("contexts")[i]);
     }
 
-    auto module_vals = v.at("modules");
+    const auto& module_vals = v.at("modules");
     for(const auto& vv : module_vals)
     {
         const auto& name = vv.get_key();
@@ -801,7 +1310,7 @@ void program::from_value(const value& v)
 
     std::unordered_map<std::string, instruction_ref> map_insts;
     auto* mm = get_main_module();
-    mod_from_val(mm, module_vals, map_insts, map_mods);
+    mod_from_val(mm, module_vals, map_insts, map_mods, make_literal);
 
     // Finalize a compiled model
     if(not this->impl->contexts.empty())
@@ -849,7 +1358,7 @@ void program::mark(const parameter_map& params, marker&& m)
     this->finish();
     // Start marking
     m.mark_start(*this);
-    generic_eval(*this, ctx, params, [&](auto ins, auto f) {
+    generic_eval(*this->impl, ctx, params, [&](auto ins, auto f) {
         argument result;
         m.mark_start(ins);
         result = f();
@@ -879,7 +1388,7 @@ void program::perf_report(
     std::sort(total_vec.begin(), total_vec.end());
     std::unordered_map<instruction_ref, std::vector<double>> ins_vec;
     // Fill the map
-    generic_eval(*this, ctx, params, [&](auto ins, auto) {
+    generic_eval(*this->impl, ctx, params, [&](auto ins, auto) {
         ins_vec[ins].reserve(n);
         return argument{ins->get_shape(), nullptr};
     });
@@ -887,7 +1396,7 @@ void program::perf_report(
     // Run and time each instruction
     for(std::size_t i = 0; i < n; i++)
     {
-        generic_eval(*this, ctx, params, [&](auto ins, auto f) {
+        generic_eval(*this->impl, ctx, params, [&](auto ins, auto f) {
             argument result;
             ins_vec[ins].push_back(time<milliseconds>([&] {
                 result = f();
@@ -966,6 +1475,65 @@ void program::perf_report(
        << ", " << std::round(calculate_overhead_percent) << "%" << std::endl;
 }
 
+// Wrapper operators such as ref::op print the operator they wrap, so use the
+// printed name instead of the perf group when there is no group attribute
+static std::string profile_group(instruction_ref ins)
+{
+    auto attr = ins->get_operator().attributes();
+    if(attr.contains("group"))
+        return attr.at("group").to<std::string>();
+    auto name = to_string(ins->get_operator());
+    return name.substr(0, name.find('['));
+}
+
+perf_profile program::profile(std::size_t n, parameter_map params) const
+{
+    auto& ctx = this->impl->contexts;
+    // Run once by itself
+    eval(params);
+    this->finish();
+
+    perf_profile result;
+    std::unordered_map<instruction_ref, std::size_t> ins_index;
+    std::unordered_map<instruction_ref, std::string> names;
+    for(const auto* mod : this->get_modules())
+    {
+        names = mod->print([](auto&&...) {}, names);
+        for(auto ins : iterator_for(*mod))
+        {
+            ins_index[ins] = result.instructions.size();
+            result.instructions.push_back({names.at(ins), mod->name(), profile_group(ins)});
+        }
+    }
+
+    timer t{};
+    std::vector<std::size_t> stack;
+    for(std::size_t i = 0; i < n; i++)
+    {
+        double run_start = t.record<milliseconds>();
+        generic_eval(*this->impl, ctx, params, [&](auto ins, auto f) {
+            auto idx = result.events.size();
+            perf_profile::event e;
+            e.instruction = ins_index.at(ins);
+            e.parent      = stack.empty() ? perf_profile::no_parent : stack.back();
+            e.run         = i;
+            result.events.push_back(e);
+            stack.push_back(idx);
+            double start = t.record<milliseconds>();
+            argument r   = f();
+            this->impl->contexts[ins->get_target_id()].finish();
+            double stop = t.record<milliseconds>();
+            stack.pop_back();
+            result.events[idx].start    = start;
+            result.events[idx].duration = stop - start;
+            return r;
+        });
+        this->finish();
+        result.runs.push_back({run_start, t.record<milliseconds>() - run_start});
+    }
+    return result;
+}
+
 void program::debug_print() const { std::cout << *this << std::endl; }
 void program::debug_print(instruction_ref ins) const
 {
@@ -1063,7 +1631,7 @@ void program::print_cpp(std::ostream& os) const
 void program::dry_run(std::unordered_map<std::string, argument> params) const
 {
     auto& ctx = this->impl->contexts;
-    generic_eval(*this, ctx, std::move(params), [](auto ins, auto&&...) {
+    generic_eval(*this->impl, ctx, std::move(params), [](auto ins, auto&&...) {
         return argument{ins->get_shape(), nullptr};
     });
 }
@@ -1093,7 +1661,10 @@ module* program::create_module(const std::string& name, module m)
     return &(r.first->second);
 }
 
-module* program::get_module(const std::string& name) { return &impl->modules.at(name); }
+module* program::get_module(const std::string& name)
+{
+    return &impl->modules.at(name);
+}
 
 module* program::get_main_module() { return get_module("main"); }
 
@@ -1191,6 +1762,7 @@ void program::remove_module(const std::string& name)
                [&](auto&& ins) { return references_instruction(impl->modules, ins, name); }) &&
            "Instruction referenced in another module");
 
+    impl->cache.invalidate();
     // if an instruction has an input out side of the current module, need to remove
     // the instruction from its input's outputs
     auto& mod = impl->modules.at(name);
@@ -1214,6 +1786,7 @@ void program::rename_module(const std::string& old_name, const std::string& new_
     assert(old_name != new_name);
     assert(contains(impl->modules, old_name));
     assert(not contains(impl->modules, new_name));
+    impl->cache.invalidate();
     auto node  = impl->modules.extract(old_name);
     node.key() = new_name;
     node.mapped().set_name(new_name);
@@ -1247,7 +1820,28 @@ program& program::sort()
     return *this;
 }
 
-bool operator==(const program& x, const program& y) { return to_string(x) == to_string(y); }
+std::size_t program::hash() const
+{
+    std::unordered_map<instruction_ref, std::size_t> ids;
+    std::size_t h = 0;
+    for(const auto* mod : this->get_modules())
+        hash_combine(h, mod->hash(ids));
+    return h;
+}
+
+bool operator==(const program& x, const program& y)
+{
+    auto xmods = x.get_modules();
+    auto ymods = y.get_modules();
+    std::unordered_map<instruction_ref, instruction_ref> map_ins;
+    return std::equal(xmods.begin(),
+                      xmods.end(),
+                      ymods.begin(),
+                      ymods.end(),
+                      [&](const module* xm, const module* ym) {
+                          return xm->name() == ym->name() and xm->equal(*ym, map_ins);
+                      });
+}
 
 std::ostream& operator<<(std::ostream& os, const program& p)
 {
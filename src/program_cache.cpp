@@ -0,0 +1,391 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/program_cache.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/load_save.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/tmp_dir.hpp>
+#include <migraphx/env.hpp>
+#include <migraphx/context.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/version.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <unordered_map>
+#include <vector>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+#ifndef _WIN32
+extern char** environ; // NOLINT
+#endif
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_PROGRAM_CACHE_DIR)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_PROGRAM_CACHE_SIZE)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_TRACE_PROGRAM_CACHE)
+
+namespace {
+
+// Exclusive lock on a file in the cache directory, which serializes the writers of every process
+// using the directory
+struct cache_lock
+{
+#ifndef _WIN32
+    int fd = -1;
+    explicit cache_lock(const fs::path& filename)
+    {
+        fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644); // NOLINT
+        if(fd < 0)
+            MIGRAPHX_THROW("Failed to open lock file: " + filename.string());
+        if(::flock(fd, LOCK_EX) != 0)
+        {
+            ::close(fd);
+            MIGRAPHX_THROW("Failed to lock file: " + filename.string());
+        }
+    }
+    ~cache_lock()
+    {
+        ::flock(fd, LOCK_UN);
+        ::close(fd);
+    }
+#else
+    explicit cache_lock(const fs::path&) {}
+#endif
+    cache_lock(const cache_lock&)            = delete;
+    cache_lock& operator=(const cache_lock&) = delete;
+};
+
+const std::string cache_extension = ".mxr";
+
+// SHA-256, so that different programs don't end up with the same key
+struct sha256
+{
+    std::array<std::uint32_t, 8> state = {0x6a09e667,
+                                          0xbb67ae85,
+                                          0x3c6ef372,
+                                          0xa54ff53a,
+                                          0x510e527f,
+                                          0x9b05688c,
+                                          0x1f83d9ab,
+                                          0x5be0cd19};
+    std::array<std::uint8_t, 64> block{};
+    std::size_t used    = 0;
+    std::uint64_t total = 0;
+
+    static std::uint32_t rotr(std::uint32_t x, unsigned n) { return (x >> n) | (x << (32u - n)); }
+
+    void compress()
+    {
+        static const std::array<std::uint32_t, 64> k = {
+            0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+            0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+            0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+            0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+            0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+            0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+            0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+            0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+            0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+            0xc67178f2};
+        std::array<std::uint32_t, 64> w{};
+        for(std::size_t i = 0; i < 16; i++)
+        {
+            w[i] = (std::uint32_t{block[4 * i]} << 24u) | (std::uint32_t{block[4 * i + 1]} << 16u) |
+                   (std::uint32_t{block[4 * i + 2]} << 8u) | std::uint32_t{block[4 * i + 3]};
+        }
+        for(std::size_t i = 16; i < 64; i++)
+        {
+            auto s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3u);
+            auto s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10u);
+            w[i]    = w[i - 16] + s0 + w[i - 7] + s1;
+        }
+        auto v = state;
+        for(std::size_t i = 0; i < 64; i++)
+        {
+            auto s1 = rotr(v[4], 6) ^ rotr(v[4], 11) ^ rotr(v[4], 25);
+            auto ch = (v[4] & v[5]) ^ (~v[4] & v[6]);
+            auto t1 = v[7] + s1 + ch + k[i] + w[i];
+            auto s0 = rotr(v[0], 2) ^ rotr(v[0], 13) ^ rotr(v[0], 22);
+            auto mj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+            std::copy_backward(v.begin(), v.end() - 1, v.end());
+            v[4] += t1;
+            v[0] = t1 + s0 + mj;
+        }
+        for(std::size_t i = 0; i < 8; i++)
+            state[i] += v[i];
+    }
+
+    void update(const char* data, std::size_t n)
+    {
+        total += n;
+        for(std::size_t i = 0; i < n; i++)
+        {
+            block[used++] = static_cast<std::uint8_t>(data[i]);
+            if(used == block.size())
+            {
+                compress();
+                used = 0;
+            }
+        }
+    }
+
+    void update(const std::string& s)
+    {
+        // The size separates the strings, so their concatenation is not ambiguous
+        auto n = std::to_string(s.size()) + ":";
+        update(n.data(), n.size());
+        update(s.data(), s.size());
+    }
+
+    std::string hex_digest()
+    {
+        auto bits = total * 8;
+        const char one = static_cast<char>(0x80);
+        update(&one, 1);
+        const char zero = 0;
+        while(used != 56)
+            update(&zero, 1);
+        for(unsigned i = 0; i < 8; i++)
+        {
+            auto c = static_cast<char>(bits >> (56u - 8u * i));
+            update(&c, 1);
+        }
+        std::stringstream ss;
+        for(auto x : state)
+            ss << std::hex << std::setw(8) << std::setfill('0') << x;
+        return ss.str();
+    }
+};
+
+// Add the instructions of every module, with the data of the literals
+void update_program(sha256& h, const program& p)
+{
+    std::unordered_map<instruction_ref, std::size_t> ids;
+    for(const auto* mod : p.get_modules())
+    {
+        h.update(mod->name());
+        for(auto ins : iterator_for(*mod))
+        {
+            ids.emplace(ins, ids.size());
+            h.update(ins->name());
+            h.update(to_string(ins->get_shape()));
+            if(ins->name() == "@literal")
+            {
+                const auto& lit = ins->get_literal();
+                h.update(lit.data(), lit.get_shape().bytes());
+            }
+            else
+            {
+                h.update(to_string(ins->get_operator().to_value()));
+            }
+            for(auto input : ins->inputs())
+                h.update(std::to_string(ids.at(input)));
+            for(const auto* smod : ins->module_inputs())
+                h.update(smod->name());
+        }
+    }
+}
+
+// The MIGRAPHX_ variables in the environment, which can change how a program is compiled. The
+// variables of the cache itself and the tracing variables only change where the program is
+// stored or what is printed.
+std::vector<std::string> compile_env_vars()
+{
+#ifdef _WIN32
+    char** vars = _environ;
+#else
+    char** vars = environ;
+#endif
+    std::vector<std::string> result;
+    for(; vars != nullptr and *vars != nullptr; vars++) // NOLINT
+    {
+        std::string var = *vars;
+        if(not starts_with(var, "MIGRAPHX_") or starts_with(var, "MIGRAPHX_PROGRAM_CACHE_") or
+           starts_with(var, "MIGRAPHX_TRACE_"))
+            continue;
+        result.push_back(var);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+} // namespace
+
+program_cache::program_cache(fs::path cache_dir, std::size_t max_size)
+    : dir(std::move(cache_dir)), max_size(max_size)
+{
+    fs::create_directories(dir);
+}
+
+std::string program_cache::key(const program& p, const target& t, const compile_options& options)
+{
+    sha256 h;
+    update_program(h, p);
+    h.update(t.name());
+    // The context describes the device, such as the architecture and number of CUs of the gpu
+    h.update(to_string(t.get_context().to_value()));
+    for(const auto& var : compile_env_vars())
+        h.update(var);
+    h.update(std::to_string(options.offload_copy));
+    h.update(std::to_string(options.fast_math));
+    h.update(std::to_string(options.exhaustive_tune));
+    h.update(std::to_string(MIGRAPHX_VERSION_MAJOR));
+    h.update(std::to_string(MIGRAPHX_VERSION_MINOR));
+    h.update(std::to_string(MIGRAPHX_VERSION_PATCH));
+    h.update(std::string{MIGRAPHX_VERSION_TWEAK});
+    return t.name() + "-" + h.hex_digest();
+}
+
+fs::path program_cache::path(const std::string& key) const { return dir / (key + cache_extension); }
+
+bool program_cache::load(const std::string& key, program& p) const
+{
+    auto filename = path(key);
+    std::error_code ec;
+    if(not fs::exists(filename, ec))
+    {
+        misses++;
+        return false;
+    }
+    try
+    {
+        p = migraphx::load(filename.string(), file_options{"msgpack", true, key});
+    }
+    catch(const std::exception& e)
+    {
+        // A file from an incompatible version, or a broken file, is replaced on the next store
+        if(enabled(MIGRAPHX_TRACE_PROGRAM_CACHE{}))
+            std::cout << "program_cache: failed to load " << filename << ": " << e.what()
+                      << std::endl;
+        misses++;
+        return false;
+    }
+    // The modification time is used to find the least recently used programs
+    fs::last_write_time(filename, fs::file_time_type::clock::now(), ec);
+    if(enabled(MIGRAPHX_TRACE_PROGRAM_CACHE{}))
+        std::cout << "program_cache: loaded " << filename << std::endl;
+    hits++;
+    return true;
+}
+
+void program_cache::store(const std::string& key, const program& p) const
+{
+    auto tmp = dir / (unique_string("tmp") + cache_extension + ".tmp");
+    try
+    {
+        cache_lock lock{dir / ".lock"};
+        save(p, tmp.string(), file_options{"msgpack", true, key});
+        fs::rename(tmp, path(key));
+        stores++;
+        if(enabled(MIGRAPHX_TRACE_PROGRAM_CACHE{}))
+            std::cout << "program_cache: stored " << path(key) << std::endl;
+        evict(path(key));
+    }
+    catch(const std::exception& e)
+    {
+        // The program is still usable when it can't be cached
+        std::error_code ec;
+        fs::remove(tmp, ec);
+        if(enabled(MIGRAPHX_TRACE_PROGRAM_CACHE{}))
+            std::cout << "program_cache: failed to store " << path(key) << ": " << e.what()
+                      << std::endl;
+    }
+}
+
+// Remove the least recently used programs, other than the one that was just stored, until the
+// cache fits in the size limit. This is only called while holding the lock.
+void program_cache::evict(const fs::path& keep) const
+{
+    if(max_size == 0)
+        return;
+    struct entry
+    {
+        fs::path filename;
+        fs::file_time_type time;
+        std::size_t size = 0;
+    };
+    std::vector<entry> entries;
+    std::size_t total = 0;
+    std::error_code ec;
+    for(const auto& f : fs::directory_iterator(dir, ec))
+    {
+        if(f.path().extension() != cache_extension)
+            continue;
+        entry e{f.path(), fs::last_write_time(f.path(), ec), fs::file_size(f.path(), ec)};
+        if(ec)
+            continue;
+        total += e.size;
+        if(f.path() != keep)
+            entries.push_back(e);
+    }
+    std::sort(entries.begin(), entries.end(), [](const auto& x, const auto& y) {
+        return x.time < y.time;
+    });
+    for(const auto& e : entries)
+    {
+        if(total <= max_size)
+            break;
+        if(not fs::remove(e.filename, ec))
+            continue;
+        total -= e.size;
+        evictions++;
+    }
+}
+
+program_cache_stats program_cache::stats() const
+{
+    program_cache_stats result;
+    result.hits      = hits;
+    result.misses    = misses;
+    result.stores    = stores;
+    result.evictions = evictions;
+    return result;
+}
+
+program_cache* get_program_cache()
+{
+    static std::unique_ptr<program_cache> cache = []() -> std::unique_ptr<program_cache> {
+        auto cache_dir = string_value_of(MIGRAPHX_PROGRAM_CACHE_DIR{});
+        if(cache_dir.empty())
+            return nullptr;
+        auto max_size = value_of(MIGRAPHX_PROGRAM_CACHE_SIZE{}, 4096) * 1024 * 1024;
+        return std::make_unique<program_cache>(cache_dir, max_size);
+    }();
+    return cache.get();
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
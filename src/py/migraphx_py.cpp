@@ -26,6 +26,7 @@
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
 #include <migraphx/program.hpp>
+#include <migraphx/batch_executor.hpp>
 #include <migraphx/instruction_ref.hpp>
 #include <migraphx/operation.hpp>
 #include <migraphx/quantization.hpp>
@@ -34,6 +35,7 @@
 #include <migraphx/instruction.hpp>
 #include <migraphx/ref/target.hpp>
 #include <migraphx/stringutils.hpp>
+#include <migraphx/ranges.hpp>
 #include <migraphx/tf.hpp>
 #include <migraphx/onnx.hpp>
 #include <migraphx/load_save.hpp>
@@ -43,6 +45,7 @@
 #include <migraphx/op/common.hpp>
 #include <migraphx/float8.hpp>
 #include <migraphx/pass_manager.hpp>
+#include <cstring>
 #ifdef HAVE_GPU
 #include <migraphx/gpu/hip.hpp>
 #endif
@@ -255,6 +258,88 @@ migraphx::shape to_shape(const py::buffer_info& info)
     }
 }
 
+migraphx::parameter_map to_parameter_map(const py::dict& params)
+{
+    migraphx::parameter_map pm;
+    for(auto x : params)
+    {
+        std::string key      = x.first.cast<std::string>();
+        py::buffer b         = x.second.cast<py::buffer>();
+        py::buffer_info info = b.request();
+        pm[key]              = migraphx::argument(to_shape(info), info.ptr);
+    }
+    return pm;
+}
+
+// Names of the parameters that the outputs of the program are written to, which is empty for
+// the outputs that don't have a parameter
+std::vector<std::string> get_output_parameter_names(const migraphx::program& p)
+{
+    auto param_shapes = p.get_parameter_shapes();
+    std::vector<std::string> names(p.get_output_shapes().size());
+    for(std::size_t i = 0; i < names.size(); i++)
+    {
+        auto name = "main:#output_" + std::to_string(i);
+        if(migraphx::contains(param_shapes, name))
+            names[i] = name;
+        else if(names.size() == 1 and migraphx::contains(param_shapes, "output"))
+            names[i] = "output";
+    }
+    return names;
+}
+
+// Evaluates the program without holding the GIL. The outputs are written into the buffers in
+// outputs when it is not None: a program on the host writes them directly when it has output
+// parameters, otherwise the results are copied into them from wherever they are.
+std::vector<migraphx::argument> run_program(const migraphx::program& p,
+                                            const py::dict& params,
+                                            const py::object& outputs,
+                                            migraphx::execution_environment exec_env = {})
+{
+    auto pm = to_parameter_map(params);
+    std::vector<migraphx::argument> output_args;
+    if(not outputs.is_none())
+    {
+        for(auto x : outputs.cast<py::sequence>())
+        {
+            py::buffer_info info = x.cast<py::buffer>().request(true);
+            output_args.emplace_back(to_shape(info), info.ptr);
+        }
+        auto output_names = get_output_parameter_names(p);
+        if(output_args.size() != output_names.size())
+            MIGRAPHX_THROW("MIGRAPHX PYTHON: expected " + std::to_string(output_names.size()) +
+                           " output buffers but got " + std::to_string(output_args.size()));
+        // The output parameters of the targets that use device memory need device buffers
+        if(p.uses_host_memory())
+        {
+            for(std::size_t i = 0; i < output_names.size(); i++)
+            {
+                if(not output_names[i].empty())
+                    pm[output_names[i]] = output_args[i];
+            }
+        }
+    }
+    py::gil_scoped_release release;
+    auto results = p.eval(pm, exec_env);
+    for(std::size_t i = 0; i < output_args.size(); i++)
+    {
+        // The result was written into the buffer
+        if(results[i].data() == output_args[i].data())
+        {
+            results[i] = output_args[i];
+            continue;
+        }
+        if(output_args[i].get_shape() != results[i].get_shape())
+            MIGRAPHX_THROW("MIGRAPHX PYTHON: output buffer " + std::to_string(i) + " has shape " +
+                           migraphx::to_string(output_args[i].get_shape()) + " but should be " +
+                           migraphx::to_string(results[i].get_shape()));
+        auto result = p.copy_to_host(results[i]);
+        std::memcpy(output_args[i].data(), result.data(), result.get_shape().bytes());
+        results[i] = output_args[i];
+    }
+    return results;
+}
+
 MIGRAPHX_PYBIND11_MODULE(migraphx, m)
 {
     py::class_<migraphx::shape> shape_cls(m, "shape");
@@ -395,41 +480,72 @@ MIGRAPHX_PYBIND11_MODULE(migraphx, m)
             "create_module",
             [](migraphx::program& p, const std::string& name) { return p.create_module(name); },
             py::arg("name"))
-        .def("run",
-             [](migraphx::program& p, py::dict params) {
-                 migraphx::parameter_map pm;
-                 for(auto x : params)
-                 {
-                     std::string key      = x.first.cast<std::string>();
-                     py::buffer b         = x.second.cast<py::buffer>();
-                     py::buffer_info info = b.request();
-                     pm[key]              = migraphx::argument(to_shape(info), info.ptr);
-                 }
-                 return p.eval(pm);
-             })
-        .def("run_async",
-             [](migraphx::program& p,
-                py::dict params,
-                std::uintptr_t stream,
-                std::string stream_name) {
-                 migraphx::parameter_map pm;
-                 for(auto x : params)
-                 {
-                     std::string key      = x.first.cast<std::string>();
-                     py::buffer b         = x.second.cast<py::buffer>();
-                     py::buffer_info info = b.request();
-                     pm[key]              = migraphx::argument(to_shape(info), info.ptr);
-                 }
-                 migraphx::execution_environment exec_env{
-                     migraphx::any_ptr(reinterpret_cast<void*>(stream), stream_name), true};
-                 return p.eval(pm, exec_env);
-             })
+        .def(
+            "run",
+            [](const migraphx::program& p, py::dict params, py::object outputs) {
+                return run_program(p, params, outputs);
+            },
+            "Runs the program and returns its outputs. The GIL is released while the program "
+            "runs, so other python threads can run the same program at the same time. The "
+            "outputs are written into the buffers in outputs when it is given. The cpu target "
+            "writes them directly, and the results of the other targets are copied into them. "
+            "The buffers of the parameters and outputs are not copied, so they must not be "
+            "modified by other threads until the call returns.",
+            py::arg("params"),
+            py::arg("outputs") = py::none())
+        .def(
+            "run_async",
+            [](const migraphx::program& p,
+               py::dict params,
+               std::uintptr_t stream,
+               std::string stream_name,
+               py::object outputs) {
+                migraphx::execution_environment exec_env{
+                    migraphx::any_ptr(reinterpret_cast<void*>(stream), stream_name), true};
+                return run_program(p, params, outputs, exec_env);
+            },
+            py::arg("params"),
+            py::arg("stream"),
+            py::arg("stream_name"),
+            py::arg("outputs") = py::none())
         .def("sort", &migraphx::program::sort)
         .def("print", [](const migraphx::program& p) { std::cout << p << std::endl; })
         .def("__eq__", std::equal_to<migraphx::program>{})
         .def("__ne__", std::not_equal_to<migraphx::program>{})
         .def("__repr__", [](const migraphx::program& p) { return migraphx::to_string(p); });
 
+    py::class_<migraphx::batch_executor_stats>(m, "batch_executor_stats")
+        .def_readonly("requests", &migraphx::batch_executor_stats::requests)
+        .def_readonly("batches", &migraphx::batch_executor_stats::batches)
+        .def_readonly("rows", &migraphx::batch_executor_stats::rows)
+        .def_readonly("padded_rows", &migraphx::batch_executor_stats::padded_rows)
+        .def_readonly("queue_depth", &migraphx::batch_executor_stats::queue_depth)
+        .def_readonly("max_queue_depth", &migraphx::batch_executor_stats::max_queue_depth)
+        .def_readonly("queue_time_us", &migraphx::batch_executor_stats::queue_time_us);
+
+    py::class_<migraphx::batch_executor>(m, "batch_executor")
+        .def(py::init([](const migraphx::program& p, std::size_t batch, std::size_t latency) {
+                 migraphx::batch_executor_options options;
+                 options.max_batch   = batch;
+                 options.max_latency = std::chrono::microseconds{latency};
+                 return migraphx::batch_executor{p, options};
+             }),
+             py::arg("p"),
+             py::arg("max_batch")   = 0,
+             py::arg("max_latency") = 1000)
+        .def("run",
+             [](const migraphx::batch_executor& be, py::dict params) {
+                 auto pm = to_parameter_map(params);
+                 // Other python threads must be able to submit to the same batch
+                 py::gil_scoped_release release;
+                 return be.run(pm);
+             },
+             "Runs the parameters as part of a batch and waits for the result. The buffers of "
+             "the parameters are not copied, so they must not be modified by other threads until "
+             "the call returns.")
+        .def("batch_sizes", &migraphx::batch_executor::batch_sizes)
+        .def("stats", &migraphx::batch_executor::stats);
+
     py::class_<migraphx::operation> op(m, "op");
     op.def(py::init([](const std::string& name, py::kwargs kwargs) {
           migraphx::value v = migraphx::value::object{};
@@ -577,12 +693,39 @@ MIGRAPHX_PYBIND11_MODULE(migraphx, m)
           &migraphx::quantize_fp16,
           py::arg("prog"),
           py::arg("ins_names") = std::vector<std::string>{"all"});
-    m.def("quantize_int8",
-          &migraphx::quantize_int8,
+    m.def("quantize_weights_int8",
+          &migraphx::quantize_weights_int8,
+          py::arg("prog"),
+          py::arg("group_size") = 128);
+    m.def("quantize_weights_int4",
+          &migraphx::quantize_weights_int4,
           py::arg("prog"),
-          py::arg("t"),
-          py::arg("calibration") = std::vector<migraphx::parameter_map>{},
-          py::arg("ins_names")   = std::unordered_set<std::string>{"dot", "convolution"});
+          py::arg("group_size") = 128);
+    m.def(
+        "quantize_int8",
+        [](migraphx::program& prog,
+           const migraphx::target& t,
+           const std::vector<migraphx::parameter_map>& calibration,
+           const std::unordered_set<std::string>& ins_names,
+           const std::string& calibration_method,
+           float percentile,
+           bool per_channel,
+           std::size_t jobs) {
+            migraphx::calibration_options options;
+            options.method      = calibration_method;
+            options.percentile  = percentile;
+            options.per_channel = per_channel;
+            options.jobs        = jobs;
+            migraphx::quantize_int8(prog, t, calibration, ins_names, options);
+        },
+        py::arg("prog"),
+        py::arg("t"),
+        py::arg("calibration")        = std::vector<migraphx::parameter_map>{},
+        py::arg("ins_names")          = std::unordered_set<std::string>{"dot", "convolution"},
+        py::arg("calibration_method") = "max",
+        py::arg("percentile")         = 99.99f,
+        py::arg("per_channel")        = false,
+        py::arg("jobs")               = 0);
     m.def(
         "autocast_fp8",
         [](migraphx::program& prog) {
@@ -26,6 +26,7 @@
 #include <migraphx/quantization.hpp>
 #include <migraphx/quantize_fp16.hpp>
 #include <migraphx/quantize_8bits.hpp>
+#include <migraphx/quantize_weights.hpp>
 #include <migraphx/simplify_reshapes.hpp>
 #include <migraphx/simplify_qdq.hpp>
 #include <migraphx/eliminate_common_subexpression.hpp>
@@ -41,6 +42,7 @@
 #include <migraphx/make_op.hpp>
 #include <migraphx/pass_manager.hpp>
 #include <migraphx/normalize_ops.hpp>
+#include <migraphx/thread_pool.hpp>
 #include <set>
 
 namespace migraphx {
@@ -62,58 +64,64 @@ void quantize_fp16(program& prog, const std::vector<std::string>& ins_names)
                 optimize_module{{"quantizelinear", "dequantizelinear"}}});
 }
 
+// Run optimize_module() first so the weights that are computed from constants are folded into
+// the literals that are quantized.
+static void quantize_weights(program& prog, std::size_t bits, std::size_t group_size)
+{
+    run_passes(prog,
+               {normalize_ops{},
+                optimize_module{},
+                quantize_weights_pass{bits, group_size},
+                dead_code_elimination{}});
+}
+
+void quantize_weights_int8(program& prog, std::size_t group_size)
+{
+    quantize_weights(prog, 8, group_size);
+}
+
+void quantize_weights_int4(program& prog, std::size_t group_size)
+{
+    quantize_weights(prog, 4, group_size);
+}
+
 void quantize_8bits(program& prog,
                     const target& t,
                     shape::type_t precision,
                     const std::vector<parameter_map>& calibration,
-                    const std::unordered_set<std::string>& ins_names)
+                    const std::unordered_set<std::string>& ins_names,
+                    const calibration_options& options)
 {
     // Run optimize_module() before converting to int8/fp8 to const eval and fold in FP32 to
     // avoid loss of precision.
     run_passes(prog, {normalize_ops{}, optimize_module{}});
 
-    std::shared_ptr<std::vector<std::pair<float, float>>> quant_8bit_params =
-        std::make_shared<std::vector<std::pair<float, float>>>();
-    std::shared_ptr<std::vector<float>> max_abs_vals = std::make_shared<std::vector<float>>();
-
-    float quantized_range  = (precision == shape::type_t::int8_type) ? 127.0 : 240.0;
+    // The statistics are computed in place on the captured arguments, which are only copied
+    // when they don't live on the host
+    std::unique_ptr<calibrator> stats = nullptr;
     auto calc_quant_params = [&](std::size_t ins_index, std::vector<argument> args) {
-        std::pair<float, float> param_pair{64.0f, 0.0f};
-        // scale and shift is need for only int8 type, and we do not
-        // consider shift, so set shift to 0
-        std::vector<float> vec_val;
-        argument arg = t.copy_from(args.front());
-        arg.visit([&](auto output) { vec_val.assign(output.begin(), output.end()); });
-        auto max_val                = *std::max_element(vec_val.begin(), vec_val.end());
-        auto min_val                = *std::min_element(vec_val.begin(), vec_val.end());
-        auto max_abs                = std::max(std::fabs(max_val), std::fabs(min_val));
-        max_abs_vals->at(ins_index) = std::max(max_abs_vals->at(ins_index), max_abs);
-        // if all values are 0, no need to do scaling
-        if(float_equal(max_abs_vals->at(ins_index), 0.0f))
-        {
-            param_pair.first = 1.0f;
-        }
-        else
-        {
-            param_pair.first = quantized_range / max_abs_vals->at(ins_index);
-        }
-        quant_8bit_params->at(ins_index) = param_pair;
+        stats->add(ins_index, t.copy_from(args.front()));
     };
 
     // pass to add capture argument op
     std::size_t param_num = 0;
     run_passes(prog, {capture_arguments_pass{ins_names, calc_quant_params, &param_num}});
-    quant_8bit_params->resize(param_num, std::pair<float, float>(64.0f, 0.0f));
-    max_abs_vals->resize(param_num, 0.0f);
+    stats = std::make_unique<calibrator>(param_num, precision, options.method, options.percentile);
 
     // use the calibration data to compute the quantization scale
     auto capture_prog = prog;
     capture_prog.compile(t);
 
+    // Evaluate several batches at once. The host targets give each concurrent eval its own
+    // buffers, while the contexts of the other targets share their scratch memory.
+    std::size_t jobs = options.jobs;
+    if(jobs == 0)
+        jobs = contains({"ref", "cpu"}, t.name()) ? get_thread_pool().size() : 1;
+
     // use all calibration data to run the program to calculate the
     // quantization scale and shift
-    for(auto&& arg : calibration)
-    {
+    get_thread_pool().run(calibration.size(), jobs, [&](std::size_t i, std::size_t) {
+        const auto& arg = calibration[i];
         parameter_map m;
         for(auto&& x : capture_prog.get_parameter_shapes())
         {
@@ -128,14 +136,15 @@ void quantize_8bits(program& prog,
             }
         }
         capture_prog.eval(m);
-    }
+    });
+    auto quant_8bit_params = stats->quant_params();
 
     // print the quantization parameters in only the main module
     if(enabled(MIGRAPHX_8BITS_QUANTIZATION_PARAMS{}))
     {
-        for(std::size_t i = 0; i < quant_8bit_params->size(); ++i)
+        for(std::size_t i = 0; i < quant_8bit_params.size(); ++i)
         {
-            auto param = quant_8bit_params->at(i);
+            auto param = quant_8bit_params.at(i);
             std::cout << "ins_index = " << i << ", scale = " << param.first
                       << ", shift = " << param.second << std::endl;
         }
@@ -143,7 +152,7 @@ void quantize_8bits(program& prog,
     }
 
     run_passes(prog,
-               {quantize_8bits_pass{precision, *quant_8bit_params},
+               {quantize_8bits_pass{precision, quant_8bit_params, options.per_channel},
                 simplify_qdq{},
                 optimize_module{},
                 dead_code_elimination{}});
@@ -152,17 +161,21 @@ void quantize_8bits(program& prog,
 void quantize_int8(program& prog,
                    const target& t,
                    const std::vector<parameter_map>& calibration,
-                   const std::unordered_set<std::string>& ins_names)
+                   const std::unordered_set<std::string>& ins_names,
+                   const calibration_options& options)
 {
     std::unordered_set<std::string> op_names = {"convolution", "dot"};
     if(op_names != ins_names)
     {
         MIGRAPHX_THROW("QUANTIZE_INT8: only support DOT and CONVOLUTION operation");
     }
-    quantize_8bits(prog, t, shape::int8_type, calibration, ins_names);
+    quantize_8bits(prog, t, shape::int8_type, calibration, ins_names, options);
 }
 
-void quantize_fp8(program& prog, const target& t, const std::vector<parameter_map>& calibration)
+void quantize_fp8(program& prog,
+                  const target& t,
+                  const std::vector<parameter_map>& calibration,
+                  const calibration_options& options)
 {
     std::cout << "[Warning] : MIGraphX has BETA support for FP8. Using FP8 may result in "
                  "incorrect final outputs\n";
@@ -180,7 +193,8 @@ void quantize_fp8(program& prog, const target& t, const std::vector<parameter_ma
             supported_ins_names.insert(ins->name());
         }
     }
-    quantize_8bits(prog, t, shape::fp8e4m3fnuz_type, calibration, supported_ins_names);
+    quantize_8bits(
+        prog, t, shape::fp8e4m3fnuz_type, calibration, supported_ins_names, options);
 }
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
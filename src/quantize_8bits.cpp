@@ -35,6 +35,12 @@
 #include <migraphx/target.hpp>
 #include <migraphx/make_op.hpp>
 #include <migraphx/pass_manager.hpp>
+#include <migraphx/strided_for_each.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <mutex>
 #include <numeric>
 #include <set>
 
@@ -48,6 +54,94 @@ static std::vector<shape::type_t>& get_quantizable_type()
     return quantable_types;
 }
 
+static float quantized_range(shape::type_t precision)
+{
+    return (precision == shape::int8_type) ? 127.0f : 240.0f;
+}
+
+// Calls f(x, stride, n) for each run of n elements x[0], x[stride], ... of the tensor at data
+template <class T, class F>
+static void for_each_run(const T* data,
+                         const std::vector<std::size_t>& lens,
+                         const std::vector<std::size_t>& strides,
+                         F f)
+{
+    const detail::strided_dims<1> dims{lens, {&strides}};
+    auto run = [&](const std::array<std::size_t, 1>& base,
+                   const std::array<std::size_t, 1>& stride,
+                   std::size_t first,
+                   std::size_t last) {
+        f(data + base[0] + first * stride[0], stride[0], last - first);
+    };
+    detail::strided_for_each_run(dims, 0, dims.elements(), run);
+}
+
+// Fold the largest absolute value of the n elements x[0], x[stride], ... into m. Several
+// accumulators are used so the iterations don't depend on each other.
+template <class T>
+static double max_abs_run(const T* x, std::size_t stride, std::size_t n, double m)
+{
+    std::array<double, 4> ms = {m, 0, 0, 0};
+    std::size_t j            = 0;
+    for(; j + ms.size() <= n; j += ms.size())
+    {
+        for(std::size_t k = 0; k < ms.size(); k++)
+            ms[k] = std::max(ms[k], std::fabs(static_cast<double>(x[(j + k) * stride])));
+    }
+    for(; j < n; j++)
+        ms[0] = std::max(ms[0], std::fabs(static_cast<double>(x[j * stride])));
+    return std::max(std::max(ms[0], ms[1]), std::max(ms[2], ms[3]));
+}
+
+// The axis of the output channels when the captured argument is the constant weight of a dot or
+// a convolution, or -1 otherwise
+static int weight_channel_axis(instruction_ref capture)
+{
+    auto input = capture->inputs().front();
+    if(capture->outputs().empty() or not input->can_eval())
+        return -1;
+    std::set<int> axes;
+    for(auto output : capture->outputs())
+    {
+        if(output->inputs().size() < 2 or output->inputs()[1] != capture)
+            return -1;
+        if(output->name() == "convolution")
+            axes.insert(0);
+        else if(output->name() == "dot")
+            axes.insert(static_cast<int>(input->get_shape().ndim()) - 1);
+        else
+            return -1;
+    }
+    if(axes.size() != 1)
+        return -1;
+    return *axes.begin();
+}
+
+// The scales that quantize each slice of the constant weight along axis to the full range
+static std::vector<float>
+channel_scales(instruction_ref weight, std::size_t axis, shape::type_t precision)
+{
+    auto s    = weight->get_shape();
+    auto lens = s.lens();
+    std::vector<float> scales(lens[axis], 1.0f);
+    weight->eval().visit([&](auto x) {
+        auto strides = s.strides();
+        auto stride  = strides[axis];
+        lens.erase(lens.begin() + axis);
+        strides.erase(strides.begin() + axis);
+        for(std::size_t c = 0; c < scales.size(); c++)
+        {
+            double m = 0;
+            for_each_run(x.data() + c * stride, lens, strides, [&](auto p, auto st, auto n) {
+                m = max_abs_run(p, st, n, m);
+            });
+            if(not float_equal(m, 0.0))
+                scales[c] = m / quantized_range(precision);
+        }
+    });
+    return scales;
+}
+
 void quantize_8bits_pass::apply(module& m) const // NOLINT
 {
     const auto& quantizable_types = get_quantizable_type();
@@ -68,10 +162,22 @@ void quantize_8bits_pass::apply(module& m) const // NOLINT
         {
             auto zero_point =
                 m.add_literal(migraphx::literal{migraphx::shape{precision}, {param.second}});
-            auto scale       = m.add_literal(literal({s.type()}, {1.0f / param.first}));
             const auto& lens = s.lens();
-            scale =
-                m.insert_instruction(ins, make_op("multibroadcast", {{"out_lens", lens}}), scale);
+            auto axis        = per_channel ? weight_channel_axis(ins) : -1;
+            instruction_ref scale;
+            if(axis >= 0)
+            {
+                auto scales = channel_scales(input, axis, precision);
+                scale       = m.add_literal(literal({s.type(), {scales.size()}}, scales));
+                scale       = m.insert_instruction(
+                    ins, make_op("broadcast", {{"axis", axis}, {"out_lens", lens}}), scale);
+            }
+            else
+            {
+                scale = m.add_literal(literal({s.type()}, {1.0f / param.first}));
+                scale = m.insert_instruction(
+                    ins, make_op("multibroadcast", {{"out_lens", lens}}), scale);
+            }
             zero_point = m.insert_instruction(
                 ins, make_op("multibroadcast", {{"out_lens", lens}}), zero_point);
             auto q_in =
@@ -113,5 +219,208 @@ void capture_arguments_pass::apply(module& m) const // NOLINT
     }
 }
 
+// The statistics of one captured argument over the calibration data
+struct calibration_stats
+{
+    std::mutex mutex;
+    std::size_t samples = 0;
+    double max_abs      = 0;
+    // Histogram of the absolute values, where bin i counts the values in [i * width, (i + 1) *
+    // width) and the last bin also counts the values above it
+    std::vector<std::uint64_t> bins;
+    double width = 0;
+    // Number of zeros added before the width of the bins is known
+    std::uint64_t zeros = 0;
+};
+
+struct calibrator_impl
+{
+    static constexpr std::size_t nbins = 2048;
+
+    shape::type_t precision;
+    std::string method;
+    float percentile;
+    std::vector<calibration_stats> stats;
+
+    calibrator_impl(std::size_t n, shape::type_t p, std::string m, float pct)
+        : precision(p), method(std::move(m)), percentile(pct), stats(n)
+    {
+    }
+
+    bool use_histogram() const { return method != "max"; }
+
+    // The smallest power of two that is larger than m / nbins. The width of the bins only depends
+    // on the largest value, and not on the order the arguments are added in, since the bins are
+    // widened by doubling them.
+    static double bin_width(double m)
+    {
+        int e = 0;
+        std::frexp(m / nbins, &e);
+        return std::ldexp(1.0, e);
+    }
+
+    // Widen the bins until the histogram covers m, doubling the width so the bins of the
+    // histograms built with an older width can still be merged
+    static double fit(calibration_stats& st, double m)
+    {
+        if(float_equal(m, 0.0))
+            return st.width;
+        if(st.bins.empty())
+        {
+            st.width = bin_width(m);
+            st.bins.assign(nbins, 0);
+            st.bins.front() += st.zeros;
+            st.zeros = 0;
+            return st.width;
+        }
+        while(m >= st.width * nbins)
+        {
+            for(std::size_t i = 0; i < nbins / 2; i++)
+                st.bins[i] = st.bins[2 * i] + st.bins[2 * i + 1];
+            std::fill(st.bins.begin() + nbins / 2, st.bins.end(), 0);
+            st.width *= 2;
+        }
+        return st.width;
+    }
+
+    template <class T>
+    void add(calibration_stats& st, tensor_view<T> x) const
+    {
+        const auto& s = x.get_shape();
+        double m      = 0;
+        for_each_run(x.data(), s.lens(), s.strides(), [&](auto p, auto stride, auto n) {
+            m = max_abs_run(p, stride, n, m);
+        });
+        double width = 0;
+        {
+            std::lock_guard<std::mutex> lock(st.mutex);
+            st.samples++;
+            st.max_abs = std::max(st.max_abs, m);
+            if(not use_histogram())
+                return;
+            width = fit(st, m);
+            if(st.bins.empty())
+            {
+                st.zeros += s.elements();
+                return;
+            }
+        }
+        // The histogram of this argument is built outside of the lock, and other threads may
+        // widen the bins meanwhile
+        std::vector<std::uint64_t> local(nbins);
+        for_each_run(x.data(), s.lens(), s.strides(), [&](auto p, auto stride, auto n) {
+            for(std::size_t j = 0; j < n; j++)
+            {
+                auto b = std::fabs(static_cast<double>(p[j * stride])) / width;
+                local[b < nbins ? static_cast<std::size_t>(b) : nbins - 1]++;
+            }
+        });
+        std::lock_guard<std::mutex> lock(st.mutex);
+        auto factor = static_cast<std::size_t>(std::lround(st.width / width));
+        for(std::size_t i = 0; i < nbins; i++)
+            st.bins[i / factor] += local[i];
+    }
+
+    double percentile_threshold(const calibration_stats& st) const
+    {
+        auto total  = std::accumulate(st.bins.begin(), st.bins.end(), std::uint64_t{0});
+        auto target = total * std::min(percentile, 100.0f) / 100.0;
+        std::uint64_t count = 0;
+        for(std::size_t i = 0; i < nbins; i++)
+        {
+            count += st.bins[i];
+            if(count >= target)
+                return (i + 1) * st.width;
+        }
+        return st.max_abs;
+    }
+
+    // The rounding step of a value c when the range [0, t] is quantized. The steps of int8 are
+    // uniform, while fp8 keeps three bits of mantissa.
+    double quantization_step(double c, double t) const
+    {
+        auto range = quantized_range(precision);
+        if(precision == shape::int8_type)
+            return t / range;
+        auto e = std::max(std::floor(std::log2(std::max(c * range / t, 1e-30))), -7.0);
+        return std::ldexp(1.0, static_cast<int>(e) - 3) * t / range;
+    }
+
+    // The threshold with the smallest squared error, counting the error of clipping the values
+    // above it and of rounding the values below it
+    double mse_threshold(const calibration_stats& st) const
+    {
+        double best      = std::numeric_limits<double>::max();
+        double threshold = st.max_abs;
+        for(std::size_t i = 7; i < nbins; i += 8)
+        {
+            double t   = (i + 1) * st.width;
+            double err = 0;
+            for(std::size_t j = 0; j < nbins; j++)
+            {
+                if(st.bins[j] == 0)
+                    continue;
+                double c = (j + 0.5) * st.width;
+                double d = c > t ? c - t : quantization_step(c, t) / std::sqrt(12.0);
+                err += st.bins[j] * d * d;
+            }
+            if(err < best)
+            {
+                best      = err;
+                threshold = t;
+            }
+        }
+        return threshold;
+    }
+
+    std::pair<float, float> quant_param(const calibration_stats& st) const
+    {
+        // Arguments that were never captured keep the default scale
+        if(st.samples == 0)
+            return {64.0f, 0.0f};
+        double t = st.max_abs;
+        if(not st.bins.empty())
+        {
+            if(method == "percentile")
+                t = std::min(t, percentile_threshold(st));
+            else if(method == "mse")
+                t = std::min(t, mse_threshold(st));
+        }
+        // scale and shift is need for only int8 type, and we do not consider shift, so set
+        // shift to 0. If all values are 0, no need to do scaling.
+        if(float_equal(t, 0.0))
+            return {1.0f, 0.0f};
+        return {quantized_range(precision) / t, 0.0f};
+    }
+};
+
+calibrator::calibrator(std::size_t n,
+                       shape::type_t precision,
+                       const std::string& method,
+                       float percentile)
+    : impl(std::make_unique<calibrator_impl>(n, precision, method, percentile))
+{
+    if(not contains({"max", "percentile", "mse"}, method))
+        MIGRAPHX_THROW("CALIBRATOR: unknown calibration method: " + method);
+}
+
+calibrator::~calibrator() = default;
+
+void calibrator::add(std::size_t ins_index, const argument& arg)
+{
+    if(ins_index >= impl->stats.size())
+        MIGRAPHX_THROW("CALIBRATOR: invalid instruction index " + std::to_string(ins_index));
+    arg.visit([&](auto x) { impl->add(impl->stats[ins_index], x); });
+}
+
+std::vector<std::pair<float, float>> calibrator::quant_params() const
+{
+    std::vector<std::pair<float, float>> result;
+    result.reserve(impl->stats.size());
+    for(const auto& st : impl->stats)
+        result.push_back(impl->quant_param(st));
+    return result;
+}
+
 } // namespace MIGRAPHX_INLINE_NS
 } // namespace migraphx
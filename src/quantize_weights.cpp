@@ -0,0 +1,203 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/quantize_weights.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+// The quantized weights with the scales and zero points of each group of rows of every column
+struct quantized_weights
+{
+    std::vector<int> q;
+    std::vector<double> scales;
+    std::vector<int> zero_points;
+};
+
+// Asymmetric quantization of each group to [qmin, qmax]. The range of a group always includes
+// zero so that zero is represented exactly.
+static quantized_weights
+quantize_groups(const argument& w, std::size_t group_size, int qmin, int qmax)
+{
+    auto k = w.get_shape().lens()[0];
+    auto n = w.get_shape().lens()[1];
+    quantized_weights result;
+    result.q.resize(k * n);
+    result.scales.resize(k / group_size * n);
+    result.zero_points.resize(k / group_size * n);
+    w.visit([&](auto x) {
+        for(std::size_t g = 0; g < k / group_size; g++)
+        {
+            for(std::size_t j = 0; j < n; j++)
+            {
+                double lo = 0;
+                double hi = 0;
+                for(std::size_t i = g * group_size; i < (g + 1) * group_size; i++)
+                {
+                    auto v = static_cast<double>(x(i, j));
+                    lo     = std::min(lo, v);
+                    hi     = std::max(hi, v);
+                }
+                double scale = (hi - lo) / (qmax - qmin);
+                if(scale == 0)
+                    scale = 1;
+                auto zp = static_cast<int>(std::clamp<double>(
+                    std::nearbyint(qmin - lo / scale), qmin, qmax));
+                result.scales[g * n + j]      = scale;
+                result.zero_points[g * n + j] = zp;
+                for(std::size_t i = g * group_size; i < (g + 1) * group_size; i++)
+                {
+                    auto v              = std::nearbyint(static_cast<double>(x(i, j)) / scale) + zp;
+                    result.q[i * n + j] = static_cast<int>(std::clamp<double>(v, qmin, qmax));
+                }
+            }
+        }
+    });
+    return result;
+}
+
+// Pack pairs of rows into one byte with the even row in the low 4 bits, as done by pack_int4
+// along the first axis
+static std::vector<uint8_t> pack_rows(const std::vector<int>& q, std::size_t k, std::size_t n)
+{
+    std::vector<uint8_t> packed(k / 2 * n);
+    for(std::size_t i = 0; i < k / 2; i++)
+    {
+        for(std::size_t j = 0; j < n; j++)
+        {
+            auto lo           = static_cast<uint8_t>(q[2 * i * n + j]);
+            auto hi           = static_cast<uint8_t>(q[(2 * i + 1) * n + j]);
+            packed[i * n + j] = static_cast<uint8_t>((hi << 4u) | (lo & 0x0Fu));
+        }
+    }
+    return packed;
+}
+
+void quantize_weights_pass::apply(module& m) const
+{
+    if(bits != 4 and bits != 8)
+        MIGRAPHX_THROW("QUANTIZE_WEIGHTS: only 4 and 8 bits are supported");
+    const std::vector<shape::type_t> quantizable_types = {
+        shape::float_type, shape::double_type, shape::half_type};
+    for(auto ins : iterator_for(m))
+    {
+        if(ins->name() != "dot")
+            continue;
+        auto a = ins->inputs().front();
+        auto w = ins->inputs().back();
+        // Weights shared by the batches of A are broadcasted
+        if(w->name() == "multibroadcast")
+            w = w->inputs().front();
+        const auto& ws = w->get_shape();
+        if(ws.ndim() != 2 or not w->can_eval() or not contains(quantizable_types, ws.type()))
+            continue;
+        auto k = ws.lens()[0];
+        auto n = ws.lens()[1];
+        auto g = std::min(group_size, k);
+        if(k % g != 0 or (bits == 4 and k % 2 != 0))
+            continue;
+
+        auto qw = quantize_groups(w->eval(), g, bits == 4 ? 0 : -128, bits == 4 ? 15 : 127);
+        shape qparam_shape{a->get_shape().type(), {k / g, n}};
+        auto scales = m.add_literal(literal{qparam_shape, qw.scales});
+        instruction_ref qweights;
+        instruction_ref zero_points;
+        if(bits == 4)
+        {
+            qweights =
+                m.add_literal(literal{{shape::uint8_type, {k / 2, n}}, pack_rows(qw.q, k, n)});
+            zero_points = m.add_literal(literal{{shape::uint8_type, {k / g, n}}, qw.zero_points});
+        }
+        else
+        {
+            qweights    = m.add_literal(literal{{shape::int8_type, {k, n}}, qw.q});
+            zero_points = m.add_literal(literal{{shape::int8_type, {k / g, n}}, qw.zero_points});
+        }
+        if(not a->get_shape().standard())
+            a = m.insert_instruction(ins, make_op("contiguous"), a);
+        m.replace_instruction(ins,
+                              make_op("dequant_dot", {{"group_size", g}, {"bits", bits}}),
+                              a,
+                              qweights,
+                              scales,
+                              zero_points);
+    }
+}
+
+// Repeat each row of the quantization parameters for the rows of its group
+static instruction_ref
+expand_groups(module& m, instruction_ref ins, instruction_ref qparam, std::size_t group_size)
+{
+    auto lens = qparam->get_shape().lens();
+    auto x    = m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {1}}}), qparam);
+    x         = m.insert_instruction(
+        ins, make_op("multibroadcast", {{"out_lens", {lens[0], group_size, lens[1]}}}), x);
+    x = m.insert_instruction(ins, make_op("contiguous"), x);
+    return m.insert_instruction(
+        ins, make_op("reshape", {{"dims", {lens[0] * group_size, lens[1]}}}), x);
+}
+
+void rewrite_dequant_dot::apply(module& m) const
+{
+    bool rewritten = false;
+    for(auto ins : iterator_for(m))
+    {
+        if(ins->name() != "dequant_dot")
+            continue;
+        rewritten = true;
+        auto v          = ins->get_operator().to_value();
+        auto group_size = v.at("group_size").to<std::size_t>();
+        auto a          = ins->inputs()[0];
+        auto w          = ins->inputs()[1];
+        if(v.at("bits").to<std::size_t>() == 4)
+            w = m.insert_instruction(ins, make_op("unpack_int4", {{"axis", 0}}), w);
+        auto scales      = expand_groups(m, ins, ins->inputs()[2], group_size);
+        auto zero_points = expand_groups(m, ins, ins->inputs()[3], group_size);
+        auto dq = m.insert_instruction(ins, make_op("dequantizelinear"), w, scales, zero_points);
+        auto lens = a->get_shape().lens();
+        if(lens.size() > 2)
+        {
+            lens[lens.size() - 2] = dq->get_shape().lens()[0];
+            lens.back()           = dq->get_shape().lens()[1];
+            dq = m.insert_instruction(ins, make_op("multibroadcast", {{"out_lens", lens}}), dq);
+        }
+        m.replace_instruction(ins, make_op("dot"), a, dq);
+    }
+    // The dequantized weights only depend on literals, so constant folding stores them as floats
+    if(rewritten)
+        std::cout << "[Warning] : dequant_dot is not supported natively by this target. The "
+                     "quantized weights will be dequantized when compiling and stored in full "
+                     "precision.\n";
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -23,6 +23,7 @@
  */
 #include <migraphx/rewrite_rnn.hpp>
 #include <migraphx/program.hpp>
+#include <migraphx/pass_manager.hpp>
 #include <migraphx/instruction.hpp>
 #include <migraphx/op/add.hpp>
 #include <migraphx/op/broadcast.hpp>
@@ -50,28 +51,183 @@
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 
-void rewrite_rnn::apply(module& m) const
+void rewrite_rnn::apply(module_pass_manager& mpm) const
 {
-    for(auto ins : iterator_for(m))
+    for(auto ins : iterator_for(mpm.get_module()))
     {
         if(ins->name() == "rnn")
         {
-            apply_vanilla_rnn(m, ins);
+            apply_vanilla_rnn(mpm, ins);
         }
         else if(ins->name() == "gru")
         {
-            apply_gru(m, ins);
+            apply_gru(mpm, ins);
         }
         else if(ins->name() == "lstm")
         {
-            apply_lstm(m, ins);
+            apply_lstm(mpm, ins);
         }
     }
 }
 
+instruction_ref rewrite_rnn::input_projection(module& m,
+                                              instruction_ref ins,
+                                              instruction_ref seq,
+                                              instruction_ref w,
+                                              instruction_ref bias,
+                                              long seq_len) const
+{
+    // multiply the input of all of the timesteps with the transposed w in one dot
+    auto seq_lens = seq->get_shape().lens();
+    long n        = w->get_shape().lens()[1];
+    long bs       = seq_lens[1];
+    long is       = seq_lens[2];
+    auto sw       = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), w);
+    auto tw = m.insert_instruction(ins, make_op("transpose", {{"permutation", {1, 0}}}), sw);
+    if(seq_len < seq_lens[0])
+    {
+        seq = m.insert_instruction(
+            ins, make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {seq_len}}}), seq);
+    }
+    if(not seq->get_shape().standard())
+    {
+        seq = m.insert_instruction(ins, make_op("contiguous"), seq);
+    }
+    auto rseq = m.insert_instruction(ins, make_op("reshape", {{"dims", {seq_len * bs, is}}}), seq);
+    auto xw   = m.insert_instruction(ins, make_op("dot"), rseq, tw);
+    xw = m.insert_instruction(ins, make_op("reshape", {{"dims", {seq_len, bs, n}}}), xw);
+    if(bias != m.end())
+    {
+        auto bb = m.insert_instruction(
+            ins, make_op("broadcast", {{"axis", 2}, {"out_lens", xw->get_shape().lens()}}), bias);
+        xw = m.insert_instruction(ins, make_op("add"), xw, bb);
+    }
+    return xw;
+}
+
+std::vector<instruction_ref> rewrite_rnn::run_recurrence(bool is_forward,
+                                                         module_pass_manager& mpm,
+                                                         instruction_ref ins,
+                                                         instruction_ref xw,
+                                                         std::vector<instruction_ref> states,
+                                                         const rnn_step& step) const
+{
+    auto& m      = mpm.get_module();
+    long seq_len = xw->get_shape().lens()[0];
+    // For each state, the states of all but the last computed timestep in the order of the
+    // sequence (or end when there is one timestep) followed by the state of the last one, with
+    // the dimensions of the sequence length and num_directions added
+    std::vector<instruction_ref> result;
+    if(unroll)
+    {
+        std::vector<instruction_ref> hidden_states(states.size(), m.end());
+        std::vector<instruction_ref> last_states(states.size());
+        for(long i = 0; i < seq_len; i++)
+        {
+            long seq_index = is_forward ? i : (seq_len - 1 - i);
+            auto xt        = m.insert_instruction(
+                ins,
+                make_op("slice",
+                        {{"axes", {0}}, {"starts", {seq_index}}, {"ends", {seq_index + 1}}}),
+                xw);
+            xt     = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), xt);
+            states = step(m, ins, xt, states);
+            for(std::size_t j = 0; j < states.size(); j++)
+            {
+                last_states[j] =
+                    m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), states[j]);
+                // concatenation for the last state is performed by the caller to ensure the
+                // last instruction is a concat
+                if(i == seq_len - 1)
+                    continue;
+                if(i == 0)
+                {
+                    hidden_states[j] = last_states[j];
+                }
+                else
+                {
+                    auto concat_arg0 = is_forward ? hidden_states[j] : last_states[j];
+                    auto concat_arg1 = is_forward ? last_states[j] : hidden_states[j];
+                    hidden_states[j] = m.insert_instruction(
+                        ins, make_op("concat", {{"axis", 0}}), concat_arg0, concat_arg1);
+                }
+            }
+        }
+        for(std::size_t j = 0; j < states.size(); j++)
+        {
+            result.push_back(hidden_states[j]);
+            result.push_back(last_states[j]);
+        }
+        return result;
+    }
+
+    // The body of the loop gets the iteration number, the condition and the states as
+    // parameters, and returns the condition, the new states and the new states again to be
+    // scanned into the outputs of the loop
+    auto mod_name = m.name() + ":" + ins->name() + (is_forward ? "_forward" : "_reverse") +
+                    std::to_string(std::distance(m.begin(), ins));
+    module_ref body = mpm.create_module(mod_name);
+    shape iter_s{shape::int64_type};
+    shape cond_s{shape::bool_type};
+    auto iter = body->add_parameter("iter", iter_s);
+    auto cond = body->add_parameter("cond", cond_s);
+    std::vector<instruction_ref> body_states;
+    for(std::size_t j = 0; j < states.size(); j++)
+    {
+        if(not states[j]->get_shape().standard())
+            states[j] = m.insert_instruction(ins, make_op("contiguous"), states[j]);
+        body_states.push_back(
+            body->add_parameter("state" + std::to_string(j), states[j]->get_shape()));
+    }
+    auto seq_index = iter;
+    if(not is_forward)
+    {
+        auto last_index = body->add_literal(literal{iter_s, {seq_len - 1}});
+        seq_index       = body->add_instruction(make_op("sub"), last_index, iter);
+    }
+    auto xt          = body->add_instruction(make_op("gather", {{"axis", 0}}), xw, seq_index);
+    auto new_states  = step(*body, body->end(), xt, body_states);
+    auto body_output = new_states;
+    body_output.insert(body_output.begin(), cond);
+    body_output.insert(body_output.end(), new_states.begin(), new_states.end());
+    body->add_return(body_output);
+
+    std::vector<instruction_ref> args = {m.add_literal(literal{iter_s, {seq_len}}),
+                                         m.add_literal(literal{cond_s, {true}})};
+    args.insert(args.end(), states.begin(), states.end());
+    auto loop =
+        m.insert_instruction(ins, make_op("loop", {{"max_iterations", seq_len}}), args, {body});
+    for(std::size_t j = 0; j < states.size(); j++)
+    {
+        auto last_state =
+            m.insert_instruction(ins, make_op("get_tuple_elem", {{"index", j}}), loop);
+        auto scan = m.insert_instruction(
+            ins, make_op("get_tuple_elem", {{"index", states.size() + j}}), loop);
+        if(not is_forward)
+            scan = m.insert_instruction(ins, make_op("reverse", {{"axes", {0}}}), scan);
+        scan = m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {1}}}), scan);
+
+        instruction_ref hidden_states = m.end();
+        if(seq_len > 1)
+        {
+            long start    = is_forward ? 0 : 1;
+            hidden_states = m.insert_instruction(
+                ins,
+                make_op("slice",
+                        {{"axes", {0}}, {"starts", {start}}, {"ends", {start + seq_len - 1}}}),
+                scan);
+        }
+        result.push_back(hidden_states);
+        result.push_back(
+            m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), last_state));
+    }
+    return result;
+}
+
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-void rewrite_rnn::apply_vanilla_rnn(module& m, instruction_ref ins) const
+void rewrite_rnn::apply_vanilla_rnn(module_pass_manager& mpm, instruction_ref ins) const
 {
+    auto& m = mpm.get_module();
     assert(ins->name() == "rnn");
     // could be 3 to 6 inputs, but the parse_rnn function will
     // append undefined operators to make 6 arguments when parsing
@@ -144,7 +300,7 @@ void rewrite_rnn::apply_vanilla_rnn(module& m, instruction_ref ins) const
 
         auto ret_forward =
             vanilla_rnn_cell(true,
-                             m,
+                             mpm,
                              ins,
                              {args[0], w_forward, r_forward, bias_forward, seq_lens, ih_forward},
                              actv_funcs.at(0));
@@ -157,7 +313,7 @@ void rewrite_rnn::apply_vanilla_rnn(module& m, instruction_ref ins) const
 
         auto ret_reverse =
             vanilla_rnn_cell(false,
-                             m,
+                             mpm,
                              ins,
                              {args[0], w_reverse, r_reverse, bias_reverse, seq_lens, ih_reverse},
                              actv_funcs.at(1));
@@ -218,7 +374,7 @@ void rewrite_rnn::apply_vanilla_rnn(module& m, instruction_ref ins) const
         }
 
         auto ret = vanilla_rnn_cell(
-            is_forward, m, ins, {args[0], w, r, bias, seq_lens, ih}, actv_funcs.at(0));
+            is_forward, mpm, ins, {args[0], w, r, bias, seq_lens, ih}, actv_funcs.at(0));
         last_output = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), ret[1]);
 
         // following logic is to ensure the last instruction is a
@@ -243,12 +399,13 @@ void rewrite_rnn::apply_vanilla_rnn(module& m, instruction_ref ins) const
 }
 
 std::vector<instruction_ref> rewrite_rnn::vanilla_rnn_cell(bool is_forward,
-                                                           module& m,
+                                                           module_pass_manager& mpm,
                                                            instruction_ref ins,
                                                            std::vector<instruction_ref> inputs,
                                                            const operation& actv_func) const
 {
     assert(inputs.size() == 6);
+    auto& m       = mpm.get_module();
     auto seq      = inputs.at(0);
     auto w        = inputs.at(1);
     auto r        = inputs.at(2);
@@ -256,21 +413,16 @@ std::vector<instruction_ref> rewrite_rnn::vanilla_rnn_cell(bool is_forward,
     auto seq_lens = inputs.at(4);
     auto ih       = inputs.at(5);
 
-    // squeeze and transpose w
-    std::vector<int64_t> perm{1, 0};
-    auto sw      = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), w);
-    auto tran_sw = m.insert_instruction(ins, make_op("transpose", {{"permutation", perm}}), sw);
-
     // squeeze and transpose r
+    std::vector<int64_t> perm{1, 0};
     auto sr      = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), r);
     auto tran_sr = m.insert_instruction(ins, make_op("transpose", {{"permutation", perm}}), sr);
 
     // initial hidden state
-    auto sih      = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), ih);
-    auto sih_lens = sih->get_shape().lens();
+    auto sih = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), ih);
 
-    // bias
-    instruction_ref bb{};
+    // bias, which is added to the input projection
+    instruction_ref wrb = m.end();
     if(bias != m.end())
     {
         long hs    = r->get_shape().lens()[2];
@@ -279,63 +431,24 @@ std::vector<instruction_ref> rewrite_rnn::vanilla_rnn_cell(bool is_forward,
             ins, make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {hs}}}), sbias);
         auto rb = m.insert_instruction(
             ins, make_op("slice", {{"axes", {0}}, {"starts", {hs}}, {"ends", {2 * hs}}}), sbias);
-        auto wrb = m.insert_instruction(ins, make_op("add"), wb, rb);
-        bb       = m.insert_instruction(
-            ins, make_op("broadcast", {{"axis", 1}, {"out_lens", sih_lens}}), wrb);
+        wrb = m.insert_instruction(ins, make_op("add"), wb, rb);
     }
 
-    instruction_ref hidden_out = m.end();
-    instruction_ref last_out{};
-    last_out     = m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), sih);
     long seq_len = get_seq_len(m, seq, seq_lens);
-    for(long i = 0; i < seq_len; i++)
-    {
-        long seq_index = is_forward ? i : (seq_len - 1 - i);
-        auto xt        = m.insert_instruction(
-            ins,
-            make_op("slice", {{"axes", {0}}, {"starts", {seq_index}}, {"ends", {seq_index + 1}}}),
-            seq);
-        auto cont_xt = m.insert_instruction(ins, make_op("contiguous"), xt);
-        xt           = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), cont_xt);
-        auto xt_wi   = m.insert_instruction(ins, make_op("dot"), xt, tran_sw);
-        auto ht_ri   = m.insert_instruction(ins, make_op("dot"), sih, tran_sr);
-        if(bias != m.end())
-        {
-            xt_wi = m.insert_instruction(ins, make_op("add"), xt_wi, bb);
-        }
-        auto xt_ht = m.insert_instruction(ins, make_op("add"), xt_wi, ht_ri);
-
-        // apply activation function
-        auto ht = m.insert_instruction(ins, actv_func, xt_ht);
-        sih     = ht;
-
-        // add the dimensions of sequence length (axis 0 for sequence length,
-        // axis 1 for num_directions
-        last_out = m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), ht);
-
-        // concatenation for the last last_out is performed in the apply()
-        // function to ensure the last instruction is concat, then we have
-        // output inserted
-        if(i < seq_len - 1)
-        {
-            if(is_forward)
-            {
-                hidden_out = (seq_index == 0)
-                                 ? last_out
-                                 : m.insert_instruction(
-                                       ins, make_op("concat", {{"axis", 0}}), hidden_out, last_out);
-            }
-            else
-            {
-                hidden_out = (seq_index == seq_len - 1)
-                                 ? last_out
-                                 : m.insert_instruction(
-                                       ins, make_op("concat", {{"axis", 0}}), last_out, hidden_out);
-            }
-        }
-    }
-
-    return {hidden_out, last_out};
+    auto xw      = input_projection(m, ins, seq, w, wrb, seq_len);
+    return run_recurrence(
+        is_forward,
+        mpm,
+        ins,
+        xw,
+        {sih},
+        [&](module& sm, instruction_ref pos, instruction_ref xt_wi, const auto& states) {
+            auto ht_ri = sm.insert_instruction(pos, make_op("dot"), states[0], tran_sr);
+            auto xt_ht = sm.insert_instruction(pos, make_op("add"), xt_wi, ht_ri);
+
+            // apply activation function
+            return std::vector<instruction_ref>{sm.insert_instruction(pos, actv_func, xt_ht)};
+        });
 }
 
 std::vector<operation> rewrite_rnn::vanilla_rnn_actv_funcs(instruction_ref ins) const
@@ -376,8 +489,9 @@ std::vector<operation> rewrite_rnn::vanilla_rnn_actv_funcs(instruction_ref ins)
 }
 
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-void rewrite_rnn::apply_gru(module& m, instruction_ref ins) const
+void rewrite_rnn::apply_gru(module_pass_manager& mpm, instruction_ref ins) const
 {
+    auto& m = mpm.get_module();
     assert(ins->name() == "gru");
     const auto actv_funcs = gru_actv_funcs(ins);
     // could be 3 to 6 inputs, but the parse_gru function will
@@ -449,7 +563,7 @@ void rewrite_rnn::apply_gru(module& m, instruction_ref ins) const
 
         auto ret_forward =
             gru_cell(true,
-                     m,
+                     mpm,
                      ins,
                      {args[0], w_forward, r_forward, bias_forward, seq_lens, ih_forward},
                      gru_op.linear_before_reset,
@@ -464,7 +578,7 @@ void rewrite_rnn::apply_gru(module& m, instruction_ref ins) const
 
         auto ret_reverse =
             gru_cell(false,
-                     m,
+                     mpm,
                      ins,
                      {args[0], w_reverse, r_reverse, bias_reverse, seq_lens, ih_reverse},
                      gru_op.linear_before_reset,
@@ -524,7 +638,7 @@ void rewrite_rnn::apply_gru(module& m, instruction_ref ins) const
         }
 
         auto ret = gru_cell(is_forward,
-                            m,
+                            mpm,
                             ins,
                             {args[0], w, r, bias, seq_lens, ih},
                             gru_op.linear_before_reset,
@@ -553,7 +667,7 @@ void rewrite_rnn::apply_gru(module& m, instruction_ref ins) const
 
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 std::vector<instruction_ref> rewrite_rnn::gru_cell(bool is_forward,
-                                                   module& m,
+                                                   module_pass_manager& mpm,
                                                    instruction_ref ins,
                                                    std::vector<instruction_ref> inputs,
                                                    int linear_before_reset,
@@ -561,6 +675,7 @@ std::vector<instruction_ref> rewrite_rnn::gru_cell(bool is_forward,
                                                    const operation& actv_func2) const
 {
     assert(inputs.size() == 6);
+    auto& m       = mpm.get_module();
     auto seq      = inputs.at(0);
     auto w        = inputs.at(1);
     auto r        = inputs.at(2);
@@ -568,8 +683,6 @@ std::vector<instruction_ref> rewrite_rnn::gru_cell(bool is_forward,
     auto seq_lens = inputs.at(4);
     auto ih       = inputs.at(5);
 
-    instruction_ref hidden_states = m.end();
-    instruction_ref last_output{};
     migraphx::shape seq_shape = seq->get_shape();
     migraphx::shape r_shape   = r->get_shape();
     long hs                   = r_shape.lens()[2];
@@ -578,12 +691,8 @@ std::vector<instruction_ref> rewrite_rnn::gru_cell(bool is_forward,
     std::vector<float> data(ss.elements(), 1.0f);
     auto l1 = m.add_literal(migraphx::literal{ss, data});
 
-    // w matrix squeeze to 2-dim and do a transpose
-    std::vector<int64_t> perm{1, 0};
-    auto sw = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), w);
-    auto tw = m.insert_instruction(ins, make_op("transpose", {{"permutation", perm}}), sw);
-
     // r slide to two part, zr and h
+    std::vector<int64_t> perm{1, 0};
     auto sr  = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), r);
     auto rzr = m.insert_instruction(
         ins, make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {2 * hs}}}), sr);
@@ -597,19 +706,15 @@ std::vector<instruction_ref> rewrite_rnn::gru_cell(bool is_forward,
     auto sih  = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), ih);
     size_t bs = ih->get_shape().lens()[1];
 
-    // bias
-    instruction_ref bwb{};
+    // bias, where the bias of w is added to the input projection
+    instruction_ref wb = m.end();
     instruction_ref brb_zr{};
     instruction_ref brb_h{};
     if(bias != m.end())
     {
         auto sbias = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), bias);
-        auto wb    = m.insert_instruction(
+        wb         = m.insert_instruction(
             ins, make_op("slice", {{"axes", {0}}, {"starts", {0}}, {"ends", {3 * hs}}}), sbias);
-        bwb = m.insert_instruction(
-            ins,
-            make_op("broadcast", {{"axis", 1}, {"out_lens", {bs, static_cast<size_t>(3 * hs)}}}),
-            wb);
 
         auto rb_zr = m.insert_instruction(
             ins,
@@ -630,96 +735,75 @@ std::vector<instruction_ref> rewrite_rnn::gru_cell(bool is_forward,
     }
 
     long seq_len = get_seq_len(m, seq, seq_lens);
-    for(long i = 0; i < seq_len; i++)
-    {
-        long seq_index = is_forward ? i : (seq_len - 1 - i);
-        auto xt        = m.insert_instruction(
-            ins,
-            make_op("slice", {{"axes", {0}}, {"starts", {seq_index}}, {"ends", {seq_index + 1}}}),
-            seq);
-        auto cont_xt = m.insert_instruction(ins, make_op("contiguous"), xt);
-        xt           = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), cont_xt);
-
-        auto xt_w    = m.insert_instruction(ins, make_op("dot"), xt, tw);
-        auto ih1_rzr = m.insert_instruction(ins, make_op("dot"), sih, trzr);
-        if(bias != m.end())
-        {
-            xt_w    = m.insert_instruction(ins, make_op("add"), xt_w, bwb);
-            ih1_rzr = m.insert_instruction(ins, make_op("add"), ih1_rzr, brb_zr);
-        }
-
-        auto xw_z = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {0}}, {"ends", {hs}}}), xt_w);
-        auto xw_r = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {hs}}, {"ends", {2 * hs}}}), xt_w);
-        auto xw_h = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {2 * hs}}, {"ends", {3 * hs}}}), xt_w);
-
-        auto hr_z = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {0}}, {"ends", {hs}}}), ih1_rzr);
-        auto hr_r = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {hs}}, {"ends", {2 * hs}}}), ih1_rzr);
-
-        auto xw_hr_z = m.insert_instruction(ins, make_op("add"), xw_z, hr_z);
-        auto zt      = m.insert_instruction(ins, actv_func1, xw_hr_z);
-
-        auto xw_hr_r = m.insert_instruction(ins, make_op("add"), xw_r, hr_r);
-        auto rt      = m.insert_instruction(ins, actv_func1, xw_hr_r);
-
-        instruction_ref hr_h{};
-        if(linear_before_reset == 0)
-        {
-            // equation g(Xt*(Wh^T) + (rt (.) Ht-1)*(Rh^T) + Rbh + Wbh)
-            auto rt_ht1 = m.insert_instruction(ins, make_op("mul"), rt, sih);
-            hr_h        = m.insert_instruction(ins, make_op("dot"), rt_ht1, trh);
-            if(bias != m.end())
-            {
-                hr_h = m.insert_instruction(ins, make_op("add"), hr_h, brb_h);
-            }
-        }
-        else
-        {
-            // equation ht = g(Xt*(Wh^T) + (rt (.) (Ht-1*(Rh^T) + Rbh)) + Wbh)
-            auto ht1_rh = m.insert_instruction(ins, make_op("dot"), sih, trh);
+    auto xw      = input_projection(m, ins, seq, w, wb, seq_len);
+    return run_recurrence(
+        is_forward,
+        mpm,
+        ins,
+        xw,
+        {sih},
+        [&](module& sm, instruction_ref pos, instruction_ref xt_w, const auto& states) {
+            auto sih1    = states[0];
+            auto ih1_rzr = sm.insert_instruction(pos, make_op("dot"), sih1, trzr);
             if(bias != m.end())
             {
-                ht1_rh = m.insert_instruction(ins, make_op("add"), ht1_rh, brb_h);
+                ih1_rzr = sm.insert_instruction(pos, make_op("add"), ih1_rzr, brb_zr);
             }
-            hr_h = m.insert_instruction(ins, make_op("mul"), rt, ht1_rh);
-        }
-
-        auto xw_hr_h = m.insert_instruction(ins, make_op("add"), xw_h, hr_h);
-        auto ht      = m.insert_instruction(ins, actv_func2, xw_hr_h);
 
-        // equation Ht = (1 - zt) (.) ht + zt (.) Ht-1
-        auto one_minus_zt    = m.insert_instruction(ins, make_op("sub"), l1, zt);
-        auto one_minus_zt_ht = m.insert_instruction(ins, make_op("mul"), one_minus_zt, ht);
-        auto zt_ht1          = m.insert_instruction(ins, make_op("mul"), zt, sih);
-        sih                  = m.insert_instruction(ins, make_op("add"), one_minus_zt_ht, zt_ht1);
-        last_output = m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), sih);
-
-        if(i < seq_len - 1)
-        {
-            if(is_forward)
+            auto xw_z = sm.insert_instruction(
+                pos, make_op("slice", {{"axes", {1}}, {"starts", {0}}, {"ends", {hs}}}), xt_w);
+            auto xw_r = sm.insert_instruction(
+                pos, make_op("slice", {{"axes", {1}}, {"starts", {hs}}, {"ends", {2 * hs}}}), xt_w);
+            auto xw_h = sm.insert_instruction(
+                pos,
+                make_op("slice", {{"axes", {1}}, {"starts", {2 * hs}}, {"ends", {3 * hs}}}),
+                xt_w);
+
+            auto hr_z = sm.insert_instruction(
+                pos, make_op("slice", {{"axes", {1}}, {"starts", {0}}, {"ends", {hs}}}), ih1_rzr);
+            auto hr_r = sm.insert_instruction(
+                pos,
+                make_op("slice", {{"axes", {1}}, {"starts", {hs}}, {"ends", {2 * hs}}}),
+                ih1_rzr);
+
+            auto xw_hr_z = sm.insert_instruction(pos, make_op("add"), xw_z, hr_z);
+            auto zt      = sm.insert_instruction(pos, actv_func1, xw_hr_z);
+
+            auto xw_hr_r = sm.insert_instruction(pos, make_op("add"), xw_r, hr_r);
+            auto rt      = sm.insert_instruction(pos, actv_func1, xw_hr_r);
+
+            instruction_ref hr_h{};
+            if(linear_before_reset == 0)
             {
-                hidden_states =
-                    (seq_index == 0)
-                        ? last_output
-                        : m.insert_instruction(
-                              ins, make_op("concat", {{"axis", 0}}), hidden_states, last_output);
+                // equation g(Xt*(Wh^T) + (rt (.) Ht-1)*(Rh^T) + Rbh + Wbh)
+                auto rt_ht1 = sm.insert_instruction(pos, make_op("mul"), rt, sih1);
+                hr_h        = sm.insert_instruction(pos, make_op("dot"), rt_ht1, trh);
+                if(bias != m.end())
+                {
+                    hr_h = sm.insert_instruction(pos, make_op("add"), hr_h, brb_h);
+                }
             }
             else
             {
-                hidden_states =
-                    (seq_index == seq_len - 1)
-                        ? last_output
-                        : m.insert_instruction(
-                              ins, make_op("concat", {{"axis", 0}}), last_output, hidden_states);
+                // equation ht = g(Xt*(Wh^T) + (rt (.) (Ht-1*(Rh^T) + Rbh)) + Wbh)
+                auto ht1_rh = sm.insert_instruction(pos, make_op("dot"), sih1, trh);
+                if(bias != m.end())
+                {
+                    ht1_rh = sm.insert_instruction(pos, make_op("add"), ht1_rh, brb_h);
+                }
+                hr_h = sm.insert_instruction(pos, make_op("mul"), rt, ht1_rh);
             }
-        }
-    }
 
-    return {hidden_states, last_output};
+            auto xw_hr_h = sm.insert_instruction(pos, make_op("add"), xw_h, hr_h);
+            auto ht      = sm.insert_instruction(pos, actv_func2, xw_hr_h);
+
+            // equation Ht = (1 - zt) (.) ht + zt (.) Ht-1
+            auto one_minus_zt    = sm.insert_instruction(pos, make_op("sub"), l1, zt);
+            auto one_minus_zt_ht = sm.insert_instruction(pos, make_op("mul"), one_minus_zt, ht);
+            auto zt_ht1          = sm.insert_instruction(pos, make_op("mul"), zt, sih1);
+            return std::vector<instruction_ref>{
+                sm.insert_instruction(pos, make_op("add"), one_minus_zt_ht, zt_ht1)};
+        });
 }
 
 std::vector<operation> rewrite_rnn::gru_actv_funcs(instruction_ref ins) const
@@ -764,8 +848,9 @@ std::vector<operation> rewrite_rnn::gru_actv_funcs(instruction_ref ins) const
 
 // for lstm operators
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
-void rewrite_rnn::apply_lstm(module& m, instruction_ref ins) const
+void rewrite_rnn::apply_lstm(module_pass_manager& mpm, instruction_ref ins) const
 {
+    auto& m = mpm.get_module();
     assert(ins->name() == "lstm");
     auto args = ins->inputs();
 
@@ -865,7 +950,7 @@ void rewrite_rnn::apply_lstm(module& m, instruction_ref ins) const
         }
 
         auto ret_forward = lstm_cell(true,
-                                     m,
+                                     mpm,
                                      ins,
                                      {args[0],
                                       w_forward,
@@ -885,7 +970,7 @@ void rewrite_rnn::apply_lstm(module& m, instruction_ref ins) const
                 m.insert_instruction(ins, make_op("rnn_var_sl_shift_sequence"), args[0], seq_lens);
         }
         auto ret_reverse = lstm_cell(false,
-                                     m,
+                                     mpm,
                                      ins,
                                      {args[0],
                                       w_reverse,
@@ -980,7 +1065,7 @@ void rewrite_rnn::apply_lstm(module& m, instruction_ref ins) const
                 m.insert_instruction(ins, make_op("rnn_var_sl_shift_sequence"), args[0], seq_lens);
         }
         auto ret = lstm_cell(is_forward,
-                             m,
+                             mpm,
                              ins,
                              {args[0], w, r, bias, seq_lens, ih, ic, pph},
                              actv_funcs.at(0),
@@ -1022,7 +1107,7 @@ void rewrite_rnn::apply_lstm(module& m, instruction_ref ins) const
 
 // NOLINTNEXTLINE(readability-function-cognitive-complexity)
 std::vector<instruction_ref> rewrite_rnn::lstm_cell(bool is_forward,
-                                                    module& m,
+                                                    module_pass_manager& mpm,
                                                     instruction_ref ins,
                                                     std::vector<instruction_ref> inputs,
                                                     const operation& actv_func1,
@@ -1031,6 +1116,7 @@ std::vector<instruction_ref> rewrite_rnn::lstm_cell(bool is_forward,
 {
     // must have 7 args in the input vector
     assert(inputs.size() == 8);
+    auto& m       = mpm.get_module();
     auto seq      = inputs.at(0);
     auto w        = inputs.at(1);
     auto r        = inputs.at(2);
@@ -1040,22 +1126,11 @@ std::vector<instruction_ref> rewrite_rnn::lstm_cell(bool is_forward,
     auto ic       = inputs.at(6);
     auto pph      = inputs.at(7);
 
-    instruction_ref hidden_states = m.end();
-    instruction_ref cell_outputs  = m.end();
-
-    instruction_ref last_hs_output{};
-    instruction_ref last_cell_output{};
-
     migraphx::shape r_shape = r->get_shape();
     long hs                 = r_shape.lens()[2];
-    auto bs                 = ih->get_shape().lens()[1];
-
-    std::vector<int64_t> perm{1, 0};
-    // w matrix, squeeze and transpose
-    auto sw  = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), w);
-    auto tsw = m.insert_instruction(ins, make_op("transpose", {{"permutation", perm}}), sw);
 
     // r matrix, squeeze and transpose
+    std::vector<int64_t> perm{1, 0};
     auto sr  = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), r);
     auto tsr = m.insert_instruction(ins, make_op("transpose", {{"permutation", perm}}), sr);
 
@@ -1066,8 +1141,8 @@ std::vector<instruction_ref> rewrite_rnn::lstm_cell(bool is_forward,
     auto sic     = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), ic);
     auto ic_lens = sic->get_shape().lens();
 
-    // bias
-    instruction_ref wrb{};
+    // bias, which is added to the input projection
+    instruction_ref wrb = m.end();
     if(bias != m.end())
     {
 
@@ -1078,12 +1153,7 @@ std::vector<instruction_ref> rewrite_rnn::lstm_cell(bool is_forward,
             ins,
             make_op("slice", {{"axes", {0}}, {"starts", {4 * hs}}, {"ends", {8 * hs}}}),
             sbias);
-        auto ub_wrb = m.insert_instruction(ins, make_op("add"), ub_wb, ub_rb);
-
-        wrb = m.insert_instruction(
-            ins,
-            make_op("broadcast", {{"axis", 1}, {"out_lens", {bs, 4 * static_cast<size_t>(hs)}}}),
-            ub_wrb);
+        wrb = m.insert_instruction(ins, make_op("add"), ub_wb, ub_rb);
     }
 
     // peep hole
@@ -1110,95 +1180,66 @@ std::vector<instruction_ref> rewrite_rnn::lstm_cell(bool is_forward,
     }
 
     long seq_len = get_seq_len(m, seq, seq_lens);
-    for(long i = 0; i < seq_len; ++i)
-    {
-        long seq_index = is_forward ? i : (seq_len - 1 - i);
-        auto xt        = m.insert_instruction(
-            ins,
-            make_op("slice", {{"axes", {0}}, {"starts", {seq_index}}, {"ends", {seq_index + 1}}}),
-            seq);
-        auto cont_xt = m.insert_instruction(ins, make_op("contiguous"), xt);
-        xt           = m.insert_instruction(ins, make_op("squeeze", {{"axes", {0}}}), cont_xt);
-
-        auto xt_tsw  = m.insert_instruction(ins, make_op("dot"), xt, tsw);
-        auto sih_tsr = m.insert_instruction(ins, make_op("dot"), sih, tsr);
-        auto xt_sih  = m.insert_instruction(ins, make_op("add"), xt_tsw, sih_tsr);
-        if(bias != m.end())
-        {
-            xt_sih = m.insert_instruction(ins, make_op("add"), xt_sih, wrb);
-        }
-
-        auto it_before_actv = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {0}}, {"ends", {hs}}}), xt_sih);
-        auto ot_before_actv = m.insert_instruction(
-            ins, make_op("slice", {{"axes", {1}}, {"starts", {hs}}, {"ends", {2 * hs}}}), xt_sih);
-        auto ft_before_actv = m.insert_instruction(
-            ins,
-            make_op("slice", {{"axes", {1}}, {"starts", {2 * hs}}, {"ends", {3 * hs}}}),
-            xt_sih);
-        auto ct_before_actv = m.insert_instruction(
-            ins,
-            make_op("slice", {{"axes", {1}}, {"starts", {3 * hs}}, {"ends", {4 * hs}}}),
-            xt_sih);
-
-        if(pph != m.end())
-        {
-            auto pphi_ct   = m.insert_instruction(ins, make_op("mul"), pphi_brcst, sic);
-            it_before_actv = m.insert_instruction(ins, make_op("add"), it_before_actv, pphi_ct);
-
-            auto pphf_ct   = m.insert_instruction(ins, make_op("mul"), pphf_brcst, sic);
-            ft_before_actv = m.insert_instruction(ins, make_op("add"), ft_before_actv, pphf_ct);
-        }
-        auto it = m.insert_instruction(ins, actv_func1, it_before_actv);
-        auto ft = m.insert_instruction(ins, actv_func1, ft_before_actv);
-        auto ct = m.insert_instruction(ins, actv_func2, ct_before_actv);
-
-        // equation Ct = ft (.) Ct-1 + it (.) ct
-        auto ft_cell = m.insert_instruction(ins, make_op("mul"), ft, sic);
-        auto it_ct   = m.insert_instruction(ins, make_op("mul"), it, ct);
-        auto cellt   = m.insert_instruction(ins, make_op("add"), ft_cell, it_ct);
-
-        if(pph != m.end())
-        {
-            auto ppho_cellt = m.insert_instruction(ins, make_op("mul"), ppho_brcst, cellt);
-            ot_before_actv  = m.insert_instruction(ins, make_op("add"), ot_before_actv, ppho_cellt);
-        }
-        auto ot = m.insert_instruction(ins, actv_func1, ot_before_actv);
-
-        // Ht = ot (.) h(Ct)
-        auto h_cellt = m.insert_instruction(ins, actv_func3, cellt);
-        auto ht      = m.insert_instruction(ins, make_op("mul"), ot, h_cellt);
+    auto xw      = input_projection(m, ins, seq, w, wrb, seq_len);
+    return run_recurrence(
+        is_forward,
+        mpm,
+        ins,
+        xw,
+        {sih, sic},
+        [&](module& sm, instruction_ref pos, instruction_ref xt_tsw, const auto& states) {
+            auto sih1    = states[0];
+            auto sic1    = states[1];
+            auto sih_tsr = sm.insert_instruction(pos, make_op("dot"), sih1, tsr);
+            auto xt_sih  = sm.insert_instruction(pos, make_op("add"), xt_tsw, sih_tsr);
+
+            auto it_before_actv = sm.insert_instruction(
+                pos, make_op("slice", {{"axes", {1}}, {"starts", {0}}, {"ends", {hs}}}), xt_sih);
+            auto ot_before_actv = sm.insert_instruction(
+                pos,
+                make_op("slice", {{"axes", {1}}, {"starts", {hs}}, {"ends", {2 * hs}}}),
+                xt_sih);
+            auto ft_before_actv = sm.insert_instruction(
+                pos,
+                make_op("slice", {{"axes", {1}}, {"starts", {2 * hs}}, {"ends", {3 * hs}}}),
+                xt_sih);
+            auto ct_before_actv = sm.insert_instruction(
+                pos,
+                make_op("slice", {{"axes", {1}}, {"starts", {3 * hs}}, {"ends", {4 * hs}}}),
+                xt_sih);
+
+            if(pph != m.end())
+            {
+                auto pphi_ct   = sm.insert_instruction(pos, make_op("mul"), pphi_brcst, sic1);
+                it_before_actv =
+                    sm.insert_instruction(pos, make_op("add"), it_before_actv, pphi_ct);
 
-        sic = cellt;
-        sih = ht;
+                auto pphf_ct   = sm.insert_instruction(pos, make_op("mul"), pphf_brcst, sic1);
+                ft_before_actv =
+                    sm.insert_instruction(pos, make_op("add"), ft_before_actv, pphf_ct);
+            }
+            auto it = sm.insert_instruction(pos, actv_func1, it_before_actv);
+            auto ft = sm.insert_instruction(pos, actv_func1, ft_before_actv);
+            auto ct = sm.insert_instruction(pos, actv_func2, ct_before_actv);
 
-        last_hs_output = m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), ht);
-        last_cell_output =
-            m.insert_instruction(ins, make_op("unsqueeze", {{"axes", {0, 1}}}), cellt);
+            // equation Ct = ft (.) Ct-1 + it (.) ct
+            auto ft_cell = sm.insert_instruction(pos, make_op("mul"), ft, sic1);
+            auto it_ct   = sm.insert_instruction(pos, make_op("mul"), it, ct);
+            auto cellt   = sm.insert_instruction(pos, make_op("add"), ft_cell, it_ct);
 
-        if(i < seq_len - 1)
-        {
-            if(i == 0)
-            {
-                hidden_states = last_hs_output;
-                cell_outputs  = last_cell_output;
-            }
-            else
+            if(pph != m.end())
             {
-                auto concat_hs_arg0 = is_forward ? hidden_states : last_hs_output;
-                auto concat_hs_arg1 = is_forward ? last_hs_output : hidden_states;
-                hidden_states       = m.insert_instruction(
-                    ins, make_op("concat", {{"axis", 0}}), concat_hs_arg0, concat_hs_arg1);
-
-                auto concat_cell_arg0 = is_forward ? cell_outputs : last_cell_output;
-                auto concat_cell_arg1 = is_forward ? last_cell_output : cell_outputs;
-                cell_outputs          = m.insert_instruction(
-                    ins, make_op("concat", {{"axis", 0}}), concat_cell_arg0, concat_cell_arg1);
+                auto ppho_cellt = sm.insert_instruction(pos, make_op("mul"), ppho_brcst, cellt);
+                ot_before_actv =
+                    sm.insert_instruction(pos, make_op("add"), ot_before_actv, ppho_cellt);
             }
-        }
-    }
+            auto ot = sm.insert_instruction(pos, actv_func1, ot_before_actv);
 
-    return {hidden_states, last_hs_output, cell_outputs, last_cell_output};
+            // Ht = ot (.) h(Ct)
+            auto h_cellt = sm.insert_instruction(pos, actv_func3, cellt);
+            auto ht      = sm.insert_instruction(pos, make_op("mul"), ot, h_cellt);
+            return std::vector<instruction_ref>{ht, cellt};
+        });
 }
 
 std::vector<operation> rewrite_rnn::lstm_actv_funcs(instruction_ref ins) const
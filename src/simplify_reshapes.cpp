@@ -1017,27 +1017,35 @@ struct find_reshape_reshape_dot
 
 void simplify_reshapes::apply(module& m) const
 {
-    for(int i = 0; i < depth; i++)
+    auto finish   = [&] { dead_code_elimination{}.apply(m); };
+    auto matchers = [](auto f) {
+        f(find_where_op{},
+          find_resize{},
+          find_nop_reshapes{},
+          find_reshaper{},
+          find_reshape_cont{},
+          find_transpose{},
+          find_concat_slice{},
+          find_concat_transpose{},
+          find_concat_multibroadcasts{},
+          find_nested_slice{},
+          find_nested_concat{},
+          find_transpose_slice{},
+          find_broadcast_transpose{},
+          find_slice_transpose{},
+          find_unary_shape_transforms{},
+          find_reshape_reshape_dot{},
+          find_scalar_multibroadcast_reshape_or_transpose{});
+    };
+    if(depth == 0)
+    {
+        matchers([&](auto&&... ms) { match::find_matches_fixpoint(m, finish, ms...); });
+        return;
+    }
+    for(std::size_t i = 0; i < depth; i++)
     {
-        match::find_matches(m,
-                            find_where_op{},
-                            find_resize{},
-                            find_nop_reshapes{},
-                            find_reshaper{},
-                            find_reshape_cont{},
-                            find_transpose{},
-                            find_concat_slice{},
-                            find_concat_transpose{},
-                            find_concat_multibroadcasts{},
-                            find_nested_slice{},
-                            find_nested_concat{},
-                            find_transpose_slice{},
-                            find_broadcast_transpose{},
-                            find_slice_transpose{},
-                            find_unary_shape_transforms{},
-                            find_reshape_reshape_dot{},
-                            find_scalar_multibroadcast_reshape_or_transpose{});
-        dead_code_elimination{}.apply(m);
+        matchers([&](auto&&... ms) { match::find_matches(m, ms...); });
+        finish();
     }
 }
 
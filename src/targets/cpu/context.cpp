@@ -0,0 +1,381 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/errors.hpp>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// A task queued on a stream. Events are recorded and waited on by the pool itself, so a stream
+// that waits for an event doesn't hold one of the worker threads.
+struct stream_task
+{
+    enum task_kind
+    {
+        run_task,
+        record_task,
+        wait_task
+    };
+    task_kind kind          = run_task;
+    std::function<void()> f = nullptr;
+    std::size_t event       = 0;
+};
+
+// The queued tasks and the events of the streams of one context
+struct stream_state
+{
+    struct queue
+    {
+        std::deque<stream_task> tasks;
+        bool running             = false;
+        std::exception_ptr error = nullptr;
+
+        bool idle() const { return tasks.empty() and not running; }
+    };
+
+    explicit stream_state(std::size_t n) : queues(n) {}
+
+    bool recorded(std::size_t event) const
+    {
+        return cancelled or (event < events.size() and events[event]);
+    }
+
+    bool idle() const
+    {
+        return std::all_of(queues.begin(), queues.end(), [](const queue& q) { return q.idle(); });
+    }
+
+    std::vector<queue> queues;
+    std::vector<bool> events;
+    bool cancelled = false;
+};
+
+// The worker threads that run the streams of a context and of all of its copies. Each stream
+// runs one task at a time in the order they were submitted, and the worker threads take the
+// next task from any stream that is ready, so concurrent evals share the same threads instead
+// of each starting their own.
+struct stream_pool
+{
+    explicit stream_pool(std::size_t n) : budget(std::max<std::size_t>(1, hardware_threads() / n))
+    {
+        for(std::size_t i = 0; i < n; i++)
+            threads.emplace_back([this] { this->run(); });
+    }
+
+    stream_pool(const stream_pool&)            = delete;
+    stream_pool& operator=(const stream_pool&) = delete;
+
+    ~stream_pool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stop = true;
+        }
+        cv.notify_all();
+        for(auto& t : threads)
+            t.join();
+    }
+
+    std::size_t size() const { return threads.size(); }
+
+    void add(stream_state* s)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        states.push_back(s);
+    }
+
+    // Run the remaining tasks of the state and stop using it
+    void remove(stream_state* s)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cancel(*s);
+        cv.wait(lock, [&] { return s->idle(); });
+        states.erase(std::find(states.begin(), states.end(), s));
+    }
+
+    void submit(stream_state& s, std::size_t stream, stream_task t)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            s.queues.at(stream).tasks.push_back(std::move(t));
+            advance(s);
+        }
+        cv.notify_all();
+    }
+
+    // Wait until all the tasks submitted to the stream have run, and return the first error
+    // they raised
+    std::exception_ptr sync(stream_state& s, std::size_t stream)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto& q = s.queues.at(stream);
+        cv.wait(lock, [&] { return q.idle(); });
+        return std::exchange(q.error, nullptr);
+    }
+
+    std::exception_ptr sync(stream_state& s)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&] { return s.idle(); });
+        std::exception_ptr error = nullptr;
+        for(auto& q : s.queues)
+        {
+            auto e = std::exchange(q.error, nullptr);
+            if(error == nullptr)
+                error = e;
+        }
+        return error;
+    }
+
+    // Release the waits that can no longer be satisfied, e.g. after an earlier eval failed, and
+    // clear the events once the streams are done
+    void reset(stream_state& s)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        cancel(s);
+        cv.wait(lock, [&] { return s.idle(); });
+        for(auto& q : s.queues)
+            q.error = nullptr;
+        s.events.clear();
+        s.cancelled = false;
+    }
+
+    std::size_t budget = 1;
+
+    private:
+    // Must be called with the mutex held
+    void cancel(stream_state& s)
+    {
+        s.cancelled = true;
+        advance(s);
+        cv.notify_all();
+    }
+
+    // Record the events and release the waits at the front of the streams until only tasks that
+    // need a worker thread are left. Must be called with the mutex held.
+    static void advance(stream_state& s)
+    {
+        bool changed = true;
+        while(changed)
+        {
+            changed = false;
+            for(auto& q : s.queues)
+            {
+                while(not q.running and not q.tasks.empty())
+                {
+                    auto& t = q.tasks.front();
+                    if(t.kind == stream_task::record_task)
+                    {
+                        if(t.event >= s.events.size())
+                            s.events.resize(t.event + 1);
+                        s.events[t.event] = true;
+                    }
+                    else if(t.kind != stream_task::wait_task or not s.recorded(t.event))
+                    {
+                        break;
+                    }
+                    q.tasks.pop_front();
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    // Find a stream whose next task can run. Must be called with the mutex held.
+    std::pair<stream_state*, stream_state::queue*> next()
+    {
+        for(auto* s : states)
+        {
+            for(auto& q : s->queues)
+            {
+                if(not q.running and not q.tasks.empty() and
+                   q.tasks.front().kind == stream_task::run_task)
+                    return {s, &q};
+            }
+        }
+        return {nullptr, nullptr};
+    }
+
+    void run()
+    {
+        scoped_thread_budget tb{budget};
+        std::unique_lock<std::mutex> lock(mutex);
+        for(;;)
+        {
+            std::pair<stream_state*, stream_state::queue*> p;
+            cv.wait(lock, [&] {
+                p = next();
+                return stop or p.second != nullptr;
+            });
+            if(p.second == nullptr)
+                return;
+            auto& q = *p.second;
+            auto f  = std::move(q.tasks.front().f);
+            q.tasks.pop_front();
+            q.running = true;
+            lock.unlock();
+            std::exception_ptr e = nullptr;
+            try
+            {
+                f();
+            }
+            catch(...)
+            {
+                e = std::current_exception();
+            }
+            lock.lock();
+            q.running = false;
+            // Keep running the tasks after an error so that the events still get recorded
+            if(q.error == nullptr)
+                q.error = e;
+            advance(*p.first);
+            cv.notify_all();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<stream_state*> states;
+    bool stop = false;
+    // Started last so that the other members are initialized before the threads use them
+    std::vector<std::thread> threads;
+};
+
+context::context(const context& other) : streams(other.streams), pool(other.pool) {}
+
+context& context::operator=(const context& other)
+{
+    streams = other.streams;
+    state   = nullptr;
+    pool    = other.pool;
+    return *this;
+}
+
+context::~context() = default;
+
+stream_state& context::get_state()
+{
+    if(state == nullptr)
+    {
+        auto p = pool;
+        auto s = std::make_unique<stream_state>(p->size());
+        p->add(s.get());
+        // The pool runs the remaining tasks of the streams before the state is deleted
+        state = std::shared_ptr<stream_state>(s.release(), [p](stream_state* x) {
+            p->remove(x);
+            delete x; // NOLINT
+        });
+    }
+    return *state;
+}
+
+void context::finish() const
+{
+    if(state == nullptr)
+        return;
+    auto e = pool->sync(*state);
+    if(e != nullptr)
+        std::rethrow_exception(e);
+}
+
+void context::create_streams(std::size_t n)
+{
+    if(n <= streams)
+        return;
+    streams = n;
+    state   = nullptr;
+    // The pool is created here so that the copies of the compiled context share it
+    pool = std::make_shared<stream_pool>(n);
+}
+
+void context::submit(std::size_t stream, stream_task t)
+{
+    if(stream >= streams)
+        MIGRAPHX_THROW("CPU: stream " + std::to_string(stream) + " was not created");
+    auto& s = get_state();
+    pool->submit(s, stream, std::move(t));
+}
+
+void context::execute(std::size_t stream, std::function<void()> f)
+{
+    if(streams == 1 and stream == 0)
+        f();
+    else
+        this->submit(stream, {stream_task::run_task, std::move(f)});
+}
+
+void context::run(const std::function<void()>& f)
+{
+    if(streams == 1)
+    {
+        f();
+        return;
+    }
+    scoped_thread_budget tb{pool->budget};
+    f();
+}
+
+void context::sync_stream(std::size_t stream)
+{
+    if(streams == 1)
+        return;
+    auto e = pool->sync(get_state(), stream);
+    if(e != nullptr)
+        std::rethrow_exception(e);
+}
+
+void context::record_event(std::size_t stream, std::size_t event)
+{
+    // A single stream runs everything in order, so there is nothing to wait for
+    if(streams == 1 and stream == 0)
+        return;
+    this->submit(stream, {stream_task::record_task, nullptr, event});
+}
+
+void context::wait_event(std::size_t stream, std::size_t event)
+{
+    if(streams == 1 and stream == 0)
+        return;
+    this->submit(stream, {stream_task::wait_task, nullptr, event});
+}
+
+void context::reset_events()
+{
+    if(state != nullptr)
+        pool->reset(*state);
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -22,6 +22,12 @@
  * THE SOFTWARE.
  */
 #include <migraphx/cpu/dnnl.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/stringutils.hpp>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
 
 #if defined(__GNUC__) && __GNUC__ <= 5
 namespace std {
@@ -53,6 +59,12 @@ dnnl_context& get_dnnl_context()
     return ctx;
 }
 
+dnnl::stream& get_dnnl_stream()
+{
+    thread_local dnnl::stream s{get_dnnl_context().engine}; // NOLINT
+    return s;
+}
+
 #ifdef __clang__
 #pragma clang diagnostic push
 #pragma clang diagnostic ignored "-Wswitch-enum"
@@ -95,6 +107,118 @@ dnnl::memory::desc to_dnnl_memory_desc(const shape& s)
     return {to_dnnl_dims(s.lens()), to_dnnl_memory_data_type(s.type()), to_dnnl_dims(s.strides())};
 }
 
+static const std::vector<std::pair<std::string, dnnl::memory::format_tag>>& blocked_layouts()
+{
+    using tag = dnnl::memory::format_tag;
+    static const std::vector<std::pair<std::string, tag>> m = {{"nCw8c", tag::nCw8c},
+                                                               {"nCw16c", tag::nCw16c},
+                                                               {"nChw8c", tag::nChw8c},
+                                                               {"nChw16c", tag::nChw16c},
+                                                               {"nCdhw8c", tag::nCdhw8c},
+                                                               {"nCdhw16c", tag::nCdhw16c}};
+    return m;
+}
+
+dnnl::memory::desc to_dnnl_memory_desc(const shape& s, const std::string& layout)
+{
+    if(layout.empty())
+        return to_dnnl_memory_desc(s);
+    auto dims = to_dnnl_dims(s.lens());
+    auto t    = to_dnnl_memory_data_type(s.type());
+    if(layout == "any" or is_dnnl_packed_layout(layout))
+        return {dims, t, dnnl::memory::format_tag::any};
+    auto it = std::find_if(blocked_layouts().begin(),
+                           blocked_layouts().end(),
+                           [&](const auto& p) { return p.first == layout; });
+    if(it == blocked_layouts().end())
+        MIGRAPHX_THROW("Unknown dnnl layout: " + layout);
+    dnnl::memory::desc result{dims, t, it->second};
+    // The blocked format must not need padding since the buffer is allocated for the shape
+    if(result.get_size() != s.bytes())
+        MIGRAPHX_THROW("Layout " + layout +
+                       " does not fit the buffer of " + migraphx::to_string(s));
+    return result;
+}
+
+std::string to_dnnl_layout(const dnnl::memory::desc& desc)
+{
+    auto dims = desc.dims();
+    for(const auto& [name, tag] : blocked_layouts())
+    {
+        try
+        {
+            if(dnnl::memory::desc{dims, desc.data_type(), tag} == desc)
+                return name;
+        }
+        catch(const dnnl::error&)
+        {
+            // The format does not apply to the number of dimensions
+        }
+    }
+    return "";
+}
+
+std::vector<std::string> get_op_layouts(const operation& op)
+{
+    auto v = op.to_value();
+    if(not v.contains("layouts"))
+        return {};
+    return v.at("layouts").to_vector<std::string>();
+}
+
+operation with_layouts(const operation& op, const std::vector<std::string>& layouts)
+{
+    auto v       = op.to_value();
+    v["layouts"] = layouts;
+    return make_op(op.name(), v);
+}
+
+bool is_dnnl_packed_layout(const std::string& layout)
+{
+    return layout == "packed" or starts_with(layout, "packed:");
+}
+
+std::string to_dnnl_packed_layout(const dnnl::memory::desc& desc)
+{
+    // FNV-1a hash of the memory descriptor
+    std::uint64_t h = 14695981039346656037ull;
+    for(auto x : to_dnnl_binary(desc))
+    {
+        h ^= x;
+        h *= 1099511628211ull;
+    }
+    std::stringstream ss;
+    ss << "packed:" << std::hex << std::setw(16) << std::setfill('0') << h;
+    return ss.str();
+}
+
+value::binary to_dnnl_binary(const dnnl::memory::desc& desc)
+{
+    return {reinterpret_cast<const std::uint8_t*>(&desc.data), sizeof(desc.data)};
+}
+
+dnnl::memory::desc from_dnnl_binary(const value::binary& b)
+{
+    dnnl::memory::desc result;
+    if(b.size() != sizeof(result.data))
+        MIGRAPHX_THROW("Invalid size for a dnnl memory descriptor: " + std::to_string(b.size()));
+    std::memcpy(&result.data, b.data(), b.size());
+    return result;
+}
+
+argument reorder_dnnl_memory(const argument& a,
+                             const dnnl::memory::desc& from,
+                             const dnnl::memory::desc& to)
+{
+    argument result{shape{shape::uint8_type, {to.get_size()}}};
+    auto src = to_dnnl_memory(from, a);
+    auto dst = to_dnnl_memory(to, result);
+    auto& s  = get_dnnl_stream();
+    dnnl::reorder(src, dst).execute(s, src, dst);
+    s.wait();
+    return result;
+}
+
 dnnl::memory to_dnnl_memory(const dnnl::memory::desc& desc, const argument& a)
 {
     return {desc, get_dnnl_context().engine, a.data()};
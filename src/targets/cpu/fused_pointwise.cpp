@@ -0,0 +1,338 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/cpu/fused_pointwise.hpp>
+#include <migraphx/cpu/pointwise.hpp>
+#include <migraphx/check_shapes.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/stringutils.hpp>
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+// Number of elements evaluated together. The registers of a module stay in
+// the L1 cache, while each operator runs as a loop the compiler can vectorize.
+constexpr std::size_t block_size = 256;
+
+using block_function = void (*)(float*, const float* const*, std::size_t);
+
+template <float (*F)(float)>
+void unary_block(float* y, const float* const* xs, std::size_t n)
+{
+    const float* x = xs[0];
+    for(std::size_t i = 0; i < n; i++)
+        y[i] = F(x[i]);
+}
+
+template <float (*F)(float, float)>
+void binary_block(float* z, const float* const* xs, std::size_t n)
+{
+    const float* x = xs[0];
+    const float* y = xs[1];
+    for(std::size_t i = 0; i < n; i++)
+        z[i] = F(x[i], y[i]);
+}
+
+inline void clip_block(float* y, const float* const* xs, std::size_t n)
+{
+    const float* x  = xs[0];
+    const float* lo = xs[1];
+    const float* hi = xs[2];
+    for(std::size_t i = 0; i < n; i++)
+        y[i] = std::min(std::max(x[i], lo[i]), hi[i]);
+}
+
+struct scalar_ops
+{
+    static float abs(float x) { return std::fabs(x); }
+    static float ceil(float x) { return std::ceil(x); }
+    static float cos(float x) { return std::cos(x); }
+    static float erf(float x) { return std::erf(x); }
+    static float exp(float x) { return std::exp(x); }
+    static float floor(float x) { return std::floor(x); }
+    static float identity(float x) { return x; }
+    static float log(float x) { return std::log(x); }
+    static float neg(float x) { return -x; }
+    static float recip(float x) { return 1.0f / x; }
+    static float relu(float x) { return std::max(x, 0.0f); }
+    static float rsqrt(float x) { return 1.0f / std::sqrt(x); }
+    static float sigmoid(float x) { return 1.0f / (1.0f + std::exp(-x)); }
+    static float sin(float x) { return std::sin(x); }
+    static float sqrt(float x) { return std::sqrt(x); }
+    static float tanh(float x) { return std::tanh(x); }
+
+    static float add(float x, float y) { return x + y; }
+    static float div(float x, float y) { return x / y; }
+    static float max(float x, float y) { return std::max(x, y); }
+    static float min(float x, float y) { return std::min(x, y); }
+    static float mul(float x, float y) { return x * y; }
+    static float pow(float x, float y) { return std::pow(x, y); }
+    static float prelu(float x, float slope) { return x < 0 ? slope * x : x; }
+    static float sqdiff(float x, float y) { return (x - y) * (x - y); }
+    static float sub(float x, float y) { return x - y; }
+};
+
+// Operators without attributes that have a specialized loop. Every other
+// operator is evaluated a block at a time with its own compute function.
+static const std::unordered_map<std::string, block_function>& block_functions()
+{
+    static const std::unordered_map<std::string, block_function> m = {
+        {"abs", &unary_block<&scalar_ops::abs>},
+        {"ceil", &unary_block<&scalar_ops::ceil>},
+        {"cos", &unary_block<&scalar_ops::cos>},
+        {"erf", &unary_block<&scalar_ops::erf>},
+        {"exp", &unary_block<&scalar_ops::exp>},
+        {"floor", &unary_block<&scalar_ops::floor>},
+        {"identity", &unary_block<&scalar_ops::identity>},
+        {"log", &unary_block<&scalar_ops::log>},
+        {"neg", &unary_block<&scalar_ops::neg>},
+        {"recip", &unary_block<&scalar_ops::recip>},
+        {"relu", &unary_block<&scalar_ops::relu>},
+        {"rsqrt", &unary_block<&scalar_ops::rsqrt>},
+        {"sigmoid", &unary_block<&scalar_ops::sigmoid>},
+        {"sin", &unary_block<&scalar_ops::sin>},
+        {"sqrt", &unary_block<&scalar_ops::sqrt>},
+        {"tanh", &unary_block<&scalar_ops::tanh>},
+        {"add", &binary_block<&scalar_ops::add>},
+        {"div", &binary_block<&scalar_ops::div>},
+        {"max", &binary_block<&scalar_ops::max>},
+        {"min", &binary_block<&scalar_ops::min>},
+        {"mul", &binary_block<&scalar_ops::mul>},
+        {"pow", &binary_block<&scalar_ops::pow>},
+        {"prelu", &binary_block<&scalar_ops::prelu>},
+        {"sqdiff", &binary_block<&scalar_ops::sqdiff>},
+        {"sub", &binary_block<&scalar_ops::sub>},
+        {"clip", &clip_block}};
+    return m;
+}
+
+struct cpu_fused_pointwise : reduce_dims_base
+{
+    // Registers are numbered with the inputs first, followed by the literals
+    // and then the result of each operator. The registers read by operator k
+    // are stored in args between arg_offsets[k] and arg_offsets[k + 1].
+    std::size_t inputs = 0;
+    std::vector<float> literals;
+    std::vector<operation> ops;
+    std::vector<std::size_t> args;
+    std::vector<std::size_t> arg_offsets = {0};
+    std::size_t output                   = 0;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.inputs, "inputs"),
+                    f(self.literals, "literals"),
+                    f(self.ops, "ops"),
+                    f(self.args, "args"),
+                    f(self.arg_offsets, "arg_offsets"),
+                    f(self.output, "output"));
+    }
+
+    std::string name() const { return "cpu::fused_pointwise"; }
+
+    shape compute_shape(const std::vector<shape>& shapes) const
+    {
+        check_shapes{shapes, *this}.has(inputs + 1).same_dims();
+        return shapes.back();
+    }
+
+    std::size_t first_op() const { return inputs + literals.size(); }
+
+    std::vector<block_function> get_block_functions() const
+    {
+        std::vector<block_function> result(ops.size());
+        std::transform(ops.begin(), ops.end(), result.begin(), [](const operation& op) {
+            auto it = block_functions().find(op.name());
+            if(it == block_functions().end())
+                return block_function{nullptr};
+            // Operators with attributes use their own compute
+            auto v = op.to_value();
+            if(v.is_object() and not v.empty())
+                return block_function{nullptr};
+            return it->second;
+        });
+        return result;
+    }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>& xs) const
+    {
+        argument result       = get_arg(xs, xs.size() - 1);
+        const auto& out_shape = result.get_shape();
+        auto* out             = result.cast<float>();
+        std::vector<argument> in_args(inputs);
+        for(std::size_t i = 0; i < inputs; i++)
+            in_args[i] = get_arg(xs, i);
+        auto functions = get_block_functions();
+
+        auto n        = out_shape.elements();
+        auto nblocks  = (n + block_size - 1) / block_size;
+        auto nregs    = first_op() + ops.size();
+        bool out_flat = out_shape.standard();
+        ctx.bulk_execute(nblocks, 4, [&](std::size_t start, std::size_t end) {
+            std::vector<float> storage(nregs * block_size);
+            std::vector<const float*> regs(nregs);
+            std::vector<const float*> op_args;
+            auto block = [&](std::size_t r) { return storage.data() + r * block_size; };
+            for(std::size_t i = 0; i < literals.size(); i++)
+            {
+                auto r = inputs + i;
+                std::fill(block(r), block(r) + block_size, literals[i]);
+                regs[r] = block(r);
+            }
+            for(std::size_t i = 0; i < inputs; i++)
+            {
+                const auto& s = in_args[i].get_shape();
+                if(not s.scalar())
+                    continue;
+                std::fill(block(i), block(i) + block_size, in_args[i].cast<float>()[0]);
+                regs[i] = block(i);
+            }
+            for(auto b = start; b < end; b++)
+            {
+                auto offset = b * block_size;
+                auto len    = std::min(block_size, n - offset);
+                for(std::size_t i = 0; i < inputs; i++)
+                {
+                    const auto& s = in_args[i].get_shape();
+                    const auto* x = in_args[i].cast<float>();
+                    if(s.scalar())
+                        continue;
+                    if(out_flat and s.standard())
+                    {
+                        regs[i] = x + offset;
+                        continue;
+                    }
+                    float* y = block(i);
+                    for(std::size_t j = 0; j < len; j++)
+                        y[j] = x[s.index(offset + j)];
+                    regs[i] = y;
+                }
+                for(std::size_t k = 0; k < ops.size(); k++)
+                {
+                    auto r   = first_op() + k;
+                    float* y = (r == output and out_flat) ? out + offset : block(r);
+                    op_args.clear();
+                    std::transform(args.begin() + arg_offsets[k],
+                                   args.begin() + arg_offsets[k + 1],
+                                   std::back_inserter(op_args),
+                                   [&](auto a) { return regs[a]; });
+                    if(functions[k] != nullptr)
+                        functions[k](y, op_args.data(), len);
+                    else
+                        compute_block(ops[k], y, op_args, len);
+                    regs[r] = y;
+                }
+                const float* z = regs[output];
+                if(out_flat)
+                {
+                    if(z != out + offset)
+                        std::copy(z, z + len, out + offset);
+                }
+                else
+                {
+                    for(std::size_t j = 0; j < len; j++)
+                        out[out_shape.index(offset + j)] = z[j];
+                }
+            }
+        });
+        return xs.back();
+    }
+
+    static void
+    compute_block(const operation& op, float* y, const std::vector<const float*>& xs, std::size_t n)
+    {
+        shape s{shape::float_type, {n}};
+        std::vector<argument> block_args;
+        std::transform(xs.begin(), xs.end(), std::back_inserter(block_args), [&](const float* x) {
+            return argument{s, const_cast<float*>(x)}; // NOLINT
+        });
+        auto r = op.compute(s, block_args);
+        r.visit([&](auto v) { std::copy(v.begin(), v.end(), y); });
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+};
+MIGRAPHX_REGISTER_OP(cpu_fused_pointwise)
+
+std::optional<operation> compile_pointwise(const module& m)
+{
+    cpu_fused_pointwise op;
+    std::unordered_map<instruction_ref, std::size_t> regs;
+    auto names = m.get_parameter_names();
+    // The inputs of the pointwise instruction are in the order of the sorted parameter names
+    std::sort(names.begin(), names.end());
+    op.inputs = names.size();
+    for(std::size_t i = 0; i < names.size(); i++)
+        regs[m.get_parameter(names[i])] = i;
+
+    for(auto ins : iterator_for(m))
+    {
+        if(ins->get_shape().type() != shape::float_type and ins->name() != "@return")
+            return std::nullopt;
+        if(ins->name() != "@literal")
+            continue;
+        auto lit = ins->get_literal();
+        if(lit.get_shape().elements() != 1)
+            return std::nullopt;
+        regs[ins] = op.inputs + op.literals.size();
+        op.literals.push_back(lit.at<float>());
+    }
+    for(auto ins : iterator_for(m))
+    {
+        if(contains(regs, ins))
+            continue;
+        if(ins->name() == "@return")
+        {
+            if(ins->inputs().size() != 1)
+                return std::nullopt;
+            op.output = regs.at(ins->inputs().front());
+            return op;
+        }
+        if(starts_with(ins->name(), "@") or not ins->module_inputs().empty())
+            return std::nullopt;
+        std::transform(ins->inputs().begin(),
+                       ins->inputs().end(),
+                       std::back_inserter(op.args),
+                       [&](auto input) { return regs.at(input); });
+        regs[ins] = op.first_op() + op.ops.size();
+        op.ops.push_back(ins->get_operator());
+        op.arg_offsets.push_back(op.args.size());
+    }
+    return std::nullopt;
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -38,7 +38,7 @@ struct cpu_allocation_model
     std::string copy() const;
     operation allocate(const shape& s) const;
     operation preallocate(const shape& s, const std::string& id) const;
-    bool needs_out_params() const { return false; }
+    bool needs_out_params() const { return true; }
 };
 
 } // namespace cpu
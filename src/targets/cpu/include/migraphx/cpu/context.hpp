@@ -29,14 +29,47 @@
 #include <migraphx/cpu/parallel.hpp>
 #include <migraphx/par_for.hpp>
 #include <migraphx/cpu/export.h>
+#include <functional>
+#include <memory>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
-struct context
+struct stream_pool;
+struct stream_state;
+struct stream_task;
+
+struct MIGRAPHX_CPU_EXPORT context
 {
-    void finish() const {}
+    context() = default;
+    // Copies share the threads of the streams, but have their own events so that they can be
+    // evaluated concurrently
+    context(const context& other);
+    context& operator=(const context& other);
+    context(context&&) noexcept            = default;
+    context& operator=(context&&) noexcept = default;
+    ~context();
+
+    /// Wait for the work submitted on all of the streams
+    void finish() const;
+
+    /// Make sure at least n streams are available. With more than one stream, the streams run on
+    /// n worker threads that are shared with the copies of the context, and the threads are split
+    /// evenly between the streams for the intra-op parallelism.
+    void create_streams(std::size_t n);
+    std::size_t nstreams() const { return streams; }
+
+    /// Run f on the stream after the work previously submitted to it
+    void execute(std::size_t stream, std::function<void()> f);
+    /// Run f now on the calling thread, using the thread budget of a stream
+    void run(const std::function<void()>& f);
+    /// Wait on the calling thread for the work submitted on the stream
+    void sync_stream(std::size_t stream);
+    void record_event(std::size_t stream, std::size_t event);
+    void wait_event(std::size_t stream, std::size_t event);
+    /// Wait for all of the streams and clear the recorded events
+    void reset_events();
 
     template <class F>
     void bulk_execute(std::size_t n, std::size_t min_grain, F f)
@@ -49,6 +82,13 @@ struct context
     {
         this->bulk_execute(n, 256, f);
     }
+
+    private:
+    stream_state& get_state();
+    void submit(std::size_t stream, stream_task t);
+    std::size_t streams                 = 1;
+    std::shared_ptr<stream_pool> pool   = nullptr;
+    std::shared_ptr<stream_state> state = nullptr;
 };
 
 } // namespace cpu
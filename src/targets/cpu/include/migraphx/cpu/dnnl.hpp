@@ -29,6 +29,7 @@
 #include <migraphx/reflect.hpp>
 #include <migraphx/register_op.hpp>
 #include <migraphx/check_shapes.hpp>
+#include <migraphx/value.hpp>
 #include <unordered_map>
 #include <migraphx/errors.hpp>
 #include <migraphx/assert.hpp>
@@ -53,12 +54,16 @@ namespace dnnl = zendnn;
 struct dnnl_context
 {
     dnnl::engine engine;
-    dnnl::stream stream;
-    dnnl_context() : engine(dnnl::engine::kind::cpu, 0), stream(engine) {}
+    dnnl_context() : engine(dnnl::engine::kind::cpu, 0) {}
 };
 
 dnnl_context& get_dnnl_context();
 
+// The stream used to execute the primitives on the calling thread. Each thread gets its own
+// stream on the shared engine so that instructions scheduled on different streams can execute
+// concurrently.
+dnnl::stream& get_dnnl_stream();
+
 dnnl::memory::data_type to_dnnl_memory_data_type(shape::type_t t);
 
 dnnl::memory::format_tag to_dnnl_memory_format_tag(std::size_t n);
@@ -71,6 +76,34 @@ inline dnnl::memory::dims to_dnnl_dims(R&& r)
 
 dnnl::memory::desc to_dnnl_memory_desc(const shape& s);
 
+// Layouts name the dnnl formats, such as nChw16c, for memory that is not laid out as described by
+// the strides of the shape. An empty layout uses the shape, and "any" lets dnnl pick the format.
+dnnl::memory::desc to_dnnl_memory_desc(const shape& s, const std::string& layout);
+
+// The name of the layout of the memory descriptor, or empty when it is not a blocked format
+std::string to_dnnl_layout(const dnnl::memory::desc& desc);
+
+// The layouts of the arguments of a dnnl op, with the output last
+std::vector<std::string> get_op_layouts(const operation& op);
+
+operation with_layouts(const operation& op, const std::vector<std::string>& layouts);
+
+// Constant weights can be packed ahead of time into the format the primitive prefers. The
+// "packed" layout lets dnnl pick that format, and resolves to "packed:<id>" where the id
+// identifies the exact format that was picked.
+bool is_dnnl_packed_layout(const std::string& layout);
+
+std::string to_dnnl_packed_layout(const dnnl::memory::desc& desc);
+
+value::binary to_dnnl_binary(const dnnl::memory::desc& desc);
+
+dnnl::memory::desc from_dnnl_binary(const value::binary& b);
+
+// Reorder the memory of the argument into a new buffer laid out as described by to
+argument reorder_dnnl_memory(const argument& a,
+                             const dnnl::memory::desc& from,
+                             const dnnl::memory::desc& to);
+
 dnnl::memory to_dnnl_memory(const dnnl::memory::desc& desc, const argument& a);
 
 dnnl::memory to_dnnl_memory(const argument& a);
@@ -108,12 +141,14 @@ template <class Derived, class Primitive>
 struct dnnl_op : auto_register_op<Derived>
 {
     std::vector<post_op> post_ops;
+    // The layouts of the arguments, with the output last
+    std::vector<std::string> layouts;
     std::function<argument(context& ctx, const std::vector<argument>& args)> execute;
 
     template <class Self, class F>
     static auto reflect_base(Self& self, F f)
     {
-        return pack(f(self.post_ops, "post_ops"));
+        return pack(f(self.post_ops, "post_ops"), f(self.layouts, "layouts"));
     }
 
     template <class Self, class F>
@@ -173,6 +208,60 @@ struct dnnl_op : auto_register_op<Derived>
 #endif
         return str == nullptr ? "" : str;
     }
+    static dnnl::memory::desc query_arg_desc(const Primitive& prim, int arg)
+    {
+        auto desc = prim.get_primitive_desc();
+#ifdef MIGRAPHX_ENABLE_ZENDNN
+        const auto* md = zendnn_primitive_desc_query_md(desc, zendnn_query_exec_arg_md, arg);
+#else
+        const auto* md = dnnl_primitive_desc_query_md(desc, dnnl_query_exec_arg_md, arg);
+#endif
+        if(md == nullptr)
+            MIGRAPHX_THROW("Missing memory descriptor for: " + std::to_string(arg));
+        return dnnl::memory::desc{*md};
+    }
+    std::string get_layout(std::size_t i) const
+    {
+        if(i >= layouts.size())
+            return "";
+        return layouts[i];
+    }
+    // Replace the layouts that dnnl was free to pick with the format it picked
+    std::vector<std::string> resolve_layouts(const Primitive& prim, std::size_t n) const
+    {
+        std::vector<std::string> result(n + 1);
+        auto m = create_arg_map(n);
+        for(std::size_t i = 0; i < result.size(); i++)
+        {
+            result[i] = get_layout(i);
+            if(result[i] != "any" and not is_dnnl_packed_layout(result[i]))
+                continue;
+            auto arg  = i == n ? MIGRAPHX_DNNL_PREFIX(ARG_DST) : m[i];
+            auto desc = query_arg_desc(prim, arg);
+            result[i] = result[i] == "any" ? to_dnnl_layout(desc) : to_dnnl_packed_layout(desc);
+        }
+        return result;
+    }
+    // The packed arguments are read in the format the primitive picked, which must be the
+    // format they were packed for
+    void resolve_packed(const Primitive& prim,
+                        std::unordered_map<int, dnnl::memory::desc>& md,
+                        std::size_t n) const
+    {
+        const auto& self = static_cast<const Derived&>(*this);
+        auto m           = create_arg_map(n);
+        for(std::size_t i = 0; i < n; i++)
+        {
+            auto layout = get_layout(i);
+            if(not is_dnnl_packed_layout(layout))
+                continue;
+            auto desc = query_arg_desc(prim, m[i]);
+            if(to_dnnl_packed_layout(desc) != layout)
+                MIGRAPHX_THROW(self.name() + ": Argument " + std::to_string(i) +
+                               " was not packed for the format of the primitive: " + layout);
+            md[m[i]] = desc;
+        }
+    }
     // Map arg index to arg in dnnl
     std::vector<int> arg_map(int size) const
     {
@@ -241,12 +330,14 @@ struct dnnl_op : auto_register_op<Derived>
         const auto& self = static_cast<const Derived&>(*this);
         std::unordered_map<int, dnnl::memory::desc> result;
         result[MIGRAPHX_DNNL_PREFIX(ARG_DST)] =
-            to_dnnl_memory_desc(self.adjust_shape(output_shape, inputs.size(), output_shape));
+            to_dnnl_memory_desc(self.adjust_shape(output_shape, inputs.size(), output_shape),
+                                get_layout(inputs.size()));
         auto m = create_arg_map(inputs.size());
         assert(m.size() >= inputs.size());
         for(int i = 0; i < inputs.size(); i++)
         {
-            result[m[i]] = to_dnnl_memory_desc(self.adjust_shape(inputs[i], i, output_shape));
+            result[m[i]] =
+                to_dnnl_memory_desc(self.adjust_shape(inputs[i], i, output_shape), get_layout(i));
         }
         return result;
     }
@@ -299,14 +390,28 @@ struct dnnl_op : auto_register_op<Derived>
     {
         return shapes.size() - 1;
     }
-    value compile(context&, const shape& output_shape, std::vector<shape> inputs)
+    value compile(context&, const shape& output_shape, std::vector<shape> inputs) const
     {
         // Compensate for allocation
         inputs.pop_back();
         auto md        = to_memory_desc(output_shape, inputs);
         auto prim      = get_primitive(md);
         auto impl_name = impl(prim);
-        return {{"impl", impl_name}};
+        value result   = {{"impl", impl_name}, {"layouts", resolve_layouts(prim, inputs.size())}};
+        // The memory descriptors to pack the constant arguments from and to
+        const auto& self = static_cast<const Derived&>(*this);
+        auto m           = create_arg_map(inputs.size());
+        value packed     = value::object{};
+        for(std::size_t i = 0; i < inputs.size(); i++)
+        {
+            if(not is_dnnl_packed_layout(get_layout(i)))
+                continue;
+            auto from = to_dnnl_memory_desc(self.adjust_shape(inputs[i], i, output_shape));
+            packed[std::to_string(i)] = {{"from", to_dnnl_binary(from)},
+                                         {"to", to_dnnl_binary(query_arg_desc(prim, m[i]))}};
+        }
+        result["packed"] = packed;
+        return result;
     }
 
     void finalize(context&, const shape& output_shape, std::vector<shape> inputs)
@@ -318,6 +423,7 @@ struct dnnl_op : auto_register_op<Derived>
         auto md          = to_memory_desc(output_shape, inputs);
         auto prim        = get_primitive(md);
         auto arg_lookup  = create_arg_map(inputs.size());
+        resolve_packed(prim, md, inputs.size());
 #ifndef NDEBUG
         auto prim_attr = get_primitive_attr(md);
 #endif
@@ -327,6 +433,7 @@ struct dnnl_op : auto_register_op<Derived>
             auto debug_args = args;
             debug_args.pop_back();
             auto debug_md = to_memory_desc(output_shape, to_shapes(debug_args));
+            resolve_packed(prim, debug_md, debug_args.size());
             for(auto&& p : debug_md)
             {
                 if(md.count(p.first) == 0)
@@ -390,7 +497,7 @@ struct dnnl_op : auto_register_op<Derived>
                 to_dnnl_memory(md.at(MIGRAPHX_DNNL_PREFIX(ARG_DST)), args.back());
             for(int i = 0; i < args.size() - 1; i++)
                 m[arg_lookup[i]] = to_dnnl_memory(md.at(arg_lookup[i]), args[i]);
-            prim.execute(get_dnnl_context().stream, m);
+            prim.execute(get_dnnl_stream(), m);
             return args.back();
         });
     }
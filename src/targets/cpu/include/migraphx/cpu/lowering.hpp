@@ -33,6 +33,14 @@ struct module;
 
 namespace cpu {
 
+/// Replace the layernorm and gelu patterns with dnnl operators before the
+/// pointwise fusion breaks them up
+struct MIGRAPHX_CPU_EXPORT lower_patterns
+{
+    std::string name() const { return "cpu::lower_patterns"; }
+    void apply(module& m) const;
+};
+
 struct MIGRAPHX_CPU_EXPORT lowering
 {
     std::string name() const { return "cpu::lowering"; }
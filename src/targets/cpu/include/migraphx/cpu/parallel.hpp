@@ -25,6 +25,7 @@
 #define MIGRAPHX_GUARD_AMDMIGRAPHX_CPU_PARALLEL_HPP
 
 // #define MIGRAPHX_DISABLE_OMP
+#include <algorithm>
 #include <cmath>
 #include <cassert>
 #include <migraphx/config.hpp>
@@ -47,9 +48,18 @@ namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
 namespace cpu {
 
+// Number of threads the calling thread may use for intra-op parallelism, or 0 when it is not
+// limited. It is set on threads that run one of several concurrent streams so that the streams
+// share the cores instead of each of them using all of them.
+inline std::size_t& thread_budget()
+{
+    thread_local std::size_t n = 0;
+    return n;
+}
+
 #ifdef MIGRAPHX_DISABLE_OMP
 
-inline std::size_t max_threads() { return std::thread::hardware_concurrency(); }
+inline std::size_t hardware_threads() { return get_thread_pool().size(); }
 
 template <class F>
 void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
@@ -60,29 +70,17 @@ void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
     }
     else
     {
-        std::vector<joinable_thread> threads(threadsize);
-// Using const here causes gcc 5 to ICE
-#if(!defined(__GNUC__) || __GNUC__ != 5)
-        const
-#endif
-            std::size_t grainsize = std::ceil(static_cast<double>(n) / threads.size());
-
-        std::size_t work = 0;
-        std::generate(threads.begin(), threads.end(), [=, &work] {
-            auto result = joinable_thread([=]() mutable {
-                assert(work < n);
+        const std::size_t grainsize = std::ceil(static_cast<double>(n) / threadsize);
+        get_thread_pool().run(threadsize, threadsize, [&](std::size_t task, std::size_t) {
+            std::size_t work = task * grainsize;
+            if(work < n)
                 f(work, std::min(n, work + grainsize));
-            });
-            work += grainsize;
-            return result;
         });
-        // cppcheck-suppress unsignedLessThanZero
-        assert(work >= n);
     }
 }
 #else
 
-inline std::size_t max_threads() { return omp_get_max_threads(); }
+inline std::size_t hardware_threads() { return omp_get_max_threads(); }
 
 template <class F>
 void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
@@ -104,6 +102,45 @@ void parallel_for_impl(std::size_t n, std::size_t threadsize, F f)
     }
 }
 #endif
+
+inline std::size_t max_threads()
+{
+    auto n = hardware_threads();
+    if(thread_budget() == 0)
+        return n;
+    return std::min(n, thread_budget());
+}
+
+/// Limit the intra-op threads of the calling thread for the lifetime of the object
+struct scoped_thread_budget
+{
+    explicit scoped_thread_budget(std::size_t n) : prev(thread_budget())
+    {
+        thread_budget() = n;
+#ifndef MIGRAPHX_DISABLE_OMP
+        // The dnnl primitives size their parallel regions from the omp settings
+        prev_omp = omp_get_max_threads();
+        if(n > 0)
+            omp_set_num_threads(static_cast<int>(n));
+#endif
+    }
+    scoped_thread_budget(const scoped_thread_budget&)            = delete;
+    scoped_thread_budget& operator=(const scoped_thread_budget&) = delete;
+    ~scoped_thread_budget()
+    {
+        thread_budget() = prev;
+#ifndef MIGRAPHX_DISABLE_OMP
+        omp_set_num_threads(prev_omp);
+#endif
+    }
+
+    private:
+    std::size_t prev = 0;
+#ifndef MIGRAPHX_DISABLE_OMP
+    int prev_omp = 0;
+#endif
+};
+
 template <class F>
 void parallel_for(std::size_t n, std::size_t min_grain, F f)
 {
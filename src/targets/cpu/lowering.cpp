@@ -23,6 +23,7 @@
  */
 
 #include <migraphx/cpu/lowering.hpp>
+#include <migraphx/cpu/fused_pointwise.hpp>
 #include <migraphx/instruction.hpp>
 #include <migraphx/dfor.hpp>
 #include <migraphx/op/identity.hpp>
@@ -44,7 +45,7 @@
 #include <migraphx/op/rnn_var_sl_last_output.hpp>
 #include <migraphx/op/mod.hpp>
 #include <migraphx/op/fmod.hpp>
-#include <migraphx/shape_for_each.hpp>
+#include <migraphx/strided_for_each.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/par_dfor.hpp>
 #include <migraphx/clamp.hpp>
@@ -57,6 +58,8 @@
 #include <migraphx/match/gelu_erf.hpp>
 #include <migraphx/match/gelu_tanh.hpp>
 #include <migraphx/matcher.hpp>
+#include <migraphx/stringutils.hpp>
+#include <numeric>
 #include <unordered_map>
 #include <utility>
 #include <iostream>
@@ -200,14 +203,15 @@ struct cpu_pad
         });
 
         visit_all(result, args[0])([&](auto output, auto input) {
-            shape_for_each(input.get_shape(), [&](const auto& idx) {
-                std::vector<std::size_t> new_idx(idx.size());
-                std::transform(
-                    idx.begin(), idx.end(), op.pads.begin(), new_idx.begin(), [](auto i, auto j) {
-                        return i + j;
-                    });
-                output(new_idx.begin(), new_idx.end()) = input(idx.begin(), idx.end());
-            });
+            // The input is copied into the window of the output after the leading pads
+            const auto& in_shape    = input.get_shape();
+            const auto& out_strides = output.get_shape().strides();
+            std::size_t offset      = std::inner_product(
+                out_strides.begin(), out_strides.end(), op.pads.begin(), std::size_t{0});
+            strided_for_each(in_shape, shape{in_shape.type(), in_shape.lens(), out_strides})(
+                [&](auto in_idx, auto out_idx) {
+                    output.data()[offset + out_idx] = input.data()[in_idx];
+                });
         });
 
         return result;
@@ -360,10 +364,8 @@ struct cpu_apply
         extend_op("rnn_var_sl_last_output", "cpu::rnn_var_sl_last_output", false);
     }
 
-    void apply()
+    void apply_patterns()
     {
-        init();
-        // Apply fusion matchers first
         match::find_matches(*modl,
                             fuse_match(match::gelu_erf(),
                                        make_op("dnnl::eltwise", {{"algo", "eltwise_gelu_erf"}}),
@@ -372,6 +374,25 @@ struct cpu_apply
                                        make_op("dnnl::eltwise", {{"algo", "eltwise_gelu_tanh"}}),
                                        {"x"}),
                             fuse_match(match::layernorm(), make_op("dnnl::layernorm"), {"x"}));
+    }
+
+    void apply()
+    {
+        init();
+        apply_patterns();
+        // Single operators are better served by the dnnl primitives, so only
+        // compile the pointwise modules that fuse several operators
+        std::vector<instruction_ref> inlined;
+        for(auto it : iterator_for(*modl))
+        {
+            if(it->name() != "pointwise")
+                continue;
+            const auto* pm = it->module_inputs().front();
+            if(count_ops(*pm) < 2 or not compile_pointwise(*pm).has_value())
+                inlined.push_back(it);
+        }
+        for(auto ins : inlined)
+            inline_pointwise(ins);
         // Apply these operators first so the inputs can be const folded
         for(auto it : iterator_for(*modl))
         {
@@ -398,6 +419,10 @@ struct cpu_apply
             {
                 apply_pooling(it);
             }
+            else if(it->name() == "pointwise")
+            {
+                apply_pointwise(it);
+            }
             else if(apply_map.count(it->name()) > 0)
             {
                 apply_map.at(it->name())(it);
@@ -416,6 +441,52 @@ struct cpu_apply
                        {ins->inputs().front()});
     }
 
+    static std::size_t count_ops(const module& m)
+    {
+        return std::count_if(m.begin(), m.end(), [](const auto& ins) {
+            return not starts_with(ins.name(), "@");
+        });
+    }
+
+    void inline_pointwise(instruction_ref ins) const
+    {
+        const auto* pm = ins->module_inputs().front();
+        auto names     = pm->get_parameter_names();
+        std::sort(names.begin(), names.end());
+        std::unordered_map<instruction_ref, instruction_ref> map_ins;
+        std::transform(names.begin(),
+                       names.end(),
+                       ins->inputs().begin(),
+                       std::inserter(map_ins, map_ins.end()),
+                       [&](const auto& name, auto input) {
+                           return std::make_pair(pm->get_parameter(name), input);
+                       });
+        // The literals in the module are usually scalars so broadcast them to the output
+        for(auto pins : iterator_for(*pm))
+        {
+            if(pins->name() != "@literal")
+                continue;
+            auto l = modl->add_literal(pins->get_literal());
+            if(l->get_shape().lens() != ins->get_shape().lens())
+                l = modl->insert_instruction(
+                    ins, make_op("multibroadcast", {{"out_lens", ins->get_shape().lens()}}), l);
+            map_ins[pins] = l;
+        }
+        auto outputs = modl->insert_instructions(ins, pm, &map_ins);
+        modl->replace_instruction(ins, outputs.front());
+        modl->remove_instruction(ins);
+    }
+
+    instruction_ref apply_pointwise(instruction_ref ins) const
+    {
+        auto op = compile_pointwise(*ins->module_inputs().front());
+        assert(op.has_value());
+        auto inputs = ins->inputs();
+        inputs.push_back(insert_allocation(ins, ins->get_shape()));
+        // The module is no longer needed once it is compiled
+        return modl->replace_instruction(ins, *op, inputs, {});
+    }
+
     instruction_ref apply_pooling(instruction_ref ins) const
     {
         auto&& op = ins->get_operator();
@@ -457,6 +528,8 @@ struct cpu_apply
     }
 };
 
+void lower_patterns::apply(module& m) const { cpu_apply{&m}.apply_patterns(); }
+
 void lowering::apply(module& m) const { cpu_apply{&m}.apply(); }
 
 } // namespace cpu
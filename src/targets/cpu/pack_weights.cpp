@@ -0,0 +1,137 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/cpu/pack_weights.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/dnnl.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/value.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct packed_literal
+{
+    // The bytes of the literal in the format of the primitive that reads it
+    argument data;
+    // The shape of the literal before it was packed
+    shape s;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.data, "data"), f(self.s, "shape"));
+    }
+
+    std::string name() const { return "cpu::packed_literal"; }
+
+    shape compute_shape(const std::vector<shape>&) const { return s; }
+
+    argument compute(const shape&, const std::vector<argument>&) const
+    {
+        return {s, data.data()};
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const packed_literal& x)
+    {
+        os << x.name();
+        return os;
+    }
+};
+MIGRAPHX_REGISTER_OP(packed_literal);
+
+// The ops with the weights as the second argument
+static const std::vector<std::string>& weight_ops()
+{
+    static const std::vector<std::string> ops = {
+        "dnnl::convolution", "dnnl::convolution_backwards", "dnnl::dot"};
+    return ops;
+}
+
+// A literal that other instructions also read would be kept along with its packed copy, so only
+// the literals that are only read as weights are packed
+static bool only_read_as_weights(instruction_ref w)
+{
+    return std::all_of(w->outputs().begin(), w->outputs().end(), [&](instruction_ref out) {
+        const auto& inputs = out->inputs();
+        return contains(weight_ops(), out->name()) and inputs.size() > 1 and inputs[1] == w and
+               std::count(inputs.begin(), inputs.end(), w) == 1;
+    });
+}
+
+void pack_weights::apply(module& m) const
+{
+    // The literals that were already packed for a format
+    std::unordered_map<instruction_ref, std::unordered_map<std::string, instruction_ref>> packed;
+    for(auto ins : iterator_for(m))
+    {
+        if(not contains(weight_ops(), ins->name()))
+            continue;
+        auto inputs = ins->inputs();
+        auto w      = inputs.at(1);
+        if(w->name() != "@literal" or not only_read_as_weights(w))
+            continue;
+        auto op = ins->get_operator();
+        auto ls = get_op_layouts(op);
+        ls.resize(inputs.size());
+        ls[1] = "packed";
+        value info;
+        try
+        {
+            auto new_op = with_layouts(op, ls);
+            info        = compile(new_op, *ctx, ins->get_shape(), to_shapes(inputs));
+        }
+        catch(const std::exception&)
+        {
+            continue;
+        }
+        // The reference implementations only read the weights as they are
+        if(starts_with(info.at("impl").to<std::string>(), "ref:"))
+            continue;
+        ls               = info.at("layouts").to_vector<std::string>();
+        const auto& desc = info.at("packed").at("1");
+        auto& p          = packed[w];
+        if(not contains(p, ls[1]))
+        {
+            auto data = reorder_dnnl_memory(w->get_literal().get_argument(),
+                                            from_dnnl_binary(desc.at("from").get_binary()),
+                                            from_dnnl_binary(desc.at("to").get_binary()));
+            p[ls[1]]  = m.insert_instruction(w, packed_literal{data, w->get_shape()});
+        }
+        inputs[1] = p.at(ls[1]);
+        m.replace_instruction(ins, with_layouts(op, ls), inputs);
+    }
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
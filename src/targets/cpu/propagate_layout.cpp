@@ -0,0 +1,254 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/cpu/allocation_model.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/dnnl.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/stringutils.hpp>
+#include <migraphx/value.hpp>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+struct layout_rule
+{
+    // The inputs the layout is propagated from
+    std::vector<std::size_t> sources;
+    // The first input that is not a source, weights or such
+    std::size_t other_inputs = 1;
+    // Let dnnl pick the layouts of the first input and the output
+    bool pick = false;
+};
+
+static const std::unordered_map<std::string, layout_rule>& layout_rules()
+{
+    static const std::unordered_map<std::string, layout_rule> m = {
+        {"dnnl::convolution", {{0}, 2, true}},
+        {"dnnl::pooling", {{0}, 1, false}},
+        {"dnnl::eltwise", {{0}, 1, false}},
+        {"dnnl::binary", {{0, 1}, 0, false}}};
+    return m;
+}
+
+static shape plain_shape(const shape& s) { return {s.type(), s.lens()}; }
+
+struct layout_propagation
+{
+    module* m    = nullptr;
+    context* ctx = nullptr;
+    // The layout of the outputs that are not laid out as their shape describes
+    std::unordered_map<instruction_ref, std::string> layouts = {};
+    std::unordered_map<instruction_ref, std::unordered_map<std::string, instruction_ref>>
+        conversions = {};
+
+    std::string get_layout(instruction_ref ins) const
+    {
+        auto it = layouts.find(ins);
+        if(it == layouts.end())
+            return "";
+        return it->second;
+    }
+
+    instruction_ref convert(instruction_ref ins, const std::string& layout)
+    {
+        if(get_layout(ins) == layout)
+            return ins;
+        auto& c = conversions[ins];
+        if(contains(c, layout))
+            return c.at(layout);
+        auto x    = ins;
+        auto from = get_layout(ins);
+        // Reorder the input of a reorder directly, which cancels out a pair of reorders that
+        // goes back to the layout it started from
+        if(ins->name() == "dnnl::reorder")
+        {
+            x    = ins->inputs().front();
+            from = get_op_layouts(ins->get_operator()).empty()
+                       ? ""
+                       : get_op_layouts(ins->get_operator()).front();
+        }
+        auto s = plain_shape(ins->get_shape());
+        if(from == layout and x->get_shape() == s)
+        {
+            c[layout] = x;
+            return x;
+        }
+        auto alloc = m->insert_instruction(std::next(ins), cpu_allocation_model{}.allocate(s));
+        auto r     = m->insert_instruction(std::next(alloc),
+                                       make_op("dnnl::reorder",
+                                               {{"layouts", std::vector<std::string>{from, layout}}}),
+                                       x,
+                                       alloc);
+        if(not layout.empty())
+            layouts[r] = layout;
+        c[layout] = r;
+        return r;
+    }
+
+    // Check the layouts with dnnl, and return the layouts it resolved
+    std::vector<std::string> try_layouts(instruction_ref ins,
+                                         const std::vector<std::string>& ls) const
+    {
+        auto op     = with_layouts(ins->get_operator(), ls);
+        auto inputs = to_shapes(ins->inputs());
+        for(std::size_t i = 0; i + 1 < inputs.size(); i++)
+        {
+            if(not ls[i].empty())
+                inputs[i] = plain_shape(inputs[i]);
+        }
+        try
+        {
+            auto s = op.compute_shape(inputs);
+            if(s != ins->get_shape())
+                return {};
+            auto info = compile(op, *ctx, s, inputs);
+            if(info.contains("impl") and starts_with(info.at("impl").to<std::string>(), "ref:"))
+                return {};
+            return info.at("layouts").to_vector<std::string>();
+        }
+        catch(const std::exception&)
+        {
+            return {};
+        }
+    }
+
+    void propagate(instruction_ref ins)
+    {
+        if(not contains(layout_rules(), ins->name()) or not ins->get_shape().standard())
+            return;
+        const auto& rule = layout_rules().at(ins->name());
+        auto inputs      = ins->inputs();
+        auto n           = inputs.size() - 1;
+        std::vector<std::string> ls(n + 1);
+        std::string layout;
+        for(auto i : rule.sources)
+        {
+            layout = get_layout(inputs[i]);
+            if(not layout.empty())
+                break;
+        }
+        if(rule.pick)
+        {
+            ls.front() = layout.empty() ? "any" : layout;
+            ls.back()  = "any";
+            ls         = try_layouts(ins, ls);
+            if(ls.empty())
+                return;
+        }
+        else if(layout.empty())
+        {
+            return;
+        }
+        else
+        {
+            ls.back() = layout;
+        }
+        // The other inputs with the dimensions of the output are read in the same layout
+        auto first = rule.pick ? rule.other_inputs : 0;
+        for(std::size_t i = first; i < n; i++)
+        {
+            auto s = inputs[i]->get_shape();
+            if(not ls.back().empty() and
+               (get_layout(inputs[i]) == ls.back() or
+                (s.lens() == ins->get_shape().lens() and not s.broadcasted())))
+                ls[i] = ls.back();
+            else
+                ls[i] = "";
+        }
+        if(std::all_of(ls.begin(), ls.end(), [](const auto& l) { return l.empty(); }))
+            return;
+        ls = try_layouts(ins, ls);
+        if(ls.empty())
+            return;
+        for(std::size_t i = 0; i < n; i++)
+        {
+            if(ls[i] != get_layout(inputs[i]))
+                inputs[i] = convert(inputs[i], ls[i]);
+        }
+        m->replace_instruction(ins, with_layouts(ins->get_operator(), ls), inputs);
+        if(not ls.back().empty())
+            layouts[ins] = ls.back();
+    }
+
+    // A reorder can read any layout, so a reorder of a blocked output, such as a contiguous,
+    // reads it directly. A conversion of its output can then cancel out with it.
+    void read_layout(instruction_ref ins)
+    {
+        auto layout = get_layout(ins->inputs().front());
+        auto ls     = get_op_layouts(ins->get_operator());
+        ls.resize(ins->inputs().size());
+        if(layout.empty() or not ls.front().empty())
+            return;
+        ls.front() = layout;
+        m->replace_instruction(ins, with_layouts(ins->get_operator(), ls), ins->inputs());
+    }
+
+    // Reorder the arguments for the instructions that can't read their layout
+    void convert_arguments(instruction_ref ins)
+    {
+        auto op_layouts = ins->name().front() == '@' ? std::vector<std::string>{}
+                                                     : get_op_layouts(ins->get_operator());
+        auto inputs = ins->inputs();
+        for(std::size_t i = 0; i < inputs.size(); i++)
+        {
+            auto layout = get_layout(inputs[i]);
+            if(layout.empty())
+                continue;
+            if(i < op_layouts.size() and op_layouts[i] == layout)
+                continue;
+            // The same argument could have been used more than once
+            if(not contains(ins->inputs(), inputs[i]))
+                continue;
+            instruction::replace_argument(ins, inputs[i], convert(inputs[i], ""));
+        }
+    }
+
+    void apply()
+    {
+        for(auto ins : iterator_for(*m))
+        {
+            if(ins->name() == "dnnl::reorder")
+                read_layout(ins);
+            propagate(ins);
+            convert_arguments(ins);
+        }
+    }
+};
+
+void propagate_layout::apply(module& m) const
+{
+    layout_propagation{&m, ctx}.apply();
+}
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
@@ -0,0 +1,289 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/schedule.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/register_op.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/operation.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/env.hpp>
+#include <algorithm>
+#include <unordered_map>
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+namespace cpu {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_CPU_STREAMS)
+
+// Runs the operator on one of the streams of the context
+struct stream_op
+{
+    operation op;
+    std::size_t stream = 0;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.op, "op"), f(self.stream, "stream"));
+    }
+
+    std::string name() const { return "cpu::stream_op"; }
+
+    shape compute_shape(const std::vector<shape>& inputs) const
+    {
+        return op.compute_shape(inputs);
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return op.output_alias(shapes);
+    }
+
+    void finalize(context& ctx, const shape& output_shape, const std::vector<shape>& inputs)
+    {
+        ctx.create_streams(stream + 1);
+        if(not has_finalize(op))
+            return;
+        migraphx::context mctx = std::ref(ctx);
+        op.finalize(mctx, output_shape, inputs);
+    }
+
+    argument
+    compute(context& ctx, const shape& output_shape, const std::vector<argument>& args) const
+    {
+        // An operator that writes its result into the last argument can run later on the
+        // stream's thread, since the result is already known to be in that buffer
+        if(not args.empty() and args.back().get_shape() == output_shape and
+           op.output_alias(to_shapes(args)) == static_cast<std::ptrdiff_t>(args.size()) - 1)
+        {
+            ctx.execute(stream, [this, &ctx, output_shape, args] {
+                migraphx::context mctx = std::ref(ctx);
+                op.compute(mctx, output_shape, args);
+            });
+            return args.back();
+        }
+        // Otherwise the result is needed now so wait for the stream and run it here
+        ctx.sync_stream(stream);
+        argument result;
+        ctx.run([&] {
+            migraphx::context mctx = std::ref(ctx);
+            result                 = op.compute(mctx, output_shape, args);
+        });
+        return result;
+    }
+};
+
+struct record_event
+{
+    std::size_t event  = 0;
+    std::size_t stream = 0;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.event, "event"), f(self.stream, "stream"));
+    }
+
+    std::string name() const { return "cpu::record_event"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.record_event(stream, event);
+        return {};
+    }
+};
+
+struct wait_event
+{
+    std::size_t event  = 0;
+    std::size_t stream = 0;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.event, "event"), f(self.stream, "stream"));
+    }
+
+    std::string name() const { return "cpu::wait_event"; }
+    shape compute_shape(const std::vector<shape>&) const { return {}; }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>&) const
+    {
+        ctx.wait_event(stream, event);
+        return {};
+    }
+};
+
+// Wait for all of the streams. With reset it instead discards what is left over from a
+// previous eval, so it can start with no events recorded.
+struct wait_streams
+{
+    bool reset = false;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return pack(f(self.reset, "reset"));
+    }
+
+    std::string name() const { return "cpu::wait_streams"; }
+
+    shape compute_shape(const std::vector<shape>& inputs) const
+    {
+        if(inputs.empty())
+            return {};
+        return inputs.front();
+    }
+
+    argument compute(context& ctx, const shape&, const std::vector<argument>& args) const
+    {
+        if(reset)
+            ctx.reset_events();
+        else
+            ctx.finish();
+        if(args.empty())
+            return {};
+        return args.front();
+    }
+
+    std::ptrdiff_t output_alias(const std::vector<shape>& shapes) const
+    {
+        return shapes.empty() ? -1 : 0;
+    }
+};
+
+MIGRAPHX_REGISTER_OP(stream_op)
+MIGRAPHX_REGISTER_OP(record_event)
+MIGRAPHX_REGISTER_OP(wait_event)
+MIGRAPHX_REGISTER_OP(wait_streams)
+
+static std::size_t get_stream(instruction_ref ins)
+{
+    if(ins->name() != "cpu::stream_op")
+        return 0;
+    return any_cast<stream_op>(ins->get_operator()).stream;
+}
+
+std::size_t schedule_model::concurrency() const { return streams; }
+
+void schedule_model::sched(module& m, instruction_ref ins, std::size_t n) const
+{
+    // Builtins and instructions with submodules are evaluated on the calling thread
+    if(ins->name().front() == '@' or not ins->module_inputs().empty())
+        return;
+    m.replace_instruction(ins, stream_op{ins->get_operator(), n}, ins->inputs());
+}
+
+void schedule_model::wait(module& m, instruction_ref ins, std::size_t wait_id) const
+{
+    m.insert_instruction(ins, wait_event{wait_id, get_stream(ins)});
+}
+
+void schedule_model::record(module& m, instruction_ref ins, std::size_t wait_id) const
+{
+    m.insert_instruction(std::next(ins), record_event{wait_id, get_stream(ins)});
+}
+
+static std::unordered_map<std::string, std::size_t> create_weight_map()
+{
+    return {{"cpu::allocate", 0},
+            {"cpu::literal", 0},
+            {"cpu::packed_literal", 0},
+            {"cpu::preallocate", 0},
+            {"dnnl::convolution", 8},
+            {"dnnl::convolution_backwards", 8},
+            {"dnnl::pooling", 4},
+            {"dnnl::dot", 4}};
+}
+
+static const std::unordered_map<std::string, std::size_t>& weight_map()
+{
+    static const std::unordered_map<std::string, std::size_t> m = create_weight_map();
+    return m;
+}
+
+std::size_t schedule_model::weight(const operation& op) const
+{
+    if(weight_map().count(op.name()) == 0)
+    {
+        return 2;
+    }
+    return weight_map().at(op.name());
+}
+
+// Instructions that run on the calling thread and either read the data or write into a buffer
+// that could still be used by a stream
+static bool needs_wait(instruction_ref ins)
+{
+    if(ins->name() == "@return")
+        return true;
+    if(ins->name().front() == '@' or ins->inputs().empty())
+        return false;
+    if(contains({"cpu::stream_op", "cpu::record_event", "cpu::wait_event", "cpu::wait_streams"},
+                ins->name()))
+        return false;
+    // Views dont access the data
+    const auto& op = ins->get_operator();
+    return not is_context_free(op) or op.output_alias(to_shapes(ins->inputs())) < 0;
+}
+
+void schedule_streams::apply(module_pass_manager& mpm) const
+{
+    // Only the main module is scheduled so the events of the modules dont overlap
+    auto& m = mpm.get_module();
+    if(streams < 2 or mpm.get_root_module() != &m)
+        return;
+    mpm.run_pass(schedule{schedule_model{streams}});
+    if(std::none_of(m.begin(), m.end(), [](const auto& ins) {
+           return ins.name() == "cpu::stream_op";
+       }))
+        return;
+
+    auto first = std::find_if(
+        m.begin(), m.end(), [](const auto& ins) { return ins.name().front() != '@'; });
+    m.insert_instruction(first, wait_streams{true});
+    for(auto ins : iterator_for(m))
+    {
+        if(not needs_wait(ins))
+            continue;
+        if(ins != m.begin() and std::prev(ins)->name() == "cpu::wait_streams")
+            continue;
+        m.insert_instruction(ins, wait_streams{});
+    }
+    auto last = std::prev(m.end());
+    if(last->name() != "@return" and last->name() != "cpu::wait_streams")
+        m.add_instruction(wait_streams{}, last);
+}
+
+std::size_t default_streams() { return value_of(MIGRAPHX_CPU_STREAMS{}, 1); }
+
+} // namespace cpu
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
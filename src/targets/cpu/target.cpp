@@ -33,6 +33,7 @@
 #include <migraphx/eliminate_identity.hpp>
 #include <migraphx/eliminate_pad.hpp>
 #include <migraphx/eliminate_convert.hpp>
+#include <migraphx/fuse_pointwise.hpp>
 #include <migraphx/layout_nhwc.hpp>
 #include <migraphx/memory_coloring.hpp>
 #include <migraphx/propagate_constant.hpp>
@@ -51,6 +52,13 @@
 #include <migraphx/cpu/target.hpp>
 #include <migraphx/cpu/context.hpp>
 #include <migraphx/cpu/lowering.hpp>
+#include <migraphx/cpu/pack_weights.hpp>
+#include <migraphx/cpu/propagate_layout.hpp>
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/cpu/parallel.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/stringutils.hpp>
 #include <migraphx/pass.hpp>
 #include <migraphx/generate.hpp>
 #include <migraphx/normalize_ops.hpp>
@@ -95,6 +103,10 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
             dead_code_elimination{},
             propagate_constant{},
             dead_code_elimination{},
+            lower_patterns{},
+            dead_code_elimination{},
+            fuse_pointwise{},
+            dead_code_elimination{},
             lowering{},
             eliminate_contiguous{"dnnl::reorder"},
             dead_code_elimination{},
@@ -104,8 +116,13 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
             dead_code_elimination{},
             fuse_ops{&ctx},
             dead_code_elimination{},
+            propagate_layout{&ctx},
+            dead_code_elimination{},
+            pack_weights{&ctx},
+            dead_code_elimination{},
             write_literals{},
             dead_code_elimination{},
+            schedule_streams{default_streams()},
             memory_coloring{"cpu::allocate"},
             dead_code_elimination{},
             preallocate_param{"scratch", cpu_allocation_model{}},
@@ -114,6 +131,21 @@ std::vector<pass> target::get_passes(migraphx::context& gctx, const compile_opti
 
 argument target::allocate(const shape& s) const { return fill_argument(s, 0); }
 
+supported_segments target::find_supported(const_module_ref mod, support_metric) const
+{
+    // The elements are computed in parallel by all the threads
+    auto n = static_cast<float>(hardware_threads());
+    supported_segments result;
+    for(auto ins : iterator_for(*mod))
+    {
+        if(starts_with(ins->name(), "@") or not ins->module_inputs().empty())
+            continue;
+        const auto& s = ins->get_shape();
+        result.push_back({{ins}, s.dynamic() ? 0.0f : s.elements() / n});
+    }
+    return result;
+}
+
 MIGRAPHX_REGISTER_TARGET(target);
 
 } // namespace cpu
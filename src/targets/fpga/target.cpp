@@ -34,6 +34,7 @@
 #include <migraphx/dead_code_elimination.hpp>
 #include <migraphx/generate.hpp>
 #include <migraphx/normalize_ops.hpp>
+#include <migraphx/instruction.hpp>
 #include <migraphx/iterator_for.hpp>
 
 namespace migraphx {
@@ -65,14 +66,19 @@ argument target::allocate(const shape& s) const { return fill_argument(s, 0); }
 
 supported_segments target::find_supported(const_module_ref mod, support_metric m) const
 {
-    (void)m;
-
+    // The whole module runs as a single kernel, which has a fixed cost to launch and processes
+    // several elements at once
+    const float launch_cost = 1024;
+    const float width       = 16;
     supported_segment instrs;
+    instrs.metric = m == support_metric::latency ? launch_cost : 0;
     for(const auto ins : iterator_for(*mod))
     {
         instrs.instructions.insert(ins);
+        const auto& s = ins->get_shape();
+        if(ins->name().front() != '@' and not s.dynamic())
+            instrs.metric += s.elements() / width;
     }
-    instrs.metric = 1; // arbitrary value
     return {instrs};
 }
 
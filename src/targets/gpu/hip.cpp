@@ -212,6 +212,11 @@ argument to_gpu(const argument& arg, bool host)
 
 argument from_gpu(const argument& arg)
 {
+    // The results that are already on the host, like the outputs of the programs compiled with
+    // offload_copy, are returned as they are
+    if(arg.get_shape().type() != shape::tuple_type and not arg.empty() and
+       not is_device_ptr(arg.data()))
+        return arg;
     argument result;
     arg.visit(
         [&](auto x) {
@@ -265,6 +265,8 @@ struct context
         value result;
         result["events"]  = events.size();
         result["streams"] = current_device->nstreams();
+        result["device"]  = current_device->get_device_name();
+        result["cus"]     = current_device->get_cu_count();
 
         return result;
     }
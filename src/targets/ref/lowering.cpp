@@ -40,7 +40,7 @@
 #include <migraphx/op/argmax.hpp>
 #include <migraphx/op/argmin.hpp>
 #include <migraphx/op/rnn_var_sl_last_output.hpp>
-#include <migraphx/shape_for_each.hpp>
+#include <migraphx/strided_for_each.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <migraphx/par_dfor.hpp>
 #include <migraphx/clamp.hpp>
@@ -49,6 +49,7 @@
 #include <migraphx/tune_axis.hpp>
 #include <migraphx/pad_calc.hpp>
 
+#include <numeric>
 #include <unordered_map>
 #include <utility>
 #include <iostream>
@@ -252,14 +253,15 @@ struct ref_pad
         });
 
         visit_all(result, args[0])([&](auto output, auto input) {
-            shape_for_each(input.get_shape(), [&](const auto& idx) {
-                std::vector<std::size_t> new_idx(idx.size());
-                std::transform(
-                    idx.begin(), idx.end(), op.pads.begin(), new_idx.begin(), [](auto i, auto j) {
-                        return i + j;
-                    });
-                output(new_idx.begin(), new_idx.end()) = input(idx.begin(), idx.end());
-            });
+            // The input is copied into the window of the output after the leading pads
+            const auto& in_shape    = input.get_shape();
+            const auto& out_strides = output.get_shape().strides();
+            std::size_t offset      = std::inner_product(
+                out_strides.begin(), out_strides.end(), op.pads.begin(), std::size_t{0});
+            strided_for_each(in_shape, shape{in_shape.type(), in_shape.lens(), out_strides})(
+                [&](auto in_idx, auto out_idx) {
+                    output.data()[offset + out_idx] = input.data()[in_idx];
+                });
         });
 
         return result;
@@ -35,6 +35,9 @@
 #include <migraphx/generate.hpp>
 #include <migraphx/normalize_ops.hpp>
 #include <migraphx/eliminate_data_type.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/stringutils.hpp>
 
 namespace migraphx {
 inline namespace MIGRAPHX_INLINE_NS {
@@ -49,7 +52,7 @@ std::vector<pass> target::get_passes(migraphx::context&, const compile_options&)
             dead_code_elimination{},
             insert_pad{},
             dead_code_elimination{},
-            rewrite_rnn{},
+            rewrite_rnn{false},
             dead_code_elimination{},
             auto_contiguous{},
             dead_code_elimination{},
@@ -59,6 +62,20 @@ std::vector<pass> target::get_passes(migraphx::context&, const compile_options&)
 
 argument target::allocate(const shape& s) const { return fill_argument(s, 0); }
 
+supported_segments target::find_supported(const_module_ref mod, support_metric) const
+{
+    // Every instruction is supported, and costs one unit for each element it computes
+    supported_segments result;
+    for(auto ins : iterator_for(*mod))
+    {
+        if(starts_with(ins->name(), "@") or not ins->module_inputs().empty())
+            continue;
+        const auto& s = ins->get_shape();
+        result.push_back({{ins}, s.dynamic() ? 0.0f : static_cast<float>(s.elements())});
+    }
+    return result;
+}
+
 MIGRAPHX_REGISTER_TARGET(target);
 
 } // namespace ref
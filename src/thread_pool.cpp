@@ -0,0 +1,446 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/thread_pool.hpp>
+#include <migraphx/env.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <pthread.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace migraphx {
+inline namespace MIGRAPHX_INLINE_NS {
+
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_NUM_THREADS)
+MIGRAPHX_DECLARE_ENV_VAR(MIGRAPHX_THREAD_AFFINITY)
+
+namespace {
+
+// Set while a thread is executing tasks of a job, so nested jobs run serially
+thread_local bool inside_job = false; // NOLINT
+
+struct task_queue
+{
+    std::mutex m;
+    std::deque<std::size_t> tasks;
+
+    void assign(std::size_t first, std::size_t last)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        tasks.clear();
+        for(std::size_t i = first; i < last; i++)
+            tasks.push_back(i);
+    }
+
+    bool pop(std::size_t& task)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if(tasks.empty())
+            return false;
+        task = tasks.front();
+        tasks.pop_front();
+        return true;
+    }
+
+    bool steal(std::size_t& task)
+    {
+        std::lock_guard<std::mutex> lock(m);
+        if(tasks.empty())
+            return false;
+        task = tasks.back();
+        tasks.pop_back();
+        return true;
+    }
+};
+
+void pin_thread(std::thread& t, std::size_t cpu)
+{
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+    (void)t;
+    (void)cpu;
+#endif
+}
+
+// A job submitted while the worker threads are busy with a job from another thread. The idle
+// workers, and the workers that finish their part of the other job, join it until it has
+// nthreads threads.
+struct shared_job
+{
+    const std::function<void(std::size_t, std::size_t)>* f = nullptr;
+    std::size_t ntasks                                      = 0;
+    std::size_t nthreads                                    = 0;
+    std::atomic<std::size_t> next{0};
+    // The number of threads that joined, including the calling thread, and the ones still
+    // executing tasks. These are protected by the mutex of the pool.
+    std::size_t joined  = 1;
+    std::size_t running = 0;
+    std::mutex error_mutex;
+    std::exception_ptr error = nullptr;
+
+    bool available() const { return joined < nthreads and next < ntasks; }
+
+    void execute(std::size_t tid)
+    {
+        inside_job = true;
+        for(auto task = next++; task < ntasks; task = next++)
+        {
+            try
+            {
+                (*f)(task, tid);
+            }
+            catch(...)
+            {
+                std::lock_guard<std::mutex> lock(error_mutex);
+                if(error == nullptr)
+                    error = std::current_exception();
+            }
+        }
+        inside_job = false;
+    }
+};
+
+} // namespace
+
+struct thread_pool_impl
+{
+    using job_function = std::function<void(std::size_t, std::size_t)>;
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<task_queue>> queues;
+
+    std::mutex m;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+    std::size_t generation  = 0;
+    bool stop               = false;
+    const job_function* job = nullptr;
+    std::size_t job_threads = 0;
+    std::size_t active      = 0;
+    bool pinned             = false;
+
+    // Only one job can use the task queues at a time, the others are shared with the workers
+    // that are not busy
+    std::mutex job_mutex;
+    std::vector<shared_job*> shared_jobs;
+    std::mutex error_mutex;
+    std::exception_ptr error = nullptr;
+
+    std::atomic<std::uint64_t> jobs{0};
+    std::atomic<std::uint64_t> tasks{0};
+    std::atomic<std::uint64_t> steals{0};
+    std::atomic<std::uint64_t> idle_ns{0};
+
+    thread_pool_impl(std::size_t n, bool pin) : pinned(pin)
+    {
+        n = std::max<std::size_t>(n, 1);
+        for(std::size_t i = 0; i < n; i++)
+            queues.push_back(std::make_unique<task_queue>());
+        for(std::size_t i = 1; i < n; i++)
+        {
+            threads.emplace_back([this, i] { this->worker(i); });
+            if(pin)
+                pin_thread(threads.back(), i);
+        }
+    }
+
+    ~thread_pool_impl()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            stop = true;
+        }
+        work_cv.notify_all();
+        for(auto& t : threads)
+            t.join();
+    }
+
+    thread_pool_impl(const thread_pool_impl&)            = delete;
+    thread_pool_impl& operator=(const thread_pool_impl&) = delete;
+
+    void invoke(const job_function& f, std::size_t task, std::size_t tid)
+    {
+        try
+        {
+            f(task, tid);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if(error == nullptr)
+                error = std::current_exception();
+        }
+    }
+
+    // Execute the tasks in our own queue, and then steal from the other threads until every
+    // queue is empty. Tasks are never added while a job is running so there is nothing left to
+    // do after that.
+    void execute(const job_function& f, std::size_t tid, std::size_t nthreads)
+    {
+        inside_job = true;
+        std::size_t task = 0;
+        while(queues[tid]->pop(task))
+            invoke(f, task, tid);
+        for(std::size_t k = 1; k < nthreads; k++)
+        {
+            auto& victim = *queues[(tid + k) % nthreads];
+            while(victim.steal(task))
+            {
+                steals++;
+                invoke(f, task, tid);
+            }
+        }
+        inside_job = false;
+    }
+
+    void worker(std::size_t tid)
+    {
+        std::size_t seen = 0;
+        for(;;)
+        {
+            const job_function* f = nullptr;
+            std::size_t nthreads  = 0;
+            shared_job* sj        = nullptr;
+            std::size_t sj_tid    = 0;
+            {
+                std::unique_lock<std::mutex> lock(m);
+                auto start   = std::chrono::steady_clock::now();
+                auto has_job = [&] { return generation != seen and tid < job_threads; };
+                work_cv.wait(lock, [&] {
+                    return stop or has_job() or find_shared_job() != nullptr;
+                });
+                idle_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                               std::chrono::steady_clock::now() - start)
+                               .count();
+                if(stop)
+                    return;
+                if(has_job())
+                {
+                    seen     = generation;
+                    f        = job;
+                    nthreads = job_threads;
+                }
+                else
+                {
+                    sj     = find_shared_job();
+                    sj_tid = sj->joined++;
+                    sj->running++;
+                }
+            }
+            if(sj != nullptr)
+            {
+                sj->execute(sj_tid);
+                std::lock_guard<std::mutex> lock(m);
+                sj->running--;
+                if(sj->running == 0)
+                    done_cv.notify_all();
+                continue;
+            }
+            execute(*f, tid, nthreads);
+            {
+                std::lock_guard<std::mutex> lock(m);
+                active--;
+                if(active == 0)
+                    done_cv.notify_all();
+            }
+        }
+    }
+
+    // Requires the mutex to be held
+    shared_job* find_shared_job() const
+    {
+        auto it = std::find_if(shared_jobs.begin(), shared_jobs.end(), [](const shared_job* sj) {
+            return sj->available();
+        });
+        if(it == shared_jobs.end())
+            return nullptr;
+        return *it;
+    }
+
+    // Queue a job for the workers that are not busy, while the calling thread takes part as
+    // thread 0
+    void run_shared(std::size_t ntasks, std::size_t nthreads, const job_function& f)
+    {
+        shared_job sj;
+        sj.f        = &f;
+        sj.ntasks   = ntasks;
+        sj.nthreads = nthreads;
+        {
+            std::lock_guard<std::mutex> lock(m);
+            shared_jobs.push_back(&sj);
+        }
+        work_cv.notify_all();
+        sj.execute(0);
+        {
+            std::unique_lock<std::mutex> lock(m);
+            shared_jobs.erase(std::find(shared_jobs.begin(), shared_jobs.end(), &sj));
+            done_cv.wait(lock, [&] { return sj.running == 0; });
+        }
+        jobs++;
+        tasks += ntasks;
+        if(sj.error != nullptr)
+            std::rethrow_exception(sj.error);
+    }
+
+    void run(std::size_t ntasks, std::size_t nthreads, const job_function& f)
+    {
+        // Split the tasks evenly between the queues, so each thread starts with a contiguous
+        // range of tasks
+        for(std::size_t i = 0; i < nthreads; i++)
+            queues[i]->assign(i * ntasks / nthreads, (i + 1) * ntasks / nthreads);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            job         = &f;
+            job_threads = nthreads;
+            active      = nthreads - 1;
+            generation++;
+        }
+        work_cv.notify_all();
+        execute(f, 0, nthreads);
+        {
+            std::unique_lock<std::mutex> lock(m);
+            done_cv.wait(lock, [&] { return active == 0; });
+            job         = nullptr;
+            job_threads = 0;
+        }
+        jobs++;
+        tasks += ntasks;
+        std::exception_ptr e = nullptr;
+        std::swap(e, error);
+        if(e != nullptr)
+            std::rethrow_exception(e);
+    }
+};
+
+thread_pool::thread_pool(std::size_t nthreads, bool pin_threads)
+    : impl(std::make_unique<thread_pool_impl>(nthreads, pin_threads))
+{
+}
+
+thread_pool::~thread_pool() = default;
+
+std::size_t thread_pool::size() const { return impl->queues.size(); }
+
+void thread_pool::run(std::size_t ntasks,
+                      std::size_t max_threads,
+                      const std::function<void(std::size_t, std::size_t)>& f)
+{
+    const std::size_t nthreads = std::min({max_threads, ntasks, this->size()});
+    if(nthreads <= 1 or inside_job)
+    {
+        for(std::size_t i = 0; i < ntasks; i++)
+            f(i, 0);
+        return;
+    }
+    std::unique_lock<std::mutex> lock(impl->job_mutex, std::defer_lock);
+    if(not lock.try_lock())
+    {
+        impl->run_shared(ntasks, nthreads, f);
+        return;
+    }
+    impl->run(ntasks, nthreads, f);
+}
+
+// The pools whose worker threads were lost in a fork. Their threads can't be joined and their
+// mutexes could have been locked by the parent, so they can never be destroyed. They are kept
+// here on purpose, which leaks one pool for every fork that uses the pool in the child.
+static std::vector<std::unique_ptr<thread_pool_impl>>& abandoned_pools()
+{
+    static auto* pools = new std::vector<std::unique_ptr<thread_pool_impl>>(); // NOLINT
+    return *pools;
+}
+
+void thread_pool::restart()
+{
+    auto n   = this->size();
+    auto pin = impl->pinned;
+    abandoned_pools().push_back(std::move(impl));
+    impl = std::make_unique<thread_pool_impl>(n, pin);
+}
+
+thread_pool_stats thread_pool::stats() const
+{
+    thread_pool_stats result;
+    result.jobs    = impl->jobs;
+    result.tasks   = impl->tasks;
+    result.steals  = impl->steals;
+    result.idle_ns = impl->idle_ns;
+    return result;
+}
+
+void thread_pool::reset_stats()
+{
+    impl->jobs    = 0;
+    impl->tasks   = 0;
+    impl->steals  = 0;
+    impl->idle_ns = 0;
+}
+
+// Set in the child process after a fork, since only the forking thread is copied into the child
+// and the pool needs new workers. The pool is restarted by the first use in the child rather
+// than in the fork handler, so a child that doesn't use the pool doesn't start any threads.
+static std::atomic<bool> pool_forked{false}; // NOLINT
+
+static thread_pool& create_thread_pool()
+{
+    static thread_pool pool{value_of(MIGRAPHX_NUM_THREADS{}, std::thread::hardware_concurrency()),
+                            enabled(MIGRAPHX_THREAD_AFFINITY{})};
+#ifndef _WIN32
+    pthread_atfork(nullptr, nullptr, [] { pool_forked = true; });
+#endif
+    return pool;
+}
+
+thread_pool& get_thread_pool()
+{
+    static thread_pool& pool = create_thread_pool();
+    if(pool_forked)
+    {
+        static std::mutex restart_mutex;
+        std::lock_guard<std::mutex> lock(restart_mutex);
+        if(pool_forked)
+        {
+            pool.restart();
+            pool_forked = false;
+        }
+    }
+    return pool;
+}
+
+} // namespace MIGRAPHX_INLINE_NS
+} // namespace migraphx
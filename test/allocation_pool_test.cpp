@@ -0,0 +1,173 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/allocation_pool.hpp>
+#include <migraphx/argument.hpp>
+#include <migraphx/shape.hpp>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include "test.hpp"
+
+TEST_CASE(reuse_released_buffer)
+{
+    migraphx::allocation_pool pool;
+    auto x = pool.allocate(1000);
+    auto* p = x.get();
+    x.reset();
+    EXPECT(pool.stats().cached_bytes > 0);
+    auto y = pool.allocate(1000);
+    EXPECT(y.get() == p);
+    auto stats = pool.stats();
+    EXPECT(stats.allocations == 2);
+    EXPECT(stats.reused == 1);
+    EXPECT(stats.cached_bytes == 0);
+}
+
+TEST_CASE(reuse_similar_size)
+{
+    migraphx::allocation_pool pool;
+    auto* p = pool.allocate(1000).get();
+    // The sizes round up to the same size class
+    EXPECT(pool.allocate(980).get() == p);
+    EXPECT(pool.allocate(4000).get() != p);
+}
+
+TEST_CASE(zeroed_buffer)
+{
+    migraphx::allocation_pool pool;
+    {
+        auto x = pool.allocate(256);
+        std::fill(x.get(), x.get() + 256, 1);
+    }
+    auto y = pool.allocate(256);
+    EXPECT(std::all_of(y.get(), y.get() + 256, [](char c) { return c == 0; }));
+}
+
+TEST_CASE(peak_bytes)
+{
+    migraphx::allocation_pool pool;
+    {
+        auto x = pool.allocate(1024);
+        auto y = pool.allocate(1024);
+        EXPECT(pool.stats().bytes_in_use == 2048);
+    }
+    auto z     = pool.allocate(1024);
+    auto stats = pool.stats();
+    EXPECT(stats.bytes_in_use == 1024);
+    EXPECT(stats.peak_bytes == 2048);
+    pool.release();
+    EXPECT(pool.stats().cached_bytes == 0);
+}
+
+TEST_CASE(cached_bytes_under_peak)
+{
+    migraphx::allocation_pool pool;
+    pool.allocate(1024);
+    EXPECT(pool.stats().cached_bytes == 1024);
+    // The buffer of the size that is no longer used is freed to keep the new one
+    pool.allocate(4096);
+    auto stats = pool.stats();
+    EXPECT(stats.peak_bytes == 4096);
+    EXPECT(stats.cached_bytes == 4096);
+    EXPECT(stats.trimmed == 0);
+    pool.allocate(1024);
+    EXPECT(pool.stats().reused == 0);
+}
+
+TEST_CASE(set_limit)
+{
+    migraphx::allocation_pool pool;
+    {
+        auto x = pool.allocate(1024);
+        auto y = pool.allocate(1024);
+        pool.set_limit(1024);
+    }
+    auto stats = pool.stats();
+    EXPECT(stats.cached_bytes == 1024);
+    EXPECT(stats.trimmed == 1);
+}
+
+TEST_CASE(trim)
+{
+    migraphx::allocation_pool pool;
+    {
+        auto x = pool.allocate(1024);
+        auto y = pool.allocate(1024);
+    }
+    EXPECT(pool.stats().cached_bytes == 2048);
+    pool.trim(1024);
+    EXPECT(pool.stats().cached_bytes == 1024);
+    pool.trim(0);
+    EXPECT(pool.stats().cached_bytes == 0);
+}
+
+TEST_CASE(buffer_outlives_pool)
+{
+    std::shared_ptr<char> x;
+    {
+        migraphx::allocation_pool pool;
+        x = pool.allocate(128);
+    }
+    x.get()[127] = 1;
+    x.reset();
+}
+
+TEST_CASE(argument_from_current_pool)
+{
+    migraphx::shape s{migraphx::shape::float_type, {64}};
+    migraphx::allocation_pool pool;
+    {
+        migraphx::allocation_pool::scope scope{&pool};
+        EXPECT(migraphx::allocation_pool::current() == &pool);
+        migraphx::argument a{s};
+        migraphx::argument b{s};
+    }
+    EXPECT(migraphx::allocation_pool::current() == nullptr);
+    migraphx::argument c{s};
+    auto stats = pool.stats();
+    EXPECT(stats.allocations == 2);
+    EXPECT(stats.bytes_in_use == 0);
+}
+
+TEST_CASE(release_from_other_threads)
+{
+    migraphx::allocation_pool pool;
+    std::vector<std::shared_ptr<char>> buffers;
+    for(int i = 0; i < 64; i++)
+        buffers.push_back(pool.allocate(512));
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t] {
+            for(std::size_t i = t; i < buffers.size(); i += 4)
+                buffers[i].reset();
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(pool.stats().bytes_in_use == 0);
+    EXPECT(pool.stats().cached_bytes == 64 * 512);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
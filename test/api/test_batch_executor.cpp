@@ -0,0 +1,89 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <future>
+#include <numeric>
+#include <vector>
+#include <migraphx/migraphx.h>
+#include <migraphx/migraphx.hpp>
+#include "test.hpp"
+
+static migraphx::program create_batched_add(size_t batch)
+{
+    migraphx::program p;
+    migraphx::module m = p.get_main_module();
+    migraphx::shape s{migraphx_shape_float_type, {batch, 3}};
+    auto x = m.add_parameter("x", s);
+    auto y = m.add_parameter("y", s);
+    auto r = m.add_instruction(migraphx::operation("add"), {x, y});
+    m.add_return({r});
+    p.compile(migraphx::target("ref"));
+    return p;
+}
+
+static std::vector<float> run_request(const migraphx::batch_executor& be, float value)
+{
+    migraphx::shape s{migraphx_shape_float_type, {1, 3}};
+    std::vector<float> x_data(3, value);
+    std::vector<float> y_data{1, 2, 3};
+    migraphx::program_parameters pp;
+    pp.add("x", migraphx::argument(s, x_data.data()));
+    pp.add("y", migraphx::argument(s, y_data.data()));
+    auto outputs = be.run(pp);
+    return outputs[0].as_vector<float>();
+}
+
+TEST_CASE(batch_executor_run)
+{
+    migraphx::batch_executor be{create_batched_add(4)};
+    auto result = run_request(be, 1);
+    EXPECT(result == std::vector<float>{2, 3, 4});
+    auto stats = be.stats();
+    EXPECT(stats.requests() == 1);
+    EXPECT(stats.batches() == 1);
+    EXPECT(stats.rows() == 1);
+    EXPECT(stats.padded_rows() == 3);
+}
+
+TEST_CASE(batch_executor_concurrent)
+{
+    migraphx::batch_executor_options options;
+    options.set_max_batch(4);
+    options.set_max_latency(100000);
+    migraphx::batch_executor be{create_batched_add(4), options};
+    std::vector<std::future<std::vector<float>>> futures;
+    for(int i = 0; i < 8; i++)
+        futures.push_back(std::async(std::launch::async, [&, i] { return run_request(be, i); }));
+    for(int i = 0; i < 8; i++)
+    {
+        auto fi = static_cast<float>(i);
+        EXPECT(futures[i].get() == std::vector<float>{fi + 1, fi + 2, fi + 3});
+    }
+    auto stats = be.stats();
+    EXPECT(stats.requests() == 8);
+    EXPECT(stats.rows() == 8);
+    EXPECT(stats.batches() >= 2);
+    EXPECT(stats.max_queue_depth() <= 8);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/batch_executor.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/register_target.hpp>
+#include <numeric>
+#include <thread>
+#include "test.hpp"
+
+// Computes x * 2 + y, where y is broadcasted along the batch
+static migraphx::program create_program(const migraphx::shape& s)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto two = mm->add_literal(2.0f);
+    auto mul = mm->add_instruction(migraphx::make_op("mul"),
+                                   x,
+                                   mm->add_instruction(migraphx::make_op("multibroadcast"), two, x));
+    mm->add_return({mm->add_instruction(migraphx::make_op("add"), mul, x)});
+    p.compile(migraphx::make_target("ref"));
+    return p;
+}
+
+static std::vector<float> make_rows(std::size_t rows, float start)
+{
+    std::vector<float> result(rows * 3);
+    std::iota(result.begin(), result.end(), start);
+    return result;
+}
+
+static migraphx::parameter_map make_request(std::vector<float>& data)
+{
+    migraphx::shape s{migraphx::shape::float_type, {data.size() / 3, 3}};
+    return {{"x", migraphx::argument{s, data.data()}}};
+}
+
+static bool check_result(const std::vector<migraphx::argument>& result,
+                         const std::vector<float>& data)
+{
+    if(result.size() != 1)
+        return false;
+    if(result.front().get_shape().lens() != std::vector<std::size_t>{data.size() / 3, 3})
+        return false;
+    std::vector<float> output;
+    result.front().visit([&](auto v) { output.assign(v.begin(), v.end()); });
+    return std::equal(output.begin(), output.end(), data.begin(), data.end(), [](auto x, auto y) {
+        return x == y * 3;
+    });
+}
+
+TEST_CASE(batch_single)
+{
+    migraphx::batch_executor e{create_program({migraphx::shape::float_type, {4, 3}})};
+    EXPECT(e.batch_sizes() == std::vector<std::size_t>{4});
+    auto data = make_rows(1, 1);
+    EXPECT(check_result(e.run(make_request(data)), data));
+    auto stats = e.stats();
+    EXPECT(stats.requests == 1);
+    EXPECT(stats.batches == 1);
+    EXPECT(stats.rows == 1);
+    EXPECT(stats.padded_rows == 3);
+    EXPECT(stats.queue_depth == 0);
+}
+
+TEST_CASE(batch_coalesce)
+{
+    migraphx::batch_executor_options options;
+    options.max_latency = std::chrono::seconds{10};
+    migraphx::batch_executor e{create_program({migraphx::shape::float_type, {4, 3}}), options};
+    auto data1 = make_rows(1, 1);
+    auto data2 = make_rows(3, 10);
+    // The first request waits until the second one fills up the batch
+    auto f1 = e.submit(make_request(data1));
+    auto f2 = e.submit(make_request(data2));
+    EXPECT(check_result(f1.get(), data1));
+    EXPECT(check_result(f2.get(), data2));
+    auto stats = e.stats();
+    EXPECT(stats.requests == 2);
+    EXPECT(stats.batches == 1);
+    EXPECT(stats.rows == 4);
+    EXPECT(stats.padded_rows == 0);
+}
+
+TEST_CASE(batch_split)
+{
+    migraphx::batch_executor e{create_program({migraphx::shape::float_type, {4, 3}})};
+    auto data = make_rows(10, -5);
+    EXPECT(check_result(e.run(make_request(data)), data));
+    auto stats = e.stats();
+    EXPECT(stats.batches == 3);
+    EXPECT(stats.rows == 10);
+    EXPECT(stats.padded_rows == 2);
+}
+
+TEST_CASE(batch_max_batch)
+{
+    migraphx::batch_executor_options options;
+    options.max_batch   = 2;
+    options.max_latency = std::chrono::seconds{10};
+    migraphx::batch_executor e{create_program({migraphx::shape::float_type, {4, 3}}), options};
+    auto data1 = make_rows(1, 1);
+    auto data2 = make_rows(1, 2);
+    auto f1    = e.submit(make_request(data1));
+    auto f2    = e.submit(make_request(data2));
+    EXPECT(check_result(f1.get(), data1));
+    EXPECT(check_result(f2.get(), data2));
+    auto stats = e.stats();
+    EXPECT(stats.batches == 1);
+    EXPECT(stats.padded_rows == 2);
+}
+
+TEST_CASE(batch_dynamic)
+{
+    migraphx::shape s{migraphx::shape::float_type, {{1, 8, {2, 4}}, {3, 3}}};
+    migraphx::batch_executor e{create_program(s)};
+    EXPECT(e.batch_sizes() == std::vector<std::size_t>{2, 4, 8});
+    auto data = make_rows(3, 1);
+    EXPECT(check_result(e.run(make_request(data)), data));
+    auto stats = e.stats();
+    EXPECT(stats.batches == 1);
+    EXPECT(stats.padded_rows == 1);
+}
+
+TEST_CASE(batch_concurrent)
+{
+    migraphx::batch_executor_options options;
+    options.max_latency = std::chrono::microseconds{100};
+    migraphx::batch_executor e{create_program({migraphx::shape::float_type, {8, 3}}), options};
+    std::vector<std::thread> threads;
+    std::vector<int> results(16);
+    for(std::size_t i = 0; i < results.size(); i++)
+    {
+        threads.emplace_back([&, i] {
+            auto data  = make_rows(1 + i % 3, static_cast<float>(i * 10));
+            results[i] = check_result(e.run(make_request(data)), data);
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(std::all_of(results.begin(), results.end(), [](int b) { return b != 0; }));
+    auto stats = e.stats();
+    EXPECT(stats.requests == 16);
+    EXPECT(stats.rows == 31);
+    EXPECT(stats.batches <= 16);
+}
+
+TEST_CASE(batch_invalid_request)
+{
+    migraphx::batch_executor e{create_program({migraphx::shape::float_type, {4, 3}})};
+    std::vector<float> data(8);
+    migraphx::shape s{migraphx::shape::float_type, {2, 4}};
+    EXPECT(test::throws([&] { e.submit({{"x", migraphx::argument{s, data.data()}}}); }));
+    EXPECT(test::throws([&] { e.submit({{"y", migraphx::argument{s, data.data()}}}); }));
+    EXPECT(test::throws([&] { e.submit({}); }));
+}
+
+TEST_CASE(batch_missing_parameter)
+{
+    migraphx::shape s{migraphx::shape::float_type, {4, 3}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    mm->add_return({mm->add_instruction(migraphx::make_op("add"), x, y)});
+    p.compile(migraphx::make_target("ref"));
+    migraphx::batch_executor e{p};
+    auto data = make_rows(2, 1);
+    EXPECT(test::throws([&] { e.submit(make_request(data)); }));
+    // A complete request still runs after the incomplete one was rejected
+    auto request = make_request(data);
+    request["y"] = request["x"];
+    auto result  = e.run(request);
+    std::vector<float> output;
+    result.front().visit([&](auto v) { output.assign(v.begin(), v.end()); });
+    EXPECT(output == std::vector<float>{2, 4, 6, 8, 10, 12});
+}
+
+TEST_CASE(batch_uncompiled)
+{
+    migraphx::program p;
+    p.get_main_module()->add_parameter("x", {migraphx::shape::float_type, {4, 3}});
+    EXPECT(test::throws([&] { migraphx::batch_executor{p}; }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,224 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/convolution.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/half.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <migraphx/verify.hpp>
+#include "test.hpp"
+
+struct conv_problem
+{
+    std::vector<std::size_t> input;
+    std::vector<std::size_t> weights;
+    std::vector<std::size_t> padding;
+    std::vector<std::size_t> stride;
+    std::vector<std::size_t> dilation;
+    int group = 1;
+
+    std::vector<std::size_t> output() const
+    {
+        std::vector<std::size_t> result = {input[0], weights[0]};
+        for(std::size_t d = 0; d < padding.size(); d++)
+        {
+            auto win = dilation[d] * (weights[d + 2] - 1) + 1;
+            result.push_back((input[d + 2] + 2 * padding[d] - win) / stride[d] + 1);
+        }
+        return result;
+    }
+};
+
+// Straightforward implementation used to check the convolution algorithms
+template <class Output, class T>
+void reference_convolution(Output output, T input, T weights, const conv_problem& p)
+{
+    auto wei_n = p.weights[0] / p.group;
+    auto wei_c = p.weights[1];
+    migraphx::shape win_shape{migraphx::shape::float_type,
+                              std::vector<std::size_t>(p.weights.begin() + 1, p.weights.end())};
+    migraphx::shape_for_each(output.get_shape(), [&](const auto& idx_o) {
+        auto group_id = idx_o[1] / wei_n;
+        double acc    = 0;
+        migraphx::shape_for_each(win_shape, [&](const auto& idx_w) {
+            std::vector<std::size_t> idx_in = {idx_o[0], group_id * wei_c + idx_w[0]};
+            for(std::size_t d = 0; d < p.padding.size(); d++)
+            {
+                auto x = std::ptrdiff_t(idx_o[d + 2] * p.stride[d] + idx_w[d + 1] * p.dilation[d]) -
+                         std::ptrdiff_t(p.padding[d]);
+                if(x < 0 or x >= std::ptrdiff_t(p.input[d + 2]))
+                    return;
+                idx_in.push_back(x);
+            }
+            std::vector<std::size_t> idx_wei = {idx_o[1]};
+            idx_wei.insert(idx_wei.end(), idx_w.begin(), idx_w.end());
+            acc += double(input(idx_in.begin(), idx_in.end())) *
+                   double(weights(idx_wei.begin(), idx_wei.end()));
+        });
+        output(idx_o.begin(), idx_o.end()) = acc;
+    });
+}
+
+template <class T, class U = T>
+bool verify_convolution(const conv_problem& p,
+                        migraphx::convolution_algorithm algo,
+                        migraphx::shape::type_t in_type  = migraphx::shape::float_type,
+                        migraphx::shape::type_t out_type = migraphx::shape::float_type)
+{
+    migraphx::shape is{in_type, p.input};
+    migraphx::shape ws{in_type, p.weights};
+    migraphx::shape os{out_type, p.output()};
+    auto input   = migraphx::generate_argument(is, 1);
+    auto weights = migraphx::generate_argument(ws, 2);
+    std::vector<T> result(os.elements());
+    std::vector<T> expected(os.elements());
+    auto iv = migraphx::make_view(is, reinterpret_cast<U*>(input.data()));
+    auto wv = migraphx::make_view(ws, reinterpret_cast<U*>(weights.data()));
+    migraphx::convolution(migraphx::make_view(os, result.data()),
+                          iv,
+                          wv,
+                          p.padding,
+                          p.stride,
+                          p.dilation,
+                          p.group,
+                          algo);
+    reference_convolution(migraphx::make_view(os, expected.data()), iv, wv, p);
+    return migraphx::verify::verify_rms_range(result, expected);
+}
+
+const std::vector<migraphx::convolution_algorithm>& all_algorithms()
+{
+    static const std::vector<migraphx::convolution_algorithm> result = {
+        migraphx::convolution_algorithm::automatic,
+        migraphx::convolution_algorithm::direct,
+        migraphx::convolution_algorithm::im2col};
+    return result;
+}
+
+const std::vector<migraphx::convolution_algorithm>& winograd_algorithms()
+{
+    static const std::vector<migraphx::convolution_algorithm> result = {
+        migraphx::convolution_algorithm::winograd_f2x3,
+        migraphx::convolution_algorithm::winograd_f4x3};
+    return result;
+}
+
+TEST_CASE(conv_1d)
+{
+    conv_problem p{{2, 3, 17}, {4, 3, 5}, {2}, {1}, {1}};
+    for(auto algo : all_algorithms())
+        EXPECT(verify_convolution<float>(p, algo));
+}
+
+TEST_CASE(conv_2d_stride_dilation)
+{
+    conv_problem p{{2, 5, 13, 11}, {6, 5, 3, 2}, {1, 2}, {2, 1}, {1, 2}};
+    for(auto algo : all_algorithms())
+        EXPECT(verify_convolution<float>(p, algo));
+}
+
+TEST_CASE(conv_3d)
+{
+    conv_problem p{{1, 2, 5, 6, 7}, {3, 2, 2, 3, 2}, {0, 1, 1}, {1, 2, 1}, {1, 1, 2}};
+    for(auto algo : all_algorithms())
+        EXPECT(verify_convolution<float>(p, algo));
+}
+
+TEST_CASE(conv_group)
+{
+    conv_problem p{{2, 8, 9, 9}, {6, 4, 3, 3}, {1, 1}, {1, 1}, {1, 1}, 2};
+    for(auto algo : all_algorithms())
+        EXPECT(verify_convolution<float>(p, algo));
+    for(auto algo : winograd_algorithms())
+        EXPECT(verify_convolution<float>(p, algo));
+}
+
+TEST_CASE(conv_depthwise)
+{
+    conv_problem p{{2, 6, 10, 10}, {12, 1, 3, 3}, {1, 1}, {2, 2}, {1, 1}, 6};
+    for(auto algo : all_algorithms())
+        EXPECT(verify_convolution<float>(p, algo));
+}
+
+TEST_CASE(conv_winograd)
+{
+    for(std::size_t pad : {0, 1})
+    {
+        // Output sizes that are not a multiple of the tile sizes
+        conv_problem p{{2, 9, 11, 14}, {10, 9, 3, 3}, {pad, pad}, {1, 1}, {1, 1}};
+        for(auto algo : winograd_algorithms())
+            EXPECT(verify_convolution<float>(p, algo));
+        EXPECT(verify_convolution<float>(p, migraphx::convolution_algorithm::automatic));
+    }
+}
+
+TEST_CASE(conv_winograd_half)
+{
+    conv_problem p{{1, 8, 10, 10}, {8, 8, 3, 3}, {1, 1}, {1, 1}, {1, 1}};
+    for(auto algo : winograd_algorithms())
+    {
+        EXPECT(verify_convolution<migraphx::half>(
+            p, algo, migraphx::shape::half_type, migraphx::shape::half_type));
+    }
+}
+
+TEST_CASE(conv_winograd_unsupported)
+{
+    conv_problem p{{1, 2, 8, 8}, {2, 2, 3, 3}, {0, 0}, {2, 2}, {1, 1}};
+    EXPECT(test::throws(
+        [&] { verify_convolution<float>(p, migraphx::convolution_algorithm::winograd_f2x3); }));
+}
+
+TEST_CASE(conv_int8)
+{
+    conv_problem p{{2, 4, 7, 7}, {5, 4, 3, 3}, {1, 1}, {1, 1}, {1, 1}};
+    for(auto algo : all_algorithms())
+    {
+        EXPECT(verify_convolution<int32_t, int8_t>(
+            p, algo, migraphx::shape::int8_type, migraphx::shape::int32_type));
+    }
+}
+
+TEST_CASE(conv_zero_channels)
+{
+    migraphx::shape is{migraphx::shape::float_type, {1, 0, 5, 5}};
+    migraphx::shape ws{migraphx::shape::float_type, {2, 0, 3, 3}};
+    migraphx::shape os{migraphx::shape::float_type, {1, 2, 3, 3}};
+    std::vector<float> input;
+    std::vector<float> weights;
+    for(auto algo : all_algorithms())
+    {
+        std::vector<float> result(os.elements(), 1.0f);
+        migraphx::convolution(migraphx::make_view(os, result.data()),
+                              migraphx::make_view(is, input.data()),
+                              migraphx::make_view(ws, weights.data()),
+                              std::vector<std::size_t>{0, 0},
+                              std::vector<std::size_t>{1, 1},
+                              std::vector<std::size_t>{1, 1},
+                              1,
+                              algo);
+        EXPECT(std::all_of(result.begin(), result.end(), [](auto x) { return x == 0.0f; }));
+    }
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
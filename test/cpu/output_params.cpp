@@ -0,0 +1,55 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/register_target.hpp>
+#include "test.hpp"
+
+TEST_CASE(output_parameter)
+{
+    migraphx::shape s{migraphx::shape::float_type, {4, 16}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    mm->add_return({mm->add_instruction(migraphx::make_op("add"), x, y)});
+    p.compile(migraphx::make_target("cpu"));
+    EXPECT(migraphx::contains(p.get_parameter_shapes(), "main:#output_0"));
+
+    migraphx::parameter_map params;
+    params["x"]   = migraphx::generate_argument(s, 0);
+    params["y"]   = migraphx::generate_argument(s, 1);
+    auto expected = p.eval(params).back();
+
+    // The result is written into the buffer of the output parameter
+    std::vector<float> output(s.elements());
+    params["main:#output_0"] = migraphx::argument{s, output.data()};
+    auto result              = p.eval(params).back();
+    EXPECT(result.data() == reinterpret_cast<char*>(output.data()));
+    EXPECT(result == expected);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
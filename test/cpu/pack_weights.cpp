@@ -0,0 +1,140 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/generate.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/load_save.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/verify.hpp>
+#include <algorithm>
+#include "test.hpp"
+
+migraphx::parameter_map create_params(const migraphx::program& p, const migraphx::target& t)
+{
+    migraphx::parameter_map m;
+    for(auto&& x : p.get_parameter_shapes())
+        m[x.first] = t.allocate(x.second);
+    m["x"] = migraphx::generate_argument(p.get_parameter_shape("x"), 1);
+    return m;
+}
+
+std::vector<float> eval_program(const migraphx::program& p, const migraphx::target& t)
+{
+    std::vector<float> result;
+    t.copy_from(p.eval(create_params(p, t)).back()).visit([&](auto v) {
+        result.assign(v.begin(), v.end());
+    });
+    return result;
+}
+
+std::vector<float> run_program(migraphx::program p, const migraphx::target& t)
+{
+    p.compile(t);
+    return eval_program(p, t);
+}
+
+std::size_t count_packed(const migraphx::program& p)
+{
+    const auto* mm = p.get_main_module();
+    return std::count_if(mm->begin(), mm->end(), [](const auto& ins) {
+        return ins.name() == "cpu::packed_literal";
+    });
+}
+
+migraphx::program create_conv(bool shared = false)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape xs{migraphx::shape::float_type, {1, 16, 14, 14}};
+    migraphx::shape ws{migraphx::shape::float_type, {16, 16, 3, 3}};
+    auto x    = mm->add_parameter("x", xs);
+    auto w    = mm->add_literal(migraphx::generate_literal(ws, 2));
+    auto conv = mm->add_instruction(migraphx::make_op("convolution", {{"padding", {1, 1}}}), x, w);
+    if(shared)
+    {
+        // The weights are also read by an op that is not a convolution
+        auto sum = mm->add_instruction(migraphx::make_op("reduce_sum", {{"axes", {0, 2, 3}}}), w);
+        auto b   = mm->add_instruction(
+            migraphx::make_op("multibroadcast", {{"out_lens", conv->get_shape().lens()}}),
+            mm->add_instruction(migraphx::make_op("reshape", {{"dims", {1, 16, 1, 1}}}), sum));
+        conv = mm->add_instruction(migraphx::make_op("add"), conv, b);
+    }
+    mm->add_return({conv});
+    return p;
+}
+
+TEST_CASE(pack_weights_accuracy)
+{
+    auto p = create_conv();
+    auto t = migraphx::make_target("cpu");
+    auto cpu_p = p;
+    cpu_p.compile(t);
+    EXPECT(count_packed(cpu_p) == 1);
+    auto cpu = eval_program(cpu_p, t);
+    auto ref = run_program(p, migraphx::make_target("ref"));
+    EXPECT(migraphx::verify::verify_rms_range(cpu, ref));
+}
+
+TEST_CASE(pack_weights_save_load)
+{
+    auto t = migraphx::make_target("cpu");
+    auto p = create_conv();
+    p.compile(t);
+    auto result = eval_program(p, t);
+    auto loaded = migraphx::load_buffer(migraphx::save_buffer(p));
+    EXPECT(count_packed(loaded) == 1);
+    EXPECT(eval_program(loaded, t) == result);
+
+    // The format the weights were packed in is checked against the primitive when it's loaded
+    auto v        = p.to_value();
+    bool modified = false;
+    for(auto& node : v.at("modules").at("main").at("nodes"))
+    {
+        if(node.at("name").to<std::string>() != "dnnl::convolution")
+            continue;
+        auto& layouts = node.at("operator").at("layouts");
+        EXPECT(layouts.at(1).to<std::string>().find("packed:") == 0);
+        layouts.at(1) = std::string{"packed:0000000000000000"};
+        modified      = true;
+    }
+    EXPECT(modified);
+    migraphx::program modified_p;
+    EXPECT(test::throws([&] { modified_p.from_value(v); }));
+}
+
+TEST_CASE(pack_weights_shared_literal)
+{
+    auto p = create_conv(true);
+    auto t = migraphx::make_target("cpu");
+    auto cpu_p = p;
+    cpu_p.compile(t);
+    // Packing would keep both copies of the weights
+    EXPECT(count_packed(cpu_p) == 0);
+    auto cpu = eval_program(cpu_p, t);
+    auto ref = run_program(p, migraphx::make_target("ref"));
+    EXPECT(migraphx::verify::verify_rms_range(cpu, ref));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
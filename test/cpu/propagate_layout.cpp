@@ -0,0 +1,217 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/serialize.hpp>
+#include <migraphx/verify.hpp>
+#include <algorithm>
+#include "test.hpp"
+
+// Run the passes of the cpu target from the pass named first, or from the start when it's
+// empty, up to and including the pass named last
+void run_cpu_passes(migraphx::program& p, const std::string& first, const std::string& last)
+{
+    auto t   = migraphx::make_target("cpu");
+    auto ctx = t.get_context();
+    std::vector<migraphx::pass> passes;
+    bool started = first.empty();
+    for(auto&& pass : t.get_passes(ctx, {}))
+    {
+        started = started or pass.name() == first;
+        if(started)
+            passes.push_back(pass);
+        if(pass.name() == last)
+            break;
+    }
+    migraphx::run_passes(p, passes);
+}
+
+std::vector<std::string> get_layouts(migraphx::instruction_ref ins)
+{
+    if(ins->name().front() == '@')
+        return {};
+    auto v = ins->get_operator().to_value();
+    if(not v.contains("layouts"))
+        return {};
+    return v.at("layouts").to_vector<std::string>();
+}
+
+// The layout of the output, which is empty when it's laid out as its shape describes
+std::string output_layout(migraphx::instruction_ref ins)
+{
+    auto layouts = get_layouts(ins);
+    if(layouts.empty())
+        return "";
+    return layouts.back();
+}
+
+// Only the dnnl ops that expect the layout of an input read it in a blocked layout
+bool check_layouts(const migraphx::module& m)
+{
+    for(auto ins : iterator_for(m))
+    {
+        auto layouts = get_layouts(ins);
+        auto inputs  = ins->inputs();
+        for(std::size_t i = 0; i < inputs.size(); i++)
+        {
+            auto layout = output_layout(inputs[i]);
+            if(not layout.empty() and (i >= layouts.size() or layouts[i] != layout))
+                return false;
+        }
+    }
+    return true;
+}
+
+std::vector<migraphx::instruction_ref> find_instructions(const migraphx::module& m,
+                                                         const std::string& name)
+{
+    std::vector<migraphx::instruction_ref> result;
+    for(auto ins : iterator_for(m))
+    {
+        if(ins->name() == name)
+            result.push_back(ins);
+    }
+    return result;
+}
+
+std::vector<float> run_program(migraphx::program p, const migraphx::target& t)
+{
+    p.compile(t);
+    migraphx::parameter_map m;
+    for(auto&& x : p.get_parameter_shapes())
+        m[x.first] = t.allocate(x.second);
+    m["x"] = migraphx::generate_argument(p.get_parameter_shape("x"), 1);
+    std::vector<float> result;
+    t.copy_from(p.eval(m).back()).visit([&](auto v) { result.assign(v.begin(), v.end()); });
+    return result;
+}
+
+migraphx::instruction_ref add_conv(migraphx::module& m, migraphx::instruction_ref x, int seed)
+{
+    migraphx::shape ws{migraphx::shape::float_type, {16, 16, 3, 3}};
+    auto w = m.add_literal(migraphx::generate_literal(ws, seed));
+    return m.add_instruction(migraphx::make_op("convolution", {{"padding", {1, 1}}}), x, w);
+}
+
+migraphx::shape input_shape() { return {migraphx::shape::float_type, {1, 16, 14, 14}}; }
+
+TEST_CASE(reorder_at_boundary)
+{
+    migraphx::program p;
+    auto* mm  = p.get_main_module();
+    auto x    = mm->add_parameter("x", input_shape());
+    auto conv = add_conv(*mm, x, 1);
+    auto sin  = mm->add_instruction(migraphx::make_op("sin"), conv);
+    mm->add_return({sin});
+    auto p_ref = p;
+
+    run_cpu_passes(p, "", "cpu::propagate_layout");
+    EXPECT(check_layouts(*mm));
+    auto convs = find_instructions(*mm, "dnnl::convolution");
+    EXPECT(convs.size() == 1);
+    auto layout   = output_layout(convs.front());
+    auto reorders = find_instructions(*mm, "dnnl::reorder");
+    if(layout.empty())
+    {
+        EXPECT(reorders.empty());
+    }
+    else
+    {
+        // The op that is not a dnnl op reads the output of the convolution through a reorder
+        EXPECT(reorders.size() == 1);
+        EXPECT(bool{reorders.front()->inputs().front() == convs.front()});
+        EXPECT(get_layouts(reorders.front()) == std::vector<std::string>{layout, ""});
+    }
+    EXPECT(migraphx::verify::verify_rms_range(run_program(p_ref, migraphx::make_target("cpu")),
+                                              run_program(p_ref, migraphx::make_target("ref"))));
+}
+
+TEST_CASE(cancel_reorder_pair)
+{
+    migraphx::program p;
+    auto* mm   = p.get_main_module();
+    auto x     = mm->add_parameter("x", input_shape());
+    auto conv1 = add_conv(*mm, x, 1);
+    auto conv2 = add_conv(*mm, conv1, 2);
+    mm->add_return({conv2});
+    run_cpu_passes(p, "", "cpu::fuse_ops");
+
+    // Read the output of the first convolution through a reorder to the layout of the shape,
+    // like a contiguous
+    auto convs = find_instructions(*mm, "dnnl::convolution");
+    EXPECT(convs.size() == 2);
+    auto c1    = convs.front();
+    auto c2    = convs.back();
+    auto alloc = mm->insert_instruction(
+        c2,
+        migraphx::make_op("cpu::allocate", {{"shape", migraphx::to_value(c1->get_shape())}}));
+    auto reorder = mm->insert_instruction(
+        c2,
+        migraphx::make_op("dnnl::reorder", {{"layouts", std::vector<std::string>{"", ""}}}),
+        c1,
+        alloc);
+    migraphx::instruction::replace_argument(c2, c1, reorder);
+    run_cpu_passes(p, "cpu::propagate_layout", "cpu::propagate_layout");
+    migraphx::run_passes(p, {migraphx::dead_code_elimination{}});
+
+    EXPECT(check_layouts(*mm));
+    // A reorder never converts the output of another reorder
+    auto reorders = find_instructions(*mm, "dnnl::reorder");
+    EXPECT(std::none_of(reorders.begin(), reorders.end(), [](auto r) {
+        return r->inputs().front()->name() == "dnnl::reorder";
+    }));
+    auto input   = c2->inputs().front();
+    auto layouts = get_layouts(c2);
+    if(not layouts.empty() and output_layout(c1) == layouts.front())
+        EXPECT(bool{input == c1});
+    else
+        EXPECT(input->name() == "dnnl::reorder" and input->inputs().front() == c1);
+}
+
+TEST_CASE(conv_relu_conv)
+{
+    migraphx::program p;
+    auto* mm  = p.get_main_module();
+    auto x    = mm->add_parameter("x", input_shape());
+    auto conv = add_conv(*mm, x, 1);
+    auto relu = mm->add_instruction(migraphx::make_op("relu"), conv);
+    mm->add_return({add_conv(*mm, relu, 2)});
+    auto cpu = run_program(p, migraphx::make_target("cpu"));
+    auto ref = run_program(p, migraphx::make_target("ref"));
+    EXPECT(migraphx::verify::verify_rms_range(cpu, ref));
+
+    // The activations stay blocked between the convolutions
+    run_cpu_passes(p, "", "cpu::propagate_layout");
+    EXPECT(check_layouts(*p.get_main_module()));
+    auto reorders = find_instructions(*p.get_main_module(), "dnnl::reorder");
+    EXPECT(reorders.size() <= 2);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
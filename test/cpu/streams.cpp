@@ -0,0 +1,254 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/cpu/context.hpp>
+#include <migraphx/cpu/schedule_model.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/pass.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/reflect.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/verify.hpp>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include "test.hpp"
+
+// Compile the program for the target and evaluate it, allocating the parameters that are not
+// given such as the scratch memory
+std::vector<float> run_program(migraphx::program p,
+                               const migraphx::target& t,
+                               const migraphx::parameter_map& inputs,
+                               std::size_t n = 1)
+{
+    p.compile(t);
+    migraphx::parameter_map m;
+    for(auto&& x : p.get_parameter_shapes())
+    {
+        if(inputs.count(x.first) > 0)
+            m[x.first] = t.copy_to(inputs.at(x.first));
+        else
+            m[x.first] = t.allocate(x.second);
+    }
+    std::vector<float> result;
+    for(std::size_t i = 0; i < n; i++)
+    {
+        std::vector<float> r;
+        t.copy_from(p.eval(m).back()).visit([&](auto v) { r.assign(v.begin(), v.end()); });
+        // Every eval of the same inputs has the same result
+        if(i > 0)
+            EXPECT(r == result);
+        result = r;
+    }
+    return result;
+}
+
+std::size_t count_stream_ops(migraphx::program p)
+{
+    p.compile(migraphx::make_target("cpu"));
+    const auto* mm = p.get_main_module();
+    return std::count_if(
+        mm->begin(), mm->end(), [](const auto& ins) { return ins.name() == "cpu::stream_op"; });
+}
+
+migraphx::program create_branches()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape xs{migraphx::shape::float_type, {8, 64}};
+    migraphx::shape ws{migraphx::shape::float_type, {64, 32}};
+    auto x   = mm->add_parameter("x", xs);
+    auto w1  = mm->add_literal(migraphx::generate_literal(ws, 1));
+    auto w2  = mm->add_literal(migraphx::generate_literal(ws, 2));
+    auto d1  = mm->add_instruction(migraphx::make_op("dot"), x, w1);
+    auto d2  = mm->add_instruction(migraphx::make_op("dot"), x, w2);
+    auto r1  = mm->add_instruction(migraphx::make_op("relu"), d1);
+    auto t2  = mm->add_instruction(migraphx::make_op("tanh"), d2);
+    auto sum = mm->add_instruction(migraphx::make_op("add"), r1, t2);
+    mm->add_return({sum});
+    return p;
+}
+
+TEST_CASE(streams_branches)
+{
+    auto p = create_branches();
+    EXPECT(count_stream_ops(p) > 0);
+    migraphx::parameter_map m;
+    m["x"]   = migraphx::generate_argument({migraphx::shape::float_type, {8, 64}});
+    auto ref = run_program(p, migraphx::make_target("ref"), m);
+    auto cpu = run_program(p, migraphx::make_target("cpu"), m);
+    EXPECT(migraphx::verify::verify_rms_range(cpu, ref));
+}
+
+TEST_CASE(streams_repeated_evals)
+{
+    auto p = create_branches();
+    migraphx::parameter_map m;
+    m["x"]   = migraphx::generate_argument({migraphx::shape::float_type, {8, 64}}, 3);
+    auto ref = run_program(p, migraphx::make_target("ref"), m);
+    auto cpu = run_program(p, migraphx::make_target("cpu"), m, 10);
+    EXPECT(migraphx::verify::verify_rms_range(cpu, ref));
+}
+
+// Writes the input plus one into the last argument, so it is queued on the stream of the
+// instruction. It throws instead when fail is set and the input is negative.
+struct write_op
+{
+    bool fail = false;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::pack(f(self.fail, "fail"));
+    }
+
+    std::string name() const { return "write_op"; }
+    migraphx::shape compute_shape(std::vector<migraphx::shape> inputs) const
+    {
+        return inputs.back();
+    }
+    // Takes the context so that it isn't context free, which the scheduler would not put on a
+    // stream
+    migraphx::argument
+    compute(migraphx::context&, const migraphx::shape&, std::vector<migraphx::argument> args) const
+    {
+        auto* x = reinterpret_cast<float*>(args.front().data());
+        auto* y = reinterpret_cast<float*>(args.back().data());
+        for(std::size_t i = 0; i < args.back().get_shape().elements(); i++)
+        {
+            if(fail and x[i] < 0)
+                throw std::runtime_error("negative input");
+            y[i] = x[i] + 1;
+        }
+        return args.back();
+    }
+    std::ptrdiff_t output_alias(const std::vector<migraphx::shape>& shapes) const
+    {
+        return static_cast<std::ptrdiff_t>(shapes.size()) - 1;
+    }
+};
+
+// Only schedules the streams, so the instructions are the ones of the test
+struct stream_target
+{
+    std::string name() const { return "stream"; }
+    std::vector<migraphx::pass> get_passes(migraphx::context&,
+                                           const migraphx::compile_options&) const
+    {
+        return {migraphx::cpu::schedule_streams{2}};
+    }
+    migraphx::context get_context() const { return migraphx::cpu::context{}; }
+};
+
+TEST_CASE(streams_error)
+{
+    migraphx::shape s{migraphx::shape::float_type, {16}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    // The failing branch queues more work on its stream after the error
+    auto a1 = mm->add_instruction(write_op{true}, x, mm->add_parameter("a1", s));
+    auto a2 = mm->add_instruction(write_op{}, a1, mm->add_parameter("a2", s));
+    auto b1 = mm->add_instruction(write_op{}, x, mm->add_parameter("b1", s));
+    auto b2 = mm->add_instruction(write_op{}, b1, mm->add_parameter("b2", s));
+    mm->add_return({a2, b2});
+    p.compile(stream_target{});
+    EXPECT(std::any_of(
+        mm->begin(), mm->end(), [](const auto& ins) { return ins.name() == "cpu::stream_op"; }));
+
+    std::vector<float> a1_data(s.elements());
+    std::vector<float> a2_data(s.elements());
+    std::vector<float> b1_data(s.elements());
+    std::vector<float> b2_data(s.elements());
+    auto eval = [&](float value) {
+        std::vector<float> x_data(s.elements(), value);
+        return p.eval({{"x", migraphx::argument{s, x_data.data()}},
+                       {"a1", migraphx::argument{s, a1_data.data()}},
+                       {"a2", migraphx::argument{s, a2_data.data()}},
+                       {"b1", migraphx::argument{s, b1_data.data()}},
+                       {"b2", migraphx::argument{s, b2_data.data()}}});
+    };
+    EXPECT(test::throws<std::runtime_error>([&] { eval(-4); }, "negative input"));
+    // The work queued on the streams was drained before the error was reported
+    EXPECT(b2_data == std::vector<float>(s.elements(), -2));
+    // The program can be evaluated again after the error
+    for(float value : {1, 2, 3})
+    {
+        eval(value);
+        EXPECT(a2_data == std::vector<float>(s.elements(), value + 2));
+        EXPECT(b2_data == std::vector<float>(s.elements(), value + 2));
+    }
+}
+
+TEST_CASE(streams_concurrent_evals)
+{
+    migraphx::shape s{migraphx::shape::float_type, {16}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto a1  = mm->add_instruction(write_op{}, x, mm->add_parameter("a1", s));
+    auto a2  = mm->add_instruction(write_op{}, a1, mm->add_parameter("a2", s));
+    auto b1  = mm->add_instruction(write_op{}, x, mm->add_parameter("b1", s));
+    auto b2  = mm->add_instruction(write_op{}, b1, mm->add_parameter("b2", s));
+    mm->add_return({a2, b2});
+    p.compile(stream_target{});
+    EXPECT(std::any_of(
+        mm->begin(), mm->end(), [](const auto& ins) { return ins.name() == "cpu::stream_op"; }));
+
+    // The copies of the context share the threads of the streams, but each eval waits on its own
+    // events
+    std::atomic<std::size_t> mismatches{0};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 4; i++)
+    {
+        threads.emplace_back([&, i] {
+            std::vector<float> x_data(s.elements(), i);
+            std::vector<std::vector<float>> buffers(4, std::vector<float>(s.elements()));
+            for(int j = 0; j < 20; j++)
+            {
+                p.eval({{"x", migraphx::argument{s, x_data.data()}},
+                        {"a1", migraphx::argument{s, buffers[0].data()}},
+                        {"a2", migraphx::argument{s, buffers[1].data()}},
+                        {"b1", migraphx::argument{s, buffers[2].data()}},
+                        {"b2", migraphx::argument{s, buffers[3].data()}}});
+                if(buffers[1] != std::vector<float>(s.elements(), i + 2) or
+                   buffers[3] != buffers[1])
+                    mismatches++;
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(mismatches.load() == 0);
+}
+
+int main(int argc, const char* argv[])
+{
+    // The number of streams is read once, so it's set before any program is compiled
+    setenv("MIGRAPHX_CPU_STREAMS", "4", 1); // NOLINT
+    test::run(argc, argv);
+}
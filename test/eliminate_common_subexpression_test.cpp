@@ -171,6 +171,32 @@ TEST_CASE(cse_test_literal)
     EXPECT(m1 == m2);
 }
 
+TEST_CASE(cse_test_literal_values)
+{
+    migraphx::shape s{migraphx::shape::float_type, {3}};
+    migraphx::module m1;
+    {
+        auto l1   = m1.add_literal(migraphx::literal{s, {1, 2, 3}});
+        auto l2   = m1.add_literal(migraphx::literal{s, {1, 2, 4}});
+        auto l3   = m1.add_literal(migraphx::literal{s, {1, 2, 3}});
+        auto sum1 = m1.add_instruction(migraphx::make_op("add"), l1, l2);
+        auto sum2 = m1.add_instruction(migraphx::make_op("add"), l3, l2);
+        auto sum3 = m1.add_instruction(migraphx::make_op("add"), sum1, sum2);
+        m1.add_instruction(pass_op{}, sum3);
+    }
+    run_pass(m1);
+
+    migraphx::module m2;
+    {
+        auto l2   = m2.add_literal(migraphx::literal{s, {1, 2, 4}});
+        auto l1   = m2.add_literal(migraphx::literal{s, {1, 2, 3}});
+        auto sum1 = m2.add_instruction(migraphx::make_op("add"), l1, l2);
+        auto sum2 = m2.add_instruction(migraphx::make_op("add"), sum1, sum1);
+        m2.add_instruction(pass_op{}, sum2);
+    }
+    EXPECT(m1 == m2);
+}
+
 TEST_CASE(cse_test_submodule)
 {
     migraphx::shape si{migraphx::shape::int64_type};
@@ -28,7 +28,11 @@
 #include <migraphx/stringutils.hpp>
 #include <migraphx/compile_options.hpp>
 #include <migraphx/make_op.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstring>
 #include <sstream>
+#include <thread>
 #include "test.hpp"
 #include <basic_ops.hpp>
 
@@ -91,6 +95,69 @@ struct id_ctx_final_op
     int output_alias(const std::vector<migraphx::shape>&) const { return 0; }
 };
 
+// Holds a buffer for the lifetime of the program, like the scratch memory of a target
+struct global_buffer_op
+{
+    migraphx::shape s;
+    migraphx::argument data;
+
+    template <class Self, class F>
+    static auto reflect(Self& self, F f)
+    {
+        return migraphx::pack(f(self.s, "shape"));
+    }
+
+    std::string name() const { return "global_buffer"; }
+    migraphx::shape compute_shape(const std::vector<migraphx::shape>&) const { return s; }
+    migraphx::argument compute(id_target::context&,
+                               const migraphx::shape&,
+                               const std::vector<migraphx::argument>&) const
+    {
+        return data;
+    }
+    void finalize(id_target::context&, const migraphx::shape&, const std::vector<migraphx::shape>&)
+    {
+        data = migraphx::argument{s};
+    }
+    migraphx::lifetime get_lifetime() const { return migraphx::lifetime::global; }
+};
+
+// Writes the first input into the buffer and returns a copy of the buffer after a delay, so evals
+// sharing the buffer would see the values written by another eval
+struct write_buffer_op
+{
+    std::string name() const { return "write_buffer"; }
+    migraphx::shape compute_shape(std::vector<migraphx::shape> inputs) const
+    {
+        return inputs.front();
+    }
+    migraphx::argument compute(const migraphx::shape&, std::vector<migraphx::argument> args) const
+    {
+        std::memcpy(args[1].data(), args[0].data(), args[0].get_shape().bytes());
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        return args[1].copy();
+    }
+};
+
+// Copies the first argument into the last one, like the ops that write into an allocation
+struct copy_op
+{
+    std::string name() const { return "copy"; }
+    migraphx::shape compute_shape(std::vector<migraphx::shape> inputs) const
+    {
+        return inputs.back();
+    }
+    migraphx::argument compute(const migraphx::shape&, std::vector<migraphx::argument> args) const
+    {
+        std::memcpy(args.back().data(), args.front().data(), args.front().get_shape().bytes());
+        return args.back();
+    }
+    std::ptrdiff_t output_alias(const std::vector<migraphx::shape>& shapes) const
+    {
+        return shapes.size() - 1;
+    }
+};
+
 struct reverse_pass
 {
     std::string name() const { return "reverse_pass"; }
@@ -448,6 +515,274 @@ TEST_CASE(reverse_target_test)
     EXPECT(test::throws<migraphx::exception>([&] { p.compile(reverse_target{}); }));
 }
 
+TEST_CASE(compiled_eval_repeat)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", {migraphx::shape::int32_type});
+    auto two = mm->add_literal(2);
+    auto sum = mm->add_instruction(migraphx::make_op("add"), x, two);
+    mm->add_instruction(migraphx::make_op("add"), sum, x);
+    p.compile(id_target{});
+    for(int i : {1, 2, 3})
+    {
+        auto result = p.eval({{"x", migraphx::literal{i}.get_argument()}}).back();
+        EXPECT(result == migraphx::literal{2 * i + 2});
+    }
+}
+
+TEST_CASE(compiled_eval_param_error)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", {migraphx::shape::int32_type});
+    auto y   = mm->add_parameter("y", {migraphx::shape::int32_type});
+    mm->add_instruction(sum_op{}, x, y);
+    p.compile(id_target{});
+    EXPECT(test::throws<migraphx::exception>(
+        [&] {
+            p.eval({{"x", migraphx::literal{1}.get_argument()}});
+        },
+        "Parameter not found: y"));
+    // The program can still be evaluated after an error
+    auto result = p.eval({{"x", migraphx::literal{1}.get_argument()},
+                          {"y", migraphx::literal{2}.get_argument()}})
+                      .back();
+    EXPECT(result == migraphx::literal{3});
+}
+
+TEST_CASE(compiled_eval_copy)
+{
+    migraphx::program p1;
+    auto* mm = p1.get_main_module();
+    auto one = mm->add_literal(1);
+    auto two = mm->add_literal(2);
+    mm->add_instruction(migraphx::make_op("add"), one, two);
+    p1.compile(id_target{});
+    migraphx::program p2 = p1;
+    EXPECT(p1.eval({}).back() == migraphx::literal{3});
+    EXPECT(p2.eval({}).back() == migraphx::literal{3});
+}
+
+TEST_CASE(compiled_eval_modified)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto one = mm->add_literal(1);
+    auto two = mm->add_literal(2);
+    auto sum = mm->add_instruction(migraphx::make_op("add"), one, two);
+    p.compile(id_target{});
+    EXPECT(p.eval({}).back() == migraphx::literal{3});
+    auto* mm2 = p.get_main_module();
+    mm2->add_instruction(migraphx::make_op("add"), sum, two);
+    EXPECT(p.eval({}).back() == migraphx::literal{5});
+}
+
+TEST_CASE(compiled_eval_modified_stale_pointer)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto one = mm->add_literal(1);
+    auto two = mm->add_literal(2);
+    auto sum = mm->add_instruction(migraphx::make_op("add"), one, two);
+    p.compile(id_target{});
+    EXPECT(p.eval({}).back() == migraphx::literal{3});
+    // Modify the module through the pointer that was retrieved before compiling
+    mm->replace_instruction(sum, migraphx::make_op("mul"), one, two);
+    EXPECT(p.eval({}).back() == migraphx::literal{2});
+    mm->add_instruction(migraphx::make_op("add"), sum, two);
+    EXPECT(p.eval({}).back() == migraphx::literal{4});
+}
+
+TEST_CASE(compiled_eval_concurrent)
+{
+    migraphx::shape s{migraphx::shape::int32_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto buf = mm->add_instruction(global_buffer_op{s});
+    mm->add_instruction(write_buffer_op{}, x, buf);
+    p.compile(id_target{});
+    std::atomic<std::size_t> mismatches{0};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&, i] {
+            std::vector<int> data(s.elements(), i);
+            for(int j = 0; j < 20; j++)
+            {
+                auto result = p.eval({{"x", migraphx::argument{s, data.data()}}}).back();
+                std::vector<int> output;
+                result.visit([&](auto v) { output.assign(v.begin(), v.end()); });
+                if(output != data)
+                    mismatches++;
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    EXPECT(mismatches.load() == 0);
+}
+
+// A target whose buffers are not on the host, so the copies of its contexts would share them
+struct device_target : id_target
+{
+    std::string name() const { return "device"; }
+    migraphx::argument copy_to(const migraphx::argument& arg) const { return arg.copy(); }
+    migraphx::argument copy_from(const migraphx::argument& arg) const { return arg.copy(); }
+};
+
+template <class Program>
+std::size_t count_concurrent_mismatches(const Program& p, const migraphx::shape& s)
+{
+    std::atomic<std::size_t> mismatches{0};
+    std::vector<std::thread> threads;
+    for(int i = 0; i < 8; i++)
+    {
+        threads.emplace_back([&, i] {
+            std::vector<int> data(s.elements(), i);
+            for(int j = 0; j < 20; j++)
+            {
+                auto result = p.eval({{"x", migraphx::argument{s, data.data()}}}).back();
+                std::vector<int> output;
+                result.visit([&](auto v) { output.assign(v.begin(), v.end()); });
+                if(output != data)
+                    mismatches++;
+            }
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    return mismatches.load();
+}
+
+TEST_CASE(compiled_eval_concurrent_device)
+{
+    migraphx::shape s{migraphx::shape::int32_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto buf = mm->add_instruction(global_buffer_op{s});
+    mm->add_instruction(write_buffer_op{}, x, buf);
+    p.compile(device_target{});
+    EXPECT(not p.uses_host_memory());
+    EXPECT(count_concurrent_mismatches(p, s) == 0);
+}
+
+TEST_CASE(eval_concurrent_without_plan)
+{
+    migraphx::shape s{migraphx::shape::int32_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    // The program is not compiled, so every eval writes to the buffer of the literal
+    auto buf = mm->add_literal(migraphx::literal{s, std::vector<int>(s.elements())});
+    mm->add_instruction(write_buffer_op{}, x, buf);
+    EXPECT(count_concurrent_mismatches(p, s) == 0);
+}
+
+TEST_CASE(compiled_eval_reuse_buffers)
+{
+    migraphx::shape s{migraphx::shape::float_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    auto sum = mm->add_instruction(migraphx::make_op("add"), x, y);
+    mm->add_instruction(migraphx::make_op("mul"), sum, y);
+    p.compile(id_target{});
+    std::vector<float> xdata(s.elements(), 1);
+    std::vector<float> ydata(s.elements(), 2);
+    migraphx::parameter_map params = {{"x", migraphx::argument{s, xdata.data()}},
+                                      {"y", migraphx::argument{s, ydata.data()}}};
+    EXPECT(p.eval(params).back() == p.eval(params).back());
+    auto stats = p.get_allocation_stats();
+    EXPECT(stats.allocations == 4);
+    EXPECT(stats.reused >= 1);
+    EXPECT(stats.peak_bytes >= 3 * s.bytes());
+
+    auto result = p.eval(params).back();
+    std::vector<float> output;
+    result.visit([&](auto v) { output.assign(v.begin(), v.end()); });
+    EXPECT(output == std::vector<float>(s.elements(), 6));
+    EXPECT(p.get_allocation_stats().reused == stats.reused + 2);
+}
+
+TEST_CASE(compiled_eval_output_parameter)
+{
+    migraphx::shape s{migraphx::shape::float_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto out = mm->add_parameter("main:#output_0", s);
+    mm->add_return({mm->add_instruction(copy_op{}, x, out)});
+    p.compile(id_target{});
+    std::vector<float> xdata(s.elements(), 1);
+    migraphx::parameter_map params = {{"x", migraphx::argument{s, xdata.data()}}};
+    // The output parameter is allocated when it's not passed
+    auto result = p.eval(params).back();
+    EXPECT(result == migraphx::argument{s, xdata.data()});
+    std::vector<float> output(s.elements());
+    params["main:#output_0"] = migraphx::argument{s, output.data()};
+    EXPECT(p.eval(params).back().data() == reinterpret_cast<char*>(output.data()));
+    EXPECT(output == xdata);
+}
+
+TEST_CASE(compiled_eval_keep_pool)
+{
+    migraphx::shape s{migraphx::shape::float_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    mm->add_instruction(migraphx::make_op("add"), x, y);
+    p.compile(id_target{});
+    std::vector<float> xdata(s.elements(), 1);
+    std::vector<float> ydata(s.elements(), 2);
+    migraphx::parameter_map params = {{"x", migraphx::argument{s, xdata.data()}},
+                                      {"y", migraphx::argument{s, ydata.data()}}};
+    p.eval(params);
+    // The shapes are the same, so the buffers are still reused after the plan is built again
+    p.finalize();
+    p.eval(params);
+    auto stats = p.get_allocation_stats();
+    EXPECT(stats.allocations == 2);
+    EXPECT(stats.reused == 1);
+}
+
+TEST_CASE(compiled_eval_after_get_module)
+{
+    migraphx::shape s{migraphx::shape::float_type, {64}};
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    mm->add_instruction(migraphx::make_op("add"), x, y);
+    p.compile(id_target{});
+    std::vector<float> xdata(s.elements(), 1);
+    std::vector<float> ydata(s.elements(), 2);
+    migraphx::parameter_map params = {{"x", migraphx::argument{s, xdata.data()}},
+                                      {"y", migraphx::argument{s, ydata.data()}}};
+    p.eval(params);
+    // Getting the module doesn't change it, so the evals still use the plan and its pool
+    p.get_main_module();
+    p.eval(params);
+    auto stats = p.get_allocation_stats();
+    EXPECT(stats.allocations == 2);
+    EXPECT(stats.reused == 1);
+    // The plan is rebuilt once the module is modified
+    auto* mm2 = p.get_main_module();
+    auto z    = mm2->add_parameter("z", s);
+    mm2->add_instruction(migraphx::make_op("mul"), std::prev(mm2->end()), z);
+    std::vector<float> zdata(s.elements(), 3);
+    params["z"] = migraphx::argument{s, zdata.data()};
+    auto result = p.eval(params).back();
+    std::vector<float> output;
+    result.visit([&](auto v) { output.assign(v.begin(), v.end()); });
+    EXPECT(output == std::vector<float>(s.elements(), 9));
+    EXPECT(p.get_allocation_stats().allocations == 4);
+}
+
 // Check that the program doesnt modify the context directly, and only the operators modify the
 // context
 TEST_CASE(eval_context1)
@@ -0,0 +1,248 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/gemm.hpp>
+#include <migraphx/thread_pool.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/time.hpp>
+#include <migraphx/verify.hpp>
+#include <migraphx/dfor.hpp>
+#include <migraphx/half.hpp>
+#include <iostream>
+#include "test.hpp"
+
+// Straightforward implementation used to check the blocked gemm
+template <class T, class U, class F>
+void reference_gemm(migraphx::tensor_view<T> cmat,
+                    migraphx::tensor_view<U> amat,
+                    migraphx::tensor_view<U> bmat,
+                    F alpha,
+                    F beta)
+{
+    std::size_t n_dims = cmat.get_shape().ndim();
+    std::size_t dim_0  = n_dims - 2;
+    std::size_t dim_1  = n_dims - 1;
+    auto k             = amat.get_shape().lens()[dim_1];
+    for(std::size_t i = 0; i < cmat.get_shape().elements(); i++)
+    {
+        auto c_idx = cmat.get_shape().multi(i);
+        auto a_idx = c_idx;
+        auto b_idx = c_idx;
+        double s   = 0.0;
+        migraphx::dfor(k)([&](auto kk) {
+            a_idx[dim_1] = b_idx[dim_0] = kk;
+            s += static_cast<double>(amat(a_idx.begin(), a_idx.end())) *
+                 static_cast<double>(bmat(b_idx.begin(), b_idx.end()));
+        });
+        double r = static_cast<double>(alpha) * s;
+        if(beta != 0)
+            r += static_cast<double>(beta) * static_cast<double>(cmat(c_idx.begin(), c_idx.end()));
+        cmat(c_idx.begin(), c_idx.end()) = static_cast<T>(r);
+    }
+}
+
+template <class T, class U = T>
+std::pair<std::vector<T>, std::vector<T>> run_gemm(const migraphx::shape& as,
+                                                   const migraphx::shape& bs,
+                                                   const migraphx::shape& cs,
+                                                   float alpha = 1.0f,
+                                                   float beta  = 0.0f)
+{
+    auto a = migraphx::generate_argument(as, 1);
+    auto b = migraphx::generate_argument(bs, 2);
+    auto c = migraphx::generate_argument(cs, 3);
+    std::vector<T> result;
+    std::vector<T> expected;
+    c.visit([&](auto cv) { expected.assign(cv.begin(), cv.end()); });
+    result = expected;
+    auto ashape = as;
+    auto bshape = bs;
+    auto* ap    = reinterpret_cast<U*>(a.data());
+    auto* bp    = reinterpret_cast<U*>(b.data());
+    auto cstd   = migraphx::shape{cs.type(), cs.lens()};
+    migraphx::gemm(migraphx::make_view(cstd, result.data()),
+                   migraphx::make_view(ashape, ap),
+                   migraphx::make_view(bshape, bp),
+                   alpha,
+                   beta);
+    reference_gemm(migraphx::make_view(cstd, expected.data()),
+                   migraphx::make_view(ashape, ap),
+                   migraphx::make_view(bshape, bp),
+                   alpha,
+                   beta);
+    return {result, expected};
+}
+
+template <class T>
+bool verify_gemm(const std::pair<std::vector<T>, std::vector<T>>& p)
+{
+    return migraphx::verify::verify_rms_range(p.first, p.second);
+}
+
+migraphx::shape float_shape(std::vector<std::size_t> lens)
+{
+    return {migraphx::shape::float_type, std::move(lens)};
+}
+
+TEST_CASE(gemm_small)
+{
+    auto as = float_shape({2, 3});
+    auto bs = float_shape({3, 4});
+    auto cs = float_shape({2, 4});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_uneven_rows)
+{
+    // Sizes that are not multiples of the row and depth block sizes
+    auto as = float_shape({131, 263});
+    auto bs = float_shape({263, 9});
+    auto cs = float_shape({131, 9});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_uneven_cols)
+{
+    // Sizes that are not multiples of the column and depth block sizes
+    auto as = float_shape({5, 263});
+    auto bs = float_shape({263, 277});
+    auto cs = float_shape({5, 277});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_alpha_beta)
+{
+    auto as = float_shape({17, 33});
+    auto bs = float_shape({33, 19});
+    auto cs = float_shape({17, 19});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs, 0.5f, 2.0f)));
+}
+
+TEST_CASE(gemm_transposed)
+{
+    migraphx::shape as{migraphx::shape::float_type, {20, 30}, {1, 20}};
+    migraphx::shape bs{migraphx::shape::float_type, {30, 40}, {1, 30}};
+    auto cs = float_shape({20, 40});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_batch)
+{
+    auto as = float_shape({2, 3, 9, 21});
+    auto bs = float_shape({2, 3, 21, 11});
+    auto cs = float_shape({2, 3, 9, 11});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_batch_broadcast)
+{
+    migraphx::shape as{migraphx::shape::float_type, {4, 9, 21}};
+    migraphx::shape bs{migraphx::shape::float_type, {4, 21, 11}, {0, 11, 1}};
+    auto cs = float_shape({4, 9, 11});
+    EXPECT(verify_gemm(run_gemm<float>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_empty_k)
+{
+    auto as = float_shape({3, 0});
+    auto bs = float_shape({0, 5});
+    auto cs = float_shape({3, 5});
+    auto r  = run_gemm<float>(as, bs, cs, 1.0f, 1.0f);
+    EXPECT(r.first == r.second);
+}
+
+TEST_CASE(gemm_half)
+{
+    migraphx::shape as{migraphx::shape::half_type, {33, 70}};
+    migraphx::shape bs{migraphx::shape::half_type, {70, 29}};
+    migraphx::shape cs{migraphx::shape::half_type, {33, 29}};
+    EXPECT(verify_gemm(run_gemm<migraphx::half>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_double)
+{
+    migraphx::shape as{migraphx::shape::double_type, {33, 70}};
+    migraphx::shape bs{migraphx::shape::double_type, {70, 29}};
+    migraphx::shape cs{migraphx::shape::double_type, {33, 29}};
+    EXPECT(verify_gemm(run_gemm<double>(as, bs, cs)));
+}
+
+TEST_CASE(gemm_int8)
+{
+    migraphx::shape as{migraphx::shape::int8_type, {13, 300}};
+    migraphx::shape bs{migraphx::shape::int8_type, {300, 27}};
+    migraphx::shape cs{migraphx::shape::int32_type, {13, 27}};
+    auto r = run_gemm<int32_t, int8_t>(as, bs, cs);
+    EXPECT(r.first == r.second);
+}
+
+TEST_CASE(gemm_deterministic)
+{
+    auto as = float_shape({2, 300, 200});
+    auto bs = float_shape({2, 200, 70});
+    auto cs = float_shape({2, 300, 70});
+    auto a  = migraphx::generate_argument(as, 1);
+    auto b  = migraphx::generate_argument(bs, 2);
+    auto av = migraphx::make_view(as, reinterpret_cast<float*>(a.data()));
+    auto bv = migraphx::make_view(bs, reinterpret_cast<float*>(b.data()));
+    auto run = [&](std::size_t nthreads) {
+        migraphx::thread_pool pool{nthreads};
+        std::vector<float> c(cs.elements());
+        migraphx::gemm(pool, migraphx::make_view(cs, c.data()), av, bv, 1.0f, 0.0f);
+        return c;
+    };
+    auto serial = run(1);
+    for(std::size_t nthreads : {2, 3, 4})
+        EXPECT(run(nthreads) == serial);
+}
+
+TEST_CASE(gemm_benchmark)
+{
+    auto as = float_shape({128, 128});
+    auto bs = float_shape({128, 128});
+    auto cs = float_shape({128, 128});
+    auto a  = migraphx::generate_argument(as, 1);
+    auto b  = migraphx::generate_argument(bs, 2);
+    std::vector<float> c(cs.elements());
+    auto av  = migraphx::make_view(as, reinterpret_cast<float*>(a.data()));
+    auto bv  = migraphx::make_view(bs, reinterpret_cast<float*>(b.data()));
+    auto cv  = migraphx::make_view(cs, c.data());
+    auto run = [&](auto f) {
+        f(cv, av, bv, 1.0f, 0.0f);
+        const std::size_t n = 3;
+        auto t              = migraphx::time<std::chrono::duration<double, std::milli>>([&] {
+            for(std::size_t i = 0; i < n; i++)
+                f(cv, av, bv, 1.0f, 0.0f);
+        });
+        return t / n;
+    };
+    auto ref     = run([](auto... xs) { reference_gemm(xs...); });
+    auto blocked = run([](auto... xs) { migraphx::gemm(xs...); });
+    double flops = 2.0 * 128 * 128 * 128;
+    std::cout << "gemm 128x128x128 reference: " << ref << "ms (" << flops / (ref * 1e6)
+              << " GFLOP/s), blocked: " << blocked << "ms (" << flops / (blocked * 1e6)
+              << " GFLOP/s)" << std::endl;
+    EXPECT(blocked > 0);
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -22,6 +22,8 @@
  * THE SOFTWARE.
  */
 #include <migraphx/matcher.hpp>
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/pass_manager.hpp>
 #include <migraphx/iterator_for.hpp>
 #include <test.hpp>
 #include <basic_ops.hpp>
@@ -1191,4 +1193,68 @@ TEST_CASE(match_finder)
     match::find_matches(mm, match_find_sum{sum}, match_find_literal{sum});
 }
 
+TEST_CASE(match_root_names)
+{
+    auto m1 = match::name("sum", "pass")(match::arg(0)(match::name("@literal"))).bind("x");
+    auto r1 = match::get_root_names(m1);
+    EXPECT(r1 != nullptr);
+    EXPECT(*r1 == std::unordered_set<std::string>{"sum", "pass"});
+    EXPECT(match::get_root_names(match::any()) == nullptr);
+    EXPECT(match::get_root_names(match::any_of(match::name("sum"), match::name("pass"))) ==
+           nullptr);
+}
+
+struct match_find_pass_literal
+{
+    auto matcher() const { return match::name("pass")(match::arg(0)(match::name("@literal"))); }
+
+    void apply(migraphx::module& m, const match::matcher_result& r) const
+    {
+        m.replace_instruction(r.result, r.result->inputs().front());
+    }
+};
+
+struct match_find_sum_literals
+{
+    auto matcher() const
+    {
+        return match::name("sum")(match::args(match::name("@literal").bind("x"),
+                                              match::name("@literal").bind("y")));
+    }
+
+    void apply(migraphx::module& m, const match::matcher_result& r) const
+    {
+        auto x = r.instructions["x"]->get_literal().at<int>();
+        auto y = r.instructions["y"]->get_literal().at<int>();
+        m.replace_instruction(r.result, m.add_literal(x + y));
+    }
+};
+
+TEST_CASE(match_finder_fixpoint)
+{
+    migraphx::module mm;
+    auto x = mm.add_literal(1);
+    for(int i = 0; i < 20; i++)
+        x = mm.add_instruction(pass_op{}, x);
+    // Each sum can only be folded once the instructions before it are folded
+    for(int i = 0; i < 20; i++)
+        x = mm.add_instruction(sum_op{}, x, mm.add_literal(1));
+    mm.add_return({x});
+    std::size_t rounds = 0;
+    match::find_matches_fixpoint(
+        mm,
+        [&] {
+            rounds++;
+            migraphx::run_passes(mm, {migraphx::dead_code_elimination{}});
+        },
+        match_find_sum_literals{},
+        match_find_pass_literal{});
+    auto ret = std::prev(mm.end())->inputs().front();
+    EXPECT(ret->get_literal() == migraphx::literal{21});
+    EXPECT(std::none_of(mm.begin(), mm.end(), [](const auto& ins) {
+        return ins.name() == "sum" or ins.name() == "pass";
+    }));
+    EXPECT(rounds >= 2);
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
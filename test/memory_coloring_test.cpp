@@ -35,6 +35,11 @@ void run_pass(migraphx::module& m)
     migraphx::run_passes(m, {migraphx::memory_coloring{"allocate", true}});
 }
 
+void run_pass(migraphx::module& m, const std::string& planner, bool reorder = false)
+{
+    migraphx::run_passes(m, {migraphx::memory_coloring{"allocate", true, planner, reorder}});
+}
+
 struct allocate
 {
     migraphx::shape s{};
@@ -3805,4 +3810,87 @@ TEST_CASE(test_tuple)
     CHECK(is_disjoint({a1, a2}));
 }
 
+TEST_CASE(greedy_by_size)
+{
+    migraphx::module m;
+
+    auto a1 = add_alloc(m, {migraphx::shape::float_type, {8}});
+    auto m1 = m.add_instruction(pass_op{}, a1);
+    auto a2 = add_alloc(m, {migraphx::shape::float_type, {40}});
+    auto m2 = m.add_instruction(pass_op{}, a2, m1);
+    auto a3 = add_alloc(m, {migraphx::shape::float_type, {8}});
+    m.add_instruction(pass_op{}, a3, m2);
+    run_pass(m, "greedy_by_size");
+    CHECK(m.get_parameter_shape("scratch").bytes() == 192);
+    CHECK(no_allocate(m));
+    CHECK(is_disjoint({a1, a2}));
+    CHECK(is_disjoint({a2, a3}));
+    CHECK(is_overlap_load(a1, a3));
+}
+
+TEST_CASE(best_fit)
+{
+    migraphx::module m;
+
+    auto a1 = add_alloc(m, {migraphx::shape::float_type, {40}});
+    auto m1 = m.add_instruction(pass_op{}, a1);
+    auto a2 = add_alloc(m, {migraphx::shape::float_type, {8}});
+    auto m2 = m.add_instruction(pass_op{}, a2, m1);
+    auto a3 = add_alloc(m, {migraphx::shape::float_type, {40}});
+    auto m3 = m.add_instruction(pass_op{}, a3, m2);
+    auto a4 = add_alloc(m, {migraphx::shape::float_type, {8}});
+    m.add_instruction(pass_op{}, a4, m3);
+    run_pass(m, "best_fit");
+    CHECK(m.get_parameter_shape("scratch").bytes() == 192);
+    CHECK(no_allocate(m));
+    CHECK(is_disjoint({a1, a2}));
+    CHECK(is_disjoint({a2, a3}));
+    CHECK(is_disjoint({a3, a4}));
+}
+
+TEST_CASE(interval_planner_nested_alias)
+{
+    for(const auto* planner : {"greedy_by_size", "best_fit"})
+    {
+        migraphx::module m;
+
+        auto a1 = add_alloc(m, {migraphx::shape::float_type, {40}});
+        auto m1 = m.add_instruction(pass_op{}, a1);
+        auto m2 = m.add_instruction(pass_op{}, m1);
+        auto a2 = add_alloc(m, {migraphx::shape::float_type, {40}});
+        auto m3 = m.add_instruction(pass_op{}, a2);
+        auto a3 = add_alloc(m, {migraphx::shape::float_type, {40}});
+        m.add_instruction(pass_op{}, a3, m2, m3);
+        run_pass(m, planner);
+        CHECK(m.get_parameter_shape("scratch").bytes() == 480);
+        CHECK(no_allocate(m));
+        CHECK(is_disjoint({a1, a2, a3}));
+    }
+}
+
+TEST_CASE(reorder_allocations)
+{
+    for(const auto* planner : {"coloring", "greedy_by_size", "best_fit"})
+    {
+        migraphx::module m;
+
+        auto a1 = add_alloc(m, {migraphx::shape::float_type, {40}});
+        auto a2 = add_alloc(m, {migraphx::shape::float_type, {40}});
+        m.add_instruction(pass_op{}, a1);
+        m.add_instruction(pass_op{}, a2);
+        run_pass(m, planner, true);
+        CHECK(m.get_parameter_shape("scratch").bytes() == 160);
+        CHECK(no_allocate(m));
+    }
+}
+
+TEST_CASE(unknown_planner)
+{
+    migraphx::module m;
+
+    auto a1 = add_alloc(m, {migraphx::shape::float_type, {40}});
+    m.add_instruction(pass_op{}, a1);
+    EXPECT(test::throws([&] { run_pass(m, "unknown"); }));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
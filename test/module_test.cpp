@@ -659,4 +659,115 @@ TEST_CASE(module_split3)
     EXPECT(bool{mods[2].inputs[1] == splits1.front()});
 }
 
+TEST_CASE(module_hash_equal)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3}};
+    auto create_module = [&](bool swap) {
+        migraphx::module m;
+        auto x   = m.add_parameter("x", s);
+        auto y   = m.add_parameter("y", s);
+        auto one = m.add_literal(migraphx::literal{s, {1, 2, 3, 4, 5, 6}});
+        auto add = m.add_instruction(migraphx::make_op("add"), x, one);
+        auto mul = swap ? m.add_instruction(migraphx::make_op("mul"), y, add)
+                        : m.add_instruction(migraphx::make_op("mul"), add, y);
+        m.add_return({mul});
+        return m;
+    };
+    auto m1 = create_module(false);
+    auto m2 = create_module(false);
+    auto m3 = create_module(true);
+    EXPECT(m1 == m2);
+    EXPECT(m1.hash() == m2.hash());
+    EXPECT(m1 != m3);
+    EXPECT(m1.hash() != m3.hash());
+}
+
+TEST_CASE(module_not_equal_literal)
+{
+    migraphx::shape s{migraphx::shape::float_type, {3}};
+    auto create_module = [&](float x) {
+        migraphx::module m;
+        auto l = m.add_literal(migraphx::literal{s, std::vector<float>{1, 2, x}});
+        m.add_return({m.add_instruction(migraphx::make_op("abs"), l)});
+        return m;
+    };
+    EXPECT(create_module(3) == create_module(3));
+    EXPECT(create_module(3) != create_module(4));
+    EXPECT(create_module(3).hash() != create_module(4).hash());
+}
+
+TEST_CASE(instruction_hash_replace)
+{
+    migraphx::module m;
+    auto x   = m.add_parameter("x", {migraphx::shape::float_type, {4}});
+    auto ins = m.add_instruction(migraphx::make_op("abs"), x);
+    auto h   = ins->hash();
+    EXPECT(h == ins->hash());
+    m.replace_instruction(ins, migraphx::make_op("neg"), x);
+    EXPECT(h != ins->hash());
+    m.replace_instruction(ins, migraphx::make_op("abs"), x);
+    EXPECT(h == ins->hash());
+}
+
+TEST_CASE(module_track_changes)
+{
+    migraphx::module m;
+    auto x   = m.add_parameter("x", {migraphx::shape::float_type, {4}});
+    auto abs = m.add_instruction(migraphx::make_op("abs"), x);
+    auto neg = m.add_instruction(migraphx::make_op("neg"), abs);
+    m.add_return({neg});
+
+    std::unordered_set<migraphx::instruction_ref> changed;
+    m.track_changes(&changed);
+    auto relu = m.insert_instruction(neg, migraphx::make_op("relu"), x);
+    EXPECT(bool{changed == std::unordered_set<migraphx::instruction_ref>{relu, x}});
+
+    changed.clear();
+    m.replace_instruction(neg, relu);
+    EXPECT(changed.count(neg) == 1);
+    EXPECT(changed.count(relu) == 1);
+    EXPECT(changed.count(std::prev(m.end())) == 1);
+
+    changed.clear();
+    m.remove_instruction(neg);
+    EXPECT(changed.count(abs) == 1);
+    changed.insert(abs);
+    m.remove_instruction(abs);
+    EXPECT(bool{changed == std::unordered_set<migraphx::instruction_ref>{x}});
+
+    m.track_changes(nullptr);
+    changed.clear();
+    m.add_instruction(migraphx::make_op("abs"), x);
+    EXPECT(changed.empty());
+}
+
+TEST_CASE(program_hash_equal)
+{
+    auto p1 = create_program();
+    auto p2 = create_program();
+    EXPECT(p1 == p2);
+    EXPECT(p1.hash() == p2.hash());
+    p2.get_main_module()->add_literal(2);
+    EXPECT(p1 != p2);
+    EXPECT(p1.hash() != p2.hash());
+
+    auto create_if_program = [](const std::string& name) {
+        migraphx::program p;
+        auto* mm  = p.get_main_module();
+        auto* sm  = p.create_module(name);
+        auto cond = mm->add_parameter("cond", {migraphx::shape::bool_type});
+        sm->add_return({sm->add_literal(1)});
+        mm->add_return({mm->add_instruction(migraphx::make_op("if"), {cond}, {sm, sm})});
+        return p;
+    };
+    auto p3 = create_if_program("sub");
+    auto p4 = create_if_program("renamed");
+    // Compute the hash before the rename so the cached instruction hashes are populated
+    auto h = p3.hash();
+    EXPECT(h != p4.hash());
+    p3.rename_module("sub", "renamed");
+    EXPECT(p3 == p4);
+    EXPECT(p3.hash() == p4.hash());
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
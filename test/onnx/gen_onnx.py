@@ -2230,6 +2230,43 @@ def external_constant_test():
     return ([node], [], [y])
 
 
+def external_data_tensor(name, dims, offset, length):
+    location = 'external_data_misaligned_test.weight'
+    with open(location, 'wb') as f:
+        f.write(b'\x00\x00' + np.array([1, 2, 3], dtype=np.float32).tobytes())
+    tensor = helper.make_tensor(name, TensorProto.FLOAT, dims, [])
+    tensor.ClearField('float_data')
+    tensor.data_location = TensorProto.EXTERNAL
+    for key, value in [('location', location), ('offset', str(offset)),
+                       ('length', str(length))]:
+        entry = tensor.external_data.add()
+        entry.key = key
+        entry.value = value
+    return tensor
+
+
+@onnx_test()
+def external_data_invalid_test():
+    x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [3])
+    y = helper.make_tensor_value_info('y', TensorProto.FLOAT, [3])
+    w = external_data_tensor('w', [3], 8, 12)
+
+    node = onnx.helper.make_node('Add', inputs=['x', 'w'], outputs=['y'])
+
+    return ([node], [x], [y], [w])
+
+
+@onnx_test()
+def external_data_misaligned_test():
+    x = helper.make_tensor_value_info('x', TensorProto.FLOAT, [3])
+    y = helper.make_tensor_value_info('y', TensorProto.FLOAT, [3])
+    w = external_data_tensor('w', [3], 2, 12)
+
+    node = onnx.helper.make_node('Add', inputs=['x', 'w'], outputs=['y'])
+
+    return ([node], [x], [y], [w])
+
+
 @onnx_test()
 def eyelike_default_test():
     T1 = helper.make_tensor_value_info('T1', TensorProto.FLOAT, [3, 4])
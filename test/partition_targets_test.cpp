@@ -0,0 +1,208 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/partition_targets.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/module.hpp>
+#include <migraphx/instruction.hpp>
+#include <migraphx/iterator_for.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/ranges.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/verify.hpp>
+#include "test.hpp"
+
+// Compiles with the ref target, but reports its own costs for the ops it supports
+struct stand_in_target
+{
+    std::string target_name;
+    // The cost of each element computed
+    float element_cost = 1;
+    // The ops that are supported, or all of them when empty
+    std::vector<std::string> ops = {};
+
+    std::string name() const { return target_name; }
+    std::vector<migraphx::pass> get_passes(migraphx::context& ctx,
+                                           const migraphx::compile_options& options) const
+    {
+        return migraphx::make_target("ref").get_passes(ctx, options);
+    }
+    migraphx::context get_context() const { return migraphx::make_target("ref").get_context(); }
+    migraphx::supported_segments find_supported(migraphx::const_module_ref mod,
+                                                migraphx::support_metric) const
+    {
+        migraphx::supported_segments result;
+        for(auto ins : migraphx::iterator_for(*mod))
+        {
+            if(ins->name().front() == '@')
+                continue;
+            if(not ops.empty() and not migraphx::contains(ops, ins->name()))
+                continue;
+            result.push_back({{ins}, ins->get_shape().elements() * element_cost});
+        }
+        return result;
+    }
+    migraphx::argument copy_to(const migraphx::argument& arg) const { return arg; }
+    migraphx::argument copy_from(const migraphx::argument& arg) const { return arg; }
+    migraphx::argument allocate(const migraphx::shape& s) const
+    {
+        return migraphx::fill_argument(s, 0);
+    }
+};
+
+static migraphx::target make_cpu(float element_cost = 0.5f)
+{
+    return stand_in_target{"cpu", element_cost};
+}
+
+static migraphx::target make_fpga(float element_cost = 0.125f)
+{
+    return stand_in_target{"fpga", element_cost, {"mul"}};
+}
+
+static migraphx::shape s{migraphx::shape::float_type, {64}};
+
+// x + y -> * z -> + y
+static migraphx::program create_chain()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    auto z   = mm->add_parameter("z", s);
+    auto a   = mm->add_instruction(migraphx::make_op("add"), x, y);
+    auto b   = mm->add_instruction(migraphx::make_op("mul"), a, z);
+    auto c   = mm->add_instruction(migraphx::make_op("add"), b, y);
+    mm->add_return({c});
+    return p;
+}
+
+static std::vector<std::string> get_plan(const migraphx::program& p,
+                                         const migraphx::target_assignments& tass)
+{
+    std::vector<std::string> result;
+    for(auto ins : migraphx::iterator_for(*p.get_main_module()))
+    {
+        if(ins->name().front() == '@')
+            continue;
+        auto it = tass.find(ins);
+        result.push_back(it == tass.end() ? "" : it->second);
+    }
+    return result;
+}
+
+TEST_CASE(single_target)
+{
+    auto p    = create_chain();
+    auto tass = p.get_target_assignments({migraphx::make_target("ref")});
+    EXPECT(get_plan(p, tass) == std::vector<std::string>{"ref", "ref", "ref"});
+    EXPECT(migraphx::float_equal(tass.get_cost(), 3.0f * 64));
+}
+
+TEST_CASE(cheapest_target)
+{
+    auto p    = create_chain();
+    auto tass = p.get_target_assignments({migraphx::make_target("ref"), make_cpu()});
+    EXPECT(get_plan(p, tass) == std::vector<std::string>{"cpu", "cpu", "cpu"});
+    EXPECT(migraphx::float_equal(tass.get_cost(), 3.0f * 64 * 0.5f));
+}
+
+TEST_CASE(unsupported_ops)
+{
+    auto p    = create_chain();
+    auto tass = p.get_target_assignments({make_fpga()});
+    EXPECT(get_plan(p, tass) == std::vector<std::string>{"", "fpga", ""});
+    EXPECT(migraphx::float_equal(tass.get_cost(), 64 * 0.125f));
+}
+
+TEST_CASE(cheap_copies)
+{
+    auto p = create_chain();
+    migraphx::assignment_options options;
+    options.copy_costs["fpga"] = 0.01f;
+    auto tass = p.get_target_assignments({make_cpu(), make_fpga()}, options);
+    EXPECT(get_plan(p, tass) == std::vector<std::string>{"cpu", "fpga", "cpu"});
+    // The mul reads two inputs from the host and writes one result back
+    auto copies = 3 * s.bytes() * 0.01f;
+    EXPECT(migraphx::float_equal(tass.get_cost(), 64 * (0.5f + 0.125f + 0.5f) + copies));
+}
+
+TEST_CASE(expensive_copies)
+{
+    auto p = create_chain();
+    migraphx::assignment_options options;
+    options.copy_costs["fpga"] = 1.0f;
+    auto tass = p.get_target_assignments({make_cpu(), make_fpga()}, options);
+    EXPECT(get_plan(p, tass) == std::vector<std::string>{"cpu", "cpu", "cpu"});
+    EXPECT(migraphx::float_equal(tass.get_cost(), 3.0f * 64 * 0.5f));
+}
+
+TEST_CASE(throughput_balances_targets)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    auto x   = mm->add_parameter("x", s);
+    auto y   = mm->add_parameter("y", s);
+    auto a   = mm->add_instruction(migraphx::make_op("add"), x, y);
+    auto b   = mm->add_instruction(migraphx::make_op("sub"), x, y);
+    mm->add_return({a, b});
+
+    std::vector<migraphx::target> targets = {make_cpu(1), migraphx::make_target("ref")};
+    auto latency = p.get_target_assignments(targets);
+    EXPECT(get_plan(p, latency) == std::vector<std::string>{"cpu", "cpu"});
+    EXPECT(migraphx::float_equal(latency.get_cost(), 2.0f * 64));
+
+    migraphx::assignment_options options;
+    options.metric  = migraphx::support_metric::throughput;
+    auto throughput = p.get_target_assignments(targets, options);
+    EXPECT(get_plan(p, throughput) == std::vector<std::string>{"cpu", "ref"});
+    EXPECT(migraphx::float_equal(throughput.get_cost(), 64.0f));
+}
+
+TEST_CASE(partition_and_run)
+{
+    auto p = create_chain();
+    std::vector<migraphx::target> targets = {make_cpu(), make_fpga()};
+    auto tass = p.get_target_assignments(targets);
+    migraphx::partition_targets(p, targets, tass);
+
+    std::vector<std::size_t> target_ids;
+    for(const auto& ins : *p.get_main_module())
+    {
+        if(ins.name() != "run_on_target")
+            continue;
+        target_ids.push_back(ins.get_operator().to_value()["target_id"].to<std::size_t>());
+    }
+    EXPECT(target_ids == std::vector<std::size_t>{0, 1, 0});
+
+    p.compile(targets);
+    migraphx::parameter_map params;
+    params["x"] = migraphx::fill_argument(s, 1);
+    params["y"] = migraphx::fill_argument(s, 2);
+    params["z"] = migraphx::fill_argument(s, 3);
+    auto result = p.eval(params).back();
+    EXPECT(result == migraphx::fill_argument(s, 11));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -22,9 +22,17 @@
  * THE SOFTWARE.
  */
 #include <migraphx/program.hpp>
+#include <migraphx/perf_profile.hpp>
+#include <migraphx/json.hpp>
+#include <migraphx/stringutils.hpp>
 #include <migraphx/ranges.hpp>
 #include <migraphx/make_op.hpp>
 #include <migraphx/register_target.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/float_equal.hpp>
+#include <algorithm>
+#include <cctype>
+#include <numeric>
 #include "test.hpp"
 
 TEST_CASE(perf_report)
@@ -50,4 +58,142 @@ TEST_CASE(perf_report)
     EXPECT(not migraphx::contains(output, "fast"));
 }
 
+static migraphx::program create_if_program()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape cond_s{migraphx::shape::bool_type};
+    migraphx::shape s{migraphx::shape::float_type, {4}};
+    auto cond = mm->add_parameter("cond", cond_s);
+    auto x    = mm->add_parameter("x", s);
+
+    auto* then_mod = p.create_module("If_0_if");
+    auto r1        = then_mod->add_instruction(migraphx::make_op("add"), x, x);
+    then_mod->add_return({r1});
+
+    auto* else_mod = p.create_module("If_0_else");
+    auto r2        = else_mod->add_instruction(migraphx::make_op("mul"), x, x);
+    else_mod->add_return({r2});
+
+    auto ret = mm->add_instruction(migraphx::make_op("if"), {cond}, {then_mod, else_mod});
+    auto r   = mm->add_instruction(migraphx::make_op("get_tuple_elem", {{"index", 0}}), ret);
+    mm->add_instruction(migraphx::make_op("neg"), r);
+    p.compile(migraphx::make_target("ref"));
+    return p;
+}
+
+static migraphx::parameter_map create_if_params(const migraphx::program& p, char& cond)
+{
+    migraphx::parameter_map params;
+    auto shapes    = p.get_parameter_shapes();
+    params["cond"] = migraphx::argument(shapes["cond"], &cond);
+    params["x"]    = migraphx::generate_argument(shapes["x"]);
+    return params;
+}
+
+TEST_CASE(timing_summary_percentiles)
+{
+    std::vector<double> samples(100);
+    std::iota(samples.begin(), samples.end(), 1);
+    std::reverse(samples.begin(), samples.end());
+    auto t = migraphx::timing_summary::compute(samples);
+    EXPECT(t.count == 100);
+    EXPECT(migraphx::float_equal(t.min, 1.0));
+    EXPECT(migraphx::float_equal(t.max, 100.0));
+    EXPECT(migraphx::float_equal(t.mean, 50.5));
+    EXPECT(migraphx::float_equal(t.p50, 50.0));
+    EXPECT(migraphx::float_equal(t.p90, 90.0));
+    EXPECT(migraphx::float_equal(t.p99, 99.0));
+
+    auto one = migraphx::timing_summary::compute({3.0});
+    EXPECT(migraphx::float_equal(one.p50, 3.0));
+    EXPECT(migraphx::float_equal(one.p99, 3.0));
+    EXPECT(migraphx::timing_summary::compute({}).count == 0);
+}
+
+TEST_CASE(profile_events)
+{
+    auto p      = create_if_program();
+    char cond   = 1;
+    auto params = create_if_params(p, cond);
+    auto prof   = p.profile(3, params);
+    EXPECT(prof.runs.size() == 3);
+
+    auto find_group = [&](const std::string& group) -> std::size_t {
+        auto it = std::find_if(prof.instructions.begin(),
+                               prof.instructions.end(),
+                               [&](const auto& info) { return info.group == group; });
+        return std::distance(prof.instructions.begin(), it);
+    };
+    auto if_idx  = find_group("if");
+    auto add_idx = find_group("ref::add");
+    auto mul_idx = find_group("ref::mul");
+    EXPECT(if_idx < prof.instructions.size());
+    EXPECT(add_idx < prof.instructions.size());
+    EXPECT(mul_idx < prof.instructions.size());
+    EXPECT(prof.instructions[add_idx].module == "If_0_if");
+    EXPECT(migraphx::starts_with(prof.instructions[add_idx].name, "If_0_if:"));
+
+    auto summaries = prof.instruction_summaries();
+    EXPECT(summaries[if_idx].count == 3);
+    EXPECT(summaries[add_idx].count == 3);
+    // Only the then branch runs
+    EXPECT(summaries[mul_idx].count == 0);
+
+    for(const auto& e : prof.events)
+    {
+        const auto& run = prof.runs[e.run];
+        EXPECT(e.start >= run.start);
+        EXPECT(e.start + e.duration <= run.start + run.duration);
+        if(prof.instructions[e.instruction].module == "main")
+        {
+            EXPECT(e.parent == migraphx::perf_profile::no_parent);
+            continue;
+        }
+        // The submodule runs inside of the if instruction
+        EXPECT(e.parent != migraphx::perf_profile::no_parent);
+        const auto& parent = prof.events[e.parent];
+        EXPECT(parent.instruction == if_idx);
+        EXPECT(parent.run == e.run);
+        EXPECT(e.start >= parent.start);
+        EXPECT(e.duration <= parent.duration);
+    }
+}
+
+TEST_CASE(profile_outputs)
+{
+    auto p      = create_if_program();
+    char cond   = 1;
+    auto params = create_if_params(p, cond);
+    auto prof   = p.profile(2, params);
+
+    std::stringstream summary;
+    prof.print_summary(summary);
+    EXPECT(migraphx::contains(summary.str(), "If_0_if:@0 = ref::add: p50="));
+    EXPECT(migraphx::contains(summary.str(), "Runs: 2"));
+    EXPECT(migraphx::contains(summary.str(), "Run time: p50="));
+    EXPECT(not migraphx::contains(summary.str(), "ref::mul"));
+
+    std::stringstream trace;
+    prof.write_chrome_trace(trace);
+    auto v      = migraphx::from_json_string(trace.str());
+    auto events = v.at("traceEvents");
+    EXPECT(events.size() == prof.runs.size() + prof.events.size());
+    EXPECT(events.front().at("name").to<std::string>() == "run");
+    EXPECT(events.back().at("ph").to<std::string>() == "X");
+
+    std::stringstream folded;
+    prof.write_folded_stacks(folded);
+    auto lines = migraphx::split_string(folded.str(), '\n');
+    lines.pop_back();
+    EXPECT(not lines.empty());
+    for(const auto& line : lines)
+    {
+        auto frames = migraphx::split_string(line, ';');
+        EXPECT(frames.front() == "main");
+        auto count = line.substr(line.rfind(' ') + 1);
+        EXPECT(std::all_of(count.begin(), count.end(), [](char c) { return std::isdigit(c); }));
+    }
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
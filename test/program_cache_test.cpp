@@ -0,0 +1,156 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/program_cache.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/tmp_dir.hpp>
+#include <migraphx/file_buffer.hpp>
+#include <cstdlib>
+#include <numeric>
+#include "test.hpp"
+
+static migraphx::program create_program(float middle = 1.0f)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {1000}};
+    std::vector<float> data(s.elements());
+    std::iota(data.begin(), data.end(), 0.0f);
+    data[s.elements() / 2] = middle;
+    auto x                 = mm->add_parameter("x", s);
+    auto y                 = mm->add_literal(migraphx::literal{s, data});
+    mm->add_instruction(migraphx::make_op("add"), x, y);
+    return p;
+}
+
+static migraphx::argument run(const migraphx::program& p)
+{
+    migraphx::shape s{migraphx::shape::float_type, {1000}};
+    std::vector<float> x(s.elements(), 1.0f);
+    return p.eval({{"x", migraphx::argument{s, x.data()}}}).back();
+}
+
+TEST_CASE(cache_key)
+{
+    auto t   = migraphx::make_target("ref");
+    auto key = migraphx::program_cache::key(create_program(), t);
+    EXPECT(key == migraphx::program_cache::key(create_program(), t));
+    // The data in the middle of the literal is not part of the hash of the program
+    auto p2 = create_program(2.0f);
+    EXPECT(create_program().hash() == p2.hash());
+    EXPECT(key != migraphx::program_cache::key(p2, t));
+    migraphx::compile_options options;
+    options.fast_math = false;
+    EXPECT(key != migraphx::program_cache::key(create_program(), t, options));
+}
+
+TEST_CASE(cache_key_env)
+{
+    auto t   = migraphx::make_target("ref");
+    auto key = migraphx::program_cache::key(create_program(), t);
+    setenv("MIGRAPHX_GEMM_ACCUMULATE_DOUBLE", "1", 1); // NOLINT
+    auto key_env = migraphx::program_cache::key(create_program(), t);
+    unsetenv("MIGRAPHX_GEMM_ACCUMULATE_DOUBLE"); // NOLINT
+    EXPECT(key != key_env);
+    // The variables of the cache don't change the key
+    setenv("MIGRAPHX_PROGRAM_CACHE_SIZE", "1", 1); // NOLINT
+    auto key_cache = migraphx::program_cache::key(create_program(), t);
+    unsetenv("MIGRAPHX_PROGRAM_CACHE_SIZE"); // NOLINT
+    EXPECT(key == key_cache);
+}
+
+TEST_CASE(cache_store_load)
+{
+    migraphx::tmp_dir td{"program_cache"};
+    migraphx::program_cache cache{td.path};
+    auto t   = migraphx::make_target("ref");
+    auto p1  = create_program();
+    auto key = migraphx::program_cache::key(p1, t);
+    migraphx::program p2;
+    EXPECT(not cache.load(key, p2));
+    p1.compile(t);
+    cache.store(key, p1);
+    EXPECT(migraphx::fs::exists(cache.path(key)));
+    EXPECT(cache.load(key, p2));
+    EXPECT(p2.is_compiled());
+    EXPECT(run(p1) == run(p2));
+    auto stats = cache.stats();
+    EXPECT(stats.hits == 1);
+    EXPECT(stats.misses == 1);
+    EXPECT(stats.stores == 1);
+    EXPECT(stats.evictions == 0);
+}
+
+TEST_CASE(cache_other_key)
+{
+    migraphx::tmp_dir td{"program_cache"};
+    migraphx::program_cache cache{td.path};
+    auto t  = migraphx::make_target("ref");
+    auto p1 = create_program();
+    auto p2 = create_program(2.0f);
+    auto k1 = migraphx::program_cache::key(p1, t);
+    auto k2 = migraphx::program_cache::key(p2, t);
+    p1.compile(t);
+    cache.store(k1, p1);
+    // A file stored under another key is not used, as if the names of the files collided
+    migraphx::fs::copy_file(cache.path(k1), cache.path(k2));
+    migraphx::program p;
+    EXPECT(not cache.load(k2, p));
+    EXPECT(cache.load(k1, p));
+}
+
+TEST_CASE(cache_invalid_file)
+{
+    migraphx::tmp_dir td{"program_cache"};
+    migraphx::program_cache cache{td.path};
+    auto key = migraphx::program_cache::key(create_program(), migraphx::make_target("ref"));
+    migraphx::write_buffer(cache.path(key), std::vector<char>{'x', 'y', 'z'});
+    migraphx::program p;
+    EXPECT(not cache.load(key, p));
+    EXPECT(cache.stats().misses == 1);
+}
+
+TEST_CASE(cache_evict)
+{
+    migraphx::tmp_dir td{"program_cache"};
+    // Only one program fits in the cache
+    migraphx::program_cache cache{td.path, 6000};
+    auto t = migraphx::make_target("ref");
+    std::vector<std::string> keys;
+    for(float middle : {1.0f, 2.0f, 3.0f})
+    {
+        auto p = create_program(middle);
+        keys.push_back(migraphx::program_cache::key(p, t));
+        p.compile(t);
+        cache.store(keys.back(), p);
+    }
+    EXPECT(cache.stats().stores == 3);
+    EXPECT(cache.stats().evictions == 2);
+    EXPECT(not migraphx::fs::exists(cache.path(keys[0])));
+    EXPECT(not migraphx::fs::exists(cache.path(keys[1])));
+    EXPECT(migraphx::fs::exists(cache.path(keys[2])));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
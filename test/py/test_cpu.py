@@ -21,7 +21,7 @@
 # OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
 # THE SOFTWARE.
 #####################################################################################
-import migraphx, array, sys
+import migraphx, array, sys, threading
 
 
 def test_conv_relu():
@@ -83,7 +83,46 @@ def test_module():
     print(mm)
 
 
+def create_add_scalar_params():
+    params = {}
+    params["0"] = migraphx.argument(
+        create_buffer("B", list(range(120)), [2, 3, 4, 5]))
+    params["1"] = migraphx.argument(create_buffer("B", [1], ()))
+    return params
+
+
+def test_run_outputs():
+    p = migraphx.parse_onnx("add_scalar_test.onnx")
+    p.compile(migraphx.get_target("ref"))
+    out = memoryview(bytearray(120)).cast("B", [2, 3, 4, 5])
+    r = p.run(create_add_scalar_params(), [out])[-1]
+    expected = [x + 1 for x in range(120)]
+    assert r.tolist() == expected
+    assert out.tobytes() == bytes(expected)
+
+
+def test_run_threads():
+    p = migraphx.parse_onnx("add_scalar_test.onnx")
+    p.compile(migraphx.get_target("ref"))
+    expected = [x + 1 for x in range(120)]
+    results = []
+
+    def run():
+        params = create_add_scalar_params()
+        for _ in range(10):
+            results.append(p.run(params)[-1].tolist() == expected)
+
+    threads = [threading.Thread(target=run) for _ in range(4)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    assert len(results) == 40 and all(results)
+
+
 test_conv_relu()
 test_module()
 if sys.version_info >= (3, 0):
     test_add_scalar()
+    test_run_outputs()
+    test_run_threads()
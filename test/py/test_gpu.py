@@ -175,6 +175,21 @@ def test_dyn_batch():
     run_prog(4)
 
 
+def test_run_outputs_device():
+    for offload_copy in [True, False]:
+        p = migraphx.parse_onnx("add_scalar_test.onnx")
+        p.compile(migraphx.get_target("gpu"), offload_copy=offload_copy)
+        params = {}
+        for key, value in p.get_parameter_shapes().items():
+            arg = migraphx.generate_argument(value)
+            params[key] = arg if offload_copy else migraphx.to_gpu(arg)
+        expected = migraphx.from_gpu(p.run(params)[-1]).tolist()
+        out = memoryview(bytearray(120)).cast("B", [2, 3, 4, 5])
+        r = p.run(params, [out])[-1]
+        assert r.tolist() == expected
+        assert out.tobytes() == bytes(expected)
+
+
 test_conv_relu()
 test_sub_uint64()
 test_neg_int64()
@@ -182,3 +197,4 @@ test_fp16_imagescaler()
 test_if_pl()
 test_nonzero()
 test_dyn_batch()
+test_run_outputs_device()
@@ -45,6 +45,9 @@
 #include <migraphx/program.hpp>
 #include <migraphx/shape.hpp>
 #include "test.hpp"
+#include <migraphx/float_equal.hpp>
+#include <numeric>
+#include <thread>
 #include <migraphx/half.hpp>
 
 static void optimize_prog_int8(migraphx::program& prog)
@@ -1356,4 +1359,152 @@ TEST_CASE(test_op_capture)
     EXPECT(migraphx::verify::verify_rms_range(vec, cap_vec));
 }
 
+TEST_CASE(calibrator_methods)
+{
+    migraphx::shape s{migraphx::shape::float_type, {1001}};
+    std::vector<float> data(s.elements());
+    std::iota(data.begin(), data.end(), -500.0f);
+    data.back() = 10000.0f;
+    migraphx::argument arg{s, data.data()};
+
+    auto scale = [&](const std::string& method) {
+        migraphx::calibrator c{1, migraphx::shape::int8_type, method, 99.0f};
+        c.add(0, arg);
+        return c.quant_params().front().first;
+    };
+    EXPECT(migraphx::float_equal(scale("max"), 127.0f / 10000.0f));
+    // The outlier is clipped by the percentile
+    auto pct = scale("percentile");
+    EXPECT(pct > 127.0f / 520.0f and pct < 127.0f / 480.0f);
+    EXPECT(scale("mse") > 127.0f / 10000.0f);
+    EXPECT(test::throws([&] { scale("entropy"); }));
+}
+
+TEST_CASE(calibrator_concurrent)
+{
+    migraphx::shape s{migraphx::shape::float_type, {4, 64}};
+    std::vector<migraphx::argument> args;
+    for(std::size_t i = 0; i < 16; i++)
+    {
+        auto x = migraphx::generate_argument(s, i);
+        // Grow the range so the histogram is widened while other threads add to it
+        x.visit([&](auto v) {
+            std::transform(v.begin(), v.end(), v.begin(), [&](auto y) { return y * (i + 1); });
+        });
+        args.push_back(x);
+    }
+
+    for(const std::string method : {"percentile", "mse"})
+    {
+        migraphx::calibrator serial{1, migraphx::shape::int8_type, method, 99.0f};
+        for(const auto& x : args)
+            serial.add(0, x);
+
+        // The thresholds don't depend on the order the arguments are added in
+        migraphx::calibrator reversed{1, migraphx::shape::int8_type, method, 99.0f};
+        for(auto it = args.rbegin(); it != args.rend(); ++it)
+            reversed.add(0, *it);
+
+        migraphx::calibrator concurrent{1, migraphx::shape::int8_type, method, 99.0f};
+        std::vector<std::thread> threads;
+        for(std::size_t t = 0; t < 4; t++)
+        {
+            threads.emplace_back([&, t] {
+                for(std::size_t i = t; i < args.size(); i += 4)
+                    concurrent.add(0, args[i]);
+            });
+        }
+        for(auto& t : threads)
+            t.join();
+
+        auto scale = serial.quant_params().front().first;
+        EXPECT(scale == reversed.quant_params().front().first);
+        EXPECT(scale == concurrent.quant_params().front().first);
+    }
+}
+
+TEST_CASE(int8_quantization_concurrent_calibration)
+{
+    auto create_program = [] {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        auto pa  = mm->add_parameter("a", {migraphx::shape::float_type, {4, 16}});
+        auto pb  = mm->add_parameter("b", {migraphx::shape::float_type, {16, 8}});
+        auto r   = mm->add_instruction(migraphx::make_op("dot"), pa, pb);
+        mm->add_return({r});
+        return p;
+    };
+
+    std::vector<migraphx::parameter_map> cali_data;
+    for(std::size_t i = 0; i < 8; i++)
+    {
+        migraphx::parameter_map m;
+        m["a"] = migraphx::generate_argument({migraphx::shape::float_type, {4, 16}}, i);
+        m["b"] = migraphx::generate_argument({migraphx::shape::float_type, {16, 8}}, i + 8);
+        cali_data.push_back(m);
+    }
+
+    auto quantize = [&](std::size_t jobs) {
+        auto p = create_program();
+        migraphx::calibration_options options;
+        options.jobs = jobs;
+        migraphx::quantize_int8(
+            p, migraphx::make_target("ref"), cali_data, {"dot", "convolution"}, options);
+        return p;
+    };
+    EXPECT(quantize(1) == quantize(4));
+}
+
+TEST_CASE(int8_quantization_conv_per_channel)
+{
+    migraphx::shape sx{migraphx::shape::float_type, {1, 2, 4, 4}};
+    migraphx::shape sw{migraphx::shape::float_type, {4, 2, 3, 3}};
+    auto create_program = [&] {
+        migraphx::program p;
+        auto* mm = p.get_main_module();
+        // The output channels of the weights have very different ranges
+        std::vector<float> w(sw.elements());
+        for(std::size_t i = 0; i < w.size(); i++)
+            w[i] = std::pow(10.0f, i / 18) * ((i % 7) - 3.0f) / 3.0f;
+        auto x = mm->add_parameter("x", sx);
+        auto r = mm->add_instruction(
+            migraphx::make_op("convolution"), x, mm->add_literal(migraphx::literal(sw, w)));
+        mm->add_return({r});
+        return p;
+    };
+
+    migraphx::parameter_map m;
+    m["x"] = migraphx::generate_argument(sx);
+    auto t = migraphx::make_target("ref");
+    auto run_prog = [&](migraphx::program p, const migraphx::calibration_options* options) {
+        if(options != nullptr)
+            migraphx::quantize_int8(p, t, {m}, {"dot", "convolution"}, *options);
+        p.compile(t);
+        std::vector<float> res;
+        p.eval(m).back().visit([&](auto v) { res.assign(v.begin(), v.end()); });
+        return res;
+    };
+
+    auto p = create_program();
+    migraphx::calibration_options options;
+    options.per_channel = true;
+    migraphx::quantize_int8(p, t, {m}, {"dot", "convolution"}, options);
+    auto* mm = p.get_main_module();
+    EXPECT(std::any_of(mm->begin(), mm->end(), [](const auto& ins) {
+        return ins.name() == "quant_convolution";
+    }));
+
+    auto float_result = run_prog(create_program(), nullptr);
+    auto quant_result = run_prog(create_program(), &options);
+    // The smallest channel is only representable with its own scale
+    std::vector<float> first_channel(float_result.begin(), float_result.begin() + 4);
+    std::vector<float> quant_first_channel(quant_result.begin(), quant_result.begin() + 4);
+    EXPECT(migraphx::verify::verify_range_with_tolerance(
+        quant_first_channel,
+        migraphx::verify::expected{first_channel},
+        migraphx::verify::tolerance{0.02}));
+    EXPECT(migraphx::verify::verify_range_with_tolerance(
+        quant_result, migraphx::verify::expected{float_result}, migraphx::verify::tolerance{0.02}));
+}
+
 int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,156 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/instruction.hpp>
+#include <migraphx/literal.hpp>
+#include <migraphx/make_op.hpp>
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/pass_manager.hpp>
+#include <migraphx/quantization.hpp>
+#include <migraphx/quantize_weights.hpp>
+#include <migraphx/register_target.hpp>
+#include <migraphx/verify.hpp>
+
+#include <test.hpp>
+
+TEST_CASE(dequant_dot_int8)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape sa{migraphx::shape::float_type, {1, 4}};
+    migraphx::shape sw{migraphx::shape::int8_type, {4, 2}};
+    migraphx::shape ss{migraphx::shape::float_type, {2, 2}};
+    migraphx::shape sz{migraphx::shape::int8_type, {2, 2}};
+    auto a      = mm->add_literal(migraphx::literal{sa, {1, 2, 3, 4}});
+    auto w      = mm->add_literal(migraphx::literal{sw, {1, -1, 2, 0, 3, 1, 4, 2}});
+    auto scales = mm->add_literal(migraphx::literal{ss, {0.5f, 1.0f, 0.25f, 2.0f}});
+    auto zp     = mm->add_literal(migraphx::literal{sz, {0, 1, 0, -1}});
+    mm->add_instruction(
+        migraphx::make_op("dequant_dot", {{"group_size", 2}, {"bits", 8}}), a, w, scales, zp);
+    p.compile(migraphx::make_target("ref"));
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold{8.75, 32};
+    EXPECT(migraphx::verify::verify_rms_range(results_vector, gold));
+}
+
+TEST_CASE(dequant_dot_int4)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape sa{migraphx::shape::float_type, {1, 4}};
+    migraphx::shape sw{migraphx::shape::uint8_type, {2, 2}};
+    migraphx::shape ss{migraphx::shape::float_type, {2, 2}};
+    migraphx::shape sz{migraphx::shape::uint8_type, {2, 2}};
+    auto a = mm->add_literal(migraphx::literal{sa, {1, 2, 3, 4}});
+    // The weights {{1, 3}, {2, 0}, {3, 1}, {4, 2}} packed along the rows
+    auto w      = mm->add_literal(migraphx::literal{sw, {0x21, 0x03, 0x43, 0x21}});
+    auto scales = mm->add_literal(migraphx::literal{ss, {0.5f, 1.0f, 0.25f, 2.0f}});
+    auto zp     = mm->add_literal(migraphx::literal{sz, {0, 1, 0, 0}});
+    mm->add_instruction(
+        migraphx::make_op("dequant_dot", {{"group_size", 2}, {"bits", 4}}), a, w, scales, zp);
+    p.compile(migraphx::make_target("ref"));
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold{8.75, 22};
+    EXPECT(migraphx::verify::verify_rms_range(results_vector, gold));
+}
+
+static migraphx::program create_weight_dot_program()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape sw{migraphx::shape::float_type, {64, 80}};
+    auto a  = mm->add_parameter("a", migraphx::shape{migraphx::shape::float_type, {2, 3, 64}});
+    auto w  = mm->add_literal(migraphx::generate_literal(sw, 1));
+    auto wb = mm->add_instruction(migraphx::make_op("multibroadcast", {{"out_lens", {2, 64, 80}}}),
+                                  w);
+    mm->add_instruction(migraphx::make_op("dot"), a, wb);
+    return p;
+}
+
+static std::vector<float> run_weight_dot_program(migraphx::program p)
+{
+    p.compile(migraphx::make_target("ref"));
+    migraphx::parameter_map params;
+    params["a"] = migraphx::generate_argument(p.get_parameter_shape("a"), 2);
+    std::vector<float> results_vector;
+    p.eval(params).back().visit(
+        [&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    return results_vector;
+}
+
+static bool has_dequant_dot(const migraphx::program& p)
+{
+    const auto* mm = p.get_main_module();
+    return std::any_of(
+        mm->begin(), mm->end(), [](const auto& ins) { return ins.name() == "dequant_dot"; });
+}
+
+TEST_CASE(quantize_weights_int8_dot)
+{
+    auto p = create_weight_dot_program();
+    migraphx::quantize_weights_int8(p, 32);
+    EXPECT(has_dequant_dot(p));
+    auto gold   = run_weight_dot_program(create_weight_dot_program());
+    auto result = run_weight_dot_program(p);
+    EXPECT(migraphx::verify::verify_range_with_tolerance(
+        result, migraphx::verify::expected{gold}, migraphx::verify::tolerance{0.005}));
+}
+
+TEST_CASE(quantize_weights_int4_dot)
+{
+    auto p = create_weight_dot_program();
+    migraphx::quantize_weights_int4(p, 32);
+    EXPECT(has_dequant_dot(p));
+    // The weights are stored packed
+    const auto* mm = p.get_main_module();
+    EXPECT(std::none_of(mm->begin(), mm->end(), [](const auto& ins) {
+        return ins.name() == "@literal" and ins.get_shape().type() == migraphx::shape::float_type and
+               ins.get_shape().elements() == 64 * 80;
+    }));
+    auto gold   = run_weight_dot_program(create_weight_dot_program());
+    auto result = run_weight_dot_program(p);
+    EXPECT(migraphx::verify::verify_range_with_tolerance(
+        result, migraphx::verify::expected{gold}, migraphx::verify::tolerance{0.05}));
+}
+
+TEST_CASE(rewrite_dequant_dot)
+{
+    for(auto bits : {4, 8})
+    {
+        auto p = create_weight_dot_program();
+        migraphx::run_passes(p, {migraphx::quantize_weights_pass{std::size_t(bits), 16}});
+        auto p2 = p;
+        migraphx::run_passes(p2, {migraphx::rewrite_dequant_dot{}});
+        EXPECT(has_dequant_dot(p));
+        EXPECT(not has_dequant_dot(p2));
+        EXPECT(migraphx::verify::verify_range_with_tolerance(
+            run_weight_dot_program(p2),
+            migraphx::verify::expected{run_weight_dot_program(p)},
+            migraphx::verify::tolerance{1e-5}));
+    }
+}
@@ -27,6 +27,7 @@
 #include <migraphx/program.hpp>
 #include <migraphx/register_target.hpp>
 #include <migraphx/verify.hpp>
+#include <numeric>
 
 #include <test.hpp>
 
@@ -309,3 +310,56 @@ TEST_CASE(reduce_sum_variable_empty_axes)
 
     EXPECT(results_vector == input_data);
 }
+
+TEST_CASE(reduce_sum_transposed_axis1)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {3, 2, 2}};
+    auto input = migraphx::literal{s, {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12}};
+    auto l0    = mm->add_literal(input);
+    auto tl0 =
+        mm->add_instruction(migraphx::make_op("transpose", {{"permutation", {2, 0, 1}}}), l0);
+    mm->add_instruction(migraphx::make_op("reduce_sum", {{"axes", {1}}}), tl0);
+    p.compile(migraphx::make_target("ref"));
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold{15, 21, 18, 24};
+    EXPECT(results_vector == gold);
+}
+
+TEST_CASE(reduce_sum_large_axis0)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {1000, 300}};
+    std::vector<float> input_data(s.elements());
+    std::iota(input_data.begin(), input_data.end(), 0);
+    auto l0 = mm->add_literal(migraphx::literal{s, input_data});
+    mm->add_instruction(migraphx::make_op("reduce_sum", {{"axes", {0}}}), l0);
+    p.compile(migraphx::make_target("ref"));
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold(300);
+    for(std::size_t j = 0; j < gold.size(); j++)
+        gold[j] = 300.0f * 1000 * 999 / 2 + 1000.0f * j;
+    EXPECT(migraphx::verify::verify_rms_range(results_vector, gold));
+}
+
+TEST_CASE(reduce_sum_large_all_axes)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s{migraphx::shape::float_type, {64, 1023, 3}};
+    std::vector<float> input_data(s.elements(), 0.5f);
+    auto l0 = mm->add_literal(migraphx::literal{s, input_data});
+    mm->add_instruction(migraphx::make_op("reduce_sum", {{"axes", {0, 1, 2}}}), l0);
+    p.compile(migraphx::make_target("ref"));
+    auto result = p.eval({}).back();
+    std::vector<float> results_vector;
+    result.visit([&](auto output) { results_vector.assign(output.begin(), output.end()); });
+    std::vector<float> gold{0.5f * s.elements()};
+    EXPECT(results_vector == gold);
+}
@@ -21,12 +21,16 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+#include <migraphx/dead_code_elimination.hpp>
+#include <migraphx/generate.hpp>
 #include <migraphx/instruction.hpp>
 #include <migraphx/literal.hpp>
 #include <migraphx/make_op.hpp>
 #include <migraphx/op/common.hpp>
+#include <migraphx/pass_manager.hpp>
 #include <migraphx/program.hpp>
 #include <migraphx/register_target.hpp>
+#include <migraphx/rewrite_rnn.hpp>
 #include <migraphx/verify.hpp>
 
 #include "test.hpp"
@@ -8400,3 +8404,146 @@ TEST_CASE(lstm_fp16)
         0.135643,  -0.0566208, 0.142701,   0.0342236,   -0.198664,  0.0702607};
     EXPECT(migraphx::verify::verify_rms_range(hs_data, hs_data_gold, 5e4));
 }
+
+static migraphx::program create_rnn_program(const migraphx::operation& op,
+                                            const std::vector<migraphx::shape>& inputs)
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    std::vector<migraphx::instruction_ref> args;
+    for(std::size_t i = 0; i < inputs.size(); i++)
+    {
+        if(inputs[i] == migraphx::shape{})
+        {
+            args.push_back(mm->add_instruction(migraphx::make_op("undefined")));
+        }
+        else if(inputs[i].type() == migraphx::shape::int32_type)
+        {
+            // sequence lengths that decrease from the max sequence length
+            std::vector<int> lens(inputs[i].elements());
+            int seq_len = inputs[0].lens()[0];
+            for(std::size_t b = 0; b < lens.size(); b++)
+                lens[b] = std::max<int>(1, seq_len - b);
+            args.push_back(mm->add_literal(migraphx::literal{inputs[i], lens}));
+        }
+        else
+        {
+            args.push_back(mm->add_literal(migraphx::generate_literal(inputs[i], i)));
+        }
+    }
+    auto hs  = mm->add_instruction(op, args);
+    auto lho = mm->add_instruction(migraphx::make_op("rnn_last_hs_output"), hs);
+    if(op.name() == "lstm")
+    {
+        auto lco = mm->add_instruction(migraphx::make_op("rnn_last_cell_output"), hs);
+        mm->add_return({hs, lho, lco});
+    }
+    else
+    {
+        mm->add_return({hs, lho});
+    }
+    return p;
+}
+
+static void verify_unrolled_rnn(const migraphx::operation& op,
+                                const std::vector<migraphx::shape>& inputs)
+{
+    // the ref target runs the recurrence in a loop, so compare it with the unrolled timesteps
+    auto p1 = create_rnn_program(op, inputs);
+    auto p2 = create_rnn_program(op, inputs);
+    migraphx::run_passes(p2, {migraphx::rewrite_rnn{}, migraphx::dead_code_elimination{}});
+    EXPECT(std::none_of(p2.get_main_module()->begin(),
+                        p2.get_main_module()->end(),
+                        [](const auto& ins) { return ins.name() == "loop"; }));
+    p1.compile(migraphx::make_target("ref"));
+    p2.compile(migraphx::make_target("ref"));
+    auto results1 = p1.eval({});
+    auto results2 = p2.eval({});
+    EXPECT(results1.size() == results2.size());
+    for(std::size_t i = 0; i < results1.size(); i++)
+    {
+        std::vector<float> data1;
+        std::vector<float> data2;
+        results1[i].visit([&](auto output) { data1.assign(output.begin(), output.end()); });
+        results2[i].visit([&](auto output) { data2.assign(output.begin(), output.end()); });
+        EXPECT(migraphx::verify::verify_rms_range(data1, data2));
+    }
+}
+
+TEST_CASE(rnn_bidirectional_unrolled)
+{
+    std::size_t seq_len = 5, batch_size = 3, input_size = 4, hidden_size = 6;
+    migraphx::shape::type_t t = migraphx::shape::float_type;
+    verify_unrolled_rnn(
+        migraphx::make_op(
+            "rnn",
+            {{"hidden_size", hidden_size},
+             {"actv_func",
+              migraphx::to_value(std::vector<migraphx::operation>{migraphx::make_op("tanh"),
+                                                                  migraphx::make_op("sigmoid")})},
+             {"direction", migraphx::to_value(migraphx::op::rnn_direction::bidirectional)}}),
+        {{t, {seq_len, batch_size, input_size}},
+         {t, {2, hidden_size, input_size}},
+         {t, {2, hidden_size, hidden_size}},
+         {t, {2, 2 * hidden_size}},
+         {},
+         {t, {2, batch_size, hidden_size}}});
+}
+
+TEST_CASE(gru_reverse_unrolled)
+{
+    std::size_t seq_len = 4, batch_size = 2, input_size = 3, hidden_size = 5;
+    migraphx::shape::type_t t = migraphx::shape::float_type;
+    verify_unrolled_rnn(
+        migraphx::make_op("gru",
+                          {{"hidden_size", hidden_size},
+                           {"direction", migraphx::to_value(migraphx::op::rnn_direction::reverse)},
+                           {"linear_before_reset", 1}}),
+        {{t, {seq_len, batch_size, input_size}},
+         {t, {1, 3 * hidden_size, input_size}},
+         {t, {1, 3 * hidden_size, hidden_size}},
+         {t, {1, 6 * hidden_size}},
+         {},
+         {t, {1, batch_size, hidden_size}}});
+}
+
+TEST_CASE(lstm_bidirectional_var_seq_lens_unrolled)
+{
+    std::size_t seq_len = 4, batch_size = 3, input_size = 2, hidden_size = 3;
+    migraphx::shape::type_t t = migraphx::shape::float_type;
+    verify_unrolled_rnn(
+        migraphx::make_op(
+            "lstm",
+            {{"hidden_size", hidden_size},
+             {"direction", migraphx::to_value(migraphx::op::rnn_direction::bidirectional)}}),
+        {{t, {seq_len, batch_size, input_size}},
+         {t, {2, 4 * hidden_size, input_size}},
+         {t, {2, 4 * hidden_size, hidden_size}},
+         {t, {2, 8 * hidden_size}},
+         {migraphx::shape::int32_type, {batch_size}},
+         {t, {2, batch_size, hidden_size}},
+         {t, {2, batch_size, hidden_size}},
+         {t, {2, 3 * hidden_size}}});
+}
+
+TEST_CASE(lstm_loop_size)
+{
+    // the size of the graph doesn't depend on the sequence length when the recurrence is not
+    // unrolled
+    auto rewritten_size = [](std::size_t seq_len) {
+        std::size_t batch_size = 2, input_size = 3, hidden_size = 4;
+        migraphx::shape::type_t t = migraphx::shape::float_type;
+        auto p                    = create_rnn_program(
+            migraphx::make_op("lstm", {{"hidden_size", hidden_size}}),
+            {{t, {seq_len, batch_size, input_size}},
+             {t, {1, 4 * hidden_size, input_size}},
+             {t, {1, 4 * hidden_size, hidden_size}}});
+        migraphx::run_passes(p,
+                             {migraphx::rewrite_rnn{false}, migraphx::dead_code_elimination{}});
+        std::size_t n = 0;
+        for(const auto* m : p.get_modules())
+            n += m->size();
+        return n;
+    };
+    EXPECT(rewritten_size(2) == rewritten_size(64));
+}
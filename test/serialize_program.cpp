@@ -21,13 +21,16 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+#include <migraphx/instruction.hpp>
 #include <migraphx/program.hpp>
 #include <migraphx/register_target.hpp>
 #include <migraphx/load_save.hpp>
 #include "test.hpp"
 #include <migraphx/make_op.hpp>
 
+#include <cstdint>
 #include <cstdio>
+#include <numeric>
 
 migraphx::program create_program()
 {
@@ -79,6 +82,86 @@ TEST_CASE(as_file)
     EXPECT(p1.sort() == p2.sort());
 }
 
+migraphx::program create_program_with_literals()
+{
+    migraphx::program p;
+    auto* mm = p.get_main_module();
+    migraphx::shape s1{migraphx::shape::float_type, {3, 5}};
+    migraphx::shape s2{migraphx::shape::int8_type, {7}};
+    std::vector<float> data1(s1.elements());
+    std::iota(data1.begin(), data1.end(), 1.5f);
+    std::vector<int8_t> data2 = {1, -2, 3, -4, 5, -6, 7};
+    auto x                    = mm->add_parameter("x", s1);
+    auto l1                   = mm->add_literal(migraphx::literal{s1, data1});
+    auto l2                   = mm->add_literal(migraphx::literal{s2, data2});
+    auto add                  = mm->add_instruction(migraphx::make_op("add"), x, l1);
+    mm->add_return({add, l2});
+    return p;
+}
+
+bool literals_aligned(const migraphx::program& p, std::size_t alignment)
+{
+    const auto* mm = p.get_main_module();
+    return std::all_of(mm->begin(), mm->end(), [&](const migraphx::instruction& ins) {
+        if(ins.name() != "@literal")
+            return true;
+        return reinterpret_cast<std::uintptr_t>(ins.get_literal().data()) % alignment == 0;
+    });
+}
+
+TEST_CASE(as_mapped_file)
+{
+    std::string filename = "migraphx_program_mapped.mxr";
+    migraphx::file_options options;
+    options.mapped_literals = true;
+    migraphx::program p1    = create_program_with_literals();
+    migraphx::save(p1, filename, options);
+    // The file format is detected when loading
+    migraphx::program p2 = migraphx::load(filename);
+    std::remove(filename.c_str());
+    EXPECT(p1.sort() == p2.sort());
+    EXPECT(literals_aligned(p2, 4096));
+}
+
+TEST_CASE(as_mapped_buffer)
+{
+    migraphx::file_options options;
+    options.mapped_literals  = true;
+    migraphx::program p1     = create_program_with_literals();
+    std::vector<char> buffer = migraphx::save_buffer(p1, options);
+    migraphx::program p2     = migraphx::load_buffer(buffer);
+    EXPECT(p1.sort() == p2.sort());
+}
+
+TEST_CASE(as_mapped_file_eval)
+{
+    std::string filename = "migraphx_program_mapped_eval.mxr";
+    migraphx::file_options options;
+    options.mapped_literals = true;
+    migraphx::program p1    = create_program_with_literals();
+    migraphx::save(p1, filename, options);
+    migraphx::program p2 = migraphx::load(filename);
+    std::remove(filename.c_str());
+    p1.compile(migraphx::make_target("ref"));
+    p2.compile(migraphx::make_target("ref"));
+    migraphx::shape s{migraphx::shape::float_type, {3, 5}};
+    std::vector<float> x(s.elements(), 2.0f);
+    migraphx::parameter_map params = {{"x", migraphx::argument{s, x.data()}}};
+    auto r1                        = p1.eval(params);
+    auto r2                        = p2.eval(params);
+    EXPECT(r1 == r2);
+}
+
+TEST_CASE(mapped_truncated)
+{
+    migraphx::file_options options;
+    options.mapped_literals  = true;
+    std::vector<char> buffer = migraphx::save_buffer(create_program_with_literals(), options);
+    // Truncate the literals
+    buffer.erase(buffer.begin() + 4096, buffer.begin() + 8192);
+    EXPECT(test::throws([&] { migraphx::load_buffer(buffer); }));
+}
+
 TEST_CASE(compiled)
 {
     migraphx::program p1 = create_program();
@@ -88,6 +171,21 @@ TEST_CASE(compiled)
     EXPECT(p1.sort() == p2.sort());
 }
 
+TEST_CASE(with_key)
+{
+    migraphx::file_options options;
+    options.format           = "json";
+    options.key              = "key1";
+    migraphx::program p1     = create_program();
+    std::vector<char> buffer = migraphx::save_buffer(p1, options);
+    EXPECT(p1.sort() == migraphx::load_buffer(buffer, options).sort());
+    // The key is only checked when loading with one
+    options.key = "";
+    EXPECT(p1.sort() == migraphx::load_buffer(buffer, options).sort());
+    options.key = "key2";
+    EXPECT(test::throws([&] { migraphx::load_buffer(buffer, options); }));
+}
+
 TEST_CASE(unknown_format)
 {
     migraphx::file_options options;
@@ -0,0 +1,130 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/strided_for_each.hpp>
+#include <migraphx/shape_for_each.hpp>
+#include <algorithm>
+#include <atomic>
+#include <vector>
+#include "test.hpp"
+
+static migraphx::shape make_shape(std::vector<std::size_t> lens, std::vector<std::size_t> strides)
+{
+    return {migraphx::shape::float_type, std::move(lens), std::move(strides)};
+}
+
+// The offsets computed from the multi index of every element
+static std::vector<std::vector<std::size_t>>
+expected_offsets(const std::vector<migraphx::shape>& ss)
+{
+    std::vector<std::vector<std::size_t>> result;
+    migraphx::shape_for_each(ss.front(), [&](const auto& idx) {
+        std::vector<std::size_t> offsets;
+        for(const auto& s : ss)
+            offsets.push_back(s.index(idx));
+        result.push_back(offsets);
+    });
+    return result;
+}
+
+TEST_CASE(shape_for_each_order)
+{
+    migraphx::shape s{migraphx::shape::float_type, {2, 3, 4}};
+    std::size_t n = 0;
+    migraphx::shape_for_each(s, [&](const auto& idx, std::size_t i) {
+        EXPECT(i == n);
+        EXPECT(idx == s.multi(i));
+        n++;
+    });
+    EXPECT(n == s.elements());
+}
+
+TEST_CASE(shape_for_each_scalar)
+{
+    std::size_t n = 0;
+    migraphx::shape_for_each(migraphx::shape{migraphx::shape::float_type}, [&](const auto&) {
+        n++;
+    });
+    EXPECT(n == 1);
+}
+
+TEST_CASE(strided_transpose)
+{
+    auto out = make_shape({2, 3, 4}, {12, 4, 1});
+    auto in  = make_shape({2, 3, 4}, {1, 8, 2});
+    std::vector<std::vector<std::size_t>> result;
+    migraphx::strided_for_each(out, in)(
+        [&](auto o, auto i) { result.push_back({o, i}); });
+    EXPECT(result == expected_offsets({out, in}));
+}
+
+TEST_CASE(strided_broadcast)
+{
+    auto out = make_shape({4, 1, 5, 6}, {30, 30, 6, 1});
+    auto in  = make_shape({4, 1, 5, 6}, {0, 0, 1, 0});
+    std::vector<std::vector<std::size_t>> result;
+    migraphx::strided_for_each(out, in)(
+        [&](auto o, auto i) { result.push_back({o, i}); });
+    EXPECT(result == expected_offsets({out, in}));
+}
+
+TEST_CASE(strided_sliced)
+{
+    // Only the two inner dimensions can be merged
+    auto out = make_shape({3, 4, 5}, {20, 5, 1});
+    auto in  = make_shape({3, 4, 5}, {40, 5, 1});
+    std::vector<std::vector<std::size_t>> result;
+    migraphx::strided_for_each(out, in)(
+        [&](auto o, auto i) { result.push_back({o, i}); });
+    EXPECT(result == expected_offsets({out, in}));
+}
+
+TEST_CASE(strided_scalar_and_empty)
+{
+    std::size_t n = 0;
+    migraphx::strided_for_each(migraphx::shape{migraphx::shape::float_type})([&](auto i) {
+        EXPECT(i == 0);
+        n++;
+    });
+    EXPECT(n == 1);
+    migraphx::strided_for_each(migraphx::shape{migraphx::shape::float_type, {2, 0, 3}})(
+        [&](auto) { n++; });
+    EXPECT(n == 1);
+}
+
+TEST_CASE(par_strided_all_elements)
+{
+    auto out = make_shape({7, 9, 11}, {99, 11, 1});
+    auto in  = make_shape({7, 9, 11}, {1, 77, 7});
+    std::vector<std::atomic<std::size_t>> seen(out.elements());
+    std::atomic<bool> matches{true};
+    migraphx::par_strided_for_each(16, out, in)([&](auto o, auto i) {
+        seen[o]++;
+        if(in.index(out.multi(o)) != i)
+            matches = false;
+    });
+    EXPECT(matches.load());
+    EXPECT(std::all_of(seen.begin(), seen.end(), [](const auto& x) { return x == 1; }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
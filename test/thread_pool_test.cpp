@@ -0,0 +1,288 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+#include <migraphx/thread_pool.hpp>
+#include <migraphx/par_for.hpp>
+#include <migraphx/simple_par_for.hpp>
+#include <migraphx/time.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+#include "test.hpp"
+
+TEST_CASE(run_all_tasks)
+{
+    migraphx::thread_pool pool{4};
+    EXPECT(pool.size() == 4);
+    std::vector<std::atomic<int>> visited(1000);
+    pool.run(visited.size(), 4, [&](std::size_t i, std::size_t tid) {
+        EXPECT(tid < 4);
+        visited[i]++;
+    });
+    EXPECT(std::all_of(visited.begin(), visited.end(), [](const auto& x) { return x == 1; }));
+    auto stats = pool.stats();
+    EXPECT(stats.jobs == 1);
+    EXPECT(stats.tasks == visited.size());
+}
+
+TEST_CASE(run_max_threads)
+{
+    migraphx::thread_pool pool{4};
+    std::vector<std::size_t> tids(100);
+    pool.run(tids.size(), 2, [&](std::size_t i, std::size_t tid) { tids[i] = tid; });
+    EXPECT(std::all_of(tids.begin(), tids.end(), [](auto tid) { return tid < 2; }));
+}
+
+TEST_CASE(run_single_thread)
+{
+    migraphx::thread_pool pool{1};
+    std::vector<std::size_t> order;
+    pool.run(10, 4, [&](std::size_t i, std::size_t tid) {
+        EXPECT(tid == 0);
+        order.push_back(i);
+    });
+    std::vector<std::size_t> expected(10);
+    std::iota(expected.begin(), expected.end(), 0);
+    EXPECT(order == expected);
+    EXPECT(pool.stats().jobs == 0);
+}
+
+TEST_CASE(run_repeated)
+{
+    migraphx::thread_pool pool{3};
+    std::atomic<std::size_t> total{0};
+    for(std::size_t j = 0; j < 200; j++)
+        pool.run(j % 7, 3, [&](std::size_t i, std::size_t) { total += i + 1; });
+    std::size_t expected = 0;
+    for(std::size_t j = 0; j < 200; j++)
+        expected += (j % 7) * (j % 7 + 1) / 2;
+    EXPECT(total.load() == expected);
+}
+
+TEST_CASE(run_nested)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<std::size_t> total{0};
+    pool.run(8, 4, [&](std::size_t, std::size_t) {
+        pool.run(8, 4, [&](std::size_t, std::size_t) { total++; });
+    });
+    EXPECT(total.load() == 64);
+}
+
+TEST_CASE(run_exception)
+{
+    migraphx::thread_pool pool{4};
+    EXPECT(test::throws<std::runtime_error>([&] {
+        pool.run(100, 4, [&](std::size_t i, std::size_t) {
+            if(i == 57)
+                throw std::runtime_error("task failed");
+        });
+    }));
+    // The pool is still usable after an exception
+    std::atomic<std::size_t> count{0};
+    pool.run(100, 4, [&](std::size_t, std::size_t) { count++; });
+    EXPECT(count.load() == 100);
+}
+
+TEST_CASE(run_unbalanced)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<std::size_t> count{0};
+    // All of the expensive tasks are in the first queue, so the other threads steal them
+    pool.run(64, 4, [&](std::size_t i, std::size_t) {
+        if(i < 16)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        count++;
+    });
+    EXPECT(count.load() == 64);
+    EXPECT(pool.stats().steals > 0);
+    pool.reset_stats();
+    EXPECT(pool.stats().tasks == 0);
+    EXPECT(pool.stats().steals == 0);
+}
+
+TEST_CASE(par_for_exception)
+{
+    EXPECT(test::throws<std::runtime_error>([&] {
+        migraphx::par_for(1000, 1, [&](std::size_t i) {
+            if(i == 999)
+                throw std::runtime_error("loop failed");
+        });
+    }));
+}
+
+TEST_CASE(par_for_tid)
+{
+    std::vector<std::size_t> tids(1024);
+    migraphx::simple_par_for(
+        tids.size(), 1, [&](std::size_t i, std::size_t tid) { tids[i] = tid; });
+    EXPECT(std::all_of(tids.begin(), tids.end(), [](auto tid) {
+        return tid < std::thread::hardware_concurrency();
+    }));
+}
+
+TEST_CASE(run_concurrent)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    std::mutex m;
+    std::set<std::thread::id> ids;
+    std::set<std::size_t> tids;
+    // The first job keeps two of the threads busy until the second job is done, so the second
+    // job is shared with the two other workers
+    migraphx::joinable_thread first([&] {
+        pool.run(2, 2, [&](std::size_t, std::size_t) {
+            started = true;
+            while(not finished)
+                std::this_thread::yield();
+        });
+    });
+    while(not started)
+        std::this_thread::yield();
+    pool.run(8, 4, [&](std::size_t, std::size_t tid) {
+        EXPECT(tid < 4);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(m);
+        ids.insert(std::this_thread::get_id());
+        tids.insert(tid);
+    });
+    finished = true;
+    EXPECT(ids.size() > 1);
+    EXPECT(ids.size() == tids.size());
+}
+
+TEST_CASE(run_concurrent_busy)
+{
+    migraphx::thread_pool pool{4};
+    std::atomic<bool> started{false};
+    std::atomic<bool> finished{false};
+    // The first job keeps all of the threads busy, so the calling thread runs the second job
+    migraphx::joinable_thread first([&] {
+        pool.run(4, 4, [&](std::size_t, std::size_t) {
+            started = true;
+            while(not finished)
+                std::this_thread::yield();
+        });
+    });
+    while(not started)
+        std::this_thread::yield();
+    std::atomic<std::size_t> count{0};
+    EXPECT(test::throws<std::runtime_error>([&] {
+        pool.run(8, 4, [&](std::size_t i, std::size_t) {
+            count++;
+            if(i == 3)
+                throw std::runtime_error("task failed");
+        });
+    }));
+    finished = true;
+    EXPECT(count.load() == 8);
+}
+
+TEST_CASE(run_restart)
+{
+    migraphx::thread_pool pool{4};
+    pool.restart();
+    EXPECT(pool.size() == 4);
+    std::atomic<std::size_t> count{0};
+    pool.run(100, 4, [&](std::size_t, std::size_t) { count++; });
+    EXPECT(count.load() == 100);
+}
+
+#ifndef _WIN32
+TEST_CASE(run_after_fork)
+{
+    auto& pool = migraphx::get_thread_pool();
+    std::atomic<std::size_t> count{0};
+    pool.run(100, pool.size(), [&](std::size_t, std::size_t) { count++; });
+    auto pid = fork();
+    if(pid == 0)
+    {
+        // The pool is restarted by getting it in the child
+        auto& child_pool = migraphx::get_thread_pool();
+        std::atomic<std::size_t> child_count{0};
+        child_pool.run(100, child_pool.size(), [&](std::size_t, std::size_t) { child_count++; });
+        _exit(child_count == 100 ? 0 : 1);
+    }
+    EXPECT(pid > 0);
+    int status = 0;
+    EXPECT(waitpid(pid, &status, 0) == pid);
+    EXPECT(WIFEXITED(status));
+    EXPECT(WEXITSTATUS(status) == 0);
+    EXPECT(count.load() == 100);
+}
+#endif
+
+// The previous implementation of simple_par_for which starts new threads for every loop
+template <class F>
+void spawn_par_for(std::size_t n, std::size_t threadsize, F f)
+{
+    std::vector<migraphx::joinable_thread> threads;
+    std::size_t grainsize = (n + threadsize - 1) / threadsize;
+    for(std::size_t work = 0; work < n; work += grainsize)
+    {
+        threads.emplace_back([=] {
+            for(std::size_t i = work; i < std::min(n, work + grainsize); i++)
+                f(i);
+        });
+    }
+}
+
+TEST_CASE(dispatch_benchmark)
+{
+    const std::size_t n          = 1024;
+    const std::size_t iterations = 200;
+    const std::size_t threadsize = std::max(2u, std::thread::hardware_concurrency());
+    std::vector<float> x(n, 1.0f);
+    auto body  = [&](std::size_t i) { x[i] = x[i] * 0.5f + 1.0f; };
+    auto spawn = migraphx::time<std::chrono::duration<double, std::micro>>([&] {
+        for(std::size_t j = 0; j < iterations; j++)
+            spawn_par_for(n, threadsize, body);
+    });
+    auto& pool = migraphx::get_thread_pool();
+    pool.reset_stats();
+    auto pooled = migraphx::time<std::chrono::duration<double, std::micro>>([&] {
+        for(std::size_t j = 0; j < iterations; j++)
+            migraphx::simple_par_for_impl(n, threadsize, body);
+    });
+    auto stats = pool.stats();
+    std::cout << "par_for dispatch with " << threadsize << " threads: spawn "
+              << spawn / iterations << "us, pool " << pooled / iterations << "us" << std::endl;
+    std::cout << "pool jobs: " << stats.jobs << ", tasks: " << stats.tasks
+              << ", steals: " << stats.steals << ", idle: " << stats.idle_ns / 1000 << "us"
+              << std::endl;
+    EXPECT(std::all_of(x.begin(), x.end(), [](auto v) { return v > 1.0f; }));
+}
+
+int main(int argc, const char* argv[]) { test::run(argc, argv); }
@@ -0,0 +1,56 @@
+/*
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ */
+
+#include "verify_program.hpp"
+#include <migraphx/program.hpp>
+#include <migraphx/generate.hpp>
+#include <migraphx/make_op.hpp>
+
+struct test_pointwise_chain_broadcast : verify_program<test_pointwise_chain_broadcast>
+{
+    migraphx::program create_program() const
+    {
+        migraphx::shape s{migraphx::shape::float_type, {2, 3, 16, 17}};
+        migraphx::shape bs{migraphx::shape::float_type, {3}};
+        migraphx::program p;
+        auto* mm   = p.get_main_module();
+        auto x     = mm->add_parameter("x", s);
+        auto y     = mm->add_parameter("y", {migraphx::shape::float_type, {2, 3, 17, 16}});
+        auto b     = mm->add_parameter("b", bs);
+        auto yt    = mm->add_instruction(
+            migraphx::make_op("transpose", {{"permutation", {0, 1, 3, 2}}}), y);
+        auto bb    = mm->add_instruction(
+            migraphx::make_op("broadcast", {{"axis", 1}, {"out_lens", s.lens()}}), b);
+        auto half  = mm->add_literal(migraphx::literal{migraphx::shape{s.type()}, {0.5f}});
+        auto halfb = mm->add_instruction(
+            migraphx::make_op("multibroadcast", {{"out_lens", s.lens()}}), half);
+        auto add   = mm->add_instruction(migraphx::make_op("add"), x, bb);
+        auto mul   = mm->add_instruction(migraphx::make_op("mul"), add, halfb);
+        auto leaky = mm->add_instruction(migraphx::make_op("leaky_relu", {{"alpha", 0.1f}}), mul);
+        auto sig   = mm->add_instruction(migraphx::make_op("sigmoid"), leaky);
+        auto sqd   = mm->add_instruction(migraphx::make_op("sqdiff"), sig, yt);
+        mm->add_return({sqd});
+        return p;
+    }
+};
@@ -21,6 +21,7 @@
  * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
  * THE SOFTWARE.
  */
+#include <migraphx/batch_executor.hpp>
 #include <migraphx/execution_environment.hpp>
 #include <migraphx/migraphx.h>
 #include <migraphx/rank.hpp>
@@ -149,6 +150,13 @@ void set_exhaustive_tune_flag(compile_options& options, bool value)
 
 void set_file_format(file_options& options, const char* format) { options.format = format; }
 
+void set_max_batch(batch_executor_options& options, size_t value) { options.max_batch = value; }
+
+void set_max_latency(batch_executor_options& options, size_t value)
+{
+    options.max_latency = std::chrono::microseconds{value};
+}
+
 void set_default_dim_value(onnx_options& options, size_t value)
 {
     options.default_dim_value = value;
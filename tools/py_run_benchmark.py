@@ -0,0 +1,99 @@
+#####################################################################################
+# The MIT License (MIT)
+#
+# Copyright (c) 2015-2024 Advanced Micro Devices, Inc. All rights reserved.
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in
+# all copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+# THE SOFTWARE.
+#####################################################################################
+import argparse
+import threading
+import time
+import migraphx
+import numpy as np
+
+
+def parse_args():
+    parser = argparse.ArgumentParser(
+        description=
+        'Measures the throughput of program.run from several python threads')
+    parser.add_argument('--model',
+                        type=str,
+                        required=True,
+                        help='path to onnx file')
+    parser.add_argument('--target',
+                        type=str,
+                        default='ref',
+                        help='target to compile the model for')
+    parser.add_argument('--threads',
+                        type=int,
+                        nargs='+',
+                        default=[1, 2, 4],
+                        help='number of python threads to measure')
+    parser.add_argument('--iterations',
+                        type=int,
+                        default=100,
+                        help='number of runs in each thread')
+    parser.add_argument('--outputs',
+                        action='store_true',
+                        help='write the outputs into preallocated numpy arrays')
+    return parser.parse_args()
+
+
+def create_outputs(p):
+    return [
+        np.array(migraphx.generate_argument(s)) for s in p.get_output_shapes()
+    ]
+
+
+def measure(p, nthreads, iterations, use_outputs):
+    params = {}
+    for name, s in p.get_parameter_shapes().items():
+        params[name] = migraphx.generate_argument(s)
+
+    def run():
+        outputs = create_outputs(p) if use_outputs else None
+        for _ in range(iterations):
+            results = p.run(params, outputs)
+            if not use_outputs:
+                # Converting to numpy is the copy that outputs avoids
+                [np.array(r) for r in results]
+
+    threads = [threading.Thread(target=run) for _ in range(nthreads)]
+    start = time.perf_counter()
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    return nthreads * iterations / (time.perf_counter() - start)
+
+
+def main():
+    args = parse_args()
+    p = migraphx.parse_onnx(args.model)
+    p.compile(migraphx.get_target(args.target), offload_copy=True)
+    baseline = None
+    for nthreads in args.threads:
+        throughput = measure(p, nthreads, args.iterations, args.outputs)
+        baseline = baseline or throughput
+        print('threads: {}, runs/s: {:.2f}, speedup: {:.2f}x'.format(
+            nthreads, throughput, throughput / baseline))
+
+
+if __name__ == '__main__':
+    main()